@@ -30,6 +30,9 @@ check_symbol_exists("getnameinfo" "netdb.h" AVS_COMMONS_NET_POSIX_AVS_SOCKET_HAV
 check_symbol_exists("inet_ntop" "arpa/inet.h" AVS_COMMONS_NET_POSIX_AVS_SOCKET_HAVE_INET_NTOP)
 check_symbol_exists("poll" "poll.h" AVS_COMMONS_NET_POSIX_AVS_SOCKET_HAVE_POLL)
 check_symbol_exists("recvmsg" "sys/socket.h" AVS_COMMONS_NET_POSIX_AVS_SOCKET_HAVE_RECVMSG)
+check_symbol_exists("sendmsg" "sys/socket.h" AVS_COMMONS_NET_POSIX_AVS_SOCKET_HAVE_SENDMSG)
+check_symbol_exists("sendfile" "sys/sendfile.h" AVS_COMMONS_NET_POSIX_AVS_SOCKET_HAVE_SENDFILE)
+check_symbol_exists("mmap" "sys/mman.h" AVS_COMMONS_HAVE_MMAP)
 
 # When _POSIX_C_SOURCE is defined, but none of _BSD_SOURCE, _SVID_SOURCE and
 # _GNU_SOURCE, some toolchains (e.g. default GCC on Ubuntu 16.04 or CentOS 7)
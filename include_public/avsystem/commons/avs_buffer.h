@@ -248,6 +248,199 @@ int avs_buffer_advance_ptr(avs_buffer_t *buffer, size_t count);
  */
 int avs_buffer_fill_bytes(avs_buffer_t *buffer, int value, size_t bytes_count);
 
+struct avs_ring_buffer_struct;
+typedef struct avs_ring_buffer_struct avs_ring_buffer_t;
+/**<
+ * Ring byte buffer object type.
+ *
+ * Unlike @ref avs_buffer_t, which moves all pending data to the beginning of
+ * its storage whenever contiguous free space is needed, a ring buffer never
+ * moves any data. In exchange, both the data and the free space may wrap
+ * around the end of the storage, so they are exposed as up to two contiguous
+ * segments each.
+ */
+
+/**
+ * Contiguous segment of data or free space in a ring buffer.
+ */
+typedef struct {
+    /**
+     * Pointer to the beginning of the segment.
+     */
+    char *ptr;
+
+    /**
+     * Size of the segment, in bytes.
+     */
+    size_t size;
+} avs_ring_buffer_segment_t;
+
+/**
+ * Allocates a new ring buffer with a specified size (capacity).
+ *
+ * @param buffer Pointer to a variable which will be updated with the newly
+ *               allocated buffer object.
+ *
+ * @param size   Desired capacity of the buffer, in bytes.
+ *
+ * @return 0 for success, or -1 in case of error.
+ */
+int avs_ring_buffer_create(avs_ring_buffer_t **buffer, size_t size);
+
+/**
+ * Destroys a ring buffer object, freeing any used resources.
+ *
+ * @param buffer Pointer to a variable containing a buffer to free. It will be
+ *               reset to <c>NULL</c> afterwards.
+ */
+void avs_ring_buffer_free(avs_ring_buffer_t **buffer);
+
+/**
+ * Clears the ring buffer, making all its capacity available to data.
+ *
+ * @param buffer Buffer object to operate on.
+ */
+void avs_ring_buffer_reset(avs_ring_buffer_t *buffer);
+
+/**
+ * @param buffer Buffer object to operate on.
+ *
+ * @return Number of bytes ready to consume in the buffer.
+ */
+size_t avs_ring_buffer_data_size(const avs_ring_buffer_t *buffer);
+
+/**
+ * @param buffer Buffer object to operate on.
+ *
+ * @return Total number of all bytes usable by the buffer.
+ */
+size_t avs_ring_buffer_capacity(const avs_ring_buffer_t *buffer);
+
+/**
+ * @param buffer Buffer object to operate on.
+ *
+ * @return Number of bytes that can currently be appended to the buffer.
+ */
+size_t avs_ring_buffer_space_left(const avs_ring_buffer_t *buffer);
+
+/**
+ * Returns the data contained in the ring buffer, as up to two contiguous
+ * segments, in order.
+ *
+ * The segments remain valid until the data is consumed, or the buffer is reset
+ * or freed. Appending data never invalidates them.
+ *
+ * @param buffer       Buffer object to operate on.
+ *
+ * @param out_segments Array that will be filled with the segments. Unused
+ *                     entries are set to an empty segment.
+ *
+ * @return Number of non-empty segments: 0, 1 or 2.
+ */
+size_t
+avs_ring_buffer_data_segments(avs_ring_buffer_t *buffer,
+                              avs_ring_buffer_segment_t out_segments[2]);
+
+/**
+ * Returns the free space in the ring buffer, as up to two contiguous segments,
+ * in order.
+ *
+ * This can be used to pass the buffer to external functions such as receiving
+ * from a network socket. After filling the segments, in order,
+ * @ref avs_ring_buffer_advance_ptr shall be called with the number of bytes
+ * filled.
+ *
+ * If the buffer is empty, the whole capacity is returned as a single segment.
+ *
+ * @param buffer       Buffer object to operate on.
+ *
+ * @param out_segments Array that will be filled with the segments. Unused
+ *                     entries are set to an empty segment.
+ *
+ * @return Number of non-empty segments: 0, 1 or 2.
+ */
+size_t
+avs_ring_buffer_space_segments(avs_ring_buffer_t *buffer,
+                               avs_ring_buffer_segment_t out_segments[2]);
+
+/**
+ * Copies data from the ring buffer without consuming it.
+ *
+ * @param buffer Buffer object to operate on.
+ *
+ * @param offset Offset of the first byte to copy, relative to the beginning of
+ *               the data.
+ *
+ * @param dest   Destination buffer.
+ *
+ * @param size   Number of bytes to copy.
+ *
+ * @return 0 for success, or -1 in case of error (not enough data in buffer).
+ */
+int avs_ring_buffer_copy_data(const avs_ring_buffer_t *buffer,
+                              size_t offset,
+                              void *dest,
+                              size_t size);
+
+/**
+ * Marks some amount of data as consumed, freeing portion of the available
+ * capacity.
+ *
+ * @param buffer      Buffer object to operate on.
+ *
+ * @param bytes_count Number of bytes to mark as consumed.
+ *
+ * @return 0 for success, or -1 in case of error (not enough data in buffer).
+ */
+int avs_ring_buffer_consume_bytes(avs_ring_buffer_t *buffer,
+                                  size_t bytes_count);
+
+/**
+ * Appends bytes to the end of the ring buffer.
+ *
+ * @param buffer      Buffer object to operate on.
+ *
+ * @param data        Pointer to data to append.
+ *
+ * @param data_length Number of bytes to append.
+ *
+ * @return 0 for success, or -1 in case of error (not enough free space in
+ *         buffer).
+ */
+int avs_ring_buffer_append_bytes(avs_ring_buffer_t *buffer,
+                                 const void *data,
+                                 size_t data_length);
+
+/**
+ * Marks some amount of data as appended, after filling the segments returned
+ * by @ref avs_ring_buffer_space_segments.
+ *
+ * @param buffer Buffer object to operate on.
+ *
+ * @param count  Number of bytes to mark as appended.
+ *
+ * @return 0 for success, or -1 in case of error (not enough free space in
+ *         buffer).
+ */
+int avs_ring_buffer_advance_ptr(avs_ring_buffer_t *buffer, size_t count);
+
+/**
+ * Appends a number of bytes with a specified value to the ring buffer.
+ *
+ * @param buffer      Buffer object to operate on.
+ *
+ * @param value       <c>unsigned char</c> value of constant byte to fill the
+ *                    data, cast to <c>int</c>.
+ *
+ * @param bytes_count Number of bytes to append.
+ *
+ * @return 0 for success, or -1 in case of error (not enough free space in
+ *         buffer).
+ */
+int avs_ring_buffer_fill_bytes(avs_ring_buffer_t *buffer,
+                               int value,
+                               size_t bytes_count);
+
 #ifdef __cplusplus
 }
 #endif
@@ -55,7 +55,7 @@ typedef struct {
      * used, this will be the size of the input buffer for zlib operation.
      *
      * Additionally, zlib's output buffer is hard-configured to 120% of this
-     * value.
+     * value. The same buffer sizes are used for Brotli and zstd decompression.
      *
      * Configured to 4096 in @ref AVS_HTTP_DEFAULT_BUFFER_SIZES, which means
      * 4096 bytes in input buffer and 4915 bytes in output buffer.
@@ -133,12 +133,19 @@ typedef enum { AVS_HTTP_GET, AVS_HTTP_POST, AVS_HTTP_PUT } avs_http_method_t;
  * <c>WITH_AVS_HTTP_ZLIB</c> compile-time flag, and
  * <c>AVS_HTTP_CONTENT_COMPRESS</c> is currently unsupported and only present
  * for API completeness.
+ *
+ * <c>AVS_HTTP_CONTENT_BROTLI</c> and <c>AVS_HTTP_CONTENT_ZSTD</c> are supported
+ * only for decoding responses, if the library has been compiled with the
+ * <c>WITH_AVS_HTTP_BROTLI</c> or <c>WITH_AVS_HTTP_ZSTD</c> compile-time flag,
+ * respectively. They cannot be used for encoding requests.
  */
 typedef enum {
     AVS_HTTP_CONTENT_IDENTITY,
     AVS_HTTP_CONTENT_GZIP,
     AVS_HTTP_CONTENT_COMPRESS,
-    AVS_HTTP_CONTENT_DEFLATE
+    AVS_HTTP_CONTENT_DEFLATE,
+    AVS_HTTP_CONTENT_BROTLI,
+    AVS_HTTP_CONTENT_ZSTD
 } avs_http_content_encoding_t;
 
 /**
@@ -294,6 +301,126 @@ void avs_http_tcp_configuration(
  */
 int avs_http_set_user_agent(avs_http_t *http, const char *user_agent);
 
+/**
+ * Configures reuse of connections between HTTP streams created by the client.
+ *
+ * When enabled, closing an HTTP stream whose connection is still usable (i.e.
+ * the last response has been read to the end and the server has not requested
+ * closing the connection) does not close the socket, but keeps it in a pool
+ * owned by the client. A subsequent @ref avs_http_open_stream call for the same
+ * scheme, host and port takes the connection from the pool, saving the TCP and
+ * TLS handshakes. If the server closes a pooled connection in the meantime,
+ * the first request on it is automatically retried on a new connection, in the
+ * same way as for consecutive requests within a single stream.
+ *
+ * Connections are pooled separately for each scheme, host and port. Expired
+ * connections are closed lazily, the next time the pool is accessed.
+ *
+ * The pool is disabled by default. Changing TCP or SSL configuration of the
+ * client closes all the pooled connections.
+ *
+ * @param http              HTTP client to operate on.
+ *
+ * @param max_idle_per_host Maximum number of idle connections kept for each
+ *                          scheme, host and port. When exceeded, the connection
+ *                          that has been idle for the longest time is closed.
+ *                          0 disables pooling and closes all the pooled
+ *                          connections.
+ *
+ * @param idle_timeout      Time after which an idle connection is closed
+ *                          instead of being reused. An invalid duration means
+ *                          no limit.
+ */
+void avs_http_set_connection_pool(avs_http_t *http,
+                                  size_t max_idle_per_host,
+                                  avs_time_duration_t idle_timeout);
+
+/**
+ * Closes all the connections kept in the pool of the HTTP client. See
+ * @ref avs_http_set_connection_pool for details.
+ *
+ * @param http HTTP client to operate on.
+ */
+void avs_http_clear_connection_pool(avs_http_t *http);
+
+/**
+ * Configures reuse of compression state between HTTP streams.
+ *
+ * When enabled, the zlib state and the buffers of a compressor or decompressor
+ * used for Content-Encoding of a request or response are not released when the
+ * message is done, but kept in a pool owned by the client. A subsequent message
+ * compressed or decompressed with the same parameters takes the state from the
+ * pool and only resets it, instead of initializing zlib and allocating buffers
+ * from scratch. This is mostly beneficial for many short compressed messages.
+ *
+ * Each idle decompressor state occupies a few dozen kilobytes of memory (and a
+ * compressor state several times that), in addition to the input and output
+ * buffers sized according to <c>content_coding_input</c>.
+ *
+ * The pool is disabled by default. This function has no effect if avs_http has
+ * been compiled without zlib support.
+ *
+ * @param http            HTTP client to operate on.
+ *
+ * @param max_idle_states Maximum number of idle states kept in the pool. When
+ *                        exceeded, the least recently used state is released.
+ *                        0 disables pooling and releases all the pooled states.
+ */
+void avs_http_set_compression_pool(avs_http_t *http, size_t max_idle_states);
+
+/**
+ * Callback function type used by @ref avs_http_set_header_cb .
+ *
+ * @param stream   HTTP stream on which the header has been received.
+ *
+ * @param key      Keyword of the received header, as sent by the server.
+ *
+ * @param value    Value of the received header, with leading whitespace
+ *                 removed.
+ *
+ * @param user_ptr Opaque pointer previously set using
+ *                 @ref avs_http_set_header_cb.
+ *
+ * @return Error code. If not AVS_OK, receiving the response will be aborted and
+ *         the error will be forwarded through the stream method that caused it
+ *         (usually <c>avs_stream_finish_message()</c>).
+ */
+typedef avs_error_t avs_http_header_cb_t(avs_stream_t *stream,
+                                         const char *key,
+                                         const char *value,
+                                         void *user_ptr);
+
+/**
+ * Sets callback that will be executed for each HTTP response header with the
+ * specified keyword, received on any stream created by the client.
+ *
+ * This allows capturing headers not interpreted by <c>avs_http</c> itself
+ * without having to enable header storage (see
+ * @ref avs_http_set_header_storage) and search through it after each response.
+ * The callback is also called for headers that are interpreted internally,
+ * after they have been handled.
+ *
+ * Only one callback may be set for a given keyword. Setting a callback for a
+ * keyword that already has one replaces it.
+ *
+ * @param http     HTTP client to operate on.
+ *
+ * @param key      Keyword of the header, compared case-insensitively. The
+ *                 string is copied.
+ *
+ * @param cb       Pointer to a callback function, or <c>NULL</c> to remove the
+ *                 callback previously set for @p key.
+ *
+ * @param user_ptr Opaque pointer that will be forwarded to the callback
+ *                 function on every call.
+ *
+ * @return 0 for success, or a negative value in case of an out-of-memory error.
+ */
+int avs_http_set_header_cb(avs_http_t *http,
+                           const char *key,
+                           avs_http_header_cb_t *cb,
+                           void *user_ptr);
+
 /**
  * Creates a new HTTP stream, which may be used to perform a series of related
  * HTTP requests, nominally within a single connection to the same server.
@@ -525,6 +652,66 @@ int avs_http_should_retry(avs_stream_t *stream);
  */
 int avs_http_status_code(avs_stream_t *stream);
 
+/**
+ * Enables or disables HTTP/1.1 request pipelining on a stream.
+ *
+ * In pipelining mode, <c>avs_stream_finish_message()</c> sends the request
+ * without waiting for the response, so that multiple requests may be queued on
+ * a single keep-alive connection. Responses are received, in the order in which
+ * the requests have been sent, using @ref avs_http_receive_response. Each
+ * response body shall be read to the end before receiving the next response.
+ *
+ * A copy of each request is retained until its response is received. If the
+ * server closes the connection before responding to all of them, the stream
+ * reconnects and sends all the requests that have not been responded to again.
+ * Only requests that are safe to repeat (e.g. idempotent ones) shall thus be
+ * pipelined, as the server might have already processed some of them.
+ *
+ * Limitations of the pipelining mode:
+ * - the whole request body needs to fit in the <c>body_send</c> buffer (see
+ *   @ref avs_http_buffer_sizes_t), as chunked encoding is not supported -
+ *   <c>AVS_EMSGSIZE</c> is returned otherwise,
+ * - redirects are not followed; 3xx responses are treated as errors,
+ * - requests are not retried automatically after a 401 or 417 response -
+ *   @ref avs_http_should_retry may be used to determine whether such request
+ *   should be repeated.
+ *
+ * @param stream  Stream to operate on. Need to be a stream created by
+ *                @ref avs_http_open_stream.
+ *
+ * @param enabled True to enable pipelining, false to disable it.
+ *
+ * @return 0 for success, or a negative value in case of error, e.g. when
+ *         trying to change the mode while a response is being received or there
+ *         are responses that have not been received yet.
+ */
+int avs_http_set_pipelining(avs_stream_t *stream, bool enabled);
+
+/**
+ * Receives headers of the response to the oldest request sent in pipelining
+ * mode (see @ref avs_http_set_pipelining) that has not been responded to yet.
+ *
+ * On success, the response body may be read using <c>avs_stream_read()</c>.
+ * Non-2xx responses are reported the same way as in the non-pipelining mode,
+ * i.e. as errors of @ref AVS_HTTP_ERROR_CATEGORY, with the body discarded.
+ *
+ * @param stream Stream to operate on. Need to be a stream created by
+ *               @ref avs_http_open_stream.
+ *
+ * @return @ref AVS_OK for success, or an error condition for which the
+ *         operation failed. <c>AVS_ENOENT</c> is returned if there are no
+ *         pipelined requests awaiting response, and <c>AVS_EBUSY</c> if the
+ *         body of the previous response has not been read to the end.
+ */
+avs_error_t avs_http_receive_response(avs_stream_t *stream);
+
+/**
+ * Returns the number of requests sent in pipelining mode (see
+ * @ref avs_http_set_pipelining) for which the responses have not been received
+ * yet using @ref avs_http_receive_response.
+ */
+size_t avs_http_pending_responses(avs_stream_t *stream);
+
 #ifdef __cplusplus
 }
 #endif
@@ -155,9 +155,172 @@ void avs_log_set_extended_handler(avs_log_extended_handler_t *log_handler);
 /**
  * Resets the logging system to default settings and frees all resources that
  * may be used by it.
+ *
+ * If asynchronous logging is enabled, all pending messages are delivered to
+ * the currently set handler and the asynchronous mode is disabled, as if
+ * @ref avs_log_async_disable was called.
  */
 void avs_log_reset(void);
 
+/**
+ * Behaviour of asynchronous logging when the message queue is full.
+ */
+typedef enum {
+    /**
+     * The new message is silently discarded.
+     */
+    AVS_LOG_ASYNC_OVERFLOW_DROP,
+
+    /**
+     * The logging thread delivers all queued messages by itself, and then
+     * enqueues the new one. This effectively makes logging synchronous until
+     * the delivery thread catches up.
+     *
+     * NOTE: This means that the log handler (or binary writer) is called from
+     * whichever thread happens to find the queue full, not only from the one
+     * running @ref avs_log_async_run. If the oldest queued message is still
+     * being written by another thread, the logging thread sleeps until it is
+     * complete.
+     */
+    AVS_LOG_ASYNC_OVERFLOW_BLOCK,
+
+    /**
+     * The new message is discarded. A WARNING message stating how many
+     * messages have been dropped is delivered after all the messages queued
+     * before have been delivered.
+     */
+    AVS_LOG_ASYNC_OVERFLOW_COUNT
+} avs_log_async_overflow_policy_t;
+
+/**
+ * Function that receives log records serialized in the binary format, if
+ * configured in @ref avs_log_async_config_t::binary_writer.
+ *
+ * A single record may be passed in multiple calls. The data may be decoded
+ * into text using the <c>tools/avs_log_decode.py</c> script.
+ *
+ * @param data Chunk of serialized data.
+ *
+ * @param size Size of the chunk, in bytes.
+ *
+ * @param arg  Opaque argument, as configured in
+ *             @ref avs_log_async_config_t::binary_writer_arg.
+ */
+typedef void avs_log_binary_writer_t(const void *data, size_t size, void *arg);
+
+/**
+ * Configuration of the asynchronous logging mode.
+ */
+typedef struct {
+    /**
+     * Number of messages that may be queued. Rounded up to a power of two. If
+     * zero, a default of 64 is used.
+     *
+     * Each queued message occupies about <c>AVS_COMMONS_LOG_MAX_LINE_LENGTH</c>
+     * bytes of memory.
+     */
+    size_t queue_size;
+
+    /**
+     * Behaviour when the message queue is full.
+     */
+    avs_log_async_overflow_policy_t overflow_policy;
+
+    /**
+     * If true, log statements do not format messages. Instead, a pointer to
+     * the format string and the raw values of its arguments are queued, and
+     * the message is formatted by the thread that delivers it to the log
+     * handler.
+     *
+     * Strings passed as <c>%s</c> arguments are copied, possibly truncated.
+     * <c>long double</c> arguments are converted to <c>double</c>. Messages
+     * that use conversions which cannot be deferred (<c>%n</c> and wide
+     * character ones) are formatted immediately, as if this flag was false.
+     *
+     * NOTE: The format strings are not copied, so they are required to be
+     * static. This is always the case for messages logged using the
+     * @ref avs_log family of macros, including the ones built out of
+     * <c>AVS_DISPOSABLE_LOG()</c> fragments.
+     */
+    bool deferred_formatting;
+
+    /**
+     * If not NULL, queued messages are not passed to the log handler. Instead,
+     * they are serialized in a binary format and passed to this function, so
+     * that they can be formatted offline. Implies
+     * @ref avs_log_async_config_t::deferred_formatting.
+     */
+    avs_log_binary_writer_t *binary_writer;
+
+    /**
+     * Opaque argument passed to @ref avs_log_async_config_t::binary_writer.
+     */
+    void *binary_writer_arg;
+} avs_log_async_config_t;
+
+/**
+ * Enables asynchronous logging.
+ *
+ * In this mode, log messages are formatted by the threads that log them (unless
+ * @ref avs_log_async_config_t::deferred_formatting is enabled), and then put
+ * into a bounded, lock-free queue. The log handler is called from the
+ * thread that runs @ref avs_log_async_run, so that a slow handler does not
+ * block the threads that log.
+ *
+ * The logging subsystem does not create any threads by itself. The application
+ * is expected to call @ref avs_log_async_run from a dedicated thread.
+ *
+ * NOTE: In asynchronous mode, the module and file name strings are not copied,
+ * so they are required to be static. This is always the case for messages
+ * logged using the @ref avs_log family of macros.
+ *
+ * NOTE: Log handlers MUST NOT log any messages when asynchronous logging is
+ * enabled.
+ *
+ * Asynchronous logging requires avs_compat_threading and C11 atomics.
+ * Otherwise, this function always fails.
+ *
+ * @param config Configuration to use. If NULL, defaults are used
+ *               (@ref avs_log_async_config_t::queue_size of 64 and
+ *               @ref AVS_LOG_ASYNC_OVERFLOW_BLOCK).
+ *
+ * @returns 0 on success, or a negative value if asynchronous logging is already
+ *          enabled, not supported, or in case of an out-of-memory condition.
+ */
+int avs_log_async_enable(const avs_log_async_config_t *config);
+
+/**
+ * Delivers asynchronously logged messages to the log handler on the calling
+ * thread, waiting for new messages if there are none, until
+ * @ref avs_log_async_disable or @ref avs_log_reset is called.
+ *
+ * NOTE: This function MUST have returned before calling
+ * <c>avs_cleanup_global_state()</c>.
+ *
+ * @returns 0 after the asynchronous logging has been disabled, or a negative
+ *          value if it is not enabled or in case of error.
+ */
+int avs_log_async_run(void);
+
+/**
+ * Delivers all messages that have been logged so far to the log handler on the
+ * calling thread. Does nothing if asynchronous logging is not enabled.
+ */
+void avs_log_async_flush(void);
+
+/**
+ * Disables asynchronous logging. All messages that have been logged so far are
+ * delivered to the log handler, and @ref avs_log_async_run returns. Subsequent
+ * messages are delivered synchronously.
+ */
+void avs_log_async_disable(void);
+
+/**
+ * Returns the total number of messages discarded due to a full queue, since
+ * asynchronous logging has been last enabled.
+ */
+size_t avs_log_async_dropped_count(void);
+
 #ifndef AVS_COMMONS_WITHOUT_LOG_CHECK_IN_RUNTIME
 int avs_log_set_level__(const char *module, avs_log_level_t level);
 #endif /* AVS_COMMONS_WITHOUT_LOG_CHECK_IN_RUNTIME */
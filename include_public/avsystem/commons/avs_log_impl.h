@@ -31,6 +31,22 @@ extern "C" {
 /**@{*/
 #    ifndef AVS_COMMONS_WITHOUT_LOG_CHECK_IN_RUNTIME
 int avs_log_should_log__(avs_log_level_t level, const char *module);
+
+/**
+ * Log level configuration generation. Incremented every time the log levels
+ * change; never equal to zero.
+ */
+extern unsigned avs_log_generation__;
+
+/**
+ * Equivalent to @ref avs_log_should_log__, but if the message shall not be
+ * logged, stores the current value of @ref avs_log_generation__ in
+ * <c>*site_generation</c>, so that subsequent checks at the same call site can
+ * be skipped until the log level configuration changes.
+ */
+int avs_log_should_log_cached__(avs_log_level_t level,
+                                const char *module,
+                                unsigned *site_generation);
 #    endif /* AVS_COMMONS_WITHOUT_LOG_CHECK_IN_RUNTIME */
 
 void avs_log_internal_forced_v__(avs_log_level_t level,
@@ -61,17 +77,75 @@ void avs_log_internal_l__(avs_log_level_t level,
                           const char *msg,
                           ...) AVS_F_PRINTF(5, 6);
 
-#    define AVS_LOG_IMPL__(Level, Variant, ModuleStr, ...)                   \
+#    define AVS_LOG_UNCACHED_IMPL__(Level, Variant, ModuleStr, ...)          \
         avs_log_internal_##Variant##__(Level, ModuleStr, __FILE__, __LINE__, \
                                        __VA_ARGS__)
 #    ifndef AVS_COMMONS_WITHOUT_LOG_CHECK_IN_RUNTIME
-#        define AVS_LOG_LAZY_IMPL__(Level, Variant, ModuleStr, ...)  \
-            (avs_log_should_log__(Level, ModuleStr)                  \
-                     ? avs_log_internal_forced_##Variant##__(        \
-                               Level, ModuleStr, __FILE__, __LINE__, \
-                               __VA_ARGS__)                          \
+#        define AVS_LOG_UNCACHED_LAZY_IMPL__(Level, Variant, ModuleStr, ...) \
+            (avs_log_should_log__(Level, ModuleStr)                          \
+                     ? avs_log_internal_forced_##Variant##__(                \
+                               Level, ModuleStr, __FILE__, __LINE__,         \
+                               __VA_ARGS__)                                  \
+                     : (void) 0)
+#    endif /* AVS_COMMONS_WITHOUT_LOG_CHECK_IN_RUNTIME */
+
+/*
+ * The call site cache requires GNU statement expressions and __atomic builtins
+ * (the latter are not available in GCC before 4.7, which already defines
+ * __GNUC__). It declares a static variable at each call site, which is not
+ * allowed in inline functions with external linkage (C99 6.7.4p3), so it can
+ * be disabled for a single translation unit by defining
+ * AVS_LOG_WITHOUT_CALL_SITE_CACHE before including avs_log.h.
+ */
+#    if !defined(AVS_COMMONS_WITHOUT_LOG_CHECK_IN_RUNTIME)  \
+            && defined(AVS_COMMONS_LOG_WITH_CALL_SITE_CACHE) \
+            && !defined(AVS_LOG_WITHOUT_CALL_SITE_CACHE)     \
+            && defined(__GNUC__) && defined(__ATOMIC_RELAXED)
+static inline void avs_log_discard_l__(const char *msg, ...)
+        AVS_F_PRINTF(1, 2);
+static inline void avs_log_discard_l__(const char *msg, ...) {
+    (void) msg;
+}
+
+static inline void avs_log_discard_v__(const char *msg, va_list ap) {
+    (void) msg;
+    (void) ap;
+}
+
+/**
+ * Runtime log level check with the result cached in a static variable local to
+ * the call site. A disabled log statement only costs comparing the cached
+ * generation with @ref avs_log_generation__.
+ */
+#        define AVS_LOG_SHOULD_LOG_CACHED__(Level, ModuleStr)                  \
+            __extension__({                                                    \
+                static unsigned avs_log_site_generation__;                     \
+                __atomic_load_n(&avs_log_site_generation__, __ATOMIC_RELAXED)  \
+                                != __atomic_load_n(&avs_log_generation__,      \
+                                                   __ATOMIC_RELAXED)           \
+                        && avs_log_should_log_cached__(                        \
+                                   Level, ModuleStr,                           \
+                                   &avs_log_site_generation__);                \
+            })
+
+/* arguments of non-lazy log statements are evaluated even if not logged */
+#        define AVS_LOG_IMPL__(Level, Variant, ModuleStr, ...)           \
+            (AVS_LOG_SHOULD_LOG_CACHED__(Level, ModuleStr)               \
+                     ? avs_log_internal_forced_##Variant##__(            \
+                               Level, ModuleStr, __FILE__, __LINE__,     \
+                               __VA_ARGS__)                              \
+                     : avs_log_discard_##Variant##__(__VA_ARGS__))
+#        define AVS_LOG_LAZY_IMPL__(Level, Variant, ModuleStr, ...)      \
+            (AVS_LOG_SHOULD_LOG_CACHED__(Level, ModuleStr)               \
+                     ? avs_log_internal_forced_##Variant##__(            \
+                               Level, ModuleStr, __FILE__, __LINE__,     \
+                               __VA_ARGS__)                              \
                      : (void) 0)
+#    elif !defined(AVS_COMMONS_WITHOUT_LOG_CHECK_IN_RUNTIME)
+#        define AVS_LOG_IMPL__ AVS_LOG_UNCACHED_IMPL__
+#        define AVS_LOG_LAZY_IMPL__ AVS_LOG_UNCACHED_LAZY_IMPL__
 #    else
+#        define AVS_LOG_IMPL__ AVS_LOG_UNCACHED_IMPL__
 #        define AVS_LOG_LAZY_IMPL__(Level, Variant, ModuleStr, ...)           \
             avs_log_internal_forced_##Variant##__(Level, ModuleStr, __FILE__, \
                                                   __LINE__, __VA_ARGS__)
@@ -101,23 +175,29 @@ void avs_log_internal_l__(avs_log_level_t level,
 /* enable compiling-in TRACE messages */
 #        ifndef AVS_LOG_WITH_TRACE
 #            undef AVS_LOG__TRACE
-#            define AVS_LOG__TRACE(...) \
-                ((void) sizeof(AVS_LOG_IMPL__(AVS_LOG_TRACE, __VA_ARGS__), 0))
+#            define AVS_LOG__TRACE(...)                           \
+                ((void) sizeof(AVS_LOG_UNCACHED_IMPL__(AVS_LOG_TRACE, \
+                                                       __VA_ARGS__), \
+                               0))
 #            undef AVS_LOG__LAZY_TRACE
 #            define AVS_LOG__LAZY_TRACE(...) \
-                ((void) sizeof(              \
-                        AVS_LOG_LAZY_IMPL__(AVS_LOG_DEBUG, __VA_ARGS__), 0))
+                ((void) sizeof(AVS_LOG_UNCACHED_IMPL__(AVS_LOG_TRACE, \
+                                                       __VA_ARGS__), \
+                               0))
 #        endif
 
 /* disable compiling-in DEBUG messages */
 #        ifdef AVS_LOG_WITHOUT_DEBUG
 #            undef AVS_LOG__DEBUG
-#            define AVS_LOG__DEBUG(...) \
-                ((void) sizeof(AVS_LOG_IMPL__(AVS_LOG_DEBUG, __VA_ARGS__), 0))
+#            define AVS_LOG__DEBUG(...)                           \
+                ((void) sizeof(AVS_LOG_UNCACHED_IMPL__(AVS_LOG_DEBUG, \
+                                                       __VA_ARGS__), \
+                               0))
 #            undef AVS_LOG__LAZY_DEBUG
 #            define AVS_LOG__LAZY_DEBUG(...) \
-                ((void) sizeof(              \
-                        AVS_LOG_LAZY_IMPL__(AVS_LOG_DEBUG, __VA_ARGS__), 0))
+                ((void) sizeof(AVS_LOG_UNCACHED_IMPL__(AVS_LOG_DEBUG, \
+                                                       __VA_ARGS__), \
+                               0))
 #        endif
 #    endif /*AVS_LOG_LEVEL_DEFAULT*/
 
@@ -19,6 +19,10 @@
 
 #include <avsystem/commons/avs_time.h>
 
+#ifdef AVS_COMMONS_WITH_AVS_STREAM
+#    include <avsystem/commons/avs_stream.h>
+#endif // AVS_COMMONS_WITH_AVS_STREAM
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -73,6 +77,107 @@ typedef void avs_sched_clb_t(avs_sched_t *sched, const void *data);
  */
 avs_sched_t *avs_sched_new(const char *name, void *data);
 
+/**
+ * Data structures that may be used by the scheduler to store scheduled jobs.
+ */
+typedef enum {
+    /**
+     * Binary heap. Scheduling, rescheduling and cancelling jobs take
+     * logarithmic time, and jobs are executed with the full precision of the
+     * monotonic clock. This is the default.
+     */
+    AVS_SCHED_BACKEND_HEAP,
+
+    /**
+     * Hashed timing wheel. Scheduling and cancelling jobs that fit in the range
+     * of the wheel (<c>wheel_tick * wheel_slots</c> from now) take constant
+     * time. Jobs scheduled further in the future are kept in a binary heap
+     * until they fit in the wheel.
+     *
+     * This backend is well suited for large numbers of short timeouts that
+     * are usually cancelled before they expire, at the cost of precision: the
+     * instants of all jobs are rounded up to a multiple of <c>wheel_tick</c>.
+     * Jobs scheduled for past instants may also have their instants moved
+     * forward, although never later than the current time. Values returned by
+     * @ref avs_sched_time and @ref avs_sched_time_of_next reflect the rounded
+     * instants.
+     */
+    AVS_SCHED_BACKEND_TIMING_WHEEL
+} avs_sched_backend_t;
+
+/**
+ * Scheduler configuration, used by @ref avs_sched_new_with_config .
+ */
+typedef struct {
+    /**
+     * Data structure used to store scheduled jobs.
+     */
+    avs_sched_backend_t backend;
+
+    /**
+     * Length of a single timing wheel tick. Only used with
+     * @ref AVS_SCHED_BACKEND_TIMING_WHEEL . If not a valid positive duration,
+     * 10 milliseconds is used.
+     */
+    avs_time_duration_t wheel_tick;
+
+    /**
+     * Number of timing wheel slots. Only used with
+     * @ref AVS_SCHED_BACKEND_TIMING_WHEEL . Rounded up to a power of two, and
+     * to at least 64. If zero, 1024 is used.
+     */
+    size_t wheel_slots;
+
+    /**
+     * Number of job structures to allocate when creating the scheduler.
+     *
+     * Job structures of executed or cancelled jobs are kept in a
+     * per-scheduler pool and reused for new jobs of similar size.
+     * Preallocating them makes scheduling up to that number of concurrent jobs
+     * free of any memory allocation right from the start.
+     *
+     * The pool keeps at most 64 unused job structures, or
+     * <c>job_pool_prealloc</c> if larger; any further ones are freed when
+     * released. The exception are job structures that have ever been linked to
+     * a handle variable (<c>out_handle</c> argument to @ref AVS_SCHED_AT), as
+     * handles may be concurrently accessed from other threads - these are
+     * always kept until the scheduler is destroyed.
+     */
+    size_t job_pool_prealloc;
+
+    /**
+     * Size of callback data (<c>ClbDataSize</c> argument to
+     * @ref AVS_SCHED_AT) that the preallocated job structures shall be able to
+     * hold. Only used if <c>job_pool_prealloc</c> is non-zero.
+     */
+    size_t job_pool_prealloc_data_size;
+} avs_sched_config_t;
+
+/**
+ * Default scheduler configuration, used by @ref avs_sched_new . See
+ * @ref avs_sched_config_t for details.
+ */
+extern const avs_sched_config_t AVS_SCHED_DEFAULT_CONFIG;
+
+/**
+ * Creates a new scheduler object with a specific configuration.
+ *
+ * @param name   The name of the scheduler that will be used in log messages.
+ *               If NULL, <c>"(unknown)"</c> will be used instead.
+ *
+ * @param data   An opaque pointer that will be possible to retrieve from the
+ *               scheduler using @ref avs_sched_data .
+ *
+ * @param config Scheduler configuration. If NULL,
+ *               @ref AVS_SCHED_DEFAULT_CONFIG is used. The structure is not
+ *               referenced after this function returns.
+ *
+ * @returns Created scheduler object, or NULL if there is a fatal error.
+ */
+avs_sched_t *avs_sched_new_with_config(const char *name,
+                                       void *data,
+                                       const avs_sched_config_t *config);
+
 /**
  * Destroys the scheduler and releases all resources related to it.
  *
@@ -232,6 +337,17 @@ int avs_sched_at_impl__(avs_sched_t *sched,
                         const void *clb_data,
                         size_t clb_data_size);
 
+int avs_sched_at_with_affinity_impl__(avs_sched_t *sched,
+                                      avs_sched_handle_t *out_handle,
+                                      avs_time_monotonic_t instant,
+                                      uint64_t affinity_key,
+                                      const char *log_file,
+                                      unsigned log_line,
+                                      const char *log_name,
+                                      avs_sched_clb_t *clb,
+                                      const void *clb_data,
+                                      size_t clb_data_size);
+
 int avs_resched_at_impl__(avs_sched_handle_t *handle_ptr,
                           avs_time_monotonic_t instant);
 
@@ -345,6 +461,144 @@ int avs_resched_at_impl__(avs_sched_handle_t *handle_ptr,
                  ClbData,                                          \
                  ClbDataSize)
 
+/**
+ * Affinity key of jobs that are not bound to any particular worker of
+ * @ref avs_sched_executor_t . All jobs scheduled using @ref AVS_SCHED_AT,
+ * @ref AVS_SCHED_DELAYED and @ref AVS_SCHED_NOW have this affinity key.
+ */
+#define AVS_SCHED_NO_AFFINITY 0
+
+/**
+ * A variant of @ref AVS_SCHED_AT that additionally assigns an affinity key to
+ * the job. See that macro's documentation for details.
+ *
+ * Affinity keys are only meaningful if the scheduler is driven by an
+ * @ref avs_sched_executor_t . All jobs with the same affinity key (other than
+ * @ref AVS_SCHED_NO_AFFINITY) are executed by the same worker, so they are
+ * never executed concurrently with each other, and they are executed in the
+ * same order as if they were executed by @ref avs_sched_run . The key is
+ * retained if the job is rescheduled.
+ *
+ * @param AffinityKey Affinity key of the job (<c>uint64_t</c>).
+ */
+#define AVS_SCHED_AT_WITH_AFFINITY(Sched, OutHandle, Instant, AffinityKey, \
+                                   Clb, ClbData, ClbDataSize)             \
+    avs_sched_at_with_affinity_impl__(                                    \
+            (Sched),                                                      \
+            (OutHandle),                                                  \
+            (Instant),                                                    \
+            (AffinityKey),                                                \
+            AVS_SCHED_LOG_ARGS__(Clb, (ClbData, ClbDataSize)),            \
+            (Clb),                                                        \
+            (ClbData),                                                    \
+            (ClbDataSize))
+
+/**
+ * A variant of @ref AVS_SCHED_AT_WITH_AFFINITY that uses a delay relative to
+ * "now", instead of an absolute instant at which to schedule the job.
+ */
+#define AVS_SCHED_DELAYED_WITH_AFFINITY(Sched, OutHandle, Delay, AffinityKey, \
+                                        Clb, ClbData, ClbDataSize)           \
+    AVS_SCHED_AT_WITH_AFFINITY(                                              \
+            Sched,                                                           \
+            OutHandle,                                                       \
+            avs_time_monotonic_add(avs_time_monotonic_now(), Delay),         \
+            AffinityKey,                                                     \
+            Clb,                                                             \
+            ClbData,                                                         \
+            ClbDataSize)
+
+/**
+ * A variant of @ref AVS_SCHED_AT_WITH_AFFINITY that schedules the job to
+ * execute "now" (at earliest possible time).
+ */
+#define AVS_SCHED_NOW_WITH_AFFINITY(Sched, OutHandle, AffinityKey, Clb, \
+                                    ClbData, ClbDataSize)               \
+    AVS_SCHED_AT_WITH_AFFINITY(Sched,                                   \
+                               OutHandle,                               \
+                               avs_time_monotonic_now(),                \
+                               AffinityKey,                             \
+                               Clb,                                     \
+                               ClbData,                                 \
+                               ClbDataSize)
+
+/**
+ * Description of a single job to schedule using @ref avs_sched_at_batch .
+ *
+ * It is recommended to initialize it using @ref AVS_SCHED_BATCH_ENTRY or
+ * @ref AVS_SCHED_BATCH_ENTRY_WITH_AFFINITY , which also fill the fields used
+ * for logging.
+ */
+typedef struct {
+    /** Equivalent to the <c>OutHandle</c> argument of @ref AVS_SCHED_AT . */
+    avs_sched_handle_t *out_handle;
+    /** Equivalent to the <c>Instant</c> argument of @ref AVS_SCHED_AT . */
+    avs_time_monotonic_t instant;
+    /**
+     * Equivalent to the <c>AffinityKey</c> argument of
+     * @ref AVS_SCHED_AT_WITH_AFFINITY .
+     */
+    uint64_t affinity_key;
+    /** Source file name used in log messages; may be NULL. */
+    const char *log_file;
+    /** Source line number used in log messages. */
+    unsigned log_line;
+    /** Job name used in log messages; may be NULL. */
+    const char *log_name;
+    /** Equivalent to the <c>Clb</c> argument of @ref AVS_SCHED_AT . */
+    avs_sched_clb_t *clb;
+    /** Equivalent to the <c>ClbData</c> argument of @ref AVS_SCHED_AT . */
+    const void *clb_data;
+    /** Equivalent to the <c>ClbDataSize</c> argument of @ref AVS_SCHED_AT . */
+    size_t clb_data_size;
+} avs_sched_batch_entry_t;
+
+/**
+ * Initializer for @ref avs_sched_batch_entry_t with an affinity key. The
+ * arguments have the same meaning as for @ref AVS_SCHED_AT_WITH_AFFINITY .
+ */
+#define AVS_SCHED_BATCH_ENTRY_WITH_AFFINITY(OutHandle, Instant, AffinityKey, \
+                                            Clb, ClbData, ClbDataSize)      \
+    {                                                                       \
+        (OutHandle), (Instant), (AffinityKey),                              \
+                AVS_SCHED_LOG_ARGS__(Clb, (ClbData, ClbDataSize)), (Clb),   \
+                (ClbData), (ClbDataSize)                                    \
+    }
+
+/**
+ * Initializer for @ref avs_sched_batch_entry_t . The arguments have the same
+ * meaning as for @ref AVS_SCHED_AT .
+ */
+#define AVS_SCHED_BATCH_ENTRY(OutHandle, Instant, Clb, ClbData, ClbDataSize) \
+    AVS_SCHED_BATCH_ENTRY_WITH_AFFINITY(OutHandle, Instant,                 \
+                                        AVS_SCHED_NO_AFFINITY, Clb, ClbData, \
+                                        ClbDataSize)
+
+/**
+ * Schedules multiple jobs at once.
+ *
+ * This is equivalent to calling @ref AVS_SCHED_AT_WITH_AFFINITY for each of
+ * the entries in order, but the scheduler is locked only once, and waiters
+ * (see @ref avs_sched_wait_until_next) are notified only once, which is
+ * considerably faster when scheduling a large number of jobs.
+ *
+ * The operation is atomic: either all the jobs are scheduled, or none of them.
+ *
+ * @param sched   Scheduler object to access.
+ *
+ * @param entries Array of descriptions of the jobs to schedule.
+ *
+ * @param count   Number of elements in @p entries .
+ *
+ * @returns
+ * - 0 on success
+ * - negative value if any of the entries has a <c>NULL</c> callback or an
+ *   invalid instant, or if there is not enough memory available
+ */
+int avs_sched_at_batch(avs_sched_t *sched,
+                       const avs_sched_batch_entry_t *entries,
+                       size_t count);
+
 /**
  * Reschedules a job to the specific point in time in the system monotonic
  * clock's domain.
@@ -409,6 +663,184 @@ avs_time_monotonic_t avs_sched_time(avs_sched_handle_t *handle_ptr);
  */
 void avs_sched_del(avs_sched_handle_t *handle_ptr);
 
+/**
+ * Unschedules multiple jobs at once.
+ *
+ * This is equivalent to calling @ref avs_sched_del for each of the handles,
+ * but consecutive handles that refer to jobs of the same scheduler are
+ * cancelled while locking that scheduler only once.
+ *
+ * @param handle_ptrs Array of pointers to job handle variables to unschedule.
+ *                    <c>NULL</c> elements are ignored. On return from this
+ *                    function, all the handle variables will be set to
+ *                    <c>NULL</c>.
+ *
+ * @param count       Number of elements in @p handle_ptrs .
+ */
+void avs_sched_del_batch(avs_sched_handle_t *const *handle_ptrs,
+                         size_t count);
+
+/**
+ * Statistics of the pool of job structures, see
+ * @ref avs_sched_config_t::job_pool_prealloc .
+ */
+typedef struct {
+    /** Number of jobs scheduled using a job structure taken from the pool. */
+    uint64_t hits;
+
+    /** Number of jobs for which a new job structure had to be allocated. */
+    uint64_t misses;
+
+    /** Number of job structures currently unused and available in the pool. */
+    size_t free_jobs;
+} avs_sched_pool_stats_t;
+
+/**
+ * Retrieves statistics of the pool of job structures of a scheduler.
+ *
+ * @param sched     Scheduler object to access.
+ *
+ * @param out_stats Structure to fill with the statistics.
+ */
+void avs_sched_pool_stats(avs_sched_t *sched,
+                          avs_sched_pool_stats_t *out_stats);
+
+/**
+ * Number of buckets in @ref avs_sched_histogram_t .
+ */
+#define AVS_SCHED_STATS_HISTOGRAM_BUCKETS 32
+
+/**
+ * Maximum number of entries in @ref avs_sched_stats_t::slowest_callbacks .
+ */
+#define AVS_SCHED_STATS_SLOWEST_CALLBACKS 8
+
+/**
+ * Histogram of durations with logarithmic buckets.
+ *
+ * Bucket 0 counts durations shorter than 1 microsecond. Bucket <c>k</c>, for
+ * <c>k >= 1</c>, counts durations of at least <c>2^(k-1)</c> and less than
+ * <c>2^k</c> microseconds. The last bucket also counts all longer durations.
+ */
+typedef struct {
+    uint64_t buckets[AVS_SCHED_STATS_HISTOGRAM_BUCKETS];
+
+    /** Number of recorded durations. */
+    uint64_t count;
+
+    /** Sum of all recorded durations. */
+    avs_time_duration_t total;
+
+    /** Longest recorded duration. */
+    avs_time_duration_t max;
+} avs_sched_histogram_t;
+
+/**
+ * Execution statistics of jobs scheduled from a single call site.
+ */
+typedef struct {
+    /**
+     * Source file and line from which the jobs were scheduled. Only available
+     * if the scheduler has been compiled with internal logs enabled, and
+     * <c>AVS_LOG_WITH_TRACE</c> was defined when scheduling the job; NULL and 0
+     * otherwise.
+     */
+    const char *file;
+    unsigned line;
+
+    /** Stringified callback name, available under the same conditions. */
+    const char *name;
+
+    /** Callback function of the jobs. */
+    avs_sched_clb_t *clb;
+
+    /** Number of executions recorded for this call site. */
+    uint64_t executions;
+
+    /** Total execution time of the recorded executions. */
+    avs_time_duration_t total_exec_time;
+
+    /** Longest execution time. */
+    avs_time_duration_t max_exec_time;
+} avs_sched_callback_stats_t;
+
+/**
+ * Statistics of a scheduler, see @ref avs_sched_stats_enable .
+ */
+typedef struct {
+    /**
+     * Histogram of scheduling lateness, i.e. the differences between the
+     * actual time at which jobs started executing and the time they were
+     * scheduled at.
+     */
+    avs_sched_histogram_t lateness;
+
+    /** Histogram of execution times of job callbacks. */
+    avs_sched_histogram_t exec_time;
+
+    /** Number of jobs currently scheduled. */
+    size_t queue_depth;
+
+    /** Largest number of jobs scheduled at once. */
+    size_t max_queue_depth;
+
+    /** Number of valid entries in <c>slowest_callbacks</c>. */
+    size_t slowest_callbacks_count;
+
+    /**
+     * Call sites of jobs with the longest execution times, sorted by
+     * <c>max_exec_time</c>, in descending order.
+     *
+     * Jobs are grouped by the callback function and the call site that
+     * scheduled them. Only a limited number of call sites is tracked, so
+     * a call site may replace another one with a shorter maximum execution
+     * time, in which case its statistics only cover executions since then.
+     */
+    avs_sched_callback_stats_t
+            slowest_callbacks[AVS_SCHED_STATS_SLOWEST_CALLBACKS];
+} avs_sched_stats_t;
+
+/**
+ * Enables or disables collection of statistics for a scheduler.
+ *
+ * Statistics are disabled by default, as collecting them requires reading the
+ * clock twice for each executed job. Enabling statistics when they are already
+ * enabled resets them.
+ *
+ * @param sched   Scheduler object to access.
+ *
+ * @param enabled Whether to collect statistics.
+ *
+ * @returns 0 on success, or a negative value if there is not enough memory.
+ */
+int avs_sched_stats_enable(avs_sched_t *sched, bool enabled);
+
+/**
+ * Retrieves the statistics of a scheduler.
+ *
+ * @param sched     Scheduler object to access.
+ *
+ * @param out_stats Structure to fill with the statistics.
+ *
+ * @returns 0 on success, or a negative value if statistics are not enabled.
+ */
+int avs_sched_stats_get(avs_sched_t *sched, avs_sched_stats_t *out_stats);
+
+#ifdef AVS_COMMONS_WITH_AVS_STREAM
+/**
+ * Writes the statistics of a scheduler to a stream, in a human-readable
+ * format.
+ *
+ * @param sched  Scheduler object to access.
+ *
+ * @param stream Stream to write the statistics to.
+ *
+ * @returns AVS_OK for success, or an error condition for which the operation
+ *          failed.
+ */
+avs_error_t avs_sched_stats_dump(avs_sched_t *sched, avs_stream_t *stream);
+#endif // AVS_COMMONS_WITH_AVS_STREAM
+
 /**
  * Detaches a handle variable from a scheduled job.
  *
@@ -445,6 +877,89 @@ void avs_sched_detach(avs_sched_handle_t *handle_ptr);
  */
 int avs_sched_leap_time(avs_sched_t *sched, avs_time_duration_t diff);
 
+/**
+ * Executor that executes jobs of a single scheduler on multiple worker threads
+ * concurrently.
+ *
+ * The executor does not create any threads by itself. Instead, the application
+ * is expected to call @ref avs_sched_executor_run_worker from each of the
+ * worker threads.
+ *
+ * Each worker has its own queue of due jobs:
+ * - jobs with an affinity key (see @ref AVS_SCHED_AT_WITH_AFFINITY) are always
+ *   queued on the worker determined by that key, and executed in order,
+ * - jobs without an affinity key are queued on the worker that fetched them
+ *   from the scheduler, and may be taken over ("stolen") by any idle worker.
+ *
+ * Once fetched for execution by the executor, jobs can no longer be cancelled
+ * or rescheduled, just as when they are fetched by @ref avs_sched_run .
+ *
+ * NOTE: The executor is only functional if the scheduler module has been
+ * compiled with thread safety enabled. Otherwise @ref avs_sched_executor_new
+ * will always fail.
+ */
+typedef struct avs_sched_executor_struct avs_sched_executor_t;
+
+/**
+ * Creates an executor for a scheduler.
+ *
+ * @param sched        Scheduler object whose jobs will be executed. It MUST NOT
+ *                     be cleaned up before the executor.
+ *
+ * @param worker_count Number of workers. Each worker is expected to be run on a
+ *                     separate thread using @ref avs_sched_executor_run_worker.
+ *
+ * @returns Created executor object, or NULL if there is a fatal error.
+ */
+avs_sched_executor_t *avs_sched_executor_new(avs_sched_t *sched,
+                                             size_t worker_count);
+
+/**
+ * Runs a single worker of the executor on the calling thread.
+ *
+ * The function executes due jobs, and waits for more of them to become due,
+ * until @ref avs_sched_executor_stop is called.
+ *
+ * @param executor     Executor object to access.
+ *
+ * @param worker_index Index of the worker to run, between 0 and
+ *                     <c>worker_count - 1</c>. Each worker MUST NOT be run by
+ *                     more than one thread at a time.
+ *
+ * @returns 0 after the executor has been stopped, or a negative value in case
+ *          of error.
+ */
+int avs_sched_executor_run_worker(avs_sched_executor_t *executor,
+                                  size_t worker_index);
+
+/**
+ * Requests all workers of the executor to stop.
+ *
+ * Workers finish executing their current jobs and return from
+ * @ref avs_sched_executor_run_worker . Jobs that have been fetched from the
+ * scheduler, but not executed yet, are returned to the scheduler by
+ * @ref avs_sched_executor_cleanup .
+ *
+ * This function may be called from any thread, including from within a job
+ * executed by the executor.
+ *
+ * @param executor Executor object to access.
+ */
+void avs_sched_executor_stop(avs_sched_executor_t *executor);
+
+/**
+ * Destroys the executor. Any jobs fetched, but not executed by the executor are
+ * put back into the scheduler, so that they will be executed by the next call
+ * to @ref avs_sched_run or by another executor.
+ *
+ * NOTE: All calls to @ref avs_sched_executor_run_worker MUST have returned
+ * before calling this function.
+ *
+ * @param executor_ptr Pointer to a variable that holds the executor to destroy.
+ *                     It will be reset to <c>NULL</c> afterwards.
+ */
+void avs_sched_executor_cleanup(avs_sched_executor_t **executor_ptr);
+
 #ifdef __cplusplus
 }
 #endif
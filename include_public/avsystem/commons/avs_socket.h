@@ -24,6 +24,7 @@
 #include <limits.h>
 #include <stdbool.h>
 #include <stdint.h>
+#include <stdio.h>
 #include <stdlib.h>
 
 #include <avsystem/commons/avs_commons_config.h>
@@ -860,6 +861,89 @@ avs_error_t avs_net_socket_send(avs_net_socket_t *socket,
                                 const void *buffer,
                                 size_t buffer_length);
 
+/**
+ * Maximum number of non-empty buffers that may be passed to a single
+ * @ref avs_net_socket_send_vector call on a UDP socket. Empty buffers are not
+ * counted.
+ */
+#define AVS_NET_SOCKET_SEND_VECTOR_MAX_IOVCNT 16
+
+/**
+ * Single buffer passed to @ref avs_net_socket_send_vector .
+ */
+typedef struct {
+    /** Data to send. May be NULL if <c>size</c> is 0. */
+    const void *data;
+    /** Number of bytes to send. */
+    size_t size;
+} avs_net_socket_iovec_t;
+
+/**
+ * Sends data from all of the @p iovcnt buffers described by @p iov to
+ * @p socket, as if they were concatenated and sent with a single call to
+ * @ref avs_net_socket_send , but without copying them into a contiguous
+ * buffer first (e.g. using <c>sendmsg()</c>).
+ *
+ * @li For TCP sockets: the call may block for an indeterminate amount of time,
+ *     until all passed data is successfully sent.
+ * @li For UDP sockets: all the buffers are handled as a single datagram. If
+ *     there are more than @ref AVS_NET_SOCKET_SEND_VECTOR_MAX_IOVCNT non-empty
+ *     buffers, the function fails with <c>avs_errno(AVS_EMSGSIZE)</c>.
+ *
+ * This is an optional operation. Socket types that do not support it, such as
+ * (D)TLS sockets, return <c>avs_errno(AVS_ENOTSUP)</c> without sending any
+ * data; the caller is then expected to send the buffers by other means.
+ *
+ * @param socket Socket object to send data to.
+ * @param iov    Array of buffers to send.
+ * @param iovcnt Number of elements in @p iov .
+ *
+ * @returns @li @ref AVS_OK if all the data was written,
+ *          @li <c>avs_errno(AVS_ENOTSUP)</c> if vectored sending is not
+ *              supported by @p socket ,
+ *          @li an error condition for which the operation failed.
+ */
+avs_error_t avs_net_socket_send_vector(avs_net_socket_t *socket,
+                                       const avs_net_socket_iovec_t *iov,
+                                       size_t iovcnt);
+
+/**
+ * Sends up to @p size bytes of data read from @p file, starting at @p offset,
+ * to @p socket, without copying it through user space buffers if possible (e.g.
+ * using <c>sendfile()</c>).
+ *
+ * The data is read from the underlying file descriptor, so any data buffered
+ * in @p file by the standard library MUST be flushed before calling this
+ * function. The current position of @p file is neither used nor changed.
+ *
+ * The call may block for an indeterminate amount of time, until either
+ * @p size bytes are sent or the end of file is reached.
+ *
+ * This is an optional operation, only supported on stream-oriented sockets.
+ * Socket types that do not support it, such as (D)TLS sockets, return
+ * <c>avs_errno(AVS_ENOTSUP)</c> without sending any data; the caller is then
+ * expected to read the file and send its contents by other means.
+ *
+ * @param socket         Socket object to send data to.
+ * @param file           File to read data from. MUST be open for reading.
+ * @param offset         Offset in @p file to start reading at.
+ * @param size           Maximum number of bytes to send.
+ * @param out_bytes_sent Pointer to a variable where the number of bytes sent
+ *                       will be stored. It is also set in case of error. MUST
+ *                       NOT be NULL.
+ *
+ * @returns @li @ref AVS_OK if either @p size bytes or the whole remaining
+ *              contents of @p file were sent,
+ *          @li <c>avs_errno(AVS_ENOTSUP)</c> if sending files is not
+ *              supported by @p socket or for @p file ,
+ *          @li an error condition for which the operation failed.
+ */
+avs_error_t avs_net_socket_send_file(avs_net_socket_t *socket,
+                                     FILE *file,
+                                     avs_off_t offset,
+                                     size_t size,
+                                     size_t *out_bytes_sent);
+
 /**
  * Sends exactly @p buffer_length bytes from @p buffer to @p host / @p port,
  * using @p socket.
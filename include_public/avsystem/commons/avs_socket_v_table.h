@@ -32,6 +32,15 @@ typedef avs_error_t (*avs_net_socket_decorate_t)(
 typedef avs_error_t (*avs_net_socket_send_t)(avs_net_socket_t *socket,
                                              const void *buffer,
                                              size_t buffer_length);
+typedef avs_error_t (*avs_net_socket_send_vector_t)(
+        avs_net_socket_t *socket,
+        const avs_net_socket_iovec_t *iov,
+        size_t iovcnt);
+typedef avs_error_t (*avs_net_socket_send_file_t)(avs_net_socket_t *socket,
+                                                  FILE *file,
+                                                  avs_off_t offset,
+                                                  size_t size,
+                                                  size_t *out_bytes_sent);
 typedef avs_error_t (*avs_net_socket_send_to_t)(avs_net_socket_t *socket,
                                                 const void *buffer,
                                                 size_t buffer_length,
@@ -111,6 +120,16 @@ typedef struct {
     avs_net_socket_get_local_port_t get_local_port;
     avs_net_socket_get_opt_t get_opt;
     avs_net_socket_set_opt_t set_opt;
+    /**
+     * Optional; may be NULL, in which case @ref avs_net_socket_send_vector
+     * returns <c>avs_errno(AVS_ENOTSUP)</c>.
+     */
+    avs_net_socket_send_vector_t send_vector;
+    /**
+     * Optional; may be NULL, in which case @ref avs_net_socket_send_file
+     * returns <c>avs_errno(AVS_ENOTSUP)</c>.
+     */
+    avs_net_socket_send_file_t send_file;
 } avs_net_socket_v_table_t;
 
 #ifdef __cplusplus
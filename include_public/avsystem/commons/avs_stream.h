@@ -109,6 +109,66 @@ avs_error_t avs_stream_write(avs_stream_t *stream,
                              const void *buffer,
                              size_t buffer_length);
 
+/**
+ * Single buffer of data to write, as passed to @ref avs_stream_write_vector
+ * and @ref avs_stream_write_some_vector .
+ */
+typedef struct {
+    /** Data to write. May be NULL if <c>size</c> is 0. */
+    const void *data;
+    /** Number of bytes to write. */
+    size_t size;
+} avs_stream_const_iovec_t;
+
+/**
+ * Single buffer to read data into, as passed to @ref avs_stream_read_vector .
+ */
+typedef struct {
+    /** Memory block to read data into. May be NULL if <c>size</c> is 0. */
+    void *data;
+    /** Number of bytes available in <c>data</c>. */
+    size_t size;
+} avs_stream_iovec_t;
+
+/**
+ * Writes data from multiple buffers to the stream, as if they were
+ * concatenated and written with a single call to @ref avs_stream_write_some .
+ *
+ * Streams that support the VECTOR extension (see
+ * @ref avs_stream_v_table_extension_vector_t) handle it natively, e.g. by
+ * passing all the buffers to a single <c>sendmsg()</c> call. For other
+ * streams, @ref avs_stream_write_some is called for each buffer in turn, until
+ * a short write occurs.
+ *
+ * @param stream            Stream to operate on.
+ * @param iov               Array of buffers to write.
+ * @param iovcnt            Number of elements in @p iov .
+ * @param out_bytes_written Pointer to a variable where the total number of
+ *                          bytes actually written will be stored, or NULL.
+ *
+ * @returns @ref AVS_OK for success, or an error condition for which the
+ *          operation failed.
+ */
+avs_error_t avs_stream_write_some_vector(avs_stream_t *stream,
+                                         const avs_stream_const_iovec_t *iov,
+                                         size_t iovcnt,
+                                         size_t *out_bytes_written);
+
+/**
+ * Convenience method that calls @ref avs_stream_write_some_vector but
+ * additionally returns an error if not all data was successfully written.
+ *
+ * @param stream Stream to write data to.
+ * @param iov    Array of buffers to write.
+ * @param iovcnt Number of elements in @p iov .
+ *
+ * @returns @ref AVS_OK for success, or an error condition for which the
+ *          operation failed.
+ */
+avs_error_t avs_stream_write_vector(avs_stream_t *stream,
+                                    const avs_stream_const_iovec_t *iov,
+                                    size_t iovcnt);
+
 /**
  * Finishes the message written onto stream by calling
  * @ref avs_stream_vtable_t#finish_message. The underlying stream may freely
@@ -130,6 +190,12 @@ avs_error_t avs_stream_finish_message(avs_stream_t *stream);
  *
  * Format specifiers are the same as @ref printf format specifiers.
  *
+ * If the stream supports the WRITE_BUFFER extension (see
+ * @ref avs_stream_reserve_span), the message is formatted directly into its
+ * output buffer. Otherwise, or if the message does not fit in that buffer, it
+ * is formatted into a temporary buffer first, which may require allocating
+ * memory for long messages.
+ *
  * @param stream    Stream to operate on.
  * @param msg       Message format string.
  * @param ...       Message format string arguments (as in @ref printf).
@@ -199,6 +265,37 @@ avs_error_t avs_stream_read(avs_stream_t *stream,
                             void *buffer,
                             size_t buffer_length);
 
+/**
+ * Reads data from the stream into multiple buffers, filling them in order.
+ * Semantics are the same as for @ref avs_stream_read called with the
+ * buffers concatenated; in particular, the buffers may be filled only
+ * partially.
+ *
+ * Streams that support the VECTOR extension (see
+ * @ref avs_stream_v_table_extension_vector_t) handle it natively. For other
+ * streams, @ref avs_stream_read is called for each buffer in turn; subsequent
+ * buffers are only filled if the previous ones have been filled entirely and
+ * @ref avs_stream_nonblock_read_ready reports that more data is available
+ * without blocking.
+ *
+ * @param stream                Stream to operate on.
+ * @param out_bytes_read        Pointer to a variable where the total number of
+ *                              read bytes will be written, or NULL.
+ * @param out_message_finished  Pointer to a variable where information about
+ *                              message state will be stored (0 if not finished,
+ *                              1 otherwise), or NULL.
+ * @param iov                   Array of buffers to read data into.
+ * @param iovcnt                Number of elements in @p iov .
+ *
+ * @returns @ref AVS_OK for success, or an error condition for which the
+ *          operation failed.
+ */
+avs_error_t avs_stream_read_vector(avs_stream_t *stream,
+                                   size_t *out_bytes_read,
+                                   bool *out_message_finished,
+                                   const avs_stream_iovec_t *iov,
+                                   size_t iovcnt);
+
 /**
  * Attempts to read EXACTLY @p buffer_length bytes from the underlying stream
  * by calling @ref avs_stream_read (possibly multiple times).
@@ -223,7 +320,30 @@ avs_error_t avs_stream_read_reliably(avs_stream_t *stream,
                                      size_t buffer_length);
 
 /**
- * Ignores stream data by calling @ref avs_stream_getch till the message is
+ * Discards up to @p size bytes from the stream. Semantics are the same as for
+ * @ref avs_stream_read, except that the data is not stored anywhere.
+ *
+ * If the stream supports the SKIP extension, data is discarded directly from
+ * its internal buffers. Otherwise, it is read into a temporary block of memory.
+ *
+ * @param stream                Stream to operate on.
+ * @param out_bytes_skipped     Pointer to a variable where amount of discarded
+ *                              bytes will be written, or NULL.
+ * @param out_message_finished  Pointer to a variable where information about
+ *                              message state will be stored (0 if not finished,
+ *                              1 otherwise), or NULL.
+ * @param size                  Maximum number of bytes to discard.
+ *
+ * @returns @ref AVS_OK for success, or an error condition for which the
+ *          operation failed.
+ */
+avs_error_t avs_stream_skip(avs_stream_t *stream,
+                            size_t *out_bytes_skipped,
+                            bool *out_message_finished,
+                            size_t size);
+
+/**
+ * Ignores stream data by calling @ref avs_stream_skip till the message is
  * finished. (For the more informative reference about "finished message" see
  * @ref avs_stream_read documentation).
  *
@@ -283,6 +403,10 @@ avs_error_t avs_stream_getch(avs_stream_t *stream,
  * the underlying stream implementation. @ref avs_stream_v_table_t#peek may also
  * be called with offset 0 or 1.
  *
+ * If the stream supports the READ_BUFFER extension (see
+ * @ref avs_stream_peek_span), the line is instead copied directly from the
+ * internal buffer of the stream, a whole span at a time.
+ *
  * Note: @p buffer will always be NULL-terminated, even in case of error.
  *
  * Note: the line terminator ('\n' or '\r\n') is never written into the
@@ -367,6 +491,16 @@ avs_error_t avs_stream_peekline(avs_stream_t *stream,
  * @p output_stream, until <c>*out_message_finished</c> is true on the input
  * stream or an error occurs.
  *
+ * Where possible, the intermediate buffer is avoided:
+ * - if @p output_stream implements the
+ *   @ref AVS_STREAM_V_TABLE_EXTENSION_TRANSFER extension for the given input
+ *   stream (e.g. a netbuf stream reading from a file stream on a platform that
+ *   supports @ref avs_net_socket_send_file), the data is passed directly to the
+ *   operating system,
+ * - otherwise, if @p input_stream exposes its buffered data (see
+ *   @ref avs_stream_peek_span), that data is written directly from the input
+ *   stream's buffer.
+ *
  * NOTE: @ref avs_stream_finish_message is NOT called on the output stream, so
  * you need to call it manually if needed.
  *
@@ -440,6 +574,94 @@ size_t avs_stream_nonblock_write_ready(avs_stream_t *stream);
  */
 avs_error_t avs_stream_offset(avs_stream_t *stream, avs_off_t *out_offset);
 
+/**
+ * Optional method on streams that support the READ_BUFFER extension. Exposes
+ * a contiguous fragment of data buffered internally by the stream, starting at
+ * @p offset bytes from the current stream position, without consuming or
+ * copying it. More data is buffered if necessary, similarly to
+ * @ref avs_stream_peek .
+ *
+ * The span may be shorter than the amount of data actually buffered; the rest
+ * can be accessed by calling this function again with a larger @p offset . The
+ * returned pointer is only valid until the next operation on the stream.
+ *
+ * @param[in]  stream   Stream to operate on.
+ * @param[in]  offset   Offset from the current stream position.
+ * @param[out] out_data Pointer to the buffered data at @p offset .
+ * @param[out] out_size Number of bytes available at <c>*out_data</c>, never 0
+ *                      on success.
+ *
+ * @returns @li @ref AVS_OK for success,
+ *          @li @ref AVS_EOF if @p offset has been reliably determined as
+ *              pointing past end-of-stream,
+ *          @li <c>avs_errno(AVS_ENOTSUP)</c> if the stream does not support
+ *              the READ_BUFFER extension,
+ *          @li an error condition for which the operation failed; this includes
+ *              the stream not being able to buffer enough data.
+ */
+avs_error_t avs_stream_peek_span(avs_stream_t *stream,
+                                 size_t offset,
+                                 const char **out_data,
+                                 size_t *out_size);
+
+/**
+ * Optional method on streams that support the READ_BUFFER extension. Discards
+ * @p size bytes, previously exposed by @ref avs_stream_peek_span , from the
+ * current stream position.
+ *
+ * @param stream Stream to operate on.
+ * @param size   Number of bytes to discard.
+ *
+ * @returns @ref AVS_OK for success, or an error condition for which the
+ *          operation failed; <c>avs_errno(AVS_ENOTSUP)</c> is returned if the
+ *          stream does not support the READ_BUFFER extension.
+ */
+avs_error_t avs_stream_consume_bytes(avs_stream_t *stream, size_t size);
+
+/**
+ * Optional method on streams that support the WRITE_BUFFER extension. Exposes
+ * a contiguous fragment of free space in the output buffer of the stream, so
+ * that data can be put directly into it instead of being copied by
+ * @ref avs_stream_write . If less than @p min_size bytes are available, the
+ * stream attempts to make room for them, e.g. by flushing buffered data.
+ *
+ * The data is not written until @ref avs_stream_commit_bytes is called. The
+ * returned pointer is only valid until the next operation on the stream.
+ *
+ * @param[in]  stream   Stream to operate on.
+ * @param[in]  min_size Minimum number of bytes requested; may be 0, in which
+ *                      case the span may be empty.
+ * @param[out] out_data Pointer to the free space.
+ * @param[out] out_size Number of bytes available at <c>*out_data</c>, at
+ *                      least @p min_size on success.
+ *
+ * @returns @li @ref AVS_OK for success,
+ *          @li <c>avs_errno(AVS_ENOBUFS)</c> if the stream cannot provide
+ *              @p min_size bytes of contiguous space,
+ *          @li <c>avs_errno(AVS_ENOTSUP)</c> if the stream does not support
+ *              the WRITE_BUFFER extension,
+ *          @li an error condition for which the operation failed.
+ */
+avs_error_t avs_stream_reserve_span(avs_stream_t *stream,
+                                    size_t min_size,
+                                    char **out_data,
+                                    size_t *out_size);
+
+/**
+ * Optional method on streams that support the WRITE_BUFFER extension. Writes
+ * @p size bytes that have been put at the beginning of the span previously
+ * exposed by @ref avs_stream_reserve_span .
+ *
+ * @param stream Stream to operate on.
+ * @param size   Number of bytes to write; MUST NOT exceed the size of the
+ *               exposed span.
+ *
+ * @returns @ref AVS_OK for success, or an error condition for which the
+ *          operation failed; <c>avs_errno(AVS_ENOTSUP)</c> is returned if the
+ *          stream does not support the WRITE_BUFFER extension.
+ */
+avs_error_t avs_stream_commit_bytes(avs_stream_t *stream, size_t size);
+
 #ifdef __cplusplus
 }
 #endif
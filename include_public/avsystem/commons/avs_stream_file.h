@@ -17,6 +17,8 @@
 #ifndef AVS_COMMONS_STREAM_FILE_H
 #define AVS_COMMONS_STREAM_FILE_H
 
+#include <stdio.h>
+
 #include <avsystem/commons/avs_stream.h>
 
 #ifdef __cplusplus
@@ -35,6 +37,16 @@ typedef struct {
     avs_stream_file_seek_t seek;
 } avs_stream_v_table_extension_file_t;
 
+#define AVS_STREAM_V_TABLE_EXTENSION_FILE_HANDLE 0x4648444cUL /* "FHDL" */
+
+typedef avs_error_t (*avs_stream_file_handle_t)(avs_stream_t *stream,
+                                                FILE **out_file,
+                                                avs_off_t *out_offset);
+
+typedef struct {
+    avs_stream_file_handle_t handle;
+} avs_stream_v_table_extension_file_handle_t;
+
 /**
  * Computes length of the file the stream operates on and writes it to
  * @p out_length. On error @p out_length remains unchanged.
@@ -73,8 +85,50 @@ static inline avs_error_t avs_stream_file_offset(avs_stream_t *stream,
 avs_error_t avs_stream_file_seek(avs_stream_t *stream,
                                  avs_off_t offset_from_start);
 
+/**
+ * Exposes the stdio handle of the file a readable stream operates on, so that
+ * its contents can be passed to the operating system directly, e.g. with
+ * @ref avs_net_socket_send_file . Any data buffered by the standard library is
+ * flushed first, so that the underlying file descriptor is up to date.
+ *
+ * After consuming data through the handle, the caller shall advance the stream
+ * using @ref avs_stream_file_seek ; the stream cursor is not affected
+ * otherwise.
+ *
+ * @param stream     file stream pointer
+ * @param out_file   file handle, must not be NULL
+ * @param out_offset current stream cursor position, must not be NULL
+ * @returns @li @ref AVS_OK for success,
+ *          @li <c>avs_errno(AVS_ENOTSUP)</c> if @p stream is not a readable
+ *              file stream,
+ *          @li an error condition for which the operation failed.
+ */
+avs_error_t avs_stream_file_handle(avs_stream_t *stream,
+                                   FILE **out_file,
+                                   avs_off_t *out_offset);
+
 #define AVS_STREAM_FILE_READ 0x01
 #define AVS_STREAM_FILE_WRITE 0x02
+/**
+ * May be combined with @ref AVS_STREAM_FILE_READ (and no other flags) to map
+ * the whole file into memory instead of reading it through stdio. Reading then
+ * only copies data from the mapping, peeking has constant cost regardless of
+ * the offset, and the contents can be parsed in place, without any copying,
+ * using @ref avs_stream_peek_span and @ref avs_stream_consume_bytes .
+ *
+ * The file MUST NOT be modified or truncated while the stream is open.
+ * Accessing a part of the mapping that no longer exists in the file raises
+ * <c>SIGBUS</c>, so this flag is only suitable for files that are not written
+ * by other processes. For this reason, none of the library code, including the
+ * certificate and key loaders, uses it; it is up to the application to opt in.
+ * @ref avs_stream_file_handle is not supported on such streams.
+ *
+ * If memory-mapped files are not supported (see
+ * <c>AVS_COMMONS_STREAM_FILE_WITH_MMAP</c>) or the file cannot be mapped (e.g.
+ * it is not a regular file), a regular read-only file stream is created
+ * instead.
+ */
+#define AVS_STREAM_FILE_MMAP 0x04
 typedef struct avs_file_stream_struct avs_stream_file_t;
 /**
  * Creates a new file-stream. If file referred by @p path does not exist and
@@ -99,7 +153,8 @@ typedef struct avs_file_stream_struct avs_stream_file_t;
  *                      is written
  * @param path          path to the file
  * @param mode          combination of @ref AVS_STREAM_FILE_READ,
- *                                     @ref AVS_STREAM_FILE_WRITE
+ *                                     @ref AVS_STREAM_FILE_WRITE,
+ *                                     @ref AVS_STREAM_FILE_MMAP
  * @return pointer to the new file stream, NULL on error
  */
 avs_stream_t *avs_stream_file_create(const char *path, uint8_t mode);
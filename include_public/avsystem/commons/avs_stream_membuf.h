@@ -85,9 +85,49 @@ avs_error_t avs_stream_membuf_take_ownership(avs_stream_t *stream,
 
 typedef struct avs_stream_membuf_struct avs_stream_membuf_t;
 
+/**
+ * Storage strategy of a membuf stream.
+ */
+typedef enum {
+    /**
+     * All data is kept in a single buffer that is reallocated (and possibly
+     * moved) as it grows. Any unread data is also moved to the beginning of
+     * the buffer before growing it.
+     */
+    AVS_STREAM_MEMBUF_CONTIGUOUS,
+
+    /**
+     * Data is kept in a list of chunks. Data that has already been written is
+     * never moved; each newly allocated chunk is at least as large as all the
+     * existing chunks combined. Read chunks are freed as soon as possible.
+     *
+     * This is preferable for building large messages, as it avoids repeated
+     * copying of all the data. @ref avs_stream_membuf_take_ownership and
+     * @ref avs_stream_membuf_fit copy the data into a single buffer once.
+     */
+    AVS_STREAM_MEMBUF_CHUNKED
+} avs_stream_membuf_storage_t;
+
 /**
  * Creates a new in-memory auto-resizable bidirectional stream.
  *
+ * @param storage      Storage strategy to use.
+ * @param reserve_size Number of bytes to allocate upfront, so that the first
+ *                     @p reserve_size bytes can be written without any further
+ *                     allocations; may be 0.
+ *
+ * @return NULL in case of an error, pointer to the newly allocated
+ *         stream otherwise
+ */
+avs_stream_t *avs_stream_membuf_create_ex(avs_stream_membuf_storage_t storage,
+                                          size_t reserve_size);
+
+/**
+ * Creates a new in-memory auto-resizable bidirectional stream.
+ *
+ * Equivalent to
+ * <c>avs_stream_membuf_create_ex(AVS_STREAM_MEMBUF_CONTIGUOUS, 0)</c>.
+ *
  * @return NULL in case of an error, pointer to the newly allocated
  *         stream otherwise
  */
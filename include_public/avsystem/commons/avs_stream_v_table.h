@@ -222,6 +222,229 @@ typedef struct {
     avs_stream_offset_t offset;
 } avs_stream_v_table_extension_offset_t;
 
+#define AVS_STREAM_V_TABLE_EXTENSION_VECTOR 0x56454354UL /* "VECT" */
+
+/**
+ * @ref avs_stream_write_some_vector implementation callback type.
+ *
+ * Writes data from all of the @p iovcnt buffers described by @p iov , in
+ * order, as if they were concatenated. Short writes are allowed, in the same
+ * way as for @ref avs_stream_write_some_t .
+ *
+ * @param stream            Stream to operate on.
+ * @param iov               Array of buffers to write.
+ * @param iovcnt            Number of elements in @p iov .
+ * @param out_bytes_written MUST NOT be NULL. Pointer to a variable where the
+ *                          total number of bytes actually written shall be
+ *                          stored.
+ *
+ * @returns @ref AVS_OK for success, or an error condition for which the
+ *          operation failed.
+ */
+typedef avs_error_t (*avs_stream_write_some_vector_t)(
+        avs_stream_t *stream,
+        const avs_stream_const_iovec_t *iov,
+        size_t iovcnt,
+        size_t *out_bytes_written);
+
+/**
+ * @ref avs_stream_read_vector implementation callback type.
+ *
+ * Reads data into the @p iovcnt buffers described by @p iov , filling them in
+ * order. The same rules apply as for @ref avs_stream_read_t called with the
+ * buffers concatenated.
+ *
+ * @param stream                Stream to operate on.
+ * @param out_bytes_read        MUST NOT be NULL. Pointer to a variable where
+ *                              the total number of read bytes shall be stored.
+ * @param out_message_finished  MUST NOT be NULL. Pointer to a variable where
+ *                              information about message state shall be
+ *                              stored.
+ * @param iov                   Array of buffers to read data into.
+ * @param iovcnt                Number of elements in @p iov .
+ *
+ * @returns @ref AVS_OK for success, or an error condition for which the
+ *          operation failed.
+ */
+typedef avs_error_t (*avs_stream_read_vector_t)(avs_stream_t *stream,
+                                                size_t *out_bytes_read,
+                                                bool *out_message_finished,
+                                                const avs_stream_iovec_t *iov,
+                                                size_t iovcnt);
+
+/**
+ * Either of the methods may be NULL, in which case the generic implementation
+ * based on @ref avs_stream_write_some or @ref avs_stream_read is used.
+ */
+typedef struct {
+    avs_stream_write_some_vector_t write_some_vector;
+    avs_stream_read_vector_t read_vector;
+} avs_stream_v_table_extension_vector_t;
+
+#define AVS_STREAM_V_TABLE_EXTENSION_READ_BUFFER 0x52425546UL /* "RBUF" */
+
+/**
+ * @ref avs_stream_peek_span implementation callback type.
+ *
+ * Exposes a contiguous fragment of data buffered internally by the stream,
+ * starting at @p offset bytes from the current stream position, without
+ * consuming it. If not enough data is buffered, the implementation shall
+ * attempt to buffer more, in the same way as @ref avs_stream_peek_t .
+ *
+ * The span may be shorter than the amount of data actually available, e.g.
+ * if the internal buffer wraps around, but shall never be empty on success.
+ * The returned pointer remains valid until the next operation on the stream.
+ *
+ * @param[in]  stream   Stream to operate on.
+ * @param[in]  offset   Offset from the current stream position.
+ * @param[out] out_data Pointer to the buffered data at @p offset .
+ * @param[out] out_size Number of bytes available at <c>*out_data</c>.
+ *
+ * @returns @li @ref AVS_OK for success,
+ *          @li @ref AVS_EOF if @p offset has been reliably determined as
+ *              pointing past end-of-stream,
+ *          @li an error condition for which the operation failed; this includes
+ *              <c>avs_errno(AVS_ENOBUFS)</c> if the internal buffer is too
+ *              small to reach @p offset .
+ */
+typedef avs_error_t (*avs_stream_peek_span_t)(avs_stream_t *stream,
+                                              size_t offset,
+                                              const char **out_data,
+                                              size_t *out_size);
+
+/**
+ * @ref avs_stream_consume_bytes implementation callback type.
+ *
+ * Discards @p size bytes from the current stream position. The bytes MUST have
+ * been previously exposed with @ref avs_stream_peek_span_t .
+ *
+ * @param stream Stream to operate on.
+ * @param size   Number of bytes to discard.
+ *
+ * @returns @ref AVS_OK for success, or an error condition for which the
+ *          operation failed.
+ */
+typedef avs_error_t (*avs_stream_consume_bytes_t)(avs_stream_t *stream,
+                                                  size_t size);
+
+typedef struct {
+    avs_stream_peek_span_t peek_span;
+    avs_stream_consume_bytes_t consume_bytes;
+} avs_stream_v_table_extension_read_buffer_t;
+
+#define AVS_STREAM_V_TABLE_EXTENSION_WRITE_BUFFER 0x57425546UL /* "WBUF" */
+
+/**
+ * @ref avs_stream_reserve_span implementation callback type.
+ *
+ * Exposes a contiguous fragment of free space in the output buffer of the
+ * stream, so that the caller may put data directly into it. If less than
+ * @p min_size bytes are available, the implementation shall attempt to make
+ * room for them, e.g. by flushing the buffered data or growing the buffer.
+ *
+ * The span may be larger than @p min_size , and may be empty if @p min_size
+ * is 0. Nothing is written to the stream until @ref avs_stream_commit_bytes_t
+ * is called. The returned pointer remains valid until the next operation on
+ * the stream.
+ *
+ * @param[in]  stream   Stream to operate on.
+ * @param[in]  min_size Minimum number of bytes requested.
+ * @param[out] out_data Pointer to the free space.
+ * @param[out] out_size Number of bytes available at <c>*out_data</c>.
+ *
+ * @returns @li @ref AVS_OK for success,
+ *          @li <c>avs_errno(AVS_ENOBUFS)</c> if the buffer cannot hold
+ *              @p min_size bytes at once,
+ *          @li an error condition for which the operation failed.
+ */
+typedef avs_error_t (*avs_stream_reserve_span_t)(avs_stream_t *stream,
+                                                 size_t min_size,
+                                                 char **out_data,
+                                                 size_t *out_size);
+
+/**
+ * @ref avs_stream_commit_bytes implementation callback type.
+ *
+ * Writes @p size bytes that have been put at the beginning of the span
+ * previously exposed with @ref avs_stream_reserve_span_t .
+ *
+ * @param stream Stream to operate on.
+ * @param size   Number of bytes to write.
+ *
+ * @returns @ref AVS_OK for success, or an error condition for which the
+ *          operation failed.
+ */
+typedef avs_error_t (*avs_stream_commit_bytes_t)(avs_stream_t *stream,
+                                                 size_t size);
+
+typedef struct {
+    avs_stream_reserve_span_t reserve_span;
+    avs_stream_commit_bytes_t commit_bytes;
+} avs_stream_v_table_extension_write_buffer_t;
+
+#define AVS_STREAM_V_TABLE_EXTENSION_SKIP 0x534B4950UL /* "SKIP" */
+
+/**
+ * @ref avs_stream_skip implementation callback type.
+ *
+ * Discards up to @p size bytes from the stream. The same rules apply as for
+ * @ref avs_stream_read_t , except that the data is not copied anywhere, so the
+ * implementation is free to drop whole internal buffers at once.
+ *
+ * @param stream                Stream to operate on.
+ * @param out_bytes_skipped     MUST NOT be NULL. Pointer to a variable where
+ *                              the number of discarded bytes shall be stored.
+ * @param out_message_finished  MUST NOT be NULL. Pointer to a variable where
+ *                              information about message state shall be
+ *                              stored.
+ * @param size                  Maximum number of bytes to discard.
+ *
+ * @returns @ref AVS_OK for success, or an error condition for which the
+ *          operation failed.
+ */
+typedef avs_error_t (*avs_stream_skip_t)(avs_stream_t *stream,
+                                         size_t *out_bytes_skipped,
+                                         bool *out_message_finished,
+                                         size_t size);
+
+typedef struct {
+    avs_stream_skip_t skip;
+} avs_stream_v_table_extension_skip_t;
+
+#define AVS_STREAM_V_TABLE_EXTENSION_TRANSFER 0x58464552UL /* "XFER" */
+
+/**
+ * Fast path for @ref avs_stream_copy , implemented by the output stream.
+ *
+ * Transfers data from @p input_stream directly into @p stream , without
+ * bouncing it through an intermediate buffer, e.g. by handing over file
+ * contents to the operating system. May be called repeatedly until
+ * <c>*out_message_finished</c> is set.
+ *
+ * @param stream                Output stream to operate on.
+ * @param input_stream          Stream to read data from.
+ * @param out_bytes_transferred MUST NOT be NULL. Pointer to a variable where
+ *                              the number of transferred bytes shall be
+ *                              stored.
+ * @param out_message_finished  MUST NOT be NULL. Pointer to a variable where
+ *                              information about message state of
+ *                              @p input_stream shall be stored.
+ *
+ * @returns @li @ref AVS_OK for success,
+ *          @li <c>avs_errno(AVS_ENOTSUP)</c> if no fast path is available for
+ *              this pair of streams; no data shall be consumed from
+ *              @p input_stream in that case,
+ *          @li an error condition for which the operation failed.
+ */
+typedef avs_error_t (*avs_stream_transfer_from_t)(avs_stream_t *stream,
+                                                  avs_stream_t *input_stream,
+                                                  size_t *out_bytes_transferred,
+                                                  bool *out_message_finished);
+
+typedef struct {
+    avs_stream_transfer_from_t transfer_from;
+} avs_stream_v_table_extension_transfer_t;
+
 #ifdef __cplusplus
 }
 #endif
@@ -150,6 +150,164 @@ int avs_buffer_fill_bytes(avs_buffer_t *buffer, int value, size_t bytes_count) {
     }
 }
 
+struct avs_ring_buffer_struct {
+    size_t capacity;
+    /* offset of the first byte of data */
+    size_t begin;
+    size_t size;
+    union {
+        char data[1]; /* variable length */
+        avs_max_align_t align;
+    } data;
+};
+
+int avs_ring_buffer_create(avs_ring_buffer_t **buffer_ptr, size_t capacity) {
+    *buffer_ptr = (avs_ring_buffer_t *) avs_malloc(
+            offsetof(avs_ring_buffer_t, data) + capacity);
+    if (*buffer_ptr) {
+        (*buffer_ptr)->capacity = capacity;
+        avs_ring_buffer_reset(*buffer_ptr);
+        return 0;
+    } else {
+        LOG(ERROR, _("cannot allocate buffer"));
+        return -1;
+    }
+}
+
+void avs_ring_buffer_free(avs_ring_buffer_t **buffer) {
+    avs_free(*buffer);
+    *buffer = NULL;
+}
+
+void avs_ring_buffer_reset(avs_ring_buffer_t *buffer) {
+    buffer->begin = 0;
+    buffer->size = 0;
+}
+
+size_t avs_ring_buffer_data_size(const avs_ring_buffer_t *buffer) {
+    return buffer->size;
+}
+
+size_t avs_ring_buffer_capacity(const avs_ring_buffer_t *buffer) {
+    return buffer->capacity;
+}
+
+size_t avs_ring_buffer_space_left(const avs_ring_buffer_t *buffer) {
+    return buffer->capacity - buffer->size;
+}
+
+/**
+ * Fills @p out_segments with the range of @p size bytes starting at @p offset,
+ * which may wrap around the end of storage.
+ */
+static size_t get_segments(avs_ring_buffer_t *buffer,
+                           size_t offset,
+                           size_t size,
+                           avs_ring_buffer_segment_t out_segments[2]) {
+    size_t first_size = AVS_MIN(size, buffer->capacity - offset);
+    out_segments[0].ptr = &buffer->data.data[offset];
+    out_segments[0].size = first_size;
+    out_segments[1].ptr = buffer->data.data;
+    out_segments[1].size = size - first_size;
+    return (size_t) (!!out_segments[0].size + !!out_segments[1].size);
+}
+
+/**
+ * Translates an offset relative to the beginning of data into a storage
+ * offset.
+ */
+static size_t wrap_offset(const avs_ring_buffer_t *buffer, size_t offset) {
+    offset += buffer->begin;
+    return offset >= buffer->capacity ? offset - buffer->capacity : offset;
+}
+
+size_t
+avs_ring_buffer_data_segments(avs_ring_buffer_t *buffer,
+                              avs_ring_buffer_segment_t out_segments[2]) {
+    return get_segments(buffer, buffer->begin, buffer->size, out_segments);
+}
+
+size_t
+avs_ring_buffer_space_segments(avs_ring_buffer_t *buffer,
+                               avs_ring_buffer_segment_t out_segments[2]) {
+    if (!buffer->capacity) {
+        return get_segments(buffer, 0, 0, out_segments);
+    }
+    return get_segments(buffer, wrap_offset(buffer, buffer->size),
+                        avs_ring_buffer_space_left(buffer), out_segments);
+}
+
+int avs_ring_buffer_copy_data(const avs_ring_buffer_t *buffer,
+                              size_t offset,
+                              void *dest,
+                              size_t size) {
+    if (offset > buffer->size || size > buffer->size - offset) {
+        LOG(ERROR, _("not enough data"));
+        return -1;
+    }
+    if (size) {
+        size_t start = wrap_offset(buffer, offset);
+        size_t first_size = AVS_MIN(size, buffer->capacity - start);
+        memcpy(dest, &buffer->data.data[start], first_size);
+        memcpy((char *) dest + first_size, buffer->data.data,
+               size - first_size);
+    }
+    return 0;
+}
+
+int avs_ring_buffer_consume_bytes(avs_ring_buffer_t *buffer,
+                                  size_t bytes_count) {
+    if (bytes_count > buffer->size) {
+        LOG(ERROR, _("not enough data"));
+        return -1;
+    }
+    buffer->size -= bytes_count;
+    // when empty, start over to keep the free space contiguous
+    buffer->begin = buffer->size ? wrap_offset(buffer, bytes_count) : 0;
+    return 0;
+}
+
+int avs_ring_buffer_advance_ptr(avs_ring_buffer_t *buffer, size_t n) {
+    if (n > avs_ring_buffer_space_left(buffer)) {
+        LOG(ERROR, _("position out of bounds"));
+        return -1;
+    }
+    buffer->size += n;
+    return 0;
+}
+
+int avs_ring_buffer_append_bytes(avs_ring_buffer_t *buffer,
+                                 const void *data,
+                                 size_t data_length) {
+    avs_ring_buffer_segment_t segments[2];
+    if (data_length > avs_ring_buffer_space_left(buffer)) {
+        LOG(ERROR, _("buffer too small"));
+        return -1;
+    }
+    avs_ring_buffer_space_segments(buffer, segments);
+    size_t first_size = AVS_MIN(data_length, segments[0].size);
+    memcpy(segments[0].ptr, data, first_size);
+    memcpy(segments[1].ptr, (const char *) data + first_size,
+           data_length - first_size);
+    buffer->size += data_length;
+    return 0;
+}
+
+int avs_ring_buffer_fill_bytes(avs_ring_buffer_t *buffer,
+                               int value,
+                               size_t bytes_count) {
+    avs_ring_buffer_segment_t segments[2];
+    if (bytes_count > avs_ring_buffer_space_left(buffer)) {
+        return -1;
+    }
+    avs_ring_buffer_space_segments(buffer, segments);
+    size_t first_size = AVS_MIN(bytes_count, segments[0].size);
+    memset(segments[0].ptr, value, first_size);
+    memset(segments[1].ptr, value, bytes_count - first_size);
+    buffer->size += bytes_count;
+    return 0;
+}
+
 #    ifdef AVS_UNIT_TESTING
 #        include "tests/buffer/test_buffer.c"
 #    endif
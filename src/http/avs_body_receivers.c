@@ -29,6 +29,23 @@
 
 VISIBILITY_SOURCE_BEGIN
 
+bool _avs_http_body_receiver_finished(avs_stream_t *receiver) {
+    const http_body_receiver_v_table_extension_t *ext =
+            (const http_body_receiver_v_table_extension_t *)
+                    avs_stream_v_table_find_extension(
+                            receiver, HTTP_BODY_RECEIVER_V_TABLE_EXTENSION);
+    return ext && ext->finished(receiver);
+}
+
+avs_error_t _avs_http_body_receiver_close_backend(avs_stream_t **backend_ptr,
+                                                  avs_stream_t *origin) {
+    if (origin && avs_stream_netbuf_transfer(origin, *backend_ptr)) {
+        LOG(WARNING, _("could not keep data received past the end of body"));
+    }
+    avs_stream_net_setsock(*backend_ptr, NULL); /* don't close the socket */
+    return avs_stream_cleanup(backend_ptr);
+}
+
 /******** Generic constructor */
 static avs_stream_t *
 create_body_receiver(avs_stream_t *backend,
@@ -63,12 +80,13 @@ create_body_receiver(avs_stream_t *backend,
         break;
 
     case TRANSFER_LENGTH:
-        retval = _avs_http_body_receiver_content_length_create(buffer,
-                                                               content_length);
+        retval = _avs_http_body_receiver_content_length_create(
+                buffer, backend, content_length);
         break;
 
     case TRANSFER_CHUNKED:
-        retval = _avs_http_body_receiver_chunked_create(buffer, buffer_sizes);
+        retval = _avs_http_body_receiver_chunked_create(buffer, backend,
+                                                        buffer_sizes);
         break;
     }
 
@@ -117,8 +135,9 @@ int _avs_http_body_receiver_init(http_stream_t *stream,
         return -1;
     }
 
-    result = _avs_http_content_decoder_create(&decoder, content_encoding,
-                                              &stream->http->buffer_sizes);
+    result = _avs_http_content_decoder_create(
+            &decoder, &stream->http->compression_pool, content_encoding,
+            &stream->http->buffer_sizes);
     if (!result && decoder) {
         avs_stream_t *filter_stream =
                 _avs_http_decoding_stream_create(stream->body_receiver, decoder,
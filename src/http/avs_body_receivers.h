@@ -21,6 +21,29 @@
 
 VISIBILITY_PRIVATE_HEADER_BEGIN
 
+/**
+ * Vtable extension of body receivers that can tell whether the whole body has
+ * already been read.
+ */
+#define HTTP_BODY_RECEIVER_V_TABLE_EXTENSION 0x48424459UL /* "HBDY" */
+
+typedef bool (*http_body_receiver_finished_t)(avs_stream_t *stream);
+
+typedef struct {
+    http_body_receiver_finished_t finished;
+} http_body_receiver_v_table_extension_t;
+
+/**
+ * Checks whether the whole body has already been read from a body receiver,
+ * without performing any I/O.
+ *
+ * Note that a receiver might not know that the body is finished until it
+ * attempts to read more data, e.g. when the previous read ended exactly at the
+ * end of a chunk. In such case, as well as for receivers that cannot determine
+ * it at all, false is returned.
+ */
+bool _avs_http_body_receiver_finished(avs_stream_t *receiver);
+
 /**
  * Creates a "dumb" body receiver, appropriate for the "identity" transfer
  * encoding.
@@ -40,10 +63,14 @@ avs_stream_t *_avs_http_body_receiver_dumb_create(avs_stream_t *backend);
  * been consumed.
  *
  * @param backend        The netbuf stream wrapping the TCP socket.
+ * @param origin         The netbuf stream from which buffered data has been
+ *                       transferred to @p backend . Data received past the end
+ *                       of the body is transferred back to it when closing.
  * @param content_length Limit of the number of bytes to consume.
  */
 avs_stream_t *
 _avs_http_body_receiver_content_length_create(avs_stream_t *backend,
+                                              avs_stream_t *origin,
                                               size_t content_length);
 
 /**
@@ -53,12 +80,28 @@ _avs_http_body_receiver_content_length_create(avs_stream_t *backend,
  * reading until a zero-length chunk is received.
  *
  * @param backend        The netbuf stream wrapping the TCP socket.
+ * @param origin         The netbuf stream from which buffered data has been
+ *                       transferred to @p backend . Data received past the end
+ *                       of the body is transferred back to it when closing.
  * @param buffer_sizes   Pointer to buffer sizes used by this HTTP client.
  *                       The pointer must remain valid for the lifetime of the
  *                       created object.
  */
 avs_stream_t *_avs_http_body_receiver_chunked_create(
-        avs_stream_t *backend, const avs_http_buffer_sizes_t *buffer_sizes);
+        avs_stream_t *backend,
+        avs_stream_t *origin,
+        const avs_http_buffer_sizes_t *buffer_sizes);
+
+/**
+ * Cleans up the netbuf stream used by a body receiver, without closing the
+ * socket.
+ *
+ * If @p origin is not NULL, data that has already been received past the end of
+ * the body (i.e. the beginning of the next pipelined response) is transferred
+ * back to it first.
+ */
+avs_error_t _avs_http_body_receiver_close_backend(avs_stream_t **backend_ptr,
+                                                  avs_stream_t *origin);
 
 /**
  * Puts the HTTP stream in a receiving state, filling the <c>body_receiver</c>
@@ -0,0 +1,94 @@
+/*
+ * Copyright 2023 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// NOTE: library headers may contain some of the symbols poisoned via inclusion
+// of avs_commons_init.h. Therefore they must be included before poison.
+#define AVS_SUPPRESS_POISONING
+#include <avs_commons_init.h>
+
+#if defined(AVS_COMMONS_WITH_AVS_HTTP) && defined(AVS_COMMONS_HTTP_WITH_BROTLI)
+
+#    include <brotli/decode.h>
+
+#    include <avs_commons_poison.h>
+
+#    include <avsystem/commons/avs_memory.h>
+
+#    include "avs_decompressor.h"
+
+#    include "avs_http_log.h"
+
+VISIBILITY_SOURCE_BEGIN
+
+static void *brotli_alloc(void *opaque, size_t size) {
+    (void) opaque;
+    return avs_malloc(size);
+}
+
+static void brotli_free(void *opaque, void *ptr) {
+    (void) opaque;
+    avs_free(ptr);
+}
+
+static void *brotli_create(void) {
+    return BrotliDecoderCreateInstance(brotli_alloc, brotli_free, NULL);
+}
+
+static http_decompressor_result_t
+brotli_decompress(void *state,
+                  const uint8_t **inout_next_in,
+                  size_t *inout_avail_in,
+                  uint8_t **inout_next_out,
+                  size_t *inout_avail_out) {
+    switch (BrotliDecoderDecompressStream((BrotliDecoderState *) state,
+                                          inout_avail_in, inout_next_in,
+                                          inout_avail_out, inout_next_out,
+                                          NULL)) {
+    case BROTLI_DECODER_RESULT_SUCCESS:
+        return HTTP_DECOMPRESSOR_FINISHED;
+    case BROTLI_DECODER_RESULT_NEEDS_MORE_INPUT:
+        return HTTP_DECOMPRESSOR_NEED_INPUT;
+    case BROTLI_DECODER_RESULT_NEEDS_MORE_OUTPUT:
+        return HTTP_DECOMPRESSOR_OK;
+    default:
+        LOG(ERROR, _("Brotli decompression error: ") "%s",
+            BrotliDecoderErrorString(
+                    BrotliDecoderGetErrorCode((BrotliDecoderState *) state)));
+        return HTTP_DECOMPRESSOR_ERROR;
+    }
+}
+
+static void brotli_destroy(void *state) {
+    if (state) {
+        BrotliDecoderDestroyInstance((BrotliDecoderState *) state);
+    }
+}
+
+static int brotli_reset(void **state_ptr) {
+    /* the decoder cannot be reset in place */
+    brotli_destroy(*state_ptr);
+    return (*state_ptr = brotli_create()) ? 0 : -1;
+}
+
+const http_decompressor_ops_t _AVS_HTTP_BROTLI_DECOMPRESSOR = {
+    .create = brotli_create,
+    .decompress = brotli_decompress,
+    .reset = brotli_reset,
+    .destroy = brotli_destroy
+};
+
+#endif // defined(AVS_COMMONS_WITH_AVS_HTTP) &&
+       // defined(AVS_COMMONS_HTTP_WITH_BROTLI)
@@ -42,11 +42,13 @@ static avs_error_t http_send_single_chunk(http_stream_t *stream,
             < 0) {
         AVS_UNREACHABLE();
     }
-    (void) (avs_is_err((err = avs_stream_write(stream->backend, size_buf,
-                                               strlen(size_buf))))
-            || avs_is_err((err = avs_stream_write(stream->backend, buffer,
-                                                  buffer_length)))
-            || avs_is_err((err = avs_stream_write(stream->backend, "\r\n", 2)))
+    const avs_stream_const_iovec_t chunk[] = {
+        { size_buf, strlen(size_buf) },
+        { buffer, buffer_length },
+        { "\r\n", 2 }
+    };
+    (void) (avs_is_err((err = avs_stream_write_vector(stream->backend, chunk,
+                                                      AVS_ARRAY_SIZE(chunk))))
             || avs_is_err((err = avs_stream_finish_message(stream->backend))));
     _avs_http_maybe_schedule_retry_after_send(stream, err);
     return err;
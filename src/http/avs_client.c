@@ -18,6 +18,7 @@
 
 #ifdef AVS_COMMONS_WITH_AVS_HTTP
 
+#    include <stddef.h>
 #    include <string.h>
 
 #    include <avsystem/commons/avs_memory.h>
@@ -32,7 +33,9 @@ VISIBILITY_SOURCE_BEGIN
 const avs_http_buffer_sizes_t AVS_HTTP_DEFAULT_BUFFER_SIZES = {
     .body_recv = 4096,
     .body_send = 4096,
-#    ifdef AVS_COMMONS_HTTP_WITH_ZLIB
+#    if defined(AVS_COMMONS_HTTP_WITH_ZLIB)      \
+            || defined(AVS_COMMONS_HTTP_WITH_BROTLI) \
+            || defined(AVS_COMMONS_HTTP_WITH_ZSTD)
     .content_coding_input = 4096,
     .content_coding_min_input = 128,
 #    endif
@@ -50,12 +53,16 @@ avs_http_t *avs_http_new(const avs_http_buffer_sizes_t *buffer_sizes) {
         return NULL;
     }
     result->buffer_sizes = *buffer_sizes;
+    result->pool_idle_timeout = AVS_TIME_DURATION_INVALID;
     return result;
 }
 
 void avs_http_free(avs_http_t *http) {
     if (http) {
         avs_http_clear_cookies(http);
+        avs_http_clear_connection_pool(http);
+        avs_http_set_compression_pool(http, 0);
+        AVS_LIST_CLEAR(&http->header_cbs);
         avs_free(http->user_agent);
         avs_free(http);
     }
@@ -66,6 +73,7 @@ void avs_http_ssl_configuration(
         avs_http_t *http,
         const volatile avs_net_ssl_configuration_t *ssl_configuration) {
     http->ssl_configuration = ssl_configuration;
+    avs_http_clear_connection_pool(http);
 }
 #    endif // AVS_COMMONS_WITH_AVS_CRYPTO
 
@@ -74,12 +82,19 @@ void avs_http_ssl_pre_connect_cb(avs_http_t *http,
                                  void *user_ptr) {
     http->ssl_pre_connect_cb = cb;
     http->ssl_pre_connect_cb_arg = user_ptr;
+    avs_http_clear_connection_pool(http);
+}
+
+void avs_http_set_compression_pool(avs_http_t *http, size_t max_idle_states) {
+    http->compression_pool.max_idle_states = max_idle_states;
+    _avs_http_compression_pool_trim(&http->compression_pool);
 }
 
 void avs_http_tcp_configuration(
         avs_http_t *http,
         const volatile avs_net_socket_configuration_t *tcp_configuration) {
     http->tcp_configuration = tcp_configuration;
+    avs_http_clear_connection_pool(http);
 }
 
 int avs_http_set_user_agent(avs_http_t *http, const char *user_agent) {
@@ -95,6 +110,39 @@ int avs_http_set_user_agent(avs_http_t *http, const char *user_agent) {
     return 0;
 }
 
+int avs_http_set_header_cb(avs_http_t *http,
+                           const char *key,
+                           avs_http_header_cb_t *cb,
+                           void *user_ptr) {
+    AVS_LIST(http_header_cb_entry_t) *entry_ptr;
+    AVS_LIST_FOREACH_PTR(entry_ptr, &http->header_cbs) {
+        if (avs_strcasecmp((*entry_ptr)->key, key) == 0) {
+            break;
+        }
+    }
+    if (!cb) {
+        if (*entry_ptr) {
+            AVS_LIST_DELETE(entry_ptr);
+        }
+        return 0;
+    }
+    if (!*entry_ptr) {
+        size_t key_size = strlen(key) + 1;
+        AVS_LIST(http_header_cb_entry_t) entry =
+                (AVS_LIST(http_header_cb_entry_t)) AVS_LIST_NEW_BUFFER(
+                        offsetof(http_header_cb_entry_t, key) + key_size);
+        if (!entry) {
+            LOG(ERROR, _("Out of memory"));
+            return -1;
+        }
+        memcpy(entry->key, key, key_size);
+        AVS_LIST_INSERT(entry_ptr, entry);
+    }
+    (*entry_ptr)->cb = cb;
+    (*entry_ptr)->user_ptr = user_ptr;
+    return 0;
+}
+
 void avs_http_clear_cookies(avs_http_t *http) {
     AVS_LIST_CLEAR(&http->cookies);
     http->use_cookie2 = false;
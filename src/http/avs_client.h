@@ -20,12 +20,28 @@
 #include <avsystem/commons/avs_http.h>
 #include <avsystem/commons/avs_list.h>
 
+#include "avs_compression.h"
+
 VISIBILITY_PRIVATE_HEADER_BEGIN
 
 typedef struct {
     char value[1]; // actually a FAM
 } http_cookie_t;
 
+typedef struct {
+    avs_net_socket_t *socket;
+    avs_time_monotonic_t idle_since;
+    const char *host;
+    const char *port;
+    char protocol[1]; // actually a FAM, followed by host and port
+} http_pooled_connection_t;
+
+typedef struct {
+    avs_http_header_cb_t *cb;
+    void *user_ptr;
+    char key[1]; // actually a FAM
+} http_header_cb_entry_t;
+
 struct avs_http {
     avs_http_buffer_sizes_t buffer_sizes;
 
@@ -42,6 +58,17 @@ struct avs_http {
     const volatile avs_net_ssl_configuration_t *ssl_configuration;
 #endif // AVS_COMMONS_WITH_AVS_CRYPTO
     const volatile avs_net_socket_configuration_t *tcp_configuration;
+
+    /* Idle keep-alive connections, most recently released first */
+    AVS_LIST(http_pooled_connection_t) connection_pool;
+    size_t pool_max_idle_per_host;
+    avs_time_duration_t pool_idle_timeout;
+
+    /* Idle zlib states, see avs_http_set_compression_pool() */
+    http_compression_pool_t compression_pool;
+
+    /* User callbacks for received headers, see avs_http_set_header_cb() */
+    AVS_LIST(http_header_cb_entry_t) header_cbs;
 };
 
 extern const char *const _AVS_HTTP_METHOD_NAMES[];
@@ -50,6 +77,21 @@ int _avs_http_set_cookie(avs_http_t *client,
                          bool use_cookie2,
                          const char *cookie_header);
 
+/**
+ * Takes an idle connection to the host designated by @p url out of the pool.
+ * Returns NULL if there is none.
+ */
+avs_net_socket_t *_avs_http_pool_checkout(avs_http_t *http,
+                                          const avs_url_t *url);
+
+/**
+ * Puts a connection to the host designated by @p url into the pool, or closes
+ * it if pooling is disabled. <c>*socket_ptr</c> is set to NULL in either case.
+ */
+void _avs_http_pool_checkin(avs_http_t *http,
+                            const avs_url_t *url,
+                            avs_net_socket_t **socket_ptr);
+
 VISIBILITY_PRIVATE_HEADER_END
 
 #endif /* AVS_COMMONS_HTTP_CLIENT_H */
@@ -46,28 +46,46 @@ VISIBILITY_SOURCE_BEGIN
 #    define GET_OUTPUT_BUFFER(stream) \
         ((stream)->data + (stream)->input_buffer_size)
 
-typedef struct {
-    const avs_stream_v_table_t *const vtable;
+struct http_zlib_state_struct {
     z_stream zlib;
     int error;
     int flush;
+    /* parameters the state has been initialized with */
+    bool compressor;
+    http_compression_format_t format;
+    int level;
+    int window_bits;
+    int mem_level;
     size_t input_buffer_size;
     size_t output_buffer_size;
     uint8_t data[];
+};
+
+/**
+ * The object actually returned as a compressor or decompressor stream. The
+ * zlib state itself is allocated separately, so that it may outlive the stream
+ * in a pool.
+ */
+typedef struct {
+    const avs_stream_v_table_t *const vtable;
+    http_compression_pool_t *pool;
+    AVS_LIST(http_zlib_state_t) state;
 } zlib_stream_t;
 
+#    define GET_STATE(stream_) (((zlib_stream_t *) (stream_))->state)
+
 /* we don't use opaque field in zlib for allocation data,
  * so we can reuse it for flush function pointer */
 #    define FLUSH_FUNC(stream) \
         (((zlib_flush_func_holder_t *) (stream)->zlib.opaque)->flush_func)
 
 typedef struct {
-    avs_error_t (*flush_func)(zlib_stream_t *);
+    avs_error_t (*flush_func)(http_zlib_state_t *);
 } zlib_flush_func_holder_t;
 
 #    define zlib_stream_flush(stream) FLUSH_FUNC(stream)(stream)
 
-static const char *get_zlib_msg(const zlib_stream_t *stream) {
+static const char *get_zlib_msg(const http_zlib_state_t *stream) {
     return stream->zlib.msg ? stream->zlib.msg : "(no message)";
 }
 
@@ -79,7 +97,7 @@ static avs_error_t map_zlib_error(int zlib_error) {
     }
 }
 
-static avs_error_t compressor_flush(zlib_stream_t *stream) {
+static avs_error_t compressor_flush(http_zlib_state_t *stream) {
     stream->error = deflate(&stream->zlib, stream->flush);
     if (stream->error == Z_BUF_ERROR) {
         /* nothing happened, ignore */
@@ -100,7 +118,7 @@ static avs_error_t compressor_flush(zlib_stream_t *stream) {
 
 static zlib_flush_func_holder_t compressor_flush_holder = { compressor_flush };
 
-static avs_error_t decompressor_flush(zlib_stream_t *stream) {
+static avs_error_t decompressor_flush(http_zlib_state_t *stream) {
     if (stream->error == Z_STREAM_END) {
         return AVS_OK;
     }
@@ -129,7 +147,7 @@ static zlib_flush_func_holder_t decompressor_flush_holder = {
 static avs_error_t zlib_stream_write_some(avs_stream_t *stream_,
                                           const void *data,
                                           size_t *inout_data_length) {
-    zlib_stream_t *stream = (zlib_stream_t *) stream_;
+    http_zlib_state_t *stream = GET_STATE(stream_);
     if (stream->error == Z_STREAM_END || stream->flush != Z_NO_FLUSH) {
         LOG(ERROR, _("Stream finished"));
         return avs_errno(AVS_EBADF);
@@ -152,7 +170,7 @@ static avs_error_t zlib_stream_write_some(avs_stream_t *stream_,
 }
 
 static size_t zlib_stream_nonblock_write_ready(avs_stream_t *stream_) {
-    zlib_stream_t *stream = (zlib_stream_t *) stream_;
+    http_zlib_state_t *stream = GET_STATE(stream_);
     if (stream->zlib.avail_in > 0 && avs_is_err(zlib_stream_flush(stream))) {
         return 0;
     }
@@ -160,7 +178,7 @@ static size_t zlib_stream_nonblock_write_ready(avs_stream_t *stream_) {
 }
 
 static avs_error_t zlib_stream_finish_message(avs_stream_t *stream_) {
-    zlib_stream_t *stream = (zlib_stream_t *) stream_;
+    http_zlib_state_t *stream = GET_STATE(stream_);
     stream->flush = Z_FINISH;
     return zlib_stream_flush(stream);
 }
@@ -170,7 +188,7 @@ static avs_error_t zlib_stream_read(avs_stream_t *stream_,
                                     bool *out_message_finished,
                                     void *buffer,
                                     size_t buffer_length) {
-    zlib_stream_t *stream = (zlib_stream_t *) stream_;
+    http_zlib_state_t *stream = GET_STATE(stream_);
     size_t ready_bytes =
             AVS_MIN(buffer_length,
                     stream->output_buffer_size - stream->zlib.avail_out);
@@ -216,7 +234,7 @@ static avs_error_t zlib_stream_read(avs_stream_t *stream_,
 }
 
 static bool zlib_stream_nonblock_read_ready(avs_stream_t *stream_) {
-    zlib_stream_t *stream = (zlib_stream_t *) stream_;
+    http_zlib_state_t *stream = GET_STATE(stream_);
     if (stream->zlib.avail_out < stream->output_buffer_size) {
         return true;
     }
@@ -228,7 +246,7 @@ static bool zlib_stream_nonblock_read_ready(avs_stream_t *stream_) {
 
 static avs_error_t
 zlib_stream_peek(avs_stream_t *stream_, size_t offset, char *out_value) {
-    zlib_stream_t *stream = (zlib_stream_t *) stream_;
+    http_zlib_state_t *stream = GET_STATE(stream_);
     if (offset > stream->output_buffer_size) {
         LOG(ERROR, _("cannot peek - buffer is too small"));
         return avs_errno(AVS_ENOBUFS);
@@ -247,7 +265,7 @@ zlib_stream_peek(avs_stream_t *stream_, size_t offset, char *out_value) {
     }
 }
 
-static void reset_fields(zlib_stream_t *stream) {
+static void reset_fields(http_zlib_state_t *stream) {
     stream->zlib.avail_in = 0;
     stream->zlib.avail_out = (unsigned int) stream->output_buffer_size;
     stream->zlib.next_in = GET_INPUT_BUFFER(stream);
@@ -266,41 +284,116 @@ static void zlib_stream_free(void *opaque, void *ptr) {
     avs_free(ptr);
 }
 
-static zlib_stream_t *zlib_stream_init(const avs_stream_v_table_t *vtable,
-                                       size_t input_buffer_size,
-                                       size_t output_buffer_size) {
+static AVS_LIST(http_zlib_state_t) state_new(size_t input_buffer_size,
+                                             size_t output_buffer_size) {
     if (input_buffer_size <= 0 || output_buffer_size <= 0) {
         LOG(ERROR, _("buffers cannot be zero-length"));
         return NULL;
     }
-    zlib_stream_t *stream = (zlib_stream_t *) avs_calloc(
-            1, sizeof(zlib_stream_t) + input_buffer_size + output_buffer_size);
+    AVS_LIST(http_zlib_state_t) state =
+            (AVS_LIST(http_zlib_state_t)) AVS_LIST_NEW_BUFFER(
+                    sizeof(http_zlib_state_t) + input_buffer_size
+                    + output_buffer_size);
+    if (!state) {
+        LOG(ERROR, _("cannot allocate memory"));
+        return NULL;
+    }
+    state->input_buffer_size = input_buffer_size;
+    state->output_buffer_size = output_buffer_size;
+    state->zlib.zalloc = zlib_stream_alloc;
+    state->zlib.zfree = zlib_stream_free;
+    return state;
+}
+
+static int state_end(http_zlib_state_t *state) {
+    return state->compressor ? deflateEnd(&state->zlib)
+                             : inflateEnd(&state->zlib);
+}
+
+static void state_delete(AVS_LIST(http_zlib_state_t) *state_ptr) {
+    state_end(*state_ptr);
+    AVS_LIST_DELETE(state_ptr);
+}
+
+static bool state_matches(const http_zlib_state_t *state,
+                          const http_zlib_state_t *params) {
+    return state->compressor == params->compressor
+           && state->format == params->format && state->level == params->level
+           && state->window_bits == params->window_bits
+           && state->mem_level == params->mem_level
+           && state->input_buffer_size == params->input_buffer_size
+           && state->output_buffer_size == params->output_buffer_size;
+}
+
+static AVS_LIST(http_zlib_state_t)
+take_pooled_state(http_compression_pool_t *pool,
+                  const http_zlib_state_t *params) {
+    if (!pool) {
+        return NULL;
+    }
+    AVS_LIST(http_zlib_state_t) *state_ptr;
+    AVS_LIST_FOREACH_PTR(state_ptr, &pool->idle_states) {
+        if (state_matches(*state_ptr, params)) {
+            return AVS_LIST_DETACH(state_ptr);
+        }
+    }
+    return NULL;
+}
+
+void _avs_http_compression_pool_trim(http_compression_pool_t *pool) {
+    AVS_LIST(http_zlib_state_t) *state_ptr =
+            AVS_LIST_NTH_PTR(&pool->idle_states, pool->max_idle_states);
+    while (state_ptr && *state_ptr) {
+        state_delete(state_ptr);
+    }
+}
+
+static zlib_stream_t *zlib_stream_new(const avs_stream_v_table_t *vtable,
+                                      http_compression_pool_t *pool,
+                                      AVS_LIST(http_zlib_state_t) state) {
+    zlib_stream_t *stream = (zlib_stream_t *) avs_calloc(1, sizeof(*stream));
     if (!stream) {
         LOG(ERROR, _("cannot allocate memory"));
         return NULL;
     }
     *(const avs_stream_v_table_t **) (intptr_t) &stream->vtable = vtable;
-    stream->input_buffer_size = input_buffer_size;
-    stream->output_buffer_size = output_buffer_size;
-    stream->zlib.zalloc = zlib_stream_alloc;
-    stream->zlib.zfree = zlib_stream_free;
+    stream->pool = pool;
+    stream->state = state;
+    reset_fields(state);
     return stream;
 }
 
-static avs_error_t compressor_reset(avs_stream_t *stream_) {
+/**
+ * Returns the state of a closed stream to its pool, if the state can be reset
+ * and there is a pool to return it to. Otherwise, the state is released.
+ */
+static avs_error_t zlib_stream_close(avs_stream_t *stream_) {
     zlib_stream_t *stream = (zlib_stream_t *) stream_;
-    reset_fields(stream);
-    stream->error = deflateReset(&stream->zlib);
-    if (stream->error != Z_OK) {
-        return map_zlib_error(stream->error);
+    http_compression_pool_t *pool = stream->pool;
+    http_zlib_state_t *state = stream->state;
+    if (pool && pool->max_idle_states > 0
+            && (state->compressor ? deflateReset(&state->zlib)
+                                  : inflateReset(&state->zlib))
+                           == Z_OK) {
+        AVS_LIST_INSERT(&pool->idle_states, stream->state);
+        stream->state = NULL;
+        _avs_http_compression_pool_trim(pool);
+        return AVS_OK;
+    }
+    int err = state_end(state);
+    AVS_LIST_DELETE(&stream->state);
+    if (err != Z_OK) {
+        return map_zlib_error(err);
     }
     return AVS_OK;
 }
 
-static avs_error_t compressor_close(avs_stream_t *stream) {
-    int err = deflateEnd(&((zlib_stream_t *) stream)->zlib);
-    if (err != Z_OK) {
-        return map_zlib_error(err);
+static avs_error_t compressor_reset(avs_stream_t *stream_) {
+    http_zlib_state_t *stream = GET_STATE(stream_);
+    reset_fields(stream);
+    stream->error = deflateReset(&stream->zlib);
+    if (stream->error != Z_OK) {
+        return map_zlib_error(stream->error);
     }
     return AVS_OK;
 }
@@ -315,40 +408,57 @@ static const avs_stream_v_table_extension_t zlib_vtable_extensions[] = {
 
 static const avs_stream_v_table_t compressor_vtable = {
     zlib_stream_write_some, zlib_stream_finish_message, zlib_stream_read,
-    zlib_stream_peek,       compressor_reset,           compressor_close,
+    zlib_stream_peek,       compressor_reset,           zlib_stream_close,
     zlib_vtable_extensions
 };
 
-avs_stream_t *_avs_http_create_compressor(http_compression_format_t format,
+avs_stream_t *_avs_http_create_compressor(http_compression_pool_t *pool,
+                                          http_compression_format_t format,
                                           int level,
                                           int window_bits,
                                           int mem_level,
                                           size_t input_buffer_size,
                                           size_t output_buffer_size) {
-    int result;
-    zlib_stream_t *stream =
-            zlib_stream_init(&compressor_vtable, input_buffer_size,
-                             output_buffer_size);
-    if (!stream) {
-        return NULL;
+    const http_zlib_state_t params = {
+        .compressor = true,
+        .format = format,
+        .level = level,
+        .window_bits = window_bits,
+        .mem_level = mem_level,
+        .input_buffer_size = input_buffer_size,
+        .output_buffer_size = output_buffer_size
+    };
+    AVS_LIST(http_zlib_state_t) state = take_pooled_state(pool, &params);
+    if (!state) {
+        if (!(state = state_new(input_buffer_size, output_buffer_size))) {
+            return NULL;
+        }
+        state->compressor = true;
+        state->format = format;
+        state->level = level;
+        state->window_bits = window_bits;
+        state->mem_level = mem_level;
+        state->zlib.opaque = &compressor_flush_holder;
+        int result = deflateInit2(
+                &state->zlib, level, Z_DEFLATED,
+                window_bits + (format == HTTP_COMPRESSION_GZIP ? 16 : 0),
+                mem_level, Z_DEFAULT_STRATEGY);
+        if (result != Z_OK) {
+            LOG(ERROR, _("could not initialize zlib (") "%d" _("): ") "%s",
+                result, get_zlib_msg(state));
+            AVS_LIST_DELETE(&state);
+            return NULL;
+        }
     }
-    stream->zlib.opaque = &compressor_flush_holder;
-    result = deflateInit2(&stream->zlib, level, Z_DEFLATED,
-                          window_bits
-                                  + (format == HTTP_COMPRESSION_GZIP ? 16 : 0),
-                          mem_level, Z_DEFAULT_STRATEGY);
-    if (result != Z_OK) {
-        LOG(ERROR, _("could not initialize zlib (") "%d" _("): ") "%s", result,
-            get_zlib_msg(stream));
-        avs_free(stream);
-        return NULL;
+    zlib_stream_t *stream = zlib_stream_new(&compressor_vtable, pool, state);
+    if (!stream) {
+        state_delete(&state);
     }
-    reset_fields(stream);
     return (avs_stream_t *) stream;
 }
 
 static avs_error_t decompressor_reset(avs_stream_t *stream_) {
-    zlib_stream_t *stream = (zlib_stream_t *) stream_;
+    http_zlib_state_t *stream = GET_STATE(stream_);
     reset_fields(stream);
     stream->error = inflateReset(&stream->zlib);
     if (stream->error != Z_OK) {
@@ -357,44 +467,52 @@ static avs_error_t decompressor_reset(avs_stream_t *stream_) {
     return AVS_OK;
 }
 
-static avs_error_t decompressor_close(avs_stream_t *stream) {
-    int err = inflateEnd(&((zlib_stream_t *) stream)->zlib);
-    if (err != Z_OK) {
-        return map_zlib_error(err);
-    }
-    return AVS_OK;
-}
-
 static const avs_stream_v_table_t decompressor_vtable = {
     zlib_stream_write_some, zlib_stream_finish_message, zlib_stream_read,
-    zlib_stream_peek,       decompressor_reset,         decompressor_close,
+    zlib_stream_peek,       decompressor_reset,         zlib_stream_close,
     zlib_vtable_extensions
 };
 
-avs_stream_t *_avs_http_create_decompressor(http_compression_format_t format,
+avs_stream_t *_avs_http_create_decompressor(http_compression_pool_t *pool,
+                                            http_compression_format_t format,
                                             int window_bits,
                                             size_t input_buffer_size,
                                             size_t output_buffer_size) {
-    int result;
-    zlib_stream_t *stream =
-            zlib_stream_init(&decompressor_vtable, input_buffer_size,
-                             output_buffer_size);
-    if (!stream) {
-        return NULL;
+    const http_zlib_state_t params = {
+        .compressor = false,
+        .format = format,
+        .window_bits = window_bits,
+        .input_buffer_size = input_buffer_size,
+        .output_buffer_size = output_buffer_size
+    };
+    AVS_LIST(http_zlib_state_t) state = take_pooled_state(pool, &params);
+    if (!state) {
+        if (!(state = state_new(input_buffer_size, output_buffer_size))) {
+            return NULL;
+        }
+        state->format = format;
+        state->window_bits = window_bits;
+        state->zlib.opaque = &decompressor_flush_holder;
+        int result = inflateInit2(
+                &state->zlib,
+                window_bits + (format == HTTP_COMPRESSION_GZIP ? 16 : 0));
+        if (result != Z_OK) {
+            LOG(ERROR, _("could not initialize zlib (") "%d" _("): ") "%s",
+                result, get_zlib_msg(state));
+            AVS_LIST_DELETE(&state);
+            return NULL;
+        }
     }
-    stream->zlib.opaque = &decompressor_flush_holder;
-    result = inflateInit2(&stream->zlib,
-                          window_bits
-                                  + (format == HTTP_COMPRESSION_GZIP ? 16 : 0));
-    if (result != Z_OK) {
-        LOG(ERROR, _("could not initialize zlib (") "%d" _("): ") "%s", result,
-            get_zlib_msg(stream));
-        avs_free(stream);
-        return NULL;
+    zlib_stream_t *stream = zlib_stream_new(&decompressor_vtable, pool, state);
+    if (!stream) {
+        state_delete(&state);
     }
-    reset_fields(stream);
     return (avs_stream_t *) stream;
 }
 
+#    ifdef AVS_UNIT_TESTING
+#        include "tests/http/test_compression.c"
+#    endif
+
 #endif // defined(AVS_COMMONS_WITH_AVS_HTTP) &&
        // defined(AVS_COMMONS_HTTP_WITH_ZLIB)
@@ -17,6 +17,7 @@
 #ifndef AVS_COMMONS_HTTP_COMPRESSION_H
 #define AVS_COMMONS_HTTP_COMPRESSION_H
 
+#include <avsystem/commons/avs_list.h>
 #include <avsystem/commons/avs_stream.h>
 
 VISIBILITY_PRIVATE_HEADER_BEGIN
@@ -43,8 +44,31 @@ typedef enum {
 #define HTTP_DECOMPRESSOR_WINDOW_BITS_DEFAULT \
     HTTP_COMPRESSOR_WINDOW_BITS_DEFAULT
 
+typedef struct http_zlib_state_struct http_zlib_state_t;
+
+/**
+ * Pool of zlib states, together with their input and output buffers, that are
+ * not used by any stream at the moment.
+ *
+ * Compressor and decompressor streams borrow a state created with the same
+ * parameters from the pool instead of initializing a new one, and return it
+ * there when closed, so that short messages do not pay for initializing zlib
+ * and allocating buffers each time.
+ */
+typedef struct {
+    /* most recently returned first */
+    AVS_LIST(http_zlib_state_t) idle_states;
+    size_t max_idle_states;
+} http_compression_pool_t;
+
 #ifdef AVS_COMMONS_HTTP_WITH_ZLIB
 
+/**
+ * Releases the idle states in @p pool above its <c>max_idle_states</c> limit,
+ * the least recently used first.
+ */
+void _avs_http_compression_pool_trim(http_compression_pool_t *pool);
+
 /**
  * Creates a zlib-based compressor stream.
  *
@@ -84,8 +108,12 @@ typedef enum {
  *
  * - <c>avs_stream_reset</c> - clears the buffers and the state of the
  *   compression algorithm, allowing to compress a new stream.
+ *
+ * If @p pool is not NULL, the zlib state is borrowed from it if possible, and
+ * returned to it when the stream is closed.
  */
-avs_stream_t *_avs_http_create_compressor(http_compression_format_t format,
+avs_stream_t *_avs_http_create_compressor(http_compression_pool_t *pool,
+                                          http_compression_format_t format,
                                           int level,
                                           int window_bits,
                                           int mem_level,
@@ -103,14 +131,18 @@ avs_stream_t *_avs_http_create_compressor(http_compression_format_t format,
  * @ref _avs_http_create_compressor, but with the "compressed" and
  * "uncompressed" kinds of data reversed.
  */
-avs_stream_t *_avs_http_create_decompressor(http_compression_format_t format,
+avs_stream_t *_avs_http_create_decompressor(http_compression_pool_t *pool,
+                                            http_compression_format_t format,
                                             int window_bits,
                                             size_t input_buffer_size,
                                             size_t output_buffer_size);
 
 #else
 
-#    define _avs_http_create_compressor(format,             \
+#    define _avs_http_compression_pool_trim(pool) ((void) (pool))
+
+#    define _avs_http_create_compressor(pool,               \
+                                        format,             \
                                         level,              \
                                         window_bits,        \
                                         mem_level,          \
@@ -118,8 +150,9 @@ avs_stream_t *_avs_http_create_decompressor(http_compression_format_t format,
                                         output_buffer_size) \
         (NULL)
 
-#    define _avs_http_create_decompressor(                              \
-            format, window_bits, input_buffer_size, output_buffer_size) \
+#    define _avs_http_create_decompressor(pool, format, window_bits, \
+                                          input_buffer_size,         \
+                                          output_buffer_size)        \
         (NULL)
 
 #endif
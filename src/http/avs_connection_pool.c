@@ -0,0 +1,158 @@
+/*
+ * Copyright 2023 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <avs_commons_init.h>
+
+#ifdef AVS_COMMONS_WITH_AVS_HTTP
+
+#    include <stddef.h>
+#    include <string.h>
+
+#    include <avsystem/commons/avs_utils.h>
+
+#    include "avs_client.h"
+#    include "avs_http_stream.h"
+
+#    include "avs_http_log.h"
+
+VISIBILITY_SOURCE_BEGIN
+
+static void
+close_pooled_connection(AVS_LIST(http_pooled_connection_t) *entry_ptr) {
+    LOG(TRACE, _("closing pooled connection to ") "%s" _(":") "%s",
+        (*entry_ptr)->host, (*entry_ptr)->port);
+    avs_net_socket_shutdown((*entry_ptr)->socket);
+    avs_net_socket_cleanup(&(*entry_ptr)->socket);
+    AVS_LIST_DELETE(entry_ptr);
+}
+
+static bool connection_matches(const http_pooled_connection_t *entry,
+                               const avs_url_t *url) {
+    return avs_strcasecmp(entry->protocol, avs_url_protocol(url)) == 0
+           && avs_strcasecmp(entry->host, avs_url_host(url)) == 0
+           && strcmp(entry->port, _avs_http_resolve_port(url)) == 0;
+}
+
+static void close_expired_connections(avs_http_t *http) {
+    if (!avs_time_duration_valid(http->pool_idle_timeout)) {
+        return;
+    }
+    avs_time_monotonic_t now = avs_time_monotonic_now();
+    AVS_LIST(http_pooled_connection_t) *entry_ptr;
+    AVS_LIST(http_pooled_connection_t) helper;
+    AVS_LIST_DELETABLE_FOREACH_PTR(entry_ptr, helper, &http->connection_pool) {
+        if (avs_time_duration_less(
+                    http->pool_idle_timeout,
+                    avs_time_monotonic_diff(now, (*entry_ptr)->idle_since))) {
+            close_pooled_connection(entry_ptr);
+        }
+    }
+}
+
+void avs_http_clear_connection_pool(avs_http_t *http) {
+    while (http->connection_pool) {
+        close_pooled_connection(&http->connection_pool);
+    }
+}
+
+void avs_http_set_connection_pool(avs_http_t *http,
+                                  size_t max_idle_per_host,
+                                  avs_time_duration_t idle_timeout) {
+    http->pool_max_idle_per_host = max_idle_per_host;
+    http->pool_idle_timeout = idle_timeout;
+    if (!max_idle_per_host) {
+        avs_http_clear_connection_pool(http);
+    } else {
+        close_expired_connections(http);
+    }
+}
+
+avs_net_socket_t *_avs_http_pool_checkout(avs_http_t *http,
+                                          const avs_url_t *url) {
+    close_expired_connections(http);
+    AVS_LIST(http_pooled_connection_t) *entry_ptr;
+    AVS_LIST_FOREACH_PTR(entry_ptr, &http->connection_pool) {
+        if (connection_matches(*entry_ptr, url)) {
+            avs_net_socket_t *socket = (*entry_ptr)->socket;
+            LOG(DEBUG, _("reusing pooled connection to ") "%s" _(":") "%s",
+                (*entry_ptr)->host, (*entry_ptr)->port);
+            AVS_LIST_DELETE(entry_ptr);
+            return socket;
+        }
+    }
+    return NULL;
+}
+
+static AVS_LIST(http_pooled_connection_t)
+new_pooled_connection(const avs_url_t *url) {
+    const char *protocol = avs_url_protocol(url);
+    const char *host = avs_url_host(url);
+    const char *port = _avs_http_resolve_port(url);
+    size_t protocol_size = strlen(protocol) + 1;
+    size_t host_size = strlen(host) + 1;
+    AVS_LIST(http_pooled_connection_t) entry =
+            (AVS_LIST(http_pooled_connection_t)) AVS_LIST_NEW_BUFFER(
+                    offsetof(http_pooled_connection_t, protocol)
+                    + protocol_size + host_size + strlen(port) + 1);
+    if (entry) {
+        char *ptr = entry->protocol;
+        memcpy(ptr, protocol, protocol_size);
+        entry->host = (ptr += protocol_size);
+        memcpy(ptr, host, host_size);
+        entry->port = (ptr += host_size);
+        strcpy(ptr, port);
+    }
+    return entry;
+}
+
+void _avs_http_pool_checkin(avs_http_t *http,
+                            const avs_url_t *url,
+                            avs_net_socket_t **socket_ptr) {
+    AVS_LIST(http_pooled_connection_t) entry = NULL;
+    if (!*socket_ptr) {
+        return;
+    }
+    if (http->pool_max_idle_per_host
+            && (entry = new_pooled_connection(url))) {
+        close_expired_connections(http);
+        size_t count = 0;
+        AVS_LIST(http_pooled_connection_t) *entry_ptr;
+        AVS_LIST(http_pooled_connection_t) helper;
+        AVS_LIST_DELETABLE_FOREACH_PTR(entry_ptr, helper,
+                                       &http->connection_pool) {
+            // the list is ordered from the most recently released
+            if (connection_matches(*entry_ptr, url)
+                    && ++count >= http->pool_max_idle_per_host) {
+                close_pooled_connection(entry_ptr);
+            }
+        }
+        LOG(TRACE, _("keeping connection to ") "%s" _(":") "%s",
+            entry->host, entry->port);
+        entry->socket = *socket_ptr;
+        entry->idle_since = avs_time_monotonic_now();
+        AVS_LIST_INSERT(&http->connection_pool, entry);
+        *socket_ptr = NULL;
+    } else {
+        avs_net_socket_shutdown(*socket_ptr);
+        avs_net_socket_cleanup(socket_ptr);
+    }
+}
+
+#    ifdef AVS_UNIT_TESTING
+#        include "tests/http/test_connection_pool.c"
+#    endif
+
+#endif // AVS_COMMONS_WITH_AVS_HTTP
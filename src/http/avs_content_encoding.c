@@ -21,9 +21,11 @@
 #    include <avsystem/commons/avs_memory.h>
 #    include <avsystem/commons/avs_stream_v_table.h>
 
+#    include "avs_body_receivers.h"
 #    include "avs_client.h"
 #    include "avs_compression.h"
 #    include "avs_content_encoding.h"
+#    include "avs_decompressor.h"
 
 #    include "avs_http_log.h"
 
@@ -84,6 +86,30 @@ static avs_error_t decode_more_data(decoding_stream_t *stream,
     }
 }
 
+/*
+ * The end of the compressed data may be reached before the backend has consumed
+ * the end of the body, e.g. the final zero-length chunk of a chunked body. Read
+ * the rest of it, so that the connection is left at the start of whatever comes
+ * after the body.
+ */
+static avs_error_t finish_backend(decoding_stream_t *stream) {
+    bool finished = _avs_http_body_receiver_finished(stream->backend);
+    while (!finished) {
+        size_t bytes_read;
+        char trailing_byte;
+        avs_error_t err = avs_stream_read(stream->backend, &bytes_read,
+                                          &finished, &trailing_byte, 1);
+        if (avs_is_err(err)) {
+            return err;
+        }
+        if (bytes_read) {
+            LOG(ERROR, _("unexpected data after the end of compressed data"));
+            return avs_errno(AVS_EIO);
+        }
+    }
+    return AVS_OK;
+}
+
 static avs_error_t decoding_read(avs_stream_t *stream_,
                                  size_t *out_bytes_read,
                                  bool *out_message_finished,
@@ -106,7 +132,9 @@ static avs_error_t decoding_read(avs_stream_t *stream_,
                                 out_message_finished, buffer, buffer_length);
         if (avs_is_err(err)) {
             return err;
-        } else if (*out_bytes_read > 0 || *out_message_finished) {
+        } else if (*out_message_finished) {
+            return finish_backend(stream);
+        } else if (*out_bytes_read > 0) {
             return AVS_OK;
         }
         // no_more_data signifies that the underlying stream with *encoded*
@@ -164,6 +192,16 @@ decoding_peek(avs_stream_t *stream_, size_t offset, char *out_value) {
     return err;
 }
 
+static bool decoding_finished(avs_stream_t *stream_) {
+    decoding_stream_t *stream = (decoding_stream_t *) stream_;
+    // the decoder is an in-memory stream, so reading from it performs no I/O;
+    // it only reports the end of data after the whole body has been decoded,
+    // which may still be before the end of the body in the backend
+    bool finished = false;
+    return avs_is_ok(avs_stream_read(stream->decoder, NULL, &finished, NULL, 0))
+           && finished && _avs_http_body_receiver_finished(stream->backend);
+}
+
 static avs_error_t decoding_close(avs_stream_t *stream_) {
     decoding_stream_t *stream = (decoding_stream_t *) stream_;
     avs_error_t decoder_err, backend_err;
@@ -188,6 +226,13 @@ static const avs_stream_v_table_t decoding_vtable = {
                               .read_ready = decoding_nonblock_read_ready
                           }
                       }[0] },
+            { HTTP_BODY_RECEIVER_V_TABLE_EXTENSION,
+              &(http_body_receiver_v_table_extension_t[])
+                      {
+                          {
+                              .finished = decoding_finished
+                          }
+                      }[0] },
             AVS_STREAM_V_TABLE_EXTENSION_NULL }[0]
 };
 
@@ -210,6 +255,7 @@ _avs_http_decoding_stream_create(avs_stream_t *backend,
 
 int _avs_http_content_decoder_create(
         avs_stream_t **out_decoder,
+        http_compression_pool_t *pool,
         avs_http_content_encoding_t content_encoding,
         const avs_http_buffer_sizes_t *buffer_sizes) {
     (void) buffer_sizes;
@@ -220,7 +266,8 @@ int _avs_http_content_decoder_create(
 
     case AVS_HTTP_CONTENT_GZIP:
         *out_decoder = _avs_http_create_decompressor(
-                HTTP_COMPRESSION_GZIP, HTTP_DECOMPRESSOR_WINDOW_BITS_DEFAULT,
+                pool, HTTP_COMPRESSION_GZIP,
+                HTTP_DECOMPRESSOR_WINDOW_BITS_DEFAULT,
                 buffer_sizes->content_coding_input,
                 HTTP_CONTENT_CODING_OUT_BUF_SIZE(buffer_sizes));
         return *out_decoder ? 0 : -1;
@@ -231,10 +278,35 @@ int _avs_http_content_decoder_create(
 
     case AVS_HTTP_CONTENT_DEFLATE:
         *out_decoder = _avs_http_create_decompressor(
-                HTTP_COMPRESSION_ZLIB, HTTP_DECOMPRESSOR_WINDOW_BITS_DEFAULT,
+                pool, HTTP_COMPRESSION_ZLIB,
+                HTTP_DECOMPRESSOR_WINDOW_BITS_DEFAULT,
+                buffer_sizes->content_coding_input,
+                HTTP_CONTENT_CODING_OUT_BUF_SIZE(buffer_sizes));
+        return *out_decoder ? 0 : -1;
+
+    case AVS_HTTP_CONTENT_BROTLI:
+#    ifdef AVS_COMMONS_HTTP_WITH_BROTLI
+        *out_decoder = _avs_http_decompressor_stream_create(
+                &_AVS_HTTP_BROTLI_DECOMPRESSOR,
+                buffer_sizes->content_coding_input,
+                HTTP_CONTENT_CODING_OUT_BUF_SIZE(buffer_sizes));
+        return *out_decoder ? 0 : -1;
+#    else  // AVS_COMMONS_HTTP_WITH_BROTLI
+        LOG(ERROR, _("'br' content encoding is not supported"));
+        return -1;
+#    endif // AVS_COMMONS_HTTP_WITH_BROTLI
+
+    case AVS_HTTP_CONTENT_ZSTD:
+#    ifdef AVS_COMMONS_HTTP_WITH_ZSTD
+        *out_decoder = _avs_http_decompressor_stream_create(
+                &_AVS_HTTP_ZSTD_DECOMPRESSOR,
                 buffer_sizes->content_coding_input,
                 HTTP_CONTENT_CODING_OUT_BUF_SIZE(buffer_sizes));
         return *out_decoder ? 0 : -1;
+#    else  // AVS_COMMONS_HTTP_WITH_ZSTD
+        LOG(ERROR, _("'zstd' content encoding is not supported"));
+        return -1;
+#    endif // AVS_COMMONS_HTTP_WITH_ZSTD
 
     default:
         LOG(ERROR, _("Unknown content encoding"));
@@ -247,7 +319,13 @@ int _avs_http_encoding_init(http_stream_t *stream) {
         /* no encoding */
         return 0;
     }
+    if (stream->encoding != AVS_HTTP_CONTENT_GZIP
+            && stream->encoding != AVS_HTTP_CONTENT_DEFLATE) {
+        LOG(ERROR, _("Unsupported content encoding for requests"));
+        return -1;
+    }
     stream->encoder = _avs_http_create_compressor(
+            &stream->http->compression_pool,
             stream->encoding == AVS_HTTP_CONTENT_GZIP ? HTTP_COMPRESSION_GZIP
                                                       : HTTP_COMPRESSION_ZLIB,
             HTTP_COMPRESSOR_LEVEL_DEFAULT, HTTP_COMPRESSOR_WINDOW_BITS_DEFAULT,
@@ -17,10 +17,41 @@
 #ifndef AVS_COMMONS_HTTP_CONTENT_ENCODING_H
 #define AVS_COMMONS_HTTP_CONTENT_ENCODING_H
 
+#include "avs_compression.h"
 #include "avs_http_stream.h"
 
 VISIBILITY_PRIVATE_HEADER_BEGIN
 
+/*
+ * HTTP_ACCEPT_ENCODING is the value of the Accept-Encoding header sent with
+ * requests: the list of supported content codings, the one that compresses
+ * best first. It is not defined if no content coding is supported.
+ */
+#ifdef AVS_COMMONS_HTTP_WITH_ZLIB
+#    define HTTP_ACCEPT_ENCODING_FROM_ZLIB "gzip, deflate"
+#endif
+
+#ifdef AVS_COMMONS_HTTP_WITH_BROTLI
+#    ifdef HTTP_ACCEPT_ENCODING_FROM_ZLIB
+#        define HTTP_ACCEPT_ENCODING_FROM_BROTLI \
+            "br, " HTTP_ACCEPT_ENCODING_FROM_ZLIB
+#    else
+#        define HTTP_ACCEPT_ENCODING_FROM_BROTLI "br"
+#    endif
+#elif defined(HTTP_ACCEPT_ENCODING_FROM_ZLIB)
+#    define HTTP_ACCEPT_ENCODING_FROM_BROTLI HTTP_ACCEPT_ENCODING_FROM_ZLIB
+#endif
+
+#ifdef AVS_COMMONS_HTTP_WITH_ZSTD
+#    ifdef HTTP_ACCEPT_ENCODING_FROM_BROTLI
+#        define HTTP_ACCEPT_ENCODING "zstd, " HTTP_ACCEPT_ENCODING_FROM_BROTLI
+#    else
+#        define HTTP_ACCEPT_ENCODING "zstd"
+#    endif
+#elif defined(HTTP_ACCEPT_ENCODING_FROM_BROTLI)
+#    define HTTP_ACCEPT_ENCODING HTTP_ACCEPT_ENCODING_FROM_BROTLI
+#endif
+
 /**
  * Creates a decorator stream that wraps a backend stream and transparently does
  * decoding, using a stream with semantics as described for
@@ -50,11 +81,13 @@ _avs_http_decoding_stream_create(avs_stream_t *backend,
                                  const avs_http_buffer_sizes_t *buffer_sizes);
 
 /**
- * Calls @ref _avs_http_create_decompressor to create a decompressor stream
+ * Calls @ref _avs_http_create_decompressor or
+ * @ref _avs_http_decompressor_stream_create to create a decompressor stream
  * appropriate for the specified <c>content_encoding</c>.
  */
 int _avs_http_content_decoder_create(
         avs_stream_t **out_decoder,
+        http_compression_pool_t *pool,
         avs_http_content_encoding_t content_encoding,
         const avs_http_buffer_sizes_t *buffer_sizes);
 
@@ -0,0 +1,268 @@
+/*
+ * Copyright 2023 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <avs_commons_init.h>
+
+#ifdef AVS_COMMONS_WITH_AVS_HTTP
+
+#    include <string.h>
+
+#    include <avsystem/commons/avs_errno.h>
+#    include <avsystem/commons/avs_memory.h>
+#    include <avsystem/commons/avs_stream_v_table.h>
+#    include <avsystem/commons/avs_utils.h>
+
+#    include "avs_decompressor.h"
+
+#    include "avs_http_log.h"
+
+VISIBILITY_SOURCE_BEGIN
+
+#    define GET_INPUT_BUFFER(stream) ((stream)->data)
+#    define GET_OUTPUT_BUFFER(stream) \
+        ((stream)->data + (stream)->input_buffer_size)
+
+typedef struct {
+    const avs_stream_v_table_t *const vtable;
+    const http_decompressor_ops_t *ops;
+    void *state;
+    http_decompressor_result_t result;
+    /* avs_stream_finish_message() has been called */
+    bool finishing;
+    /* number of bytes waiting in the input buffer */
+    size_t input_size;
+    size_t input_buffer_size;
+    /* number of decompressed bytes waiting in the output buffer */
+    size_t output_size;
+    size_t output_buffer_size;
+    uint8_t data[];
+} decompressor_stream_t;
+
+/**
+ * Decompresses the data waiting in the input buffer into @p out , which has
+ * room for @p out_size bytes.
+ */
+static avs_error_t decompress(decompressor_stream_t *stream,
+                              uint8_t *out,
+                              size_t out_size,
+                              size_t *out_produced) {
+    *out_produced = 0;
+    if (stream->result == HTTP_DECOMPRESSOR_ERROR) {
+        return avs_errno(AVS_EIO);
+    }
+    if (stream->result == HTTP_DECOMPRESSOR_FINISHED) {
+        return AVS_OK;
+    }
+    const uint8_t *next_in = GET_INPUT_BUFFER(stream);
+    size_t avail_in = stream->input_size;
+    size_t avail_out = out_size;
+    stream->result = stream->ops->decompress(stream->state, &next_in,
+                                             &avail_in, &out, &avail_out);
+    if (stream->result == HTTP_DECOMPRESSOR_ERROR) {
+        return avs_errno(AVS_EIO);
+    }
+    memmove(GET_INPUT_BUFFER(stream), next_in, avail_in);
+    stream->input_size = avail_in;
+    *out_produced = out_size - avail_out;
+    if (stream->finishing && stream->result == HTTP_DECOMPRESSOR_NEED_INPUT) {
+        LOG(ERROR, _("Compressed data is truncated"));
+        stream->result = HTTP_DECOMPRESSOR_ERROR;
+        return avs_errno(AVS_EIO);
+    }
+    return AVS_OK;
+}
+
+static avs_error_t decompress_to_buffer(decompressor_stream_t *stream) {
+    size_t produced;
+    avs_error_t err =
+            decompress(stream, GET_OUTPUT_BUFFER(stream) + stream->output_size,
+                       stream->output_buffer_size - stream->output_size,
+                       &produced);
+    stream->output_size += produced;
+    return err;
+}
+
+static avs_error_t decompressor_write_some(avs_stream_t *stream_,
+                                           const void *data,
+                                           size_t *inout_data_length) {
+    decompressor_stream_t *stream = (decompressor_stream_t *) stream_;
+    if (stream->finishing || stream->result == HTTP_DECOMPRESSOR_FINISHED) {
+        LOG(ERROR, _("Stream finished"));
+        return avs_errno(AVS_EBADF);
+    }
+    if (*inout_data_length > stream->input_buffer_size - stream->input_size) {
+        avs_error_t err = decompress_to_buffer(stream);
+        if (avs_is_err(err)) {
+            return err;
+        }
+    }
+    *inout_data_length =
+            AVS_MIN(*inout_data_length,
+                    stream->input_buffer_size - stream->input_size);
+    memcpy(GET_INPUT_BUFFER(stream) + stream->input_size, data,
+           *inout_data_length);
+    stream->input_size += *inout_data_length;
+    return decompress_to_buffer(stream);
+}
+
+static size_t decompressor_nonblock_write_ready(avs_stream_t *stream_) {
+    decompressor_stream_t *stream = (decompressor_stream_t *) stream_;
+    if (stream->input_size > 0
+            && avs_is_err(decompress_to_buffer(stream))) {
+        return 0;
+    }
+    return stream->input_buffer_size - stream->input_size;
+}
+
+static avs_error_t decompressor_finish_message(avs_stream_t *stream_) {
+    decompressor_stream_t *stream = (decompressor_stream_t *) stream_;
+    stream->finishing = true;
+    return decompress_to_buffer(stream);
+}
+
+static avs_error_t decompressor_read(avs_stream_t *stream_,
+                                     size_t *out_bytes_read,
+                                     bool *out_message_finished,
+                                     void *buffer,
+                                     size_t buffer_length) {
+    decompressor_stream_t *stream = (decompressor_stream_t *) stream_;
+    size_t bytes_read = AVS_MIN(buffer_length, stream->output_size);
+    if (bytes_read) {
+        memcpy(buffer, GET_OUTPUT_BUFFER(stream), bytes_read);
+        stream->output_size -= bytes_read;
+        memmove(GET_OUTPUT_BUFFER(stream),
+                GET_OUTPUT_BUFFER(stream) + bytes_read, stream->output_size);
+    }
+    if (bytes_read < buffer_length) {
+        /* the output buffer is empty now, decompress directly to the user's
+         * buffer */
+        size_t produced;
+        avs_error_t err = decompress(stream, (uint8_t *) buffer + bytes_read,
+                                     buffer_length - bytes_read, &produced);
+        if (avs_is_err(err)) {
+            return err;
+        }
+        bytes_read += produced;
+    }
+    if (out_bytes_read) {
+        *out_bytes_read = bytes_read;
+    }
+    if (out_message_finished) {
+        *out_message_finished = stream->result == HTTP_DECOMPRESSOR_FINISHED
+                                && !stream->output_size;
+    }
+    return AVS_OK;
+}
+
+static bool decompressor_nonblock_read_ready(avs_stream_t *stream_) {
+    decompressor_stream_t *stream = (decompressor_stream_t *) stream_;
+    if (!stream->output_size && avs_is_err(decompress_to_buffer(stream))) {
+        return false;
+    }
+    return stream->output_size > 0;
+}
+
+static avs_error_t
+decompressor_peek(avs_stream_t *stream_, size_t offset, char *out_value) {
+    decompressor_stream_t *stream = (decompressor_stream_t *) stream_;
+    if (offset >= stream->output_buffer_size) {
+        LOG(ERROR, _("cannot peek - buffer is too small"));
+        return avs_errno(AVS_ENOBUFS);
+    }
+    if (offset >= stream->output_size) {
+        avs_error_t err = decompress_to_buffer(stream);
+        if (avs_is_err(err)) {
+            return err;
+        }
+    }
+    if (offset < stream->output_size) {
+        *out_value = (char) GET_OUTPUT_BUFFER(stream)[offset];
+        return AVS_OK;
+    } else {
+        return AVS_EOF;
+    }
+}
+
+static avs_error_t decompressor_reset(avs_stream_t *stream_) {
+    decompressor_stream_t *stream = (decompressor_stream_t *) stream_;
+    stream->input_size = 0;
+    stream->output_size = 0;
+    stream->finishing = false;
+    if (stream->ops->reset(&stream->state)) {
+        LOG(ERROR, _("could not reset decompressor"));
+        stream->result = HTTP_DECOMPRESSOR_ERROR;
+        return avs_errno(AVS_EIO);
+    }
+    stream->result = HTTP_DECOMPRESSOR_NEED_INPUT;
+    return AVS_OK;
+}
+
+static avs_error_t decompressor_close(avs_stream_t *stream_) {
+    decompressor_stream_t *stream = (decompressor_stream_t *) stream_;
+    stream->ops->destroy(stream->state);
+    stream->state = NULL;
+    return AVS_OK;
+}
+
+static const avs_stream_v_table_t decompressor_vtable = {
+    decompressor_write_some,
+    decompressor_finish_message,
+    decompressor_read,
+    decompressor_peek,
+    decompressor_reset,
+    decompressor_close,
+    &(avs_stream_v_table_extension_t[]){
+            { AVS_STREAM_V_TABLE_EXTENSION_NONBLOCK,
+              &(avs_stream_v_table_extension_nonblock_t[]){
+                      { decompressor_nonblock_read_ready,
+                        decompressor_nonblock_write_ready } }[0] },
+            AVS_STREAM_V_TABLE_EXTENSION_NULL }[0]
+};
+
+avs_stream_t *
+_avs_http_decompressor_stream_create(const http_decompressor_ops_t *ops,
+                                     size_t input_buffer_size,
+                                     size_t output_buffer_size) {
+    if (!input_buffer_size || !output_buffer_size) {
+        LOG(ERROR, _("buffers cannot be zero-length"));
+        return NULL;
+    }
+    decompressor_stream_t *stream = (decompressor_stream_t *) avs_calloc(
+            1, sizeof(decompressor_stream_t) + input_buffer_size
+                       + output_buffer_size);
+    if (!stream) {
+        LOG(ERROR, _("cannot allocate memory"));
+        return NULL;
+    }
+    if (!(stream->state = ops->create())) {
+        LOG(ERROR, _("could not initialize decompressor"));
+        avs_free(stream);
+        return NULL;
+    }
+    *(const avs_stream_v_table_t **) (intptr_t) &stream->vtable =
+            &decompressor_vtable;
+    stream->ops = ops;
+    stream->result = HTTP_DECOMPRESSOR_NEED_INPUT;
+    stream->input_buffer_size = input_buffer_size;
+    stream->output_buffer_size = output_buffer_size;
+    return (avs_stream_t *) stream;
+}
+
+#    ifdef AVS_UNIT_TESTING
+#        include "tests/http/test_decompressor.c"
+#    endif
+
+#endif // AVS_COMMONS_WITH_AVS_HTTP
@@ -0,0 +1,112 @@
+/*
+ * Copyright 2023 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef AVS_COMMONS_HTTP_DECOMPRESSOR_H
+#define AVS_COMMONS_HTTP_DECOMPRESSOR_H
+
+#include <stdint.h>
+
+#include <avsystem/commons/avs_stream.h>
+
+VISIBILITY_PRIVATE_HEADER_BEGIN
+
+typedef enum {
+    /* the output space has been exhausted; more output may be available */
+    HTTP_DECOMPRESSOR_OK,
+    /* all the input has been consumed, and all the data that could be
+     * decompressed from it has been output */
+    HTTP_DECOMPRESSOR_NEED_INPUT,
+    /* the end of compressed data has been reached and fully output */
+    HTTP_DECOMPRESSOR_FINISHED,
+    /* the compressed data is malformed, or some other error occurred */
+    HTTP_DECOMPRESSOR_ERROR
+} http_decompressor_result_t;
+
+/**
+ * Decompression algorithm that may be plugged into a stream created with
+ * @ref _avs_http_decompressor_stream_create . Each of the operations is
+ * a thin wrapper over the streaming API of some decompression library.
+ */
+typedef struct {
+    /**
+     * Allocates and initializes a new decompressor state. Returns NULL on
+     * failure.
+     */
+    void *(*create)(void);
+
+    /**
+     * Decompresses as much data as possible from <c>*inout_next_in</c> into
+     * <c>*inout_next_out</c>, advancing both pointers past the consumed and
+     * produced data, and decreasing the corresponding sizes accordingly.
+     * Details of any error shall be logged before returning.
+     */
+    http_decompressor_result_t (*decompress)(void *state,
+                                             const uint8_t **inout_next_in,
+                                             size_t *inout_avail_in,
+                                             uint8_t **inout_next_out,
+                                             size_t *inout_avail_out);
+
+    /**
+     * Prepares the state for decompressing new data from scratch. The state may
+     * be replaced with a new one in the process. Returns 0 on success, or
+     * a negative value on failure, in which case <c>*state_ptr</c> shall be
+     * left in a state valid for <c>destroy</c>.
+     */
+    int (*reset)(void **state_ptr);
+
+    /**
+     * Frees the state. NULL shall be ignored.
+     */
+    void (*destroy)(void *state);
+} http_decompressor_ops_t;
+
+/**
+ * Creates a decompressor stream using the algorithm implemented by @p ops .
+ *
+ * The stream behaves in the same way as the decompressor created with
+ * @ref _avs_http_create_decompressor , i.e. compressed data written into it can
+ * then be read back decompressed. <c>avs_stream_finish_message</c> shall be
+ * called after writing all the compressed data; the message read from the
+ * stream is then reported as finished after the end of compressed data has
+ * been reached, and reading fails if the compressed data turned out to be
+ * truncated.
+ *
+ * @param ops                Decompression algorithm to use.
+ *
+ * @param input_buffer_size  Size of the buffer for compressed data.
+ *
+ * @param output_buffer_size Size of the buffer for decompressed data, used when
+ *                           the data is not read directly into the buffer
+ *                           passed to <c>avs_stream_read</c>.
+ */
+avs_stream_t *
+_avs_http_decompressor_stream_create(const http_decompressor_ops_t *ops,
+                                     size_t input_buffer_size,
+                                     size_t output_buffer_size);
+
+#ifdef AVS_COMMONS_HTTP_WITH_BROTLI
+/* "br" content coding, RFC 7932 */
+extern const http_decompressor_ops_t _AVS_HTTP_BROTLI_DECOMPRESSOR;
+#endif // AVS_COMMONS_HTTP_WITH_BROTLI
+
+#ifdef AVS_COMMONS_HTTP_WITH_ZSTD
+/* "zstd" content coding, RFC 8878 */
+extern const http_decompressor_ops_t _AVS_HTTP_ZSTD_DECOMPRESSOR;
+#endif // AVS_COMMONS_HTTP_WITH_ZSTD
+
+VISIBILITY_PRIVATE_HEADER_END
+
+#endif /* AVS_COMMONS_HTTP_DECOMPRESSOR_H */
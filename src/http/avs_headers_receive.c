@@ -31,6 +31,7 @@
 #    include "avs_body_receivers.h"
 #    include "avs_client.h"
 #    include "avs_headers.h"
+#    include "avs_line_parser.h"
 
 #    include "avs_http_log.h"
 
@@ -43,6 +44,7 @@ typedef struct {
     avs_http_content_encoding_t content_encoding;
     size_t content_length;
     avs_url_t *redirect_url;
+    http_line_parser_t line_parser;
     size_t header_buf_size;
     char header_buf[];
 } header_parser_state_t;
@@ -64,177 +66,362 @@ static int parse_size(size_t *out, const char *in) {
     return 0;
 }
 
-static int http_handle_header(const char *key,
+/**
+ * Handler for a header interpreted by avs_http. Returns a negative value if the
+ * header is invalid. May set @p out_header_handled to false if the header is
+ * not applicable in the current state.
+ */
+typedef int http_header_handler_t(header_parser_state_t *state,
+                                  const char *value,
+                                  bool *out_header_handled);
+
+static int handle_www_authenticate(header_parser_state_t *state,
+                                   const char *value,
+                                   bool *out_header_handled) {
+    (void) out_header_handled;
+    _avs_http_auth_setup(&state->stream->auth, value);
+    return 0;
+}
+
+static int handle_set_cookie(header_parser_state_t *state,
+                             const char *value,
+                             bool *out_header_handled) {
+    (void) out_header_handled;
+    return _avs_http_set_cookie(state->stream->http, false, value) < 0 ? -1
+                                                                       : 0;
+}
+
+static int handle_set_cookie2(header_parser_state_t *state,
                               const char *value,
-                              header_parser_state_t *state,
                               bool *out_header_handled) {
-    *out_header_handled = true;
-    if (avs_strcasecmp(key, "WWW-Authenticate") == 0) {
-        _avs_http_auth_setup(&state->stream->auth, value);
-    } else if (avs_strcasecmp(key, "Set-Cookie") == 0) {
-        if (_avs_http_set_cookie(state->stream->http, false, value) < 0) {
-            return -1;
-        }
-    } else if (avs_strcasecmp(key, "Set-Cookie2") == 0) {
-        if (_avs_http_set_cookie(state->stream->http, true, value) < 0) {
+    (void) out_header_handled;
+    return _avs_http_set_cookie(state->stream->http, true, value) < 0 ? -1 : 0;
+}
+
+static int handle_content_length(header_parser_state_t *state,
+                                 const char *value,
+                                 bool *out_header_handled) {
+    (void) out_header_handled;
+    if (state->transfer_encoding != TRANSFER_IDENTITY
+            || parse_size(&state->content_length, value)) {
+        return -1;
+    }
+    state->transfer_encoding = TRANSFER_LENGTH;
+    return 0;
+}
+
+static int handle_transfer_encoding(header_parser_state_t *state,
+                                    const char *value,
+                                    bool *out_header_handled) {
+    (void) out_header_handled;
+    if (avs_strcasecmp(value, "identity") != 0) { /* see RFC 2616, sec. 4.4 */
+        if (state->transfer_encoding != TRANSFER_IDENTITY) {
             return -1;
         }
-    } else if (avs_strcasecmp(key, "Content-Length") == 0) {
-        if (state->transfer_encoding != TRANSFER_IDENTITY
-                || parse_size(&state->content_length, value)) {
+        state->transfer_encoding = TRANSFER_CHUNKED;
+    }
+    return 0;
+}
+
+static int handle_content_encoding(header_parser_state_t *state,
+                                   const char *value,
+                                   bool *out_header_handled) {
+    (void) out_header_handled;
+    if (avs_strcasecmp(value, "identity") != 0) {
+        if (state->content_encoding != AVS_HTTP_CONTENT_IDENTITY) {
             return -1;
         }
-        state->transfer_encoding = TRANSFER_LENGTH;
-    } else if (avs_strcasecmp(key, "Transfer-Encoding") == 0) {
-        if (avs_strcasecmp(value, "identity")
-                != 0) { /* see RFC 2616, sec. 4.4 */
-            if (state->transfer_encoding != TRANSFER_IDENTITY) {
-                return -1;
-            }
-            state->transfer_encoding = TRANSFER_CHUNKED;
-        }
-    } else if (avs_strcasecmp(key, "Content-Encoding") == 0) {
-        if (avs_strcasecmp(value, "identity") != 0) {
-            if (state->content_encoding != AVS_HTTP_CONTENT_IDENTITY) {
-                return -1;
-            }
-            if (avs_strcasecmp(value, "gzip") == 0
-                    || avs_strcasecmp(value, "x-gzip") == 0) {
-                state->content_encoding = AVS_HTTP_CONTENT_GZIP;
-            } else if (avs_strcasecmp(value, "deflate") == 0) {
-                state->content_encoding = AVS_HTTP_CONTENT_DEFLATE;
-            }
-        }
-    } else if (avs_strcasecmp(key, "Connection") == 0) {
-        if (avs_strcasecmp(value, "close") == 0) {
-            state->stream->flags.keep_connection = 0;
+        if (avs_strcasecmp(value, "gzip") == 0
+                || avs_strcasecmp(value, "x-gzip") == 0) {
+            state->content_encoding = AVS_HTTP_CONTENT_GZIP;
+        } else if (avs_strcasecmp(value, "deflate") == 0) {
+            state->content_encoding = AVS_HTTP_CONTENT_DEFLATE;
+        } else if (avs_strcasecmp(value, "br") == 0) {
+            state->content_encoding = AVS_HTTP_CONTENT_BROTLI;
+        } else if (avs_strcasecmp(value, "zstd") == 0) {
+            state->content_encoding = AVS_HTTP_CONTENT_ZSTD;
         }
-    } else if (state->stream->status / 100 == 3
-               && avs_strcasecmp(key, "Location") == 0) {
-        avs_url_free(state->redirect_url);
-        state->redirect_url = avs_url_parse(value);
-    } else {
-        *out_header_handled = false;
-        LOG(DEBUG, _("Unhandled HTTP header: ") "%s" _(": ") "%s", key, value);
     }
     return 0;
 }
 
-static avs_error_t discard_line(avs_stream_t *stream) {
-    char c;
+static int handle_connection(header_parser_state_t *state,
+                             const char *value,
+                             bool *out_header_handled) {
+    (void) out_header_handled;
+    if (avs_strcasecmp(value, "close") == 0) {
+        state->stream->flags.keep_connection = 0;
+    }
+    return 0;
+}
 
-    do {
-        avs_error_t err = avs_stream_getch(stream, &c, NULL);
-        if (avs_is_err(err)) {
-            return err;
-        }
-    } while (c != '\n');
+static int handle_location(header_parser_state_t *state,
+                           const char *value,
+                           bool *out_header_handled) {
+    if (state->stream->status / 100 != 3) {
+        *out_header_handled = false;
+        return 0;
+    }
+    avs_url_free(state->redirect_url);
+    state->redirect_url = avs_url_parse(value);
+    return 0;
+}
 
-    return AVS_OK;
+typedef struct {
+    const char *key;
+    http_header_handler_t *handler;
+} http_known_header_t;
+
+static const http_known_header_t HEADER_LOCATION = {
+    "Location", handle_location
+};
+static const http_known_header_t HEADER_CONNECTION = {
+    "Connection", handle_connection
+};
+static const http_known_header_t HEADER_SET_COOKIE = {
+    "Set-Cookie", handle_set_cookie
+};
+static const http_known_header_t HEADER_SET_COOKIE2 = {
+    "Set-Cookie2", handle_set_cookie2
+};
+static const http_known_header_t HEADER_CONTENT_LENGTH = {
+    "Content-Length", handle_content_length
+};
+static const http_known_header_t HEADER_CONTENT_ENCODING = {
+    "Content-Encoding", handle_content_encoding
+};
+static const http_known_header_t HEADER_WWW_AUTHENTICATE = {
+    "WWW-Authenticate", handle_www_authenticate
+};
+static const http_known_header_t HEADER_TRANSFER_ENCODING = {
+    "Transfer-Encoding", handle_transfer_encoding
+};
+
+/**
+ * Finds the handler for @p key among the headers interpreted by avs_http.
+ *
+ * The candidate is selected by key length and, where lengths collide, by the
+ * first character, so that at most one case-insensitive string comparison is
+ * performed per received header.
+ */
+static const http_known_header_t *find_known_header(const char *key,
+                                                    size_t key_len) {
+    const http_known_header_t *candidate = NULL;
+    switch (key_len) {
+    case sizeof("Location") - 1:
+        candidate = &HEADER_LOCATION;
+        break;
+    case sizeof("Connection") - 1: // same as "Set-Cookie"
+        candidate = (tolower((unsigned char) key[0]) == 'c')
+                            ? &HEADER_CONNECTION
+                            : &HEADER_SET_COOKIE;
+        break;
+    case sizeof("Set-Cookie2") - 1:
+        candidate = &HEADER_SET_COOKIE2;
+        break;
+    case sizeof("Content-Length") - 1:
+        candidate = &HEADER_CONTENT_LENGTH;
+        break;
+    case sizeof("Content-Encoding") - 1: // same as "WWW-Authenticate"
+        candidate = (tolower((unsigned char) key[0]) == 'c')
+                            ? &HEADER_CONTENT_ENCODING
+                            : &HEADER_WWW_AUTHENTICATE;
+        break;
+    case sizeof("Transfer-Encoding") - 1:
+        candidate = &HEADER_TRANSFER_ENCODING;
+        break;
+    default:
+        return NULL;
+    }
+    return avs_strncasecmp(key, candidate->key, key_len) == 0 ? candidate
+                                                               : NULL;
 }
 
-static avs_error_t get_http_header_line(avs_stream_t *stream,
-                                        char *line_buf,
-                                        size_t line_buf_size) {
-    avs_error_t err;
+static const http_header_cb_entry_t *
+find_user_header_cb(avs_http_t *http, const http_header_span_t *header) {
+    AVS_LIST(http_header_cb_entry_t) entry;
+    AVS_LIST_FOREACH(entry, http->header_cbs) {
+        if (avs_strncasecmp(entry->key, header->key, header->key_len) == 0
+                && !entry->key[header->key_len]) {
+            return entry;
+        }
+    }
+    return NULL;
+}
 
-    while (avs_is_err((err = avs_stream_getline(stream, NULL, NULL, line_buf,
-                                                line_buf_size)))) {
-        if (err.category == AVS_ERRNO_CATEGORY && err.code == AVS_ENOBUFS) {
-            LOG(WARNING, _("HTTP header too long to handle: ") "%s", line_buf);
-            if (avs_is_err((err = discard_line(stream)))) {
+/**
+ * Receives the next line from the backend stream, feeding the line parser
+ * directly with the data in the receive buffer of the netbuf stream. Lines that
+ * are too long are skipped.
+ *
+ * On success, @p out_line points either into the receive buffer or into
+ * header_buf, and @p out_consumed is set to the number of bytes that need to be
+ * consumed from the backend stream after the line is no longer used.
+ *
+ * Returns AVS_EOF if the stream has ended; the line parser may be inspected to
+ * check whether part of a line had been received before that.
+ */
+static avs_error_t receive_line(header_parser_state_t *state,
+                                http_line_t *out_line,
+                                size_t *out_consumed) {
+    avs_stream_t *backend = state->stream->backend;
+    while (true) {
+        const char *data;
+        size_t size;
+        avs_error_t err = avs_stream_peek_span(backend, 0, &data, &size);
+        if (avs_is_err(err)) {
+            if (!avs_is_eof(err)) {
                 LOG(ERROR,
-                    _("Could not discard header line (category == ") "%" PRIu16
-                            _(", code == ") "%" PRIu16 _(")"),
+                    _("Could not read header line (category == ") "%" PRIu16 _(
+                            ", code == ") "%" PRIu16 _(")"),
                     err.category, err.code);
-                return err;
             }
-        } else {
-            LOG(ERROR,
-                _("Could not read header line (category == ") "%" PRIu16 _(
-                        ", code == ") "%" PRIu16 _(")"),
-                err.category, err.code);
+            return err;
+        }
+        switch (_avs_http_line_parser_feed(&state->line_parser, data, size,
+                                           out_consumed, out_line)) {
+        case HTTP_LINE_PARSER_LINE:
+            return AVS_OK;
+        case HTTP_LINE_PARSER_LINE_TOO_LONG:
+            LOG(WARNING, _("HTTP header too long to handle: ") "%.*s",
+                (int) out_line->size, out_line->data);
+            break;
+        case HTTP_LINE_PARSER_NEED_MORE:
+            break;
+        }
+        if (avs_is_err((err = avs_stream_consume_bytes(backend,
+                                                       *out_consumed)))) {
             return err;
         }
     }
+}
 
+/**
+ * Copies the header line into header_buf, if not already there, and
+ * null-terminates the key and value in place.
+ */
+static void materialize_header(header_parser_state_t *state,
+                               const http_line_t *line,
+                               const http_header_span_t *header,
+                               const char **out_key,
+                               const char **out_value) {
+    assert(line->size < state->header_buf_size);
+    if (line->data != state->header_buf) {
+        memcpy(state->header_buf, line->data, line->size);
+    }
+    size_t value_offset = (size_t) (header->value - line->data);
+    state->header_buf[header->key_len] = '\0';
+    state->header_buf[value_offset + header->value_len] = '\0';
+    *out_key = state->header_buf;
+    *out_value = state->header_buf + value_offset;
+}
+
+static avs_error_t store_header(header_parser_state_t *state,
+                                const char *key,
+                                size_t key_len,
+                                const char *value,
+                                size_t value_len,
+                                bool header_handled) {
+    assert(!*state->header_storage_end_ptr);
+    avs_http_header_t *element = (avs_http_header_t *) AVS_LIST_NEW_BUFFER(
+            sizeof(avs_http_header_t) + key_len + value_len + 2);
+    if (!element) {
+        LOG(ERROR, _("Could not store received header"));
+        return avs_errno(AVS_ENOMEM);
+    }
+    element->key = (char *) element + sizeof(avs_http_header_t);
+    memcpy((char *) (intptr_t) element->key, key, key_len + 1);
+    element->value = element->key + key_len + 1;
+    memcpy((char *) (intptr_t) element->value, value, value_len + 1);
+    element->handled = header_handled;
+    *state->header_storage_end_ptr = element;
+    AVS_LIST_ADVANCE_PTR((AVS_LIST(avs_http_header_t) **) (intptr_t) &state
+                                 ->header_storage_end_ptr);
     return AVS_OK;
 }
 
-static const char *http_header_split(char *line) {
-    char *value = strchr(line, ':');
-    if (value && *value) {
-        *value++ = '\0';
-        while (*value && isspace((unsigned char) *value)) {
-            *value++ = '\0';
-        }
+static avs_error_t handle_header_line(header_parser_state_t *state,
+                                      const http_line_t *line) {
+    http_header_span_t header;
+    if (!_avs_http_split_header(line, &header)) {
+        LOG(ERROR, _("Error parsing headers"));
+        return avs_errno(AVS_EPROTO);
+    }
+    const http_known_header_t *known_header =
+            find_known_header(header.key, header.key_len);
+    const http_header_cb_entry_t *user_cb =
+            find_user_header_cb(state->stream->http, &header);
+    if (!known_header && !user_cb && !state->header_storage_end_ptr) {
+        /* nobody is interested in this header - no need to copy it */
+        LOG(DEBUG, _("Unhandled HTTP header: ") "%.*s" _(": ") "%.*s",
+            (int) header.key_len, header.key, (int) header.value_len,
+            header.value);
+        return AVS_OK;
+    }
+
+    const char *key;
+    const char *value;
+    materialize_header(state, line, &header, &key, &value);
+    bool header_handled = !!known_header;
+    if (known_header && known_header->handler(state, value, &header_handled)) {
+        LOG(ERROR, _("Error handling headers"));
+        return avs_errno(AVS_EPROTO);
+    }
+    if (!header_handled) {
+        LOG(DEBUG, _("Unhandled HTTP header: ") "%s" _(": ") "%s", key, value);
+    }
+    avs_error_t err = AVS_OK;
+    if (user_cb
+            && avs_is_err((err = user_cb->cb((avs_stream_t *) state->stream,
+                                             key, value, user_cb->user_ptr)))) {
+        LOG(ERROR, _("Header callback failed"));
+        return err;
     }
-    return value;
+    if (state->header_storage_end_ptr) {
+        err = store_header(state, key, header.key_len, value, header.value_len,
+                           header_handled);
+    }
+    return err;
 }
 
 static avs_error_t http_receive_headers_internal(header_parser_state_t *state) {
     while (true) {
-        const char *value = NULL;
-        avs_error_t err =
-                get_http_header_line(state->stream->backend, state->header_buf,
-                                     state->header_buf_size);
+        http_line_t line;
+        size_t consumed;
+        avs_error_t err = receive_line(state, &line, &consumed);
         if (avs_is_err(err)) {
             LOG(ERROR, _("Error receiving headers"));
             return err;
         }
 
-        if (state->header_buf[0] == '\0') { /* empty line */
-            return AVS_OK;
+        bool empty_line = (line.size == 0);
+        if (!empty_line) {
+            LOG(TRACE, _("HTTP header: ") "%.*s", (int) line.size, line.data);
+            err = handle_header_line(state, &line);
         }
-        LOG(TRACE, _("HTTP header: ") "%s", state->header_buf);
-        bool header_handled;
-        if (!(value = http_header_split(state->header_buf))
-                || http_handle_header(state->header_buf, value, state,
-                                      &header_handled)) {
-            LOG(ERROR, _("Error parsing or handling headers"));
-            return avs_errno(AVS_EPROTO);
+        if (avs_is_ok(err)) {
+            err = avs_stream_consume_bytes(state->stream->backend, consumed);
         }
-
-        if (state->header_storage_end_ptr) {
-            assert(!*state->header_storage_end_ptr);
-            size_t key_len = strlen(state->header_buf);
-            size_t value_len = strlen(value);
-            avs_http_header_t *element =
-                    (avs_http_header_t *) AVS_LIST_NEW_BUFFER(
-                            sizeof(avs_http_header_t) + key_len + value_len
-                            + 2);
-            if (!element) {
-                LOG(ERROR, _("Could not store received header"));
-                return avs_errno(AVS_ENOMEM);
-            }
-            element->key = (char *) element + sizeof(avs_http_header_t);
-            memcpy((char *) (intptr_t) element->key, state->header_buf,
-                   key_len + 1);
-            element->value = element->key + key_len + 1;
-            memcpy((char *) (intptr_t) element->value, value, value_len + 1);
-            element->handled = header_handled;
-            *state->header_storage_end_ptr = element;
-            AVS_LIST_ADVANCE_PTR(
-                    (AVS_LIST(avs_http_header_t) **) (intptr_t) &state
-                            ->header_storage_end_ptr);
+        if (avs_is_err(err) || empty_line) {
+            return err;
         }
     }
 }
 
 static avs_error_t
 http_receive_headline_and_headers(header_parser_state_t *state) {
-    state->header_buf[0] = '\0';
     state->stream->flags.keep_connection = 1;
     state->stream->status = 0;
+    _avs_http_line_parser_init(&state->line_parser, state->header_buf,
+                               state->header_buf_size);
     /* read parse headline */
-    size_t bytes_read;
-    bool message_finished;
-    avs_error_t err = avs_stream_getline(state->stream->backend, &bytes_read,
-                                         &message_finished, state->header_buf,
-                                         state->header_buf_size);
+    http_line_t line;
+    size_t consumed;
+    avs_error_t err = receive_line(state, &line, &consumed);
     if (avs_is_err(err)) {
         LOG(ERROR, _("Could not receive HTTP headline"));
-        if (bytes_read == 0 && message_finished
+        if (avs_is_eof(err)
+                && !_avs_http_line_parser_has_partial_line(&state->line_parser)
                 && state->stream->flags.close_handling_required) {
             // end-of-stream: likely a Reset from previous connection
             // issue a fake redirect so that the stream reconnects
@@ -245,6 +432,13 @@ http_receive_headline_and_headers(header_parser_state_t *state) {
         }
         goto http_receive_headers_error;
     }
+    assert(line.size < state->header_buf_size);
+    memmove(state->header_buf, line.data, line.size);
+    state->header_buf[line.size] = '\0';
+    if (avs_is_err((err = avs_stream_consume_bytes(state->stream->backend,
+                                                   consumed)))) {
+        goto http_receive_headers_error;
+    }
     state->stream->flags.close_handling_required = 0;
     if (sscanf(state->header_buf, "HTTP/%*s %d", &state->stream->status) != 1) {
         /* discard HTTP version
@@ -275,6 +469,12 @@ http_receive_headline_and_headers(header_parser_state_t *state) {
         break;
 
     case 3: // 3xx - redirect
+        if (state->stream->pipelining) {
+            /* requests queued after this one have already been sent to the
+             * original server, so the redirect cannot be followed */
+            LOG(WARNING, _("not following redirect in pipelining mode"));
+            goto http_receive_error_response;
+        }
         state->stream->auth.state.flags.retried = 0;
         if (!state->redirect_url) {
             err = avs_errno(AVS_EINVAL);
@@ -291,6 +491,7 @@ http_receive_headline_and_headers(header_parser_state_t *state) {
         goto http_receive_headers_error;
 
     default: // most likely 5xx - server error
+    http_receive_error_response:
         state->stream->auth.state.flags.retried = 0;
         // fall-through
     case 4: // 4xx - client error
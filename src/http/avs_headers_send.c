@@ -25,6 +25,7 @@
 #    include <avsystem/commons/avs_utils.h>
 
 #    include "avs_client.h"
+#    include "avs_content_encoding.h"
 #    include "avs_headers.h"
 
 #    include "avs_http_log.h"
@@ -63,11 +64,12 @@ avs_error_t _avs_http_send_headers(http_stream_t *stream,
                                               avs_url_host(stream->url),
                                               avs_url_port(stream->url),
                                               avs_url_path(stream->url))))
-#    ifdef AVS_COMMONS_HTTP_WITH_ZLIB
+#    ifdef HTTP_ACCEPT_ENCODING
             || (stream->http->buffer_sizes.content_coding_input > 0
                 && avs_is_err((err = avs_stream_write_f(
                                        stream->backend,
-                                       "Accept-Encoding: gzip, deflate\r\n"))))
+                                       "Accept-Encoding: " HTTP_ACCEPT_ENCODING
+                                       "\r\n"))))
 #    endif
             || (stream->http->user_agent
                 && avs_is_err((
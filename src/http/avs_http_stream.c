@@ -76,7 +76,7 @@ static const char *default_port_for_protocol(http_uri_protocol_t protocol) {
     return "";
 }
 
-static const char *resolve_port(const avs_url_t *parsed_url) {
+const char *_avs_http_resolve_port(const avs_url_t *parsed_url) {
     const char *port = avs_url_port(parsed_url);
     if (port) {
         return port;
@@ -114,7 +114,7 @@ avs_error_t _avs_http_socket_new(avs_net_socket_t **out,
     }
 #    endif // AVS_COMMONS_WITH_AVS_CRYPTO
     const char *host = avs_url_host(url);
-    const char *port = resolve_port(url);
+    const char *port = _avs_http_resolve_port(url);
     avs_error_t err = avs_errno(AVS_EINVAL);
     switch (check_protocol(avs_url_protocol(url))) {
     case HTTP_URI_PROTOCOL_HTTP:
@@ -165,9 +165,9 @@ static avs_error_t reconnect_tcp_socket(avs_net_socket_t *socket,
     }
     avs_error_t err;
     if (avs_is_err((err = avs_net_socket_close(socket)))
-            || avs_is_err(
-                       (err = avs_net_socket_connect(socket, avs_url_host(url),
-                                                     resolve_port(url))))) {
+            || avs_is_err((err = avs_net_socket_connect(
+                                   socket, avs_url_host(url),
+                                   _avs_http_resolve_port(url))))) {
         LOG(ERROR, _("reconnect failed"));
         return err;
     }
@@ -198,8 +198,11 @@ avs_error_t _avs_http_redirect(http_stream_t *stream, avs_url_t **url_move) {
     _avs_http_auth_reset(&stream->auth);
     avs_net_socket_close(old_socket);
 
-    if (avs_is_err((err = _avs_http_socket_new(&new_socket, stream->http,
-                                               *url_move)))) {
+    bool reused_connection = false;
+    if ((new_socket = _avs_http_pool_checkout(stream->http, *url_move))) {
+        reused_connection = true;
+    } else if (avs_is_err((err = _avs_http_socket_new(
+                                   &new_socket, stream->http, *url_move)))) {
         return err;
     }
 
@@ -216,6 +219,7 @@ avs_error_t _avs_http_redirect(http_stream_t *stream, avs_url_t **url_move) {
     *url_move = NULL;
     stream->flags.no_expect = 0;
     stream->flags.keep_connection = 1;
+    stream->flags.close_handling_required = reused_connection;
     if ((stream->auth.credentials.user || stream->auth.credentials.password)
             && strcmp(avs_url_protocol(stream->url), "https") == 0) {
         stream->auth.state.flags.type = HTTP_AUTH_TYPE_BASIC;
@@ -313,8 +317,13 @@ static avs_error_t http_send_block(http_stream_t *stream,
             stream->flags.chunked_sending = 0;
         }
     } else {
-        if (message_finished) {
+        if (message_finished && stream->pipelining) {
+            err = _avs_http_pipeline_send(stream, data, data_length);
+        } else if (message_finished) {
             err = http_send_simple_request(stream, data, data_length);
+        } else if (stream->pipelining) {
+            LOG(ERROR, _("chunked requests cannot be pipelined"));
+            err = avs_errno(AVS_EMSGSIZE);
         } else {
             err = _avs_http_chunked_send_first(stream, data, data_length);
         }
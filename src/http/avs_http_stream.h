@@ -106,6 +106,20 @@ typedef struct {
     const char *value;
 } http_header_t;
 
+/**
+ * Request sent in pipelining mode, for which the response has not been
+ * received yet. Holds everything necessary to send it again after reconnecting.
+ */
+typedef struct {
+    /**
+     * Copy of the user headers sent with the request. Keys and values are
+     * stored in the same allocation as the list elements.
+     */
+    AVS_LIST(http_header_t) user_headers;
+    size_t body_size;
+    char body[];
+} http_pipelined_request_t;
+
 struct http_stream_struct {
     const avs_stream_v_table_t *const vtable;
     avs_http_t *const http;
@@ -165,6 +179,16 @@ struct http_stream_struct {
     AVS_LIST(http_header_t) user_headers;
     AVS_LIST(const avs_http_header_t) *incoming_header_storage;
 
+    /**
+     * Set if pipelining has been enabled using @ref avs_http_set_pipelining.
+     */
+    bool pipelining;
+    /**
+     * Requests already sent in pipelining mode, for which the responses have
+     * not been received yet, oldest first.
+     */
+    AVS_LIST(http_pipelined_request_t) pipeline;
+
     unsigned random_seed;
 
     /**
@@ -190,6 +214,12 @@ struct http_stream_struct {
 
 typedef struct http_stream_struct http_stream_t;
 
+/**
+ * Returns the port specified in @p parsed_url , or the default one for its
+ * protocol.
+ */
+const char *_avs_http_resolve_port(const avs_url_t *parsed_url);
+
 avs_error_t _avs_http_socket_new(avs_net_socket_t **out,
                                  avs_http_t *client,
                                  const avs_url_t *url);
@@ -210,6 +240,23 @@ avs_error_t _avs_http_send_via_buffer(http_stream_t *stream,
 
 avs_error_t _avs_http_encoder_flush(http_stream_t *stream);
 
+/**
+ * Sends a complete request in pipelining mode, without waiting for the
+ * response, and appends it to @ref http_stream_t.pipeline.
+ */
+avs_error_t _avs_http_pipeline_send(http_stream_t *stream,
+                                    const void *body,
+                                    size_t body_size);
+
+/**
+ * Receives headers of the response to the oldest request in
+ * @ref http_stream_t.pipeline. If the connection turns out to be closed, all
+ * the pipelined requests are sent again on a new one.
+ */
+avs_error_t _avs_http_pipeline_receive(http_stream_t *stream);
+
+void _avs_http_pipeline_clear(http_stream_t *stream);
+
 VISIBILITY_PRIVATE_HEADER_END
 
 #endif /* AVS_COMMONS_HTTP_STREAM_H */
@@ -0,0 +1,126 @@
+/*
+ * Copyright 2023 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <avs_commons_init.h>
+
+#ifdef AVS_COMMONS_WITH_AVS_HTTP
+
+#    include <assert.h>
+#    include <ctype.h>
+#    include <string.h>
+
+#    include <avsystem/commons/avs_utils.h>
+
+#    include "avs_line_parser.h"
+
+VISIBILITY_SOURCE_BEGIN
+
+void _avs_http_line_parser_init(http_line_parser_t *parser,
+                                char *buf,
+                                size_t buf_size) {
+    assert(buf_size > 0);
+    parser->buf = buf;
+    parser->buf_size = buf_size;
+    parser->buf_len = 0;
+    parser->discarding = false;
+}
+
+static void set_line(http_line_t *out_line, const char *data, size_t size) {
+    if (size > 0 && data[size - 1] == '\r') {
+        --size;
+    }
+    out_line->data = data;
+    out_line->size = size;
+}
+
+static http_line_parser_result_t line_too_long(http_line_parser_t *parser,
+                                               const char *data,
+                                               size_t chunk_size,
+                                               http_line_t *out_line) {
+    // the buffer might be completely filled if it ends with '\r'
+    size_t buf_len = AVS_MIN(parser->buf_len, parser->buf_size - 1);
+    size_t to_copy = AVS_MIN(chunk_size, parser->buf_size - 1 - buf_len);
+    memcpy(parser->buf + buf_len, data, to_copy);
+    out_line->data = parser->buf;
+    out_line->size = buf_len + to_copy;
+    parser->buf_len = 0;
+    return HTTP_LINE_PARSER_LINE_TOO_LONG;
+}
+
+http_line_parser_result_t
+_avs_http_line_parser_feed(http_line_parser_t *parser,
+                           const char *data,
+                           size_t size,
+                           size_t *out_consumed,
+                           http_line_t *out_line) {
+    const char *terminator = (const char *) memchr(data, '\n', size);
+    size_t chunk_size = terminator ? (size_t) (terminator - data) : size;
+    *out_consumed = terminator ? chunk_size + 1 : size;
+
+    if (parser->discarding) {
+        parser->discarding = !terminator;
+        return HTTP_LINE_PARSER_NEED_MORE;
+    }
+    // a trailing '\r' is not a part of the line if the terminator follows it,
+    // possibly in the next chunk, so it is always allowed to be buffered
+    size_t line_len = parser->buf_len + chunk_size;
+    if (line_len
+            && (chunk_size ? data[chunk_size - 1]
+                           : parser->buf[parser->buf_len - 1])
+                           == '\r') {
+        --line_len;
+    }
+    if (line_len >= parser->buf_size) {
+        parser->discarding = !terminator;
+        return line_too_long(parser, data, chunk_size, out_line);
+    }
+    if (!parser->buf_len && terminator) {
+        set_line(out_line, data, chunk_size);
+        return HTTP_LINE_PARSER_LINE;
+    }
+    memcpy(parser->buf + parser->buf_len, data, chunk_size);
+    parser->buf_len += chunk_size;
+    if (!terminator) {
+        return HTTP_LINE_PARSER_NEED_MORE;
+    }
+    set_line(out_line, parser->buf, parser->buf_len);
+    parser->buf_len = 0;
+    return HTTP_LINE_PARSER_LINE;
+}
+
+bool _avs_http_split_header(const http_line_t *line,
+                            http_header_span_t *out_header) {
+    const char *colon = (const char *) memchr(line->data, ':', line->size);
+    if (!colon) {
+        return false;
+    }
+    const char *end = line->data + line->size;
+    const char *value = colon + 1;
+    while (value < end && isspace((unsigned char) *value)) {
+        ++value;
+    }
+    out_header->key = line->data;
+    out_header->key_len = (size_t) (colon - line->data);
+    out_header->value = value;
+    out_header->value_len = (size_t) (end - value);
+    return true;
+}
+
+#    ifdef AVS_UNIT_TESTING
+#        include "tests/http/test_line_parser.c"
+#    endif
+
+#endif // AVS_COMMONS_WITH_AVS_HTTP
@@ -0,0 +1,114 @@
+/*
+ * Copyright 2023 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef AVS_COMMONS_HTTP_LINE_PARSER_H
+#define AVS_COMMONS_HTTP_LINE_PARSER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+VISIBILITY_PRIVATE_HEADER_BEGIN
+
+/**
+ * Incremental parser splitting HTTP headline and header data into lines.
+ *
+ * Input is fed in arbitrary chunks, e.g. directly from the receive buffer of
+ * the underlying stream. Lines contained entirely in a single chunk are
+ * returned in place, without copying. Only lines split between chunks are
+ * assembled in the parser's buffer. The parser keeps all the state between
+ * calls, so it may be fed with whatever data is available at the moment.
+ */
+typedef struct {
+    char *buf;
+    size_t buf_size;
+    size_t buf_len;
+    /* a too long line is being skipped up to its terminator */
+    bool discarding;
+} http_line_parser_t;
+
+typedef enum {
+    /* all data has been consumed, the line is not complete yet */
+    HTTP_LINE_PARSER_NEED_MORE,
+    /* a complete line is available */
+    HTTP_LINE_PARSER_LINE,
+    /* a line that does not fit in the buffer has been encountered; its
+     * beginning is available and the rest will be silently skipped */
+    HTTP_LINE_PARSER_LINE_TOO_LONG
+} http_line_parser_result_t;
+
+/**
+ * Line, without the terminating '\n' or "\r\n". NOT null-terminated.
+ */
+typedef struct {
+    const char *data;
+    size_t size;
+} http_line_t;
+
+/**
+ * Key and value of a header line, pointing into the line they were split from.
+ * The value has leading whitespace removed.
+ */
+typedef struct {
+    const char *key;
+    size_t key_len;
+    const char *value;
+    size_t value_len;
+} http_header_span_t;
+
+/**
+ * Initializes @p parser to use @p buf as storage for lines split between input
+ * chunks. Lines longer than <c>buf_size - 1</c> bytes are reported as too long,
+ * so that any returned line can be null-terminated when copied into @p buf.
+ */
+void _avs_http_line_parser_init(http_line_parser_t *parser,
+                                char *buf,
+                                size_t buf_size);
+
+/**
+ * Feeds the parser with @p size bytes at @p data .
+ *
+ * @param[out] out_consumed Number of bytes of @p data processed. The rest shall
+ *                          be fed again in the next call.
+ *
+ * @param[out] out_line     Set if HTTP_LINE_PARSER_LINE or
+ *                          HTTP_LINE_PARSER_LINE_TOO_LONG is returned. Points
+ *                          either into @p data or into the parser's buffer,
+ *                          and remains valid until the next call.
+ */
+http_line_parser_result_t
+_avs_http_line_parser_feed(http_line_parser_t *parser,
+                           const char *data,
+                           size_t size,
+                           size_t *out_consumed,
+                           http_line_t *out_line);
+
+/**
+ * Returns true if the parser is in the middle of a line.
+ */
+static inline bool
+_avs_http_line_parser_has_partial_line(const http_line_parser_t *parser) {
+    return parser->buf_len || parser->discarding;
+}
+
+/**
+ * Splits @p line at the first colon. Returns false if there is no colon.
+ */
+bool _avs_http_split_header(const http_line_t *line,
+                            http_header_span_t *out_header);
+
+VISIBILITY_PRIVATE_HEADER_END
+
+#endif /* AVS_COMMONS_HTTP_LINE_PARSER_H */
@@ -0,0 +1,186 @@
+/*
+ * Copyright 2023 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <avs_commons_init.h>
+
+#ifdef AVS_COMMONS_WITH_AVS_HTTP
+
+#    include <string.h>
+
+#    include <avsystem/commons/avs_errno.h>
+
+#    include "avs_body_receivers.h"
+#    include "avs_headers.h"
+#    include "avs_http_stream.h"
+
+#    include "avs_http_log.h"
+
+VISIBILITY_SOURCE_BEGIN
+
+static void free_request(AVS_LIST(http_pipelined_request_t) *request_ptr) {
+    AVS_LIST_CLEAR(&(*request_ptr)->user_headers);
+    AVS_LIST_DELETE(request_ptr);
+}
+
+void _avs_http_pipeline_clear(http_stream_t *stream) {
+    while (stream->pipeline) {
+        free_request(&stream->pipeline);
+    }
+}
+
+static int copy_header(AVS_LIST(http_header_t) **tail_ptr,
+                       const http_header_t *header) {
+    size_t key_size = strlen(header->key) + 1;
+    size_t value_size = strlen(header->value) + 1;
+    AVS_LIST(http_header_t) copy =
+            (AVS_LIST(http_header_t)) AVS_LIST_NEW_BUFFER(
+                    sizeof(http_header_t) + key_size + value_size);
+    if (!copy) {
+        return -1;
+    }
+    char *key = (char *) copy + sizeof(http_header_t);
+    char *value = key + key_size;
+    memcpy(key, header->key, key_size);
+    memcpy(value, header->value, value_size);
+    copy->key = key;
+    copy->value = value;
+    AVS_LIST_INSERT(*tail_ptr, copy);
+    *tail_ptr = AVS_LIST_NEXT_PTR(*tail_ptr);
+    return 0;
+}
+
+static AVS_LIST(http_pipelined_request_t)
+new_request(http_stream_t *stream, const void *body, size_t body_size) {
+    AVS_LIST(http_pipelined_request_t) request =
+            (AVS_LIST(http_pipelined_request_t)) AVS_LIST_NEW_BUFFER(
+                    sizeof(http_pipelined_request_t) + body_size);
+    if (!request) {
+        return NULL;
+    }
+    AVS_LIST(http_header_t) *tail_ptr = &request->user_headers;
+    const http_header_t *header;
+    AVS_LIST_FOREACH(header, stream->user_headers) {
+        if (copy_header(&tail_ptr, header)) {
+            free_request(&request);
+            return NULL;
+        }
+    }
+    request->body_size = body_size;
+    if (body_size) {
+        memcpy(request->body, body, body_size);
+    }
+    return request;
+}
+
+static avs_error_t send_request(http_stream_t *stream,
+                                const http_pipelined_request_t *request) {
+    /* _avs_http_send_headers() always sends stream->user_headers */
+    AVS_LIST(http_header_t) user_headers = stream->user_headers;
+    stream->user_headers = request->user_headers;
+    avs_error_t err;
+    (void) (avs_is_err((err = _avs_http_send_headers(stream,
+                                                     request->body_size)))
+            || avs_is_err((err = avs_stream_write(stream->backend,
+                                                  request->body,
+                                                  request->body_size)))
+            || avs_is_err((err = avs_stream_finish_message(stream->backend))));
+    stream->user_headers = user_headers;
+    return err;
+}
+
+/**
+ * Prepares the stream for sending. If that involves reconnecting, the requests
+ * that have not been responded to yet are sent again on the new connection.
+ */
+static avs_error_t prepare_for_sending(http_stream_t *stream) {
+    bool reconnecting = !stream->flags.keep_connection;
+    avs_error_t err = _avs_http_prepare_for_sending(stream);
+    if (avs_is_err(err) || !reconnecting || !stream->pipeline) {
+        return err;
+    }
+    LOG(DEBUG, _("resending ") "%lu" _(" pipelined requests"),
+        (unsigned long) AVS_LIST_SIZE(stream->pipeline));
+    const http_pipelined_request_t *request;
+    AVS_LIST_FOREACH(request, stream->pipeline) {
+        if (avs_is_err((err = send_request(stream, request)))) {
+            return err;
+        }
+    }
+    return AVS_OK;
+}
+
+avs_error_t _avs_http_pipeline_send(http_stream_t *stream,
+                                    const void *body,
+                                    size_t body_size) {
+    LOG(TRACE, _("http_pipeline_send, body_size == ") "%lu",
+        (unsigned long) body_size);
+    AVS_LIST(http_pipelined_request_t) request =
+            new_request(stream, body, body_size);
+    if (!request) {
+        LOG(ERROR, _("Out of memory"));
+        return avs_errno(AVS_ENOMEM);
+    }
+    stream->auth.state.flags.retried = 0;
+    avs_error_t err;
+    do {
+        if (avs_is_err((err = prepare_for_sending(stream)))
+                || avs_is_err((err = send_request(stream, request)))) {
+            _avs_http_maybe_schedule_retry_after_send(stream, err);
+        }
+    } while (avs_is_err(err) && stream->flags.should_retry);
+    if (avs_is_err(err)) {
+        free_request(&request);
+        return err;
+    }
+    AVS_LIST_APPEND(&stream->pipeline, request);
+    AVS_LIST_CLEAR(&stream->user_headers);
+    return AVS_OK;
+}
+
+avs_error_t _avs_http_pipeline_receive(http_stream_t *stream) {
+    LOG(TRACE, _("http_pipeline_receive"));
+    if (!stream->pipeline) {
+        LOG(ERROR, _("no pipelined requests to receive responses for"));
+        return avs_errno(AVS_ENOENT);
+    }
+    if (stream->body_receiver) {
+        if (!_avs_http_body_receiver_finished(stream->body_receiver)) {
+            LOG(ERROR, _("previous response has not been read yet"));
+            return avs_errno(AVS_EBUSY);
+        }
+        avs_stream_cleanup(&stream->body_receiver);
+        stream->flags.close_handling_required = 1;
+    }
+    avs_error_t err;
+    while (avs_is_err((err = _avs_http_receive_headers(stream)))
+           && stream->flags.should_retry && stream->status == 399) {
+        /* the server closed the connection without responding; all the
+         * requests that have not been responded to need to be sent again */
+        if (avs_is_err((err = prepare_for_sending(stream)))) {
+            return err;
+        }
+    }
+    if (avs_is_ok(err) || err.category == AVS_HTTP_ERROR_CATEGORY) {
+        free_request(&stream->pipeline);
+    }
+    return err;
+}
+
+#    ifdef AVS_UNIT_TESTING
+#        include "tests/http/test_pipelining.c"
+#    endif
+
+#endif // AVS_COMMONS_WITH_AVS_HTTP
@@ -27,6 +27,7 @@
 #    include <avsystem/commons/avs_stream_netbuf.h>
 #    include <avsystem/commons/avs_time.h>
 
+#    include "avs_body_receivers.h"
 #    include "avs_client.h"
 #    include "avs_content_encoding.h"
 #    include "avs_http_stream.h"
@@ -231,8 +232,10 @@ http_peek(avs_stream_t *stream_, size_t offset, char *out_value) {
 static avs_error_t http_reset(avs_stream_t *stream_) {
     http_stream_t *stream = (http_stream_t *) stream_;
     LOG(TRACE, _("http_reset"));
-    bool keep_connection =
-            (stream->flags.keep_connection && !stream->flags.chunked_sending);
+    /* responses to pipelined requests would arrive on a reused connection */
+    bool keep_connection = (stream->flags.keep_connection
+                            && !stream->flags.chunked_sending
+                            && !stream->pipeline);
     bool close_handling_required = false;
     if (keep_connection && stream->body_receiver) {
         if (avs_is_err(avs_stream_ignore_to_end(stream->body_receiver))) {
@@ -251,6 +254,7 @@ static avs_error_t http_reset(avs_stream_t *stream_) {
         stream->flags.close_handling_required = 1;
     }
     avs_stream_cleanup(&stream->body_receiver);
+    _avs_http_pipeline_clear(stream);
     stream->out_buffer_pos = 0;
     stream->status = 0;
     AVS_LIST_CLEAR(&stream->user_headers);
@@ -263,8 +267,32 @@ static avs_error_t http_reset(avs_stream_t *stream_) {
     return backend_err;
 }
 
+/**
+ * Returns the connection to the pool of the HTTP client if it can be reused by
+ * another stream, i.e. if the last response has been received completely.
+ */
+static void release_connection(http_stream_t *stream) {
+    /* only connections after a complete exchange may be reused */
+    if (!stream->http->pool_max_idle_per_host || !stream->flags.keep_connection
+            || stream->flags.chunked_sending || !stream->status
+            || stream->pipeline) {
+        return;
+    }
+    // http_close() must not block, so the body receiver is not read from;
+    // connections with an unfinished or undetermined body are not reused
+    if (stream->body_receiver
+            && !_avs_http_body_receiver_finished(stream->body_receiver)) {
+        return;
+    }
+    avs_net_socket_t *socket = avs_stream_net_getsock(stream->backend);
+    if (socket && avs_is_ok(avs_stream_net_setsock(stream->backend, NULL))) {
+        _avs_http_pool_checkin(stream->http, stream->url, &socket);
+    }
+}
+
 static avs_error_t http_close(avs_stream_t *stream_) {
     http_stream_t *stream = (http_stream_t *) stream_;
+    release_connection(stream);
     stream->flags.keep_connection = false;
     avs_error_t reset_err = http_reset(stream_);
     LOG(TRACE, _("http_close"));
@@ -353,6 +381,66 @@ int avs_http_should_retry(avs_stream_t *stream_) {
     return (int) stream->flags.should_retry;
 }
 
+/**
+ * Data received past the end of a response body is transferred back to the
+ * backend, so its input buffer needs to be as large as the body receiver's.
+ */
+static int enlarge_backend_in_buffer(http_stream_t *stream) {
+    const avs_http_buffer_sizes_t *buffer_sizes = &stream->http->buffer_sizes;
+    if (buffer_sizes->recv_shaper >= buffer_sizes->body_recv) {
+        return 0;
+    }
+    avs_stream_t *backend = NULL;
+    if (avs_stream_netbuf_create(&backend,
+                                 avs_stream_net_getsock(stream->backend),
+                                 buffer_sizes->body_recv,
+                                 buffer_sizes->send_shaper)) {
+        LOG(ERROR, _("error creating buffered netstream"));
+        return -1;
+    }
+    if (avs_stream_netbuf_transfer(backend, stream->backend)) {
+        avs_stream_net_setsock(backend, NULL); /* don't close the socket */
+        avs_stream_cleanup(&backend);
+        return -1;
+    }
+    avs_stream_net_setsock(stream->backend, NULL); /* don't close the socket */
+    avs_stream_cleanup(&stream->backend);
+    stream->backend = backend;
+    return 0;
+}
+
+int avs_http_set_pipelining(avs_stream_t *stream_, bool enabled) {
+    http_stream_t *stream = (http_stream_t *) stream_;
+    assert(stream->vtable == &http_vtable);
+    LOG(TRACE, _("http_set_pipelining: ") "%d", (int) enabled);
+    if (enabled == stream->pipelining) {
+        return 0;
+    }
+    if (stream->pipeline || stream->body_receiver
+            || stream->flags.chunked_sending) {
+        LOG(ERROR, _("cannot change pipelining mode in the middle of an "
+                     "exchange"));
+        return -1;
+    }
+    if (enabled && enlarge_backend_in_buffer(stream)) {
+        return -1;
+    }
+    stream->pipelining = enabled;
+    return 0;
+}
+
+avs_error_t avs_http_receive_response(avs_stream_t *stream_) {
+    http_stream_t *stream = (http_stream_t *) stream_;
+    assert(stream->vtable == &http_vtable);
+    return _avs_http_pipeline_receive(stream);
+}
+
+size_t avs_http_pending_responses(avs_stream_t *stream_) {
+    http_stream_t *stream = (http_stream_t *) stream_;
+    assert(stream->vtable == &http_vtable);
+    return AVS_LIST_SIZE(stream->pipeline);
+}
+
 static inline const char *string_or_null(const char *str) {
     return str ? str : "(null)";
 }
@@ -409,7 +497,10 @@ avs_error_t avs_http_open_stream(avs_stream_t **out,
         goto http_open_stream_error;
     }
 
-    if (avs_is_err((err = _avs_http_socket_new(&socket, http, url)))) {
+    if ((socket = _avs_http_pool_checkout(http, url))) {
+        /* the server might have closed a pooled connection in the meantime */
+        stream->flags.close_handling_required = 1;
+    } else if (avs_is_err((err = _avs_http_socket_new(&socket, http, url)))) {
         goto http_open_stream_error;
     }
 
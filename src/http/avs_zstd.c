@@ -0,0 +1,102 @@
+/*
+ * Copyright 2023 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// NOTE: library headers may contain some of the symbols poisoned via inclusion
+// of avs_commons_init.h. Therefore they must be included before poison.
+#define AVS_SUPPRESS_POISONING
+#include <avs_commons_init.h>
+
+#if defined(AVS_COMMONS_WITH_AVS_HTTP) && defined(AVS_COMMONS_HTTP_WITH_ZSTD)
+
+#    include <zstd.h>
+
+#    include <avs_commons_poison.h>
+
+#    include "avs_decompressor.h"
+
+#    include "avs_http_log.h"
+
+VISIBILITY_SOURCE_BEGIN
+
+/**
+ * Largest window accepted, as log2 of its size. RFC 9659 requires decoders of
+ * the "zstd" content coding to support windows of up to 8 MB, and allows
+ * rejecting larger ones. Without a limit, the library would accept windows of
+ * up to 128 MB, which need to be allocated in full.
+ */
+#    define ZSTD_WINDOW_LOG_MAX 23
+
+static void zstd_destroy(void *state) {
+    ZSTD_freeDCtx((ZSTD_DCtx *) state);
+}
+
+static void *zstd_create(void) {
+    ZSTD_DCtx *dctx = ZSTD_createDCtx();
+    if (dctx
+            && ZSTD_isError(ZSTD_DCtx_setParameter(dctx, ZSTD_d_windowLogMax,
+                                                   ZSTD_WINDOW_LOG_MAX))) {
+        zstd_destroy(dctx);
+        return NULL;
+    }
+    return dctx;
+}
+
+static http_decompressor_result_t zstd_decompress(void *state,
+                                                  const uint8_t **inout_next_in,
+                                                  size_t *inout_avail_in,
+                                                  uint8_t **inout_next_out,
+                                                  size_t *inout_avail_out) {
+    ZSTD_inBuffer in = { *inout_next_in, *inout_avail_in, 0 };
+    ZSTD_outBuffer out = { *inout_next_out, *inout_avail_out, 0 };
+    size_t result = ZSTD_decompressStream((ZSTD_DCtx *) state, &out, &in);
+    *inout_next_in += in.pos;
+    *inout_avail_in -= in.pos;
+    *inout_next_out += out.pos;
+    *inout_avail_out -= out.pos;
+    if (ZSTD_isError(result)) {
+        LOG(ERROR, _("zstd decompression error: ") "%s",
+            ZSTD_getErrorName(result));
+        return HTTP_DECOMPRESSOR_ERROR;
+    }
+    if (!result) {
+        /* a frame has been fully decoded and flushed; any further frames are
+         * not supported */
+        return HTTP_DECOMPRESSOR_FINISHED;
+    }
+    if (!*inout_avail_in && *inout_avail_out) {
+        /* the output buffer not being full means that everything that could
+         * have been decoded so far has been flushed */
+        return HTTP_DECOMPRESSOR_NEED_INPUT;
+    }
+    return HTTP_DECOMPRESSOR_OK;
+}
+
+static int zstd_reset(void **state_ptr) {
+    return ZSTD_isError(ZSTD_DCtx_reset((ZSTD_DCtx *) *state_ptr,
+                                        ZSTD_reset_session_only))
+                   ? -1
+                   : 0;
+}
+
+const http_decompressor_ops_t _AVS_HTTP_ZSTD_DECOMPRESSOR = {
+    .create = zstd_create,
+    .decompress = zstd_decompress,
+    .reset = zstd_reset,
+    .destroy = zstd_destroy
+};
+
+#endif // defined(AVS_COMMONS_WITH_AVS_HTTP) &&
+       // defined(AVS_COMMONS_HTTP_WITH_ZSTD)
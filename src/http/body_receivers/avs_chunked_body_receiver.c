@@ -34,6 +34,7 @@ VISIBILITY_SOURCE_BEGIN
 typedef struct {
     const avs_stream_v_table_t *const vtable;
     avs_stream_t *backend;
+    avs_stream_t *origin;
     const avs_http_buffer_sizes_t *buffer_sizes;
     size_t chunk_left;
     bool finished;
@@ -106,6 +107,9 @@ static avs_error_t read_chunk_size_getline_reader(void *state,
                               buffer_length);
 }
 
+/*
+ * Note: if buffer is NULL, the data is discarded instead of being read.
+ */
 static avs_error_t chunked_read(avs_stream_t *stream_,
                                 size_t *out_bytes_read,
                                 bool *out_message_finished,
@@ -137,9 +141,15 @@ static avs_error_t chunked_read(avs_stream_t *stream_,
             return err;
         }
     }
-    err = avs_stream_read(stream->backend, out_bytes_read,
-                          &backend_message_finished, buffer,
-                          AVS_MIN(buffer_length, stream->chunk_left));
+    if (buffer) {
+        err = avs_stream_read(stream->backend, out_bytes_read,
+                              &backend_message_finished, buffer,
+                              AVS_MIN(buffer_length, stream->chunk_left));
+    } else {
+        err = avs_stream_skip(stream->backend, out_bytes_read,
+                              &backend_message_finished,
+                              AVS_MIN(buffer_length, stream->chunk_left));
+    }
     stream->chunk_left -= *out_bytes_read;
     if (avs_is_ok(err) && backend_message_finished) {
         LOG(ERROR, _("unexpected end of stream"));
@@ -152,6 +162,14 @@ static avs_error_t chunked_read(avs_stream_t *stream_,
     return AVS_OK;
 }
 
+static avs_error_t chunked_skip(avs_stream_t *stream,
+                                size_t *out_bytes_skipped,
+                                bool *out_message_finished,
+                                size_t size) {
+    return chunked_read(stream, out_bytes_skipped, out_message_finished, NULL,
+                        size);
+}
+
 static bool chunked_nonblock_read_ready(avs_stream_t *stream) {
     // This is somewhat inaccurate. If there is a packet boundary somewhere
     // *within* the chunk header, then the next read operation might indeed
@@ -202,10 +220,14 @@ chunked_peek(avs_stream_t *stream_, size_t offset, char *out_value) {
     return avs_stream_peek(stream->backend, offset, out_value);
 }
 
+static bool chunked_finished(avs_stream_t *stream) {
+    return ((chunked_receiver_t *) stream)->finished;
+}
+
 static avs_error_t chunked_close(avs_stream_t *stream_) {
     chunked_receiver_t *stream = (chunked_receiver_t *) stream_;
-    avs_stream_net_setsock(stream->backend, NULL); /* don't close the socket */
-    return avs_stream_cleanup(&stream->backend);
+    return _avs_http_body_receiver_close_backend(
+            &stream->backend, stream->finished ? stream->origin : NULL);
 }
 
 static const avs_stream_v_table_t chunked_receiver_vtable = {
@@ -220,11 +242,27 @@ static const avs_stream_v_table_t chunked_receiver_vtable = {
                               .read_ready = chunked_nonblock_read_ready
                           }
                       }[0] },
+            { AVS_STREAM_V_TABLE_EXTENSION_SKIP,
+              &(avs_stream_v_table_extension_skip_t[])
+                      {
+                          {
+                              .skip = chunked_skip
+                          }
+                      }[0] },
+            { HTTP_BODY_RECEIVER_V_TABLE_EXTENSION,
+              &(http_body_receiver_v_table_extension_t[])
+                      {
+                          {
+                              .finished = chunked_finished
+                          }
+                      }[0] },
             AVS_STREAM_V_TABLE_EXTENSION_NULL }[0]
 };
 
 avs_stream_t *_avs_http_body_receiver_chunked_create(
-        avs_stream_t *backend, const avs_http_buffer_sizes_t *buffer_sizes) {
+        avs_stream_t *backend,
+        avs_stream_t *origin,
+        const avs_http_buffer_sizes_t *buffer_sizes) {
     chunked_receiver_t *retval =
             (chunked_receiver_t *) avs_calloc(1, sizeof(*retval));
     LOG(TRACE, _("create_content_length_receiver"));
@@ -232,6 +270,7 @@ avs_stream_t *_avs_http_body_receiver_chunked_create(
         *(const avs_stream_v_table_t **) (intptr_t) &retval->vtable =
                 &chunked_receiver_vtable;
         retval->backend = backend;
+        retval->origin = origin;
         retval->buffer_sizes = buffer_sizes;
     }
     return (avs_stream_t *) retval;
@@ -30,9 +30,13 @@ VISIBILITY_SOURCE_BEGIN
 typedef struct {
     const avs_stream_v_table_t *const vtable;
     avs_stream_t *backend;
+    avs_stream_t *origin;
     size_t content_left;
 } content_length_receiver_t;
 
+/*
+ * Note: if buffer is NULL, the data is discarded instead of being read.
+ */
 static avs_error_t content_length_read(avs_stream_t *stream_,
                                        size_t *out_bytes_read,
                                        bool *out_message_finished,
@@ -46,10 +50,14 @@ static avs_error_t content_length_read(avs_stream_t *stream_,
     if (!out_bytes_read) {
         out_bytes_read = &bytes_read;
     }
-    if (bytes_to_read) {
+    if (bytes_to_read && buffer) {
         err = avs_stream_read(stream->backend, out_bytes_read,
                               &backend_message_finished, buffer, bytes_to_read);
         stream->content_left -= *out_bytes_read;
+    } else if (bytes_to_read) {
+        err = avs_stream_skip(stream->backend, out_bytes_read,
+                              &backend_message_finished, bytes_to_read);
+        stream->content_left -= *out_bytes_read;
     } else {
         *out_bytes_read = 0;
     }
@@ -64,6 +72,14 @@ static avs_error_t content_length_read(avs_stream_t *stream_,
     return err;
 }
 
+static avs_error_t content_length_skip(avs_stream_t *stream,
+                                       size_t *out_bytes_skipped,
+                                       bool *out_message_finished,
+                                       size_t size) {
+    return content_length_read(stream, out_bytes_skipped, out_message_finished,
+                               NULL, size);
+}
+
 static bool content_length_nonblock_read_ready(avs_stream_t *stream_) {
     content_length_receiver_t *stream = (content_length_receiver_t *) stream_;
     if (stream->content_left) {
@@ -82,10 +98,14 @@ content_length_peek(avs_stream_t *stream_, size_t offset, char *out_value) {
     }
 }
 
+static bool content_length_finished(avs_stream_t *stream) {
+    return !((content_length_receiver_t *) stream)->content_left;
+}
+
 static avs_error_t content_length_close(avs_stream_t *stream_) {
     content_length_receiver_t *stream = (content_length_receiver_t *) stream_;
-    avs_stream_net_setsock(stream->backend, NULL); /* don't close the socket */
-    return avs_stream_cleanup(&stream->backend);
+    return _avs_http_body_receiver_close_backend(
+            &stream->backend, stream->content_left ? NULL : stream->origin);
 }
 
 static const avs_stream_v_table_t content_length_receiver_vtable = {
@@ -100,11 +120,26 @@ static const avs_stream_v_table_t content_length_receiver_vtable = {
                               .read_ready = content_length_nonblock_read_ready
                           }
                       }[0] },
+            { AVS_STREAM_V_TABLE_EXTENSION_SKIP,
+              &(avs_stream_v_table_extension_skip_t[])
+                      {
+                          {
+                              .skip = content_length_skip
+                          }
+                      }[0] },
+            { HTTP_BODY_RECEIVER_V_TABLE_EXTENSION,
+              &(http_body_receiver_v_table_extension_t[])
+                      {
+                          {
+                              .finished = content_length_finished
+                          }
+                      }[0] },
             AVS_STREAM_V_TABLE_EXTENSION_NULL }[0]
 };
 
 avs_stream_t *
 _avs_http_body_receiver_content_length_create(avs_stream_t *backend,
+                                              avs_stream_t *origin,
                                               size_t content_length) {
     content_length_receiver_t *retval =
             (content_length_receiver_t *) avs_malloc(sizeof(*retval));
@@ -113,6 +148,7 @@ _avs_http_body_receiver_content_length_create(avs_stream_t *backend,
         *(const avs_stream_v_table_t **) (intptr_t) &retval->vtable =
                 &content_length_receiver_vtable;
         retval->backend = backend;
+        retval->origin = origin;
         retval->content_left = content_length;
     }
     return (avs_stream_t *) retval;
@@ -42,6 +42,14 @@ static avs_error_t dumb_proxy_read(avs_stream_t *stream,
                            buffer_length);
 }
 
+static avs_error_t dumb_proxy_skip(avs_stream_t *stream,
+                                   size_t *out_bytes_skipped,
+                                   bool *out_message_finished,
+                                   size_t size) {
+    return avs_stream_skip(((dumb_proxy_receiver_t *) stream)->backend,
+                           out_bytes_skipped, out_message_finished, size);
+}
+
 static bool dumb_proxy_nonblock_read_ready(avs_stream_t *stream) {
     return avs_stream_nonblock_read_ready(
             ((dumb_proxy_receiver_t *) stream)->backend);
@@ -71,6 +79,13 @@ static const avs_stream_v_table_t dumb_body_receiver_vtable = {
                               .read_ready = dumb_proxy_nonblock_read_ready
                           }
                       }[0] },
+            { AVS_STREAM_V_TABLE_EXTENSION_SKIP,
+              &(avs_stream_v_table_extension_skip_t[])
+                      {
+                          {
+                              .skip = dumb_proxy_skip
+                          }
+                      }[0] },
             AVS_STREAM_V_TABLE_EXTENSION_NULL }[0]
 };
 
@@ -20,11 +20,14 @@
 #if defined(AVS_COMMONS_WITH_AVS_LOG) \
         && !defined(AVS_COMMONS_WITH_EXTERNAL_LOGGER_HEADER)
 
+#    include <assert.h>
 #    include <stdarg.h>
+#    include <stddef.h>
+#    include <limits.h>
+#    include <stdint.h>
 #    include <stdio.h>
 #    include <string.h>
 
-#    include <avsystem/commons/avs_list.h>
 #    include <avsystem/commons/avs_log.h>
 
 #    ifdef AVS_COMMONS_WITH_AVS_COMPAT_THREADING
@@ -32,6 +35,21 @@
 #        include <avsystem/commons/avs_mutex.h>
 #    endif // AVS_COMMONS_WITH_AVS_COMPAT_THREADING
 
+#    include <avsystem/commons/avs_memory.h>
+
+#    if defined(AVS_COMMONS_WITH_AVS_COMPAT_THREADING) \
+            && defined(AVS_COMMONS_HAVE_C11_STDATOMIC)
+#        define AVS_LOG_WITH_ASYNC
+#        include <stdatomic.h>
+
+#        include <avsystem/commons/avs_condvar.h>
+#        include <avsystem/commons/avs_time.h>
+
+#        ifndef AVS_COMMONS_WITHOUT_LOG_CHECK_IN_RUNTIME
+#            define AVS_LOG_LOCK_FREE_LEVELS
+#        endif // AVS_COMMONS_WITHOUT_LOG_CHECK_IN_RUNTIME
+#    endif
+
 VISIBILITY_SOURCE_BEGIN
 
 static void default_log_handler(avs_log_level_t level,
@@ -47,12 +65,143 @@ static void default_log_handler(avs_log_level_t level,
 }
 
 #    ifndef AVS_COMMONS_WITHOUT_LOG_CHECK_IN_RUNTIME
+#        ifdef AVS_LOG_LOCK_FREE_LEVELS
+/**
+ * Snapshots are published as atomic integers; these are available as plain
+ * typedefs in <c>stdatomic.h</c>, so that no C11 syntax needs to be used here.
+ * NULL stands for the default configuration (INFO, no per-module levels).
+ *
+ * Readers perform a single acquire load of the snapshot pointer, and never
+ * announce themselves, so a replaced snapshot may be in use at any time until
+ * _avs_log_cleanup_global_state(). Levels are thus stored in atomic slots that
+ * are updated in place, and a new snapshot is only published when a module is
+ * added, which bounds the number of retired snapshots by the number of
+ * distinct modules ever configured.
+ */
+typedef atomic_uintptr_t log_levels_ptr_t;
+typedef atomic_int log_level_slot_t;
+
+#            define LEVELS_LOAD(Ptr) \
+                ((log_levels_t *) atomic_load_explicit((Ptr), \
+                                                       memory_order_acquire))
+#            define LEVELS_STORE(Ptr, Value) \
+                atomic_store_explicit((Ptr), (uintptr_t) (Value), \
+                                      memory_order_release)
+#            define LEVEL_SLOT_INIT(Ptr, Value) atomic_init((Ptr), (Value))
+#            define LEVEL_SLOT_LOAD(Ptr) \
+                atomic_load_explicit((Ptr), memory_order_relaxed)
+#            define LEVEL_SLOT_STORE(Ptr, Value) \
+                atomic_store_explicit((Ptr), (Value), memory_order_relaxed)
+#        else // AVS_LOG_LOCK_FREE_LEVELS
+typedef struct log_levels_struct *log_levels_ptr_t;
+typedef int log_level_slot_t;
+
+#            define LEVELS_LOAD(Ptr) (*(Ptr))
+#            define LEVELS_STORE(Ptr, Value) (*(Ptr) = (Value))
+#            define LEVEL_SLOT_INIT(Ptr, Value) (*(Ptr) = (Value))
+#            define LEVEL_SLOT_LOAD(Ptr) (*(Ptr))
+#            define LEVEL_SLOT_STORE(Ptr, Value) (*(Ptr) = (Value))
+#        endif // AVS_LOG_LOCK_FREE_LEVELS
+
+/**
+ * Value of a module's level slot meaning that the default level applies, e.g.
+ * after avs_log_reset().
+ */
+#        define LEVEL_UNSET (-1)
+
 typedef struct {
-    avs_log_level_t level;
-    char module[1];
+    uint32_t hash;
+    log_level_slot_t level;
+    const char *module;
 } module_level_t;
+
+/**
+ * Snapshot of log level configuration, inspected by avs_log_should_log__()
+ * without locking. The set of modules in a snapshot is immutable; adding
+ * a module builds and publishes a new snapshot, while levels of modules that
+ * are already present are updated in place.
+ *
+ * Module names are stored in a single allocation, directly after the
+ * @ref log_levels_t::modules array, which is sorted by module name hash, and
+ * then by strcmp() on module names. Thanks to that, a lookup usually performs
+ * only a single string comparison.
+ */
+typedef struct log_levels_struct {
+    struct log_levels_struct *retired_next;
+    log_level_slot_t default_level;
+    size_t module_count;
+    module_level_t modules[];
+} log_levels_t;
 #    endif /* AVS_COMMONS_WITHOUT_LOG_CHECK_IN_RUNTIME */
 
+#    ifdef AVS_LOG_WITH_ASYNC
+#        define ASYNC_DEFAULT_QUEUE_SIZE 64
+#        define ASYNC_MAX_QUEUE_SIZE 65536
+
+typedef struct {
+    /**
+     * Vyukov-style sequence number: equal to the enqueue position if the slot
+     * is free, and to the enqueue position + 1 if it holds a published record.
+     */
+    atomic_size_t seq;
+    avs_log_level_t level;
+    const char *module;
+    const char *file;
+    unsigned line;
+    /**
+     * Format string of a record queued with deferred formatting, or NULL if
+     * @ref message contains an already formatted message.
+     */
+    const char *format;
+    /**
+     * Number of bytes of @ref message occupied by encoded arguments of
+     * @ref format.
+     */
+    size_t args_size;
+    char message[AVS_COMMONS_LOG_MAX_LINE_LENGTH];
+} log_async_record_t;
+
+/**
+ * Bounded multi-producer, single-consumer queue of formatted log records.
+ *
+ * Enqueueing is lock-free. The consumer role is guarded by @ref mutex: it is
+ * held by whichever thread delivers records to the log handler, be it
+ * avs_log_async_run(), avs_log_async_flush() or a producer that found the
+ * queue full under @ref AVS_LOG_ASYNC_OVERFLOW_BLOCK policy.
+ */
+typedef struct log_async_struct {
+    struct log_async_struct *retired_next;
+    avs_log_async_overflow_policy_t overflow_policy;
+    bool deferred_formatting;
+    avs_log_binary_writer_t *binary_writer;
+    void *binary_writer_arg;
+    size_t mask;
+
+    avs_mutex_t *mutex;
+    /**
+     * Notified when new records are available for a sleeping consumer, when
+     * the last producer leaves a disabled queue, and when the queue is stopped.
+     */
+    avs_condvar_t *condvar;
+    /* fields below are guarded by mutex */
+    size_t dequeue_pos;
+    size_t reported_dropped;
+    bool stopping;
+
+    atomic_bool disabled;
+    /**
+     * Number of consumers waiting on @ref condvar for the oldest record to be
+     * published.
+     */
+    atomic_size_t consumers_sleeping;
+    atomic_size_t producers;
+    atomic_size_t dropped;
+    atomic_size_t enqueue_pos;
+
+    log_async_record_t records[];
+} log_async_t;
+#    endif // AVS_LOG_WITH_ASYNC
+
 static struct {
     union {
         avs_log_handler_t *normal;
@@ -60,27 +209,66 @@ static struct {
     } handler;
     bool is_extended_handler;
 #    ifndef AVS_COMMONS_WITHOUT_LOG_CHECK_IN_RUNTIME
-    avs_log_level_t default_level;
-    AVS_LIST(module_level_t) module_levels;
+    log_levels_ptr_t levels;
+#        ifdef AVS_LOG_LOCK_FREE_LEVELS
+    /**
+     * Snapshots replaced while other threads might still be reading them.
+     * Reclaimed in _avs_log_cleanup_global_state().
+     */
+    log_levels_t *retired_levels;
+#        endif // AVS_LOG_LOCK_FREE_LEVELS
 #    endif /* AVS_COMMONS_WITHOUT_LOG_CHECK_IN_RUNTIME */
+#    ifdef AVS_LOG_WITH_ASYNC
+    /**
+     * Currently enabled asynchronous logging queue, or NULL in synchronous
+     * mode.
+     */
+    atomic_uintptr_t async;
+    /** Number of threads that might currently hold a pointer to a queue. */
+    atomic_size_t async_users;
+    /**
+     * Disabled queues that other threads might still be using. Reclaimed on
+     * the next call to avs_log_async_enable() or avs_log_async_disable() that
+     * happens while there are no users, or in _avs_log_cleanup_global_state().
+     */
+    log_async_t *retired_async;
+    /** Number of messages dropped by the most recently disabled queue. */
+    size_t async_dropped;
+#    endif // AVS_LOG_WITH_ASYNC
 #    ifdef AVS_COMMONS_LOG_USE_GLOBAL_BUFFER
     char buffer[AVS_COMMONS_LOG_MAX_LINE_LENGTH];
 #    endif // AVS_COMMONS_LOG_USE_GLOBAL_BUFFER
 } g_log = {
-    .handler.normal = default_log_handler,
-#    ifndef AVS_COMMONS_WITHOUT_LOG_CHECK_IN_RUNTIME
-    .default_level = AVS_LOG_INFO,
-    .module_levels = NULL
-#    endif /* AVS_COMMONS_WITHOUT_LOG_CHECK_IN_RUNTIME */
+    .handler.normal = default_log_handler
 };
 
 #    ifdef AVS_COMMONS_WITH_AVS_COMPAT_THREADING
 static avs_mutex_t *g_log_mutex;
 static avs_init_once_handle_t g_log_init_handle;
 
+#        ifdef AVS_LOG_WITH_ASYNC
+static void async_free(log_async_t *async);
+#        endif // AVS_LOG_WITH_ASYNC
+
 void _avs_log_cleanup_global_state(void);
 void _avs_log_cleanup_global_state(void) {
     avs_log_reset();
+#        ifdef AVS_LOG_LOCK_FREE_LEVELS
+    avs_free(LEVELS_LOAD(&g_log.levels));
+    LEVELS_STORE(&g_log.levels, NULL);
+    while (g_log.retired_levels) {
+        log_levels_t *levels = g_log.retired_levels;
+        g_log.retired_levels = levels->retired_next;
+        avs_free(levels);
+    }
+#        endif // AVS_LOG_LOCK_FREE_LEVELS
+#        ifdef AVS_LOG_WITH_ASYNC
+    while (g_log.retired_async) {
+        log_async_t *async = g_log.retired_async;
+        g_log.retired_async = async->retired_next;
+        async_free(async);
+    }
+#        endif // AVS_LOG_WITH_ASYNC
     avs_mutex_cleanup(&g_log_mutex);
     g_log_init_handle = NULL;
 }
@@ -164,49 +352,214 @@ void avs_log_set_extended_handler(avs_log_extended_handler_t *log_handler) {
 }
 
 #    ifndef AVS_COMMONS_WITHOUT_LOG_CHECK_IN_RUNTIME
-static avs_log_level_t *level_for(const char *module, int create) {
-    if (module) {
-        AVS_LIST(module_level_t) *entry_ptr;
-        int cmp = 1;
-        AVS_LIST_FOREACH_PTR(entry_ptr, &g_log.module_levels) {
-            cmp = strcmp((*entry_ptr)->module, module);
-            if (cmp >= 0) {
-                break;
-            }
-        }
+/**
+ * 32-bit FNV-1a hash of the module name.
+ */
+static uint32_t module_hash(const char *module) {
+    uint32_t hash = 2166136261U;
+    for (; *module; ++module) {
+        hash ^= (uint8_t) *module;
+        hash *= 16777619U;
+    }
+    return hash;
+}
+
+static int module_cmp(const module_level_t *entry,
+                      uint32_t hash,
+                      const char *module) {
+    if (entry->hash != hash) {
+        return entry->hash < hash ? -1 : 1;
+    }
+    return strcmp(entry->module, module);
+}
+
+/**
+ * Binary search for @p module in @p levels. Returns the index of the matching
+ * entry if found, or a negated, 1-based insertion index otherwise.
+ */
+static ptrdiff_t
+find_module(const log_levels_t *levels, uint32_t hash, const char *module) {
+    size_t lo = 0;
+    size_t hi = levels->module_count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        int cmp = module_cmp(&levels->modules[mid], hash, module);
         if (cmp == 0) {
-            return &(*entry_ptr)->level;
-        } else if (create) {
-            size_t module_size = strlen(module);
-            module_level_t *new_entry = (module_level_t *) AVS_LIST_NEW_BUFFER(
-                    offsetof(module_level_t, module) + module_size + 1);
-            if (!new_entry) {
-                return NULL;
+            return (ptrdiff_t) mid;
+        } else if (cmp < 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return -(ptrdiff_t) lo - 1;
+}
+
+static avs_log_level_t level_for(const log_levels_t *levels,
+                                 const char *module) {
+    if (!levels) {
+        return AVS_LOG_INFO;
+    }
+    if (module && levels->module_count) {
+        ptrdiff_t index = find_module(levels, module_hash(module), module);
+        if (index >= 0) {
+            int level = LEVEL_SLOT_LOAD(&levels->modules[index].level);
+            if (level != LEVEL_UNSET) {
+                return (avs_log_level_t) level;
             }
-            new_entry->level = g_log.default_level;
-            memcpy(new_entry->module, module, module_size);
-            new_entry->module[module_size] = '\0';
-            AVS_LIST_INSERT(entry_ptr, new_entry);
-            return &new_entry->level;
         }
     }
-    return &g_log.default_level;
+    return (avs_log_level_t) LEVEL_SLOT_LOAD(&levels->default_level);
+}
+
+/**
+ * Creates a copy of @p base (which may be NULL, meaning the default
+ * configuration), with an entry for @p module , which must not be present in
+ * @p base , added if it is not NULL. The entry is initialized with
+ * @ref LEVEL_UNSET .
+ */
+static log_levels_t *levels_with_module(const log_levels_t *base,
+                                        const char *module) {
+    size_t base_count = base ? base->module_count : 0;
+    uint32_t hash = 0;
+    ptrdiff_t index = -1;
+    size_t new_count = base_count;
+    size_t names_size = 0;
+    if (module) {
+        hash = module_hash(module);
+        index = base ? find_module(base, hash, module) : -1;
+        assert(index < 0);
+        ++new_count;
+        names_size += strlen(module) + 1;
+    }
+    for (size_t i = 0; i < base_count; ++i) {
+        names_size += strlen(base->modules[i].module) + 1;
+    }
+
+    log_levels_t *result = (log_levels_t *) avs_malloc(
+            offsetof(log_levels_t, modules)
+            + new_count * sizeof(module_level_t) + names_size);
+    if (!result) {
+        return NULL;
+    }
+    result->retired_next = NULL;
+    LEVEL_SLOT_INIT(&result->default_level,
+                    base ? LEVEL_SLOT_LOAD(&base->default_level)
+                         : (int) AVS_LOG_INFO);
+    result->module_count = new_count;
+
+    char *name_ptr = (char *) &result->modules[new_count];
+    size_t insert_index = (size_t) (-index - 1);
+    for (size_t i = 0, src = 0; i < new_count; ++i) {
+        module_level_t *entry = &result->modules[i];
+        if (module && i == insert_index) {
+            entry->hash = hash;
+            LEVEL_SLOT_INIT(&entry->level, LEVEL_UNSET);
+            entry->module = module;
+        } else {
+            const module_level_t *base_entry = &base->modules[src++];
+            entry->hash = base_entry->hash;
+            LEVEL_SLOT_INIT(&entry->level,
+                            LEVEL_SLOT_LOAD(&base_entry->level));
+            entry->module = base_entry->module;
+        }
+        size_t name_size = strlen(entry->module) + 1;
+        memcpy(name_ptr, entry->module, name_size);
+        entry->module = name_ptr;
+        name_ptr += name_size;
+    }
+    return result;
+}
+
+#        ifdef __GNUC__
+#            define GENERATION_LOAD(Ptr) __atomic_load_n((Ptr), __ATOMIC_ACQUIRE)
+#            define GENERATION_STORE(Ptr, Value) \
+                __atomic_store_n((Ptr), (Value), __ATOMIC_RELEASE)
+#            define SITE_GENERATION_STORE(Ptr, Value) \
+                __atomic_store_n((Ptr), (Value), __ATOMIC_RELAXED)
+#        else // __GNUC__
+#            define GENERATION_LOAD(Ptr) (*(Ptr))
+#            define GENERATION_STORE(Ptr, Value) (*(Ptr) = (Value))
+#            define SITE_GENERATION_STORE(Ptr, Value) (*(Ptr) = (Value))
+#        endif // __GNUC__
+
+unsigned avs_log_generation__ = 1;
+
+static void invalidate_site_caches_unlocked(void) {
+    // zero is the initial value of per-site caches, so it is never used as
+    // a valid generation
+    unsigned generation = avs_log_generation__ + 1;
+    GENERATION_STORE(&avs_log_generation__, generation ? generation : 1);
+}
+
+static void publish_levels_unlocked(log_levels_t *levels) {
+    log_levels_t *old_levels = LEVELS_LOAD(&g_log.levels);
+    LEVELS_STORE(&g_log.levels, levels);
+    invalidate_site_caches_unlocked();
+#        ifdef AVS_LOG_LOCK_FREE_LEVELS
+    if (old_levels) {
+        old_levels->retired_next = g_log.retired_levels;
+        g_log.retired_levels = old_levels;
+    }
+#        else  // AVS_LOG_LOCK_FREE_LEVELS
+    avs_free(old_levels);
+#        endif // AVS_LOG_LOCK_FREE_LEVELS
+}
+
+/**
+ * Returns the slot in @p levels that holds the level for @p module (or the
+ * default level, if @p module is NULL), or NULL if there is no such slot.
+ */
+static log_level_slot_t *find_level_slot(log_levels_t *levels,
+                                         const char *module) {
+    if (!levels) {
+        return NULL;
+    }
+    if (!module) {
+        return &levels->default_level;
+    }
+    ptrdiff_t index = find_module(levels, module_hash(module), module);
+    return index >= 0 ? &levels->modules[index].level : NULL;
 }
 
 static int set_log_level_unlocked(const char *module, avs_log_level_t level) {
-    avs_log_level_t *level_ptr = level_for(module, 1);
-    if (!level_ptr) {
-        if (AVS_LOG_ERROR >= g_log.default_level) {
+    log_levels_t *levels = LEVELS_LOAD(&g_log.levels);
+    log_level_slot_t *slot = find_level_slot(levels, module);
+    if (slot) {
+        LEVEL_SLOT_STORE(slot, (int) level);
+        invalidate_site_caches_unlocked();
+        return 0;
+    }
+    log_levels_t *new_levels = levels_with_module(levels, module);
+    if (!new_levels) {
+        if (AVS_LOG_ERROR >= level_for(levels, NULL)) {
             avs_log_internal_forced_l__(
                     AVS_LOG_ERROR, "avs_log", __FILE__, __LINE__,
                     "could not allocate level entry for module: %s", module);
         }
         return -1;
     }
-    *level_ptr = level;
+    LEVEL_SLOT_STORE(find_level_slot(new_levels, module), (int) level);
+    publish_levels_unlocked(new_levels);
     return 0;
 }
 
+static void reset_levels_unlocked(void) {
+#        ifdef AVS_LOG_LOCK_FREE_LEVELS
+    // other threads might be reading the snapshot, so it is reset in place
+    log_levels_t *levels = LEVELS_LOAD(&g_log.levels);
+    if (levels) {
+        LEVEL_SLOT_STORE(&levels->default_level, (int) AVS_LOG_INFO);
+        for (size_t i = 0; i < levels->module_count; ++i) {
+            LEVEL_SLOT_STORE(&levels->modules[i].level, LEVEL_UNSET);
+        }
+        invalidate_site_caches_unlocked();
+    }
+#        else  // AVS_LOG_LOCK_FREE_LEVELS
+    publish_levels_unlocked(NULL);
+#        endif // AVS_LOG_LOCK_FREE_LEVELS
+}
+
 int avs_log_set_level__(const char *module, avs_log_level_t level) {
     if (LOG_LOCK()) {
         return -1;
@@ -218,12 +571,12 @@ int avs_log_set_level__(const char *module, avs_log_level_t level) {
 #    endif /* AVS_COMMONS_WITHOUT_LOG_CHECK_IN_RUNTIME */
 
 void avs_log_reset(void) {
+    avs_log_async_disable();
     if (LOG_LOCK()) {
         return;
     }
 #    ifndef AVS_COMMONS_WITHOUT_LOG_CHECK_IN_RUNTIME
-    AVS_LIST_CLEAR(&g_log.module_levels);
-    set_log_level_unlocked(NULL, AVS_LOG_INFO);
+    reset_levels_unlocked();
 #    endif /* AVS_COMMONS_WITHOUT_LOG_CHECK_IN_RUNTIME */
     set_log_handler_unlocked(default_log_handler);
     LOG_UNLOCK();
@@ -235,12 +588,29 @@ int avs_log_should_log__(avs_log_level_t level, const char *module) {
         return 1;
     }
 
+#        ifdef AVS_LOG_LOCK_FREE_LEVELS
+    return level >= level_for(LEVELS_LOAD(&g_log.levels), module);
+#        else  // AVS_LOG_LOCK_FREE_LEVELS
     if (LOG_LOCK()) {
         return 1;
     }
-    int result = (level >= *level_for(module, 0));
+    int result = (level >= level_for(LEVELS_LOAD(&g_log.levels), module));
     LOG_UNLOCK();
     return result;
+#        endif // AVS_LOG_LOCK_FREE_LEVELS
+}
+
+int avs_log_should_log_cached__(avs_log_level_t level,
+                                const char *module,
+                                unsigned *site_generation) {
+    // generation needs to be read before the levels, so that if they are
+    // changed concurrently, the value cached here is already stale
+    unsigned generation = GENERATION_LOAD(&avs_log_generation__);
+    int result = avs_log_should_log__(level, module);
+    if (!result) {
+        SITE_GENERATION_STORE(site_generation, generation);
+    }
+    return result;
 }
 #    endif /* AVS_COMMONS_WITHOUT_LOG_CHECK_IN_RUNTIME */
 
@@ -261,14 +631,31 @@ static const char *level_as_string(avs_log_level_t level) {
     }
 }
 
-static void log_with_buffer_unlocked_v(char *log_buf,
-                                       size_t log_buf_size,
-                                       avs_log_level_t level,
-                                       const char *module,
-                                       const char *file,
-                                       unsigned line,
-                                       const char *msg,
-                                       va_list ap) {
+static int
+format_text_v(char *log_buf, size_t log_buf_size, const char *msg, va_list ap) {
+    int pfresult = vsnprintf(log_buf, log_buf_size, msg, ap);
+    if (pfresult < 0) {
+        // erroneous user-provided format string?
+        return -1;
+    }
+    if ((size_t) pfresult > log_buf_size) {
+        char *log_buf_ptr = log_buf + log_buf_size - 4;
+        for (int i = 0; i < 3; i++) {
+            *log_buf_ptr = '.';
+            ++log_buf_ptr;
+        }
+    }
+    return 0;
+}
+
+static int format_message_v(char *log_buf,
+                            size_t log_buf_size,
+                            avs_log_level_t level,
+                            const char *module,
+                            const char *file,
+                            unsigned line,
+                            const char *msg,
+                            va_list ap) {
     char *log_buf_ptr = log_buf;
     size_t log_buf_left = log_buf_size;
     int pfresult;
@@ -280,7 +667,7 @@ static void log_with_buffer_unlocked_v(char *log_buf,
         if (pfresult < 0) {
             // it's hard to imagine why snprintf() above might fail,
             // but well, let's be compliant and check it
-            return;
+            return -1;
         }
         if ((size_t) pfresult > log_buf_left) {
             pfresult = (int) log_buf_left;
@@ -289,22 +676,17 @@ static void log_with_buffer_unlocked_v(char *log_buf,
         log_buf_left -= (size_t) pfresult;
     }
 
-    if (log_buf_left) {
-        pfresult = vsnprintf(log_buf_ptr, log_buf_left, msg, ap);
-        if (pfresult < 0) {
-            // erroneous user-provided format string?
-            return;
-        }
-        if ((size_t) pfresult > log_buf_left) {
-            pfresult = (int) log_buf_left - 1;
-            log_buf_ptr = log_buf_ptr + pfresult - 3;
-            for (int i = 0; i < 3; i++) {
-                *log_buf_ptr = '.';
-                ++log_buf_ptr;
-            }
-        }
+    if (log_buf_left && format_text_v(log_buf_ptr, log_buf_left, msg, ap)) {
+        return -1;
     }
+    return 0;
+}
 
+static void deliver_message(avs_log_level_t level,
+                            const char *module,
+                            const char *file,
+                            unsigned line,
+                            const char *log_buf) {
     if (g_log.is_extended_handler) {
         g_log.handler.extended(level, module, file, line, log_buf);
     } else {
@@ -312,12 +694,1098 @@ static void log_with_buffer_unlocked_v(char *log_buf,
     }
 }
 
+static void log_with_buffer_unlocked_v(char *log_buf,
+                                       size_t log_buf_size,
+                                       avs_log_level_t level,
+                                       const char *module,
+                                       const char *file,
+                                       unsigned line,
+                                       const char *msg,
+                                       va_list ap) {
+    if (!format_message_v(log_buf, log_buf_size, level, module, file, line,
+                          msg, ap)) {
+        deliver_message(level, module, file, line, log_buf);
+    }
+}
+
+#    ifdef AVS_LOG_WITH_ASYNC
+/*
+ * Deferred formatting: instead of a formatted message, the arguments of a log
+ * statement are stored as a sequence of tagged values, with all multi-byte
+ * integers in little-endian byte order, so that the same encoding can be
+ * reused in the binary log format:
+ *
+ * - 'i' + 8-byte signed integer (also used for '*' width and precision)
+ * - 'u' + 8-byte unsigned integer
+ * - 'f' + 8-byte IEEE 754 double
+ * - 'p' + 8-byte pointer value
+ * - 's' + 2-byte length + string contents, without the terminating nullbyte
+ */
+#        define DEFERRED_ARG_SIGNED 'i'
+#        define DEFERRED_ARG_UNSIGNED 'u'
+#        define DEFERRED_ARG_DOUBLE 'f'
+#        define DEFERRED_ARG_POINTER 'p'
+#        define DEFERRED_ARG_STRING 's'
+
+/* Format used for messages that could not be deferred */
+#        define DEFERRED_PREFORMATTED_FORMAT "%s"
+
+/* Magic header of a binary log stream, version 1 */
+#        define BINARY_LOG_MAGIC "AVSLOGB1"
+
+AVS_STATIC_ASSERT(sizeof(double) == sizeof(uint64_t), double_is_64bit);
+
+typedef enum {
+    FORMAT_LENGTH_NONE,
+    FORMAT_LENGTH_HH,
+    FORMAT_LENGTH_H,
+    FORMAT_LENGTH_L,
+    FORMAT_LENGTH_LL,
+    FORMAT_LENGTH_J,
+    FORMAT_LENGTH_Z,
+    FORMAT_LENGTH_T,
+    FORMAT_LENGTH_LONG_DOUBLE
+} format_length_t;
+
+typedef struct {
+    const char *flags;
+    size_t flags_len;
+    const char *width;
+    size_t width_len;
+    bool width_star;
+    bool has_precision;
+    const char *precision;
+    size_t precision_len;
+    bool precision_star;
+    format_length_t length;
+    char conversion;
+    /* first character after the conversion specification */
+    const char *end;
+} format_spec_t;
+
+static const char *skip_digits(const char *str) {
+    while (*str >= '0' && *str <= '9') {
+        ++str;
+    }
+    return str;
+}
+
+/**
+ * Parses a printf() conversion specification. @p fmt shall point at the
+ * character directly following the '%' sign.
+ */
+static int parse_format_spec(format_spec_t *spec, const char *fmt) {
+    memset(spec, 0, sizeof(*spec));
+    spec->flags = fmt;
+    while (*fmt && strchr("-+ #0'", *fmt)) {
+        ++fmt;
+    }
+    spec->flags_len = (size_t) (fmt - spec->flags);
+    if (*fmt == '*') {
+        spec->width_star = true;
+        ++fmt;
+    } else {
+        spec->width = fmt;
+        fmt = skip_digits(fmt);
+        spec->width_len = (size_t) (fmt - spec->width);
+    }
+    if (*fmt == '.') {
+        spec->has_precision = true;
+        if (*++fmt == '*') {
+            spec->precision_star = true;
+            ++fmt;
+        } else {
+            spec->precision = fmt;
+            fmt = skip_digits(fmt);
+            spec->precision_len = (size_t) (fmt - spec->precision);
+        }
+    }
+    switch (*fmt) {
+    case 'h':
+        if (*++fmt == 'h') {
+            spec->length = FORMAT_LENGTH_HH;
+            ++fmt;
+        } else {
+            spec->length = FORMAT_LENGTH_H;
+        }
+        break;
+    case 'l':
+        if (*++fmt == 'l') {
+            spec->length = FORMAT_LENGTH_LL;
+            ++fmt;
+        } else {
+            spec->length = FORMAT_LENGTH_L;
+        }
+        break;
+    case 'j':
+        spec->length = FORMAT_LENGTH_J;
+        ++fmt;
+        break;
+    case 'z':
+        spec->length = FORMAT_LENGTH_Z;
+        ++fmt;
+        break;
+    case 't':
+        spec->length = FORMAT_LENGTH_T;
+        ++fmt;
+        break;
+    case 'L':
+        spec->length = FORMAT_LENGTH_LONG_DOUBLE;
+        ++fmt;
+        break;
+    default:
+        break;
+    }
+    if (!*fmt) {
+        return -1;
+    }
+    spec->conversion = *fmt;
+    spec->end = fmt + 1;
+    return 0;
+}
+
+typedef struct {
+    char *data;
+    size_t size;
+    size_t used;
+} deferred_args_t;
+
+static int put_tagged_u64(deferred_args_t *args, char tag, uint64_t value) {
+    if (args->size - args->used < 9) {
+        return -1;
+    }
+    args->data[args->used++] = tag;
+    for (size_t i = 0; i < 8; ++i) {
+        args->data[args->used++] = (char) (uint8_t) (value >> (8 * i));
+    }
+    return 0;
+}
+
+static int put_string(deferred_args_t *args, const char *str, size_t max_len) {
+    if (args->size - args->used < 3) {
+        return -1;
+    }
+    max_len = AVS_MIN(max_len, args->size - args->used - 3);
+    max_len = AVS_MIN(max_len, (size_t) UINT16_MAX);
+    size_t len = 0;
+    while (len < max_len && str[len]) {
+        ++len;
+    }
+    args->data[args->used++] = DEFERRED_ARG_STRING;
+    args->data[args->used++] = (char) (uint8_t) len;
+    args->data[args->used++] = (char) (uint8_t) (len >> 8);
+    // may overlap in case of put_preformatted_v()
+    memmove(&args->data[args->used], str, len);
+    args->used += len;
+    return 0;
+}
+
+static long long get_signed_arg(va_list *ap, format_length_t length) {
+    switch (length) {
+    case FORMAT_LENGTH_HH:
+        return (signed char) va_arg(*ap, int);
+    case FORMAT_LENGTH_H:
+        return (short) va_arg(*ap, int);
+    case FORMAT_LENGTH_L:
+        return va_arg(*ap, long);
+    case FORMAT_LENGTH_LL:
+        return va_arg(*ap, long long);
+    case FORMAT_LENGTH_J:
+        return (long long) va_arg(*ap, intmax_t);
+    case FORMAT_LENGTH_Z:
+    case FORMAT_LENGTH_T:
+        // there is no signed counterpart of size_t in C99
+        return (long long) va_arg(*ap, ptrdiff_t);
+    default:
+        return va_arg(*ap, int);
+    }
+}
+
+static unsigned long long get_unsigned_arg(va_list *ap,
+                                           format_length_t length) {
+    switch (length) {
+    case FORMAT_LENGTH_HH:
+        return (unsigned char) va_arg(*ap, unsigned);
+    case FORMAT_LENGTH_H:
+        return (unsigned short) va_arg(*ap, unsigned);
+    case FORMAT_LENGTH_L:
+        return va_arg(*ap, unsigned long);
+    case FORMAT_LENGTH_LL:
+        return va_arg(*ap, unsigned long long);
+    case FORMAT_LENGTH_J:
+        return (unsigned long long) va_arg(*ap, uintmax_t);
+    case FORMAT_LENGTH_Z:
+    case FORMAT_LENGTH_T:
+        return (unsigned long long) va_arg(*ap, size_t);
+    default:
+        return va_arg(*ap, unsigned);
+    }
+}
+
+static int put_spec_args(deferred_args_t *args,
+                         const format_spec_t *spec,
+                         va_list *ap) {
+    size_t max_len = SIZE_MAX;
+    if (spec->width_star
+            && put_tagged_u64(args, DEFERRED_ARG_SIGNED,
+                              (uint64_t) (int64_t) va_arg(*ap, int))) {
+        return -1;
+    }
+    if (spec->precision_star) {
+        int precision = va_arg(*ap, int);
+        if (put_tagged_u64(args, DEFERRED_ARG_SIGNED,
+                           (uint64_t) (int64_t) precision)) {
+            return -1;
+        }
+        if (precision >= 0) {
+            max_len = (size_t) precision;
+        }
+    } else if (spec->has_precision) {
+        max_len = 0;
+        for (size_t i = 0; i < spec->precision_len && max_len < INT_MAX; ++i) {
+            max_len = 10 * max_len + (size_t) (spec->precision[i] - '0');
+        }
+    }
+
+    switch (spec->conversion) {
+    case '%':
+        return 0;
+    case 'c':
+        if (spec->length != FORMAT_LENGTH_NONE) {
+            // wide character
+            return -1;
+        }
+        // fall through
+    case 'd':
+    case 'i':
+        return put_tagged_u64(args, DEFERRED_ARG_SIGNED,
+                              (uint64_t) (int64_t) get_signed_arg(
+                                      ap, spec->length));
+    case 'o':
+    case 'u':
+    case 'x':
+    case 'X':
+        return put_tagged_u64(args, DEFERRED_ARG_UNSIGNED,
+                              (uint64_t) get_unsigned_arg(ap, spec->length));
+    case 'a':
+    case 'A':
+    case 'e':
+    case 'E':
+    case 'f':
+    case 'F':
+    case 'g':
+    case 'G': {
+        double value = (spec->length == FORMAT_LENGTH_LONG_DOUBLE)
+                               ? (double) va_arg(*ap, long double)
+                               : va_arg(*ap, double);
+        uint64_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+        return put_tagged_u64(args, DEFERRED_ARG_DOUBLE, bits);
+    }
+    case 'p':
+        return put_tagged_u64(args, DEFERRED_ARG_POINTER,
+                              (uint64_t) (uintptr_t) va_arg(*ap, void *));
+    case 's': {
+        if (spec->length != FORMAT_LENGTH_NONE) {
+            // wide string
+            return -1;
+        }
+        const char *str = va_arg(*ap, const char *);
+        return put_string(args, str ? str : "(null)", max_len);
+    }
+    default:
+        // %n or unknown conversion
+        return -1;
+    }
+}
+
+/**
+ * Captures the arguments referenced by the @p msg format string.
+ *
+ * @returns 0 on success, or -1 if the format string uses conversions that
+ *          cannot be deferred, or if the arguments do not fit in @p args.
+ */
+static int
+put_deferred_args_v(deferred_args_t *args, const char *msg, va_list ap_) {
+    va_list ap;
+    va_copy(ap, ap_);
+    int result = 0;
+    while (!result && (msg = strchr(msg, '%'))) {
+        format_spec_t spec;
+        if (!(result = parse_format_spec(&spec, msg + 1))) {
+            result = put_spec_args(args, &spec, &ap);
+            msg = spec.end;
+        }
+    }
+    va_end(ap);
+    return result;
+}
+
+static int put_deferred_args(deferred_args_t *args, const char *msg, ...) {
+    va_list ap;
+    va_start(ap, msg);
+    int result = put_deferred_args_v(args, msg, ap);
+    va_end(ap);
+    return result;
+}
+
+/**
+ * Formats the message as a single string argument, to be used with
+ * @ref DEFERRED_PREFORMATTED_FORMAT.
+ */
+static int
+put_preformatted_v(deferred_args_t *args, const char *msg, va_list ap) {
+    const size_t header_size = 3;
+    if (args->size - args->used <= header_size) {
+        return -1;
+    }
+    // one byte of the available space is reserved for the terminator
+    size_t buf_size = AVS_MIN(args->size - args->used - header_size,
+                              (size_t) UINT16_MAX + 1);
+    char *text = &args->data[args->used + header_size];
+    if (format_text_v(text, buf_size, msg, ap)) {
+        return -1;
+    }
+    return put_string(args, text, SIZE_MAX);
+}
+
+typedef struct {
+    const char *data;
+    size_t size;
+    size_t pos;
+} deferred_reader_t;
+
+static int get_tagged_u64(deferred_reader_t *reader,
+                          char expected_tag,
+                          uint64_t *out_value) {
+    if (reader->size - reader->pos < 9
+            || reader->data[reader->pos] != expected_tag) {
+        return -1;
+    }
+    const uint8_t *data = (const uint8_t *) &reader->data[reader->pos + 1];
+    *out_value = 0;
+    for (size_t i = 0; i < 8; ++i) {
+        *out_value |= (uint64_t) data[i] << (8 * i);
+    }
+    reader->pos += 9;
+    return 0;
+}
+
+static int get_string(deferred_reader_t *reader,
+                      const char **out_str,
+                      int *out_len) {
+    if (reader->size - reader->pos < 3
+            || reader->data[reader->pos] != DEFERRED_ARG_STRING) {
+        return -1;
+    }
+    const uint8_t *data = (const uint8_t *) &reader->data[reader->pos + 1];
+    size_t len = (size_t) (data[0] | data[1] << 8);
+    if (reader->size - reader->pos - 3 < len) {
+        return -1;
+    }
+    *out_str = &reader->data[reader->pos + 3];
+    *out_len = (int) len;
+    reader->pos += 3 + len;
+    return 0;
+}
+
+typedef struct {
+    char *buf;
+    size_t size;
+    size_t used;
+    bool truncated;
+} deferred_output_t;
+
+static void output_append(deferred_output_t *out, const char *fmt, ...) {
+    if (out->truncated) {
+        return;
+    }
+    va_list ap;
+    va_start(ap, fmt);
+    int result = vsnprintf(&out->buf[out->used], out->size - out->used, fmt,
+                           ap);
+    va_end(ap);
+    if (result < 0 || (size_t) result >= out->size - out->used) {
+        out->truncated = true;
+    } else {
+        out->used += (size_t) result;
+    }
+}
+
+/**
+ * Formats a single conversion specification of a deferred message. Width and
+ * precision are inlined into the specification, and length modifiers are
+ * replaced according to the types in which the arguments are stored.
+ */
+static int output_spec(deferred_output_t *out,
+                       const format_spec_t *spec,
+                       deferred_reader_t *reader) {
+    char spec_buf[64];
+    deferred_output_t spec_out = {
+        .buf = spec_buf,
+        .size = sizeof(spec_buf)
+    };
+    uint64_t value;
+    output_append(&spec_out, "%%%.*s", (int) spec->flags_len, spec->flags);
+    size_t precision_pos;
+    if (spec->width_star) {
+        if (get_tagged_u64(reader, DEFERRED_ARG_SIGNED, &value)) {
+            return -1;
+        }
+        output_append(&spec_out, "%d", (int) (int64_t) value);
+    } else {
+        output_append(&spec_out, "%.*s", (int) spec->width_len, spec->width);
+    }
+    precision_pos = spec_out.used;
+    if (spec->precision_star) {
+        if (get_tagged_u64(reader, DEFERRED_ARG_SIGNED, &value)) {
+            return -1;
+        }
+        // negative precision is taken as if it was omitted
+        if ((int64_t) value >= 0) {
+            output_append(&spec_out, ".%d", (int) (int64_t) value);
+        }
+    } else if (spec->has_precision) {
+        output_append(&spec_out, ".%.*s", (int) spec->precision_len,
+                      spec->precision);
+    }
+    if (spec_out.truncated) {
+        return -1;
+    }
+
+    const char *str;
+    int len;
+    switch (spec->conversion) {
+    case '%':
+        output_append(out, "%%");
+        return 0;
+    case 'c':
+    case 'd':
+    case 'i':
+        if (get_tagged_u64(reader, DEFERRED_ARG_SIGNED, &value)) {
+            return -1;
+        }
+        output_append(&spec_out, "%s%c", spec->conversion == 'c' ? "" : "ll",
+                      spec->conversion);
+        if (spec->conversion == 'c') {
+            output_append(out, spec_buf, (int) (int64_t) value);
+        } else {
+            output_append(out, spec_buf, (long long) (int64_t) value);
+        }
+        return 0;
+    case 'o':
+    case 'u':
+    case 'x':
+    case 'X':
+        if (get_tagged_u64(reader, DEFERRED_ARG_UNSIGNED, &value)) {
+            return -1;
+        }
+        output_append(&spec_out, "ll%c", spec->conversion);
+        output_append(out, spec_buf, (unsigned long long) value);
+        return 0;
+    case 'a':
+    case 'A':
+    case 'e':
+    case 'E':
+    case 'f':
+    case 'F':
+    case 'g':
+    case 'G': {
+        double dvalue;
+        if (get_tagged_u64(reader, DEFERRED_ARG_DOUBLE, &value)) {
+            return -1;
+        }
+        memcpy(&dvalue, &value, sizeof(dvalue));
+        output_append(&spec_out, "%c", spec->conversion);
+        output_append(out, spec_buf, dvalue);
+        return 0;
+    }
+    case 'p':
+        if (get_tagged_u64(reader, DEFERRED_ARG_POINTER, &value)) {
+            return -1;
+        }
+        output_append(&spec_out, "p");
+        output_append(out, spec_buf, (void *) (uintptr_t) value);
+        return 0;
+    case 's':
+        if (get_string(reader, &str, &len)) {
+            return -1;
+        }
+        // the string has already been cut to the requested precision
+        spec_out.used = precision_pos;
+        output_append(&spec_out, ".*s");
+        output_append(out, spec_buf, len, str);
+        return 0;
+    default:
+        return -1;
+    }
+}
+
+/**
+ * Formats a message queued with deferred formatting, marking it with an
+ * ellipsis if truncated, same as @ref format_text_v.
+ */
+static int format_deferred(char *log_buf,
+                           size_t log_buf_size,
+                           const char *msg,
+                           const char *args,
+                           size_t args_size) {
+    deferred_output_t out = {
+        .buf = log_buf,
+        .size = log_buf_size
+    };
+    deferred_reader_t reader = {
+        .data = args,
+        .size = args_size
+    };
+    log_buf[0] = '\0';
+    while (*msg && !out.truncated) {
+        const char *percent = strchr(msg, '%');
+        size_t literal_len = percent ? (size_t) (percent - msg) : strlen(msg);
+        output_append(&out, "%.*s", (int) literal_len, msg);
+        if (!percent) {
+            break;
+        }
+        format_spec_t spec;
+        if (parse_format_spec(&spec, percent + 1)
+                || output_spec(&out, &spec, &reader)) {
+            return -1;
+        }
+        msg = spec.end;
+    }
+    if (out.truncated && log_buf_size >= 4) {
+        memcpy(&log_buf[log_buf_size - 4], "...", 4);
+    }
+    return 0;
+}
+
+/**
+ * Returns the currently enabled queue. Unless called with g_log_mutex held, the
+ * caller needs to announce itself in <c>g_log.async_users</c> first, so that
+ * the queue is not reclaimed while in use.
+ */
+static log_async_t *async_load(void) {
+    return (log_async_t *) atomic_load(&g_log.async);
+}
+
+static log_async_t *async_acquire(void) {
+    // do not touch the shared counter at all in synchronous mode; a queue
+    // enabled concurrently with this call may be missed either way
+    if (!atomic_load_explicit(&g_log.async, memory_order_relaxed)) {
+        return NULL;
+    }
+    atomic_fetch_add(&g_log.async_users, 1);
+    log_async_t *async = async_load();
+    if (!async) {
+        atomic_fetch_sub(&g_log.async_users, 1);
+    }
+    return async;
+}
+
+static void async_release(void) {
+    atomic_fetch_sub(&g_log.async_users, 1);
+}
+
+static void async_free(log_async_t *async) {
+    avs_condvar_cleanup(&async->condvar);
+    avs_mutex_cleanup(&async->mutex);
+    avs_free(async);
+}
+
+/**
+ * Frees the disabled queues if no thread might be using them. Needs to be
+ * called with g_log_mutex held.
+ */
+static void async_reclaim_retired_unlocked(void) {
+    if (atomic_load(&g_log.async_users)) {
+        return;
+    }
+    while (g_log.retired_async) {
+        log_async_t *async = g_log.retired_async;
+        g_log.retired_async = async->retired_next;
+        async_free(async);
+    }
+}
+
+static void deliver_formatted(avs_log_level_t level,
+                              const char *module,
+                              const char *file,
+                              unsigned line,
+                              const char *msg,
+                              ...) {
+    char log_buf[AVS_COMMONS_LOG_MAX_LINE_LENGTH];
+    va_list ap;
+    va_start(ap, msg);
+    log_with_buffer_unlocked_v(log_buf, sizeof(log_buf), level, module, file,
+                               line, msg, ap);
+    va_end(ap);
+}
+
+static void
+async_write_binary(log_async_t *async, const void *data, size_t size) {
+    async->binary_writer(data, size, async->binary_writer_arg);
+}
+
+static void async_write_binary_string(log_async_t *async,
+                                      const char *str,
+                                      size_t len) {
+    len = AVS_MIN(len, (size_t) UINT16_MAX);
+    const uint8_t header[] = { (uint8_t) len, (uint8_t) (len >> 8) };
+    async_write_binary(async, header, sizeof(header));
+    async_write_binary(async, str, len);
+}
+
+/**
+ * Serializes a record in the binary log format:
+ *
+ * - 1-byte log level
+ * - 4-byte line number
+ * - module name, file name, format string and encoded arguments, each
+ *   prefixed with 2-byte length
+ *
+ * All integers are little-endian. The stream starts with
+ * @ref BINARY_LOG_MAGIC. See also <c>tools/avs_log_decode.py</c>.
+ */
+static void async_write_binary_record_locked(log_async_t *async,
+                                             avs_log_level_t level,
+                                             const char *module,
+                                             const char *file,
+                                             unsigned line,
+                                             const char *format,
+                                             const char *args,
+                                             size_t args_size) {
+    const uint8_t header[] = { (uint8_t) level, (uint8_t) line,
+                               (uint8_t) (line >> 8), (uint8_t) (line >> 16),
+                               (uint8_t) (line >> 24) };
+    module = module ? module : "";
+    file = file ? file : "";
+    async_write_binary(async, header, sizeof(header));
+    async_write_binary_string(async, module, strlen(module));
+    async_write_binary_string(async, file, strlen(file));
+    async_write_binary_string(async, format, strlen(format));
+    async_write_binary_string(async, args, args_size);
+}
+
+#        define ASYNC_DROPPED_FORMAT "%zu log messages dropped due to full queue"
+
+static void async_report_dropped_locked(log_async_t *async) {
+    size_t dropped = atomic_load_explicit(&async->dropped, memory_order_relaxed);
+    if (async->overflow_policy != AVS_LOG_ASYNC_OVERFLOW_COUNT
+            || dropped == async->reported_dropped) {
+        return;
+    }
+    // delivered directly, as logging it would put it at the end of the queue
+    if (async->binary_writer) {
+        char buf[16];
+        deferred_args_t args = {
+            .data = buf,
+            .size = sizeof(buf)
+        };
+        if (!put_deferred_args(&args, ASYNC_DROPPED_FORMAT,
+                               dropped - async->reported_dropped)) {
+            async_write_binary_record_locked(async, AVS_LOG_WARNING, "avs_log",
+                                             __FILE__, __LINE__,
+                                             ASYNC_DROPPED_FORMAT, buf,
+                                             args.used);
+        }
+    } else {
+        deliver_formatted(AVS_LOG_WARNING, "avs_log", __FILE__, __LINE__,
+                          ASYNC_DROPPED_FORMAT,
+                          dropped - async->reported_dropped);
+    }
+    async->reported_dropped = dropped;
+}
+
+static void async_deliver_record_locked(log_async_t *async,
+                                        const log_async_record_t *record) {
+    if (!record->format) {
+        deliver_message(record->level, record->module, record->file,
+                        record->line, record->message);
+    } else if (async->binary_writer) {
+        async_write_binary_record_locked(async, record->level, record->module,
+                                         record->file, record->line,
+                                         record->format, record->message,
+                                         record->args_size);
+    } else {
+        char text[AVS_COMMONS_LOG_MAX_LINE_LENGTH];
+        if (!format_deferred(text, sizeof(text), record->format,
+                             record->message, record->args_size)) {
+            deliver_formatted(record->level, record->module, record->file,
+                              record->line, "%s", text);
+        }
+    }
+}
+
+/**
+ * Delivers up to @p limit queued records to the log handler. Stops at the
+ * first record that has not been published yet, reporting the number of
+ * dropped messages if necessary.
+ *
+ * @returns Number of records delivered.
+ */
+static size_t async_drain_locked(log_async_t *async, size_t limit) {
+    size_t delivered = 0;
+    while (delivered < limit) {
+        log_async_record_t *record =
+                &async->records[async->dequeue_pos & async->mask];
+        if (atomic_load_explicit(&record->seq, memory_order_acquire)
+                != async->dequeue_pos + 1) {
+            // messages are dropped when the queue is full, i.e. after all the
+            // messages that have just been delivered were logged
+            async_report_dropped_locked(async);
+            break;
+        }
+        if (record->level != AVS_LOG_QUIET) {
+            async_deliver_record_locked(async, record);
+        }
+        atomic_store_explicit(&record->seq, async->dequeue_pos + async->mask + 1,
+                              memory_order_release);
+        ++async->dequeue_pos;
+        ++delivered;
+    }
+    return delivered;
+}
+
+static bool async_has_data(log_async_t *async) {
+    // sequentially consistent, to pair with consumers_sleeping accesses
+    return atomic_load(&async->records[async->dequeue_pos & async->mask].seq)
+           == async->dequeue_pos + 1;
+}
+
+static void async_notify(log_async_t *async) {
+    if (!avs_mutex_lock(async->mutex)) {
+        avs_condvar_notify_all(async->condvar);
+        avs_mutex_unlock(async->mutex);
+    }
+}
+
+/**
+ * Claims a free slot in the queue. Returns NULL if the queue is full.
+ */
+static log_async_record_t *async_claim(log_async_t *async, size_t *out_pos) {
+    size_t pos =
+            atomic_load_explicit(&async->enqueue_pos, memory_order_relaxed);
+    while (true) {
+        log_async_record_t *record = &async->records[pos & async->mask];
+        size_t seq = atomic_load_explicit(&record->seq, memory_order_acquire);
+        if (seq == pos) {
+            if (atomic_compare_exchange_weak_explicit(
+                        &async->enqueue_pos, &pos, pos + 1,
+                        memory_order_relaxed, memory_order_relaxed)) {
+                *out_pos = pos;
+                return record;
+            }
+        } else if ((ptrdiff_t) (seq - pos) < 0) {
+            return NULL;
+        } else {
+            pos = atomic_load_explicit(&async->enqueue_pos,
+                                       memory_order_relaxed);
+        }
+    }
+}
+
+static log_async_record_t *async_claim_with_policy(log_async_t *async,
+                                                   size_t *out_pos) {
+    log_async_record_t *record;
+    while (!(record = async_claim(async, out_pos))) {
+        if (async->overflow_policy != AVS_LOG_ASYNC_OVERFLOW_BLOCK) {
+            atomic_fetch_add_explicit(&async->dropped, 1, memory_order_relaxed);
+            return NULL;
+        }
+        // deliver queued records by ourselves to make room
+        if (avs_mutex_lock(async->mutex)) {
+            return NULL;
+        }
+        if (!async_drain_locked(async, SIZE_MAX)) {
+            // the oldest record is still being filled by another thread;
+            // sleep until it is published instead of spinning
+            atomic_fetch_add(&async->consumers_sleeping, 1);
+            if (!async_has_data(async)) {
+                avs_condvar_wait(async->condvar, async->mutex,
+                                 AVS_TIME_MONOTONIC_INVALID);
+            }
+            atomic_fetch_sub(&async->consumers_sleeping, 1);
+        }
+        avs_mutex_unlock(async->mutex);
+    }
+    return record;
+}
+
+static int async_fill_record(log_async_t *async,
+                             log_async_record_t *record,
+                             const char *msg,
+                             va_list ap) {
+    record->format = NULL;
+    if (async->deferred_formatting) {
+        deferred_args_t args = {
+            .data = record->message,
+            .size = sizeof(record->message)
+        };
+        if (!put_deferred_args_v(&args, msg, ap)) {
+            record->format = msg;
+        } else {
+            // fall back to formatting right away
+            args.used = 0;
+            if (put_preformatted_v(&args, msg, ap)) {
+                return -1;
+            }
+            record->format = DEFERRED_PREFORMATTED_FORMAT;
+        }
+        record->args_size = args.used;
+        return 0;
+    }
+    return format_message_v(record->message, sizeof(record->message),
+                            record->level, record->module, record->file,
+                            record->line, msg, ap);
+}
+
+/**
+ * @returns 0 if the message has been handled asynchronously (i.e. either
+ *          queued or dropped), or -1 if asynchronous logging is disabled.
+ */
+static int async_log_v(avs_log_level_t level,
+                       const char *module,
+                       const char *file,
+                       unsigned line,
+                       const char *msg,
+                       va_list ap) {
+    log_async_t *async = async_acquire();
+    if (!async) {
+        return -1;
+    }
+    atomic_fetch_add(&async->producers, 1);
+    if (atomic_load(&async->disabled)) {
+        atomic_fetch_sub(&async->producers, 1);
+        async_release();
+        return -1;
+    }
+
+    size_t pos;
+    log_async_record_t *record = async_claim_with_policy(async, &pos);
+    if (record) {
+        record->level = level;
+        record->module = module;
+        record->file = file;
+        record->line = line;
+        if (async_fill_record(async, record, msg, ap)) {
+            // the slot needs to be published anyway; mark it to be skipped
+            record->level = AVS_LOG_QUIET;
+        }
+        atomic_store(&record->seq, pos + 1);
+        if (atomic_load(&async->consumers_sleeping)) {
+            async_notify(async);
+        }
+    }
+
+    if (atomic_fetch_sub(&async->producers, 1) == 1
+            && atomic_load(&async->disabled)) {
+        async_notify(async);
+    }
+    async_release();
+    return 0;
+}
+
+static int async_init(log_async_t **out_async,
+                      const avs_log_async_config_t *config) {
+    size_t queue_size = 1;
+    size_t requested_size = ASYNC_DEFAULT_QUEUE_SIZE;
+    avs_log_async_overflow_policy_t overflow_policy =
+            AVS_LOG_ASYNC_OVERFLOW_BLOCK;
+    bool deferred_formatting = false;
+    avs_log_binary_writer_t *binary_writer = NULL;
+    void *binary_writer_arg = NULL;
+    if (config) {
+        if (config->queue_size) {
+            requested_size = config->queue_size;
+        }
+        overflow_policy = config->overflow_policy;
+        binary_writer = config->binary_writer;
+        binary_writer_arg = config->binary_writer_arg;
+        deferred_formatting = config->deferred_formatting || binary_writer;
+    }
+    if (requested_size > ASYNC_MAX_QUEUE_SIZE) {
+        return -1;
+    }
+    while (queue_size < requested_size) {
+        queue_size <<= 1;
+    }
+
+    log_async_t *async = (log_async_t *) avs_calloc(
+            1, offsetof(log_async_t, records)
+                       + queue_size * sizeof(log_async_record_t));
+    if (!async) {
+        return -1;
+    }
+    if (avs_mutex_create(&async->mutex)
+            || avs_condvar_create(&async->condvar)) {
+        avs_mutex_cleanup(&async->mutex);
+        avs_free(async);
+        return -1;
+    }
+    async->overflow_policy = overflow_policy;
+    async->deferred_formatting = deferred_formatting;
+    async->binary_writer = binary_writer;
+    async->binary_writer_arg = binary_writer_arg;
+    async->mask = queue_size - 1;
+    atomic_init(&async->disabled, false);
+    atomic_init(&async->consumers_sleeping, 0);
+    atomic_init(&async->producers, 0);
+    atomic_init(&async->dropped, 0);
+    atomic_init(&async->enqueue_pos, 0);
+    for (size_t i = 0; i < queue_size; ++i) {
+        atomic_init(&async->records[i].seq, i);
+    }
+    *out_async = async;
+    return 0;
+}
+
+int avs_log_async_enable(const avs_log_async_config_t *config) {
+    if (LOG_LOCK()) {
+        return -1;
+    }
+    int result = -1;
+    log_async_t *async = NULL;
+    async_reclaim_retired_unlocked();
+    if (async_load()) {
+        avs_log_internal_forced_l__(AVS_LOG_ERROR, "avs_log", __FILE__,
+                                    __LINE__,
+                                    "asynchronous logging already enabled");
+    } else if (!(result = async_init(&async, config))) {
+        if (async->binary_writer) {
+            async_write_binary(async, BINARY_LOG_MAGIC,
+                               sizeof(BINARY_LOG_MAGIC) - 1);
+        }
+        atomic_store(&g_log.async, (uintptr_t) async);
+    }
+    LOG_UNLOCK();
+    return result;
+}
+
+int avs_log_async_run(void) {
+    log_async_t *async = async_acquire();
+    if (!async) {
+        return -1;
+    }
+    if (avs_mutex_lock(async->mutex)) {
+        async_release();
+        return -1;
+    }
+    int result = 0;
+    while (!async->stopping) {
+        if (async_drain_locked(async, async->mask + 1)) {
+            continue;
+        }
+        atomic_fetch_add(&async->consumers_sleeping, 1);
+        if (!async_has_data(async) && !async->stopping
+                && avs_condvar_wait(async->condvar, async->mutex,
+                                    AVS_TIME_MONOTONIC_INVALID)
+                               < 0) {
+            result = -1;
+        }
+        atomic_fetch_sub(&async->consumers_sleeping, 1);
+        if (result) {
+            break;
+        }
+    }
+    avs_mutex_unlock(async->mutex);
+    async_release();
+    return result;
+}
+
+void avs_log_async_flush(void) {
+    log_async_t *async = async_acquire();
+    if (!async) {
+        return;
+    }
+    if (!avs_mutex_lock(async->mutex)) {
+        async_drain_locked(async, SIZE_MAX);
+        avs_mutex_unlock(async->mutex);
+    }
+    async_release();
+}
+
+void avs_log_async_disable(void) {
+    if (LOG_LOCK()) {
+        return;
+    }
+    log_async_t *async = async_load();
+    if (async) {
+        atomic_store(&async->disabled, true);
+        atomic_store(&g_log.async, (uintptr_t) NULL);
+    }
+    LOG_UNLOCK();
+    if (!async) {
+        return;
+    }
+
+    // new messages are now logged synchronously; wait for the threads that
+    // are still logging asynchronously and deliver whatever they have queued
+    if (!avs_mutex_lock(async->mutex)) {
+        while (atomic_load(&async->producers)) {
+            if (avs_condvar_wait(async->condvar, async->mutex,
+                                 AVS_TIME_MONOTONIC_INVALID)
+                    < 0) {
+                break;
+            }
+        }
+        async_drain_locked(async, SIZE_MAX);
+        async->stopping = true;
+        avs_condvar_notify_all(async->condvar);
+        avs_mutex_unlock(async->mutex);
+    }
+
+    if (!LOG_LOCK()) {
+        g_log.async_dropped = atomic_load(&async->dropped);
+        async->retired_next = g_log.retired_async;
+        g_log.retired_async = async;
+        async_reclaim_retired_unlocked();
+        LOG_UNLOCK();
+    }
+}
+
+size_t avs_log_async_dropped_count(void) {
+    size_t result = 0;
+    if (!LOG_LOCK()) {
+        log_async_t *async = async_load();
+        result = async ? atomic_load(&async->dropped) : g_log.async_dropped;
+        LOG_UNLOCK();
+    }
+    return result;
+}
+#    else  // AVS_LOG_WITH_ASYNC
+int avs_log_async_enable(const avs_log_async_config_t *config) {
+    (void) config;
+    avs_log_internal_forced_l__(AVS_LOG_ERROR, "avs_log", __FILE__, __LINE__,
+                                "asynchronous logging not supported");
+    return -1;
+}
+
+int avs_log_async_run(void) {
+    return -1;
+}
+
+void avs_log_async_flush(void) {
+}
+
+void avs_log_async_disable(void) {
+}
+
+size_t avs_log_async_dropped_count(void) {
+    return 0;
+}
+#    endif // AVS_LOG_WITH_ASYNC
+
 void avs_log_internal_forced_v__(avs_log_level_t level,
                                  const char *module,
                                  const char *file,
                                  unsigned line,
                                  const char *msg,
                                  va_list ap) {
+#    ifdef AVS_LOG_WITH_ASYNC
+    if (!async_log_v(level, module, file, line, msg, ap)) {
+        return;
+    }
+#    endif // AVS_LOG_WITH_ASYNC
 #    ifdef AVS_COMMONS_LOG_USE_GLOBAL_BUFFER
     if (LOG_LOCK()) {
         return;
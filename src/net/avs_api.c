@@ -140,6 +140,28 @@ avs_error_t avs_net_socket_send(avs_net_socket_t *socket,
     return socket->operations->send(socket, buffer, buffer_length);
 }
 
+avs_error_t avs_net_socket_send_vector(avs_net_socket_t *socket,
+                                       const avs_net_socket_iovec_t *iov,
+                                       size_t iovcnt) {
+    if (!socket->operations->send_vector) {
+        return avs_errno(AVS_ENOTSUP);
+    }
+    return socket->operations->send_vector(socket, iov, iovcnt);
+}
+
+avs_error_t avs_net_socket_send_file(avs_net_socket_t *socket,
+                                     FILE *file,
+                                     avs_off_t offset,
+                                     size_t size,
+                                     size_t *out_bytes_sent) {
+    *out_bytes_sent = 0;
+    if (!socket->operations->send_file) {
+        return avs_errno(AVS_ENOTSUP);
+    }
+    return socket->operations->send_file(socket, file, offset, size,
+                                         out_bytes_sent);
+}
+
 avs_error_t avs_net_socket_send_to(avs_net_socket_t *socket,
                                    const void *buffer,
                                    size_t buffer_length,
@@ -408,6 +430,45 @@ static avs_error_t send_debug(avs_net_socket_t *debug_socket,
     return err;
 }
 
+static avs_error_t send_vector_debug(avs_net_socket_t *debug_socket,
+                                     const avs_net_socket_iovec_t *iov,
+                                     size_t iovcnt) {
+    avs_error_t err = avs_net_socket_send_vector(
+            ((avs_net_socket_debug_t *) debug_socket)->socket, iov, iovcnt);
+    if (avs_is_ok(err)) {
+        fprintf(communication_log, "\n----------SEND----------\n");
+        for (size_t i = 0; i < iovcnt; ++i) {
+            fwrite(iov[i].data, 1, iov[i].size, communication_log);
+        }
+        fprintf(communication_log, "\n--------SEND-END--------\n");
+        fflush(communication_log);
+    } else if (err.category != AVS_ERRNO_CATEGORY || err.code != AVS_ENOTSUP) {
+        fprintf(communication_log, "\n------SEND-FAILURE------\n");
+    }
+    return err;
+}
+
+static avs_error_t send_file_debug(avs_net_socket_t *debug_socket,
+                                   FILE *file,
+                                   avs_off_t offset,
+                                   size_t size,
+                                   size_t *out_bytes_sent) {
+    avs_error_t err = avs_net_socket_send_file(
+            ((avs_net_socket_debug_t *) debug_socket)->socket, file, offset,
+            size, out_bytes_sent);
+    if (avs_is_ok(err)) {
+        fprintf(communication_log,
+                "\n----------SEND----------\n"
+                "<%lu bytes sent from file>"
+                "\n--------SEND-END--------\n",
+                (unsigned long) *out_bytes_sent);
+        fflush(communication_log);
+    } else if (err.category != AVS_ERRNO_CATEGORY || err.code != AVS_ENOTSUP) {
+        fprintf(communication_log, "\n------SEND-FAILURE------\n");
+    }
+    return err;
+}
+
 static avs_error_t send_to_debug(avs_net_socket_t *debug_socket,
                                  const void *buffer,
                                  size_t buffer_length,
@@ -652,7 +713,8 @@ static const avs_net_socket_v_table_t debug_vtable = {
     shutdown_debug,       cleanup_debug,     system_socket_debug,
     interface_name_debug, remote_host_debug, remote_hostname_debug,
     remote_port_debug,    local_host_debug,  local_port_debug,
-    get_opt_debug,        set_opt_debug
+    get_opt_debug,        set_opt_debug,     send_vector_debug,
+    send_file_debug
 };
 
 static avs_error_t create_socket_debug(avs_net_socket_t **debug_socket,
@@ -41,6 +41,10 @@
 #        include <ifaddrs.h>
 #    endif
 
+#    ifdef AVS_COMMONS_NET_POSIX_AVS_SOCKET_HAVE_SENDFILE
+#        include <sys/sendfile.h>
+#    endif
+
 #    include "avs_compat.h"
 
 VISIBILITY_SOURCE_BEGIN
@@ -137,6 +141,18 @@ connect_net(avs_net_socket_t *net_socket, const char *host, const char *port);
 static avs_error_t send_net(avs_net_socket_t *net_socket,
                             const void *buffer,
                             size_t buffer_length);
+#    ifdef AVS_COMMONS_NET_POSIX_AVS_SOCKET_HAVE_SENDMSG
+static avs_error_t send_vector_net(avs_net_socket_t *net_socket,
+                                   const avs_net_socket_iovec_t *iov,
+                                   size_t iovcnt);
+#    endif // AVS_COMMONS_NET_POSIX_AVS_SOCKET_HAVE_SENDMSG
+#    ifdef AVS_COMMONS_NET_POSIX_AVS_SOCKET_HAVE_SENDFILE
+static avs_error_t send_file_net(avs_net_socket_t *net_socket,
+                                 FILE *file,
+                                 avs_off_t offset,
+                                 size_t size,
+                                 size_t *out_bytes_sent);
+#    endif // AVS_COMMONS_NET_POSIX_AVS_SOCKET_HAVE_SENDFILE
 static avs_error_t send_to_net(avs_net_socket_t *socket,
                                const void *buffer,
                                size_t buffer_length,
@@ -205,7 +221,13 @@ static const avs_net_socket_v_table_t net_vtable = {
     .get_local_host = local_host_net,
     .get_local_port = local_port_net,
     .get_opt = get_opt_net,
-    .set_opt = set_opt_net
+    .set_opt = set_opt_net,
+#    ifdef AVS_COMMONS_NET_POSIX_AVS_SOCKET_HAVE_SENDMSG
+    .send_vector = send_vector_net,
+#    endif // AVS_COMMONS_NET_POSIX_AVS_SOCKET_HAVE_SENDMSG
+#    ifdef AVS_COMMONS_NET_POSIX_AVS_SOCKET_HAVE_SENDFILE
+    .send_file = send_file_net
+#    endif // AVS_COMMONS_NET_POSIX_AVS_SOCKET_HAVE_SENDFILE
 };
 
 typedef struct {
@@ -1359,6 +1381,174 @@ static avs_error_t send_net(avs_net_socket_t *net_socket_,
     }
 }
 
+#    ifdef AVS_COMMONS_NET_POSIX_AVS_SOCKET_HAVE_SENDMSG
+
+/* Maximum number of buffers passed to a single sendmsg() call */
+#        define SEND_VECTOR_MAX_IOVCNT AVS_NET_SOCKET_SEND_VECTOR_MAX_IOVCNT
+
+typedef struct {
+    size_t bytes_sent;
+    struct iovec iov[SEND_VECTOR_MAX_IOVCNT];
+    size_t iovcnt;
+} send_vector_internal_arg_t;
+
+static avs_error_t send_vector_internal(sockfd_t sockfd, void *arg_) {
+    send_vector_internal_arg_t *arg = (send_vector_internal_arg_t *) arg_;
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = arg->iov;
+    msg.msg_iovlen = arg->iovcnt;
+    ssize_t result = sendmsg(sockfd, &msg, MSG_NOSIGNAL);
+    if (result < 0) {
+        return failure_from_errno();
+    }
+    arg->bytes_sent = (size_t) result;
+    return AVS_OK;
+}
+
+/* Fills arg->iov with up to SEND_VECTOR_MAX_IOVCNT non-empty buffers, starting
+ * at *inout_offset bytes into iov[*inout_index], and returns the number of
+ * bytes described by them. */
+static size_t fill_send_vector(send_vector_internal_arg_t *arg,
+                               const avs_net_socket_iovec_t *iov,
+                               size_t iovcnt,
+                               size_t index,
+                               size_t offset) {
+    size_t total_size = 0;
+    arg->iovcnt = 0;
+    for (; index < iovcnt && arg->iovcnt < SEND_VECTOR_MAX_IOVCNT; ++index) {
+        if (iov[index].size > offset) {
+            arg->iov[arg->iovcnt].iov_base =
+                    (char *) (intptr_t) iov[index].data + offset;
+            arg->iov[arg->iovcnt].iov_len = iov[index].size - offset;
+            total_size += arg->iov[arg->iovcnt].iov_len;
+            ++arg->iovcnt;
+        }
+        offset = 0;
+    }
+    return total_size;
+}
+
+static avs_error_t send_vector_net(avs_net_socket_t *net_socket_,
+                                   const avs_net_socket_iovec_t *iov,
+                                   size_t iovcnt) {
+    net_socket_impl_t *net_socket = (net_socket_impl_t *) net_socket_;
+    send_vector_internal_arg_t arg;
+    size_t index = 0;
+    size_t offset = 0;
+    size_t batch_size = fill_send_vector(&arg, iov, iovcnt, 0, 0);
+
+    if (net_socket->type != AVS_NET_TCP_SOCKET) {
+        size_t total_size = 0;
+        for (size_t i = 0; i < iovcnt; ++i) {
+            total_size += iov[i].size;
+        }
+        if (batch_size != total_size) {
+            LOG(ERROR, _("too many buffers for a single datagram"));
+            return avs_errno(AVS_EMSGSIZE);
+        }
+    }
+
+    /* send at least one datagram, even if zero-length - hence do..while */
+    do {
+        avs_error_t err = call_when_ready(&net_socket->socket, NET_SEND_TIMEOUT,
+                                          AVS_POLLOUT | AVS_POLLERR,
+                                          send_vector_internal, &arg);
+        if (avs_is_err(err)) {
+            LOG(ERROR, _("send failed"));
+            return err;
+        } else if (batch_size != 0 && arg.bytes_sent == 0) {
+            LOG(ERROR, _("send returned 0"));
+            return avs_errno(AVS_EIO);
+        } else if (net_socket->type != AVS_NET_TCP_SOCKET
+                   && arg.bytes_sent < batch_size) {
+            LOG(ERROR, _("sending fail (") "%lu" _("/") "%lu" _(")"),
+                (unsigned long) arg.bytes_sent, (unsigned long) batch_size);
+            return avs_errno(AVS_EIO);
+        }
+        net_socket->bytes_sent += arg.bytes_sent;
+
+        /* skip the data that has been sent */
+        size_t bytes_sent = arg.bytes_sent;
+        while (index < iovcnt && bytes_sent >= iov[index].size - offset) {
+            bytes_sent -= iov[index].size - offset;
+            ++index;
+            offset = 0;
+        }
+        offset += bytes_sent;
+        batch_size = fill_send_vector(&arg, iov, iovcnt, index, offset);
+        /* call sendmsg() multiple times only if the socket is stream-oriented
+         */
+    } while (net_socket->type == AVS_NET_TCP_SOCKET && batch_size > 0);
+
+    return AVS_OK;
+}
+
+#    endif // AVS_COMMONS_NET_POSIX_AVS_SOCKET_HAVE_SENDMSG
+
+#    ifdef AVS_COMMONS_NET_POSIX_AVS_SOCKET_HAVE_SENDFILE
+
+/* Linux sendfile() never transfers more than this in a single call anyway */
+#        define SEND_FILE_MAX_CHUNK 0x7ffff000
+
+typedef struct {
+    size_t bytes_sent;
+    int fd;
+    off_t offset;
+    size_t size;
+} send_file_internal_arg_t;
+
+static avs_error_t send_file_internal(sockfd_t sockfd, void *arg_) {
+    send_file_internal_arg_t *arg = (send_file_internal_arg_t *) arg_;
+    ssize_t result = sendfile(sockfd, arg->fd, &arg->offset,
+                              AVS_MIN(arg->size, SEND_FILE_MAX_CHUNK));
+    if (result < 0) {
+        return failure_from_errno();
+    }
+    arg->bytes_sent = (size_t) result;
+    return AVS_OK;
+}
+
+static avs_error_t send_file_net(avs_net_socket_t *net_socket_,
+                                 FILE *file,
+                                 avs_off_t offset,
+                                 size_t size,
+                                 size_t *out_bytes_sent) {
+    net_socket_impl_t *net_socket = (net_socket_impl_t *) net_socket_;
+    if (net_socket->type != AVS_NET_TCP_SOCKET) {
+        return avs_errno(AVS_ENOTSUP);
+    }
+    send_file_internal_arg_t arg = {
+        .bytes_sent = 0,
+        .fd = fileno(file),
+        .offset = (off_t) offset,
+        .size = size
+    };
+    while (arg.size > 0) {
+        avs_error_t err = call_when_ready(&net_socket->socket, NET_SEND_TIMEOUT,
+                                          AVS_POLLOUT | AVS_POLLERR,
+                                          send_file_internal, &arg);
+        if (avs_is_err(err)) {
+            if (!*out_bytes_sent && err.category == AVS_ERRNO_CATEGORY
+                    && (err.code == AVS_EINVAL || err.code == AVS_ENOSYS)) {
+                /* sendfile() not supported for this kind of file */
+                return avs_errno(AVS_ENOTSUP);
+            }
+            LOG(ERROR, _("sendfile failed"));
+            return err;
+        } else if (arg.bytes_sent == 0) {
+            /* end of file */
+            break;
+        }
+        net_socket->bytes_sent += arg.bytes_sent;
+        *out_bytes_sent += arg.bytes_sent;
+        arg.size -= arg.bytes_sent;
+    }
+    return AVS_OK;
+}
+
+#    endif // AVS_COMMONS_NET_POSIX_AVS_SOCKET_HAVE_SENDFILE
+
 typedef struct {
     const void *data;
     size_t data_length;
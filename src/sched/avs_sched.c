@@ -21,15 +21,20 @@
 #    include <assert.h>
 #    include <inttypes.h>
 #    include <stdio.h>
+#    include <stdlib.h>
 #    include <string.h>
 
+#    include <avsystem/commons/avs_errno.h>
 #    include <avsystem/commons/avs_list.h>
 #    include <avsystem/commons/avs_sched.h>
 #    include <avsystem/commons/avs_utils.h>
 
 #    ifdef AVS_COMMONS_SCHED_THREAD_SAFE
+#        if !defined(__GNUC__) && defined(AVS_COMMONS_HAVE_C11_STDATOMIC)
+#            include <stdatomic.h>
+#        endif // !defined(__GNUC__) && defined(AVS_COMMONS_HAVE_C11_STDATOMIC)
+
 #        include <avsystem/commons/avs_condvar.h>
-#        include <avsystem/commons/avs_init_once.h>
 #        include <avsystem/commons/avs_mutex.h>
 #    else // AVS_COMMONS_SCHED_THREAD_SAFE
 #        define avs_condvar_create(...) 0
@@ -46,15 +51,65 @@
 VISIBILITY_SOURCE_BEGIN
 
 struct avs_sched_job_struct {
-    /** The scheduler for which the job is scheduled. */
+    /**
+     * The scheduler that owns the job structure. It is set when the structure
+     * is allocated and never changes afterwards, as job structures are only
+     * reused within the pool of the same scheduler.
+     */
     avs_sched_t *sched;
 
-    /** Pointer to a handle which may be used to manage the job. */
+    /**
+     * Pointer to a handle which may be used to manage the job. The handle
+     * variable is only written with the scheduler mutex locked.
+     */
     avs_sched_handle_t *handle_ptr;
 
     /** Instant in time at which the job is scheduled. */
     avs_time_monotonic_t instant;
 
+    /**
+     * Sequence number assigned when the job is (re)scheduled. Used to break
+     * ties between jobs scheduled for the same instant, so that they are
+     * executed in the order they were scheduled in.
+     */
+    uint64_t seq;
+
+    /**
+     * Affinity key of the job, used by @ref avs_sched_executor_t to select
+     * the worker that executes it.
+     */
+    uint64_t affinity_key;
+
+    /**
+     * Position of the job in the scheduler's heap. Only meaningful if
+     * <c>in_wheel</c> is false.
+     */
+    size_t heap_index;
+
+    /** True if the job is stored in a timing wheel slot. */
+    bool in_wheel;
+
+    /**
+     * Tick of the timing wheel slot the job is stored in, if <c>in_wheel</c>
+     * is true. It may differ from the tick of <c>instant</c> for overdue jobs
+     * migrated from the heap, which are stored in the wheel's base slot.
+     */
+    int64_t wheel_tick;
+
+    /**
+     * Neighbours of the job in its timing wheel slot, if <c>in_wheel</c> is
+     * true.
+     */
+    avs_sched_job_t *wheel_prev;
+    avs_sched_job_t *wheel_next;
+
+    /**
+     * True if the structure has ever been linked to a handle variable. Such
+     * structures are never released back to the system while the scheduler
+     * exists - see @ref lock_job_by_handle for the rationale.
+     */
+    bool handle_linked;
+
 #    ifdef AVS_COMMONS_WITH_INTERNAL_LOGS
     struct {
         /** File from which AVS_SCHED*() was called. */
@@ -66,6 +121,13 @@ struct avs_sched_job_struct {
     } log_info;
 #    endif // AVS_COMMONS_WITH_INTERNAL_LOGS
 
+    /**
+     * Number of bytes available at <c>clb_data</c>. This may be larger than
+     * the data actually stored, as job structures are reused for different
+     * jobs of similar size.
+     */
+    size_t clb_data_capacity;
+
     /** Callback function to execute. */
     avs_sched_clb_t *clb;
 
@@ -74,6 +136,94 @@ struct avs_sched_job_struct {
     avs_max_align_t clb_data[];
 };
 
+/**
+ * Single slot of a timing wheel: jobs scheduled for the same tick, ordered by
+ * <c>seq</c>.
+ */
+typedef struct {
+    avs_sched_job_t *head;
+    avs_sched_job_t *tail;
+} sched_wheel_slot_t;
+
+/**
+ * Hashed timing wheel used by @ref AVS_SCHED_BACKEND_TIMING_WHEEL .
+ *
+ * The wheel covers <c>slot_count</c> consecutive ticks, starting at
+ * <c>base_tick</c>. A job scheduled for tick <c>t</c> within that range is
+ * stored in slot <c>t % slot_count</c>. Jobs scheduled beyond that range are
+ * stored in the scheduler's heap, and migrated into the wheel as it advances.
+ */
+typedef struct {
+    /** Length of a single tick, in nanoseconds. */
+    int64_t tick_ns;
+
+    /** Number of the earliest tick that may currently be stored in the wheel. */
+    int64_t base_tick;
+
+    /** Number of slots; always a power of two, and at least 64. */
+    size_t slot_count;
+
+    /** Number of jobs currently stored in the wheel. */
+    size_t job_count;
+
+    /** Bitmap of non-empty slots, <c>slot_count / 64</c> words long. */
+    uint64_t *occupied;
+
+    sched_wheel_slot_t slots[];
+} sched_wheel_t;
+
+/** Callback data capacity of job structures in the smallest pool class. */
+#    define POOL_MIN_DATA_CAPACITY 16
+
+/**
+ * Number of pool size classes. Class <c>k</c> holds job structures with
+ * callback data capacity of <c>POOL_MIN_DATA_CAPACITY << k</c> bytes. Larger
+ * job structures are allocated with their exact size, and kept in a separate
+ * free list.
+ */
+#    define POOL_CLASSES 8
+
+/**
+ * Default limit of job structures kept on the free lists. Structures released
+ * while the limit is reached are freed instead, unless they have ever been
+ * linked to a handle. The effective limit is never lower than
+ * @ref avs_sched_config_t::job_pool_prealloc .
+ */
+#    define POOL_MAX_FREE_JOBS 64
+
+/**
+ * Pool of unused job structures, reused so that steady-state scheduling does
+ * not require any memory allocation.
+ *
+ * The number of pooled structures is limited by <c>max_free_count</c>, so that
+ * a burst of scheduled jobs does not keep its peak memory usage for the whole
+ * lifetime of the scheduler. The limit does not apply to structures that have
+ * ever been linked to a handle, which are retained until the scheduler is
+ * destroyed.
+ */
+typedef struct {
+    /**
+     * Free lists of job structures for each size class, and one more list of
+     * structures too large for any of the classes.
+     */
+    AVS_LIST(avs_sched_job_t) free_jobs[POOL_CLASSES + 1];
+
+    /** Number of job allocations satisfied from the free lists. */
+    uint64_t hits;
+
+    /** Number of job allocations that required allocating memory. */
+    uint64_t misses;
+
+    /** Number of job structures currently on the free lists. */
+    size_t free_count;
+
+    /**
+     * Number of job structures on the free lists above which released
+     * structures that have never been linked to a handle are freed.
+     */
+    size_t max_free_count;
+} sched_pool_t;
+
 struct avs_sched_struct {
 #    ifdef AVS_COMMONS_WITH_INTERNAL_LOGS
     /** Name of the scheduler. */
@@ -85,7 +235,7 @@ struct avs_sched_struct {
 
 #    ifdef AVS_COMMONS_SCHED_THREAD_SAFE
     /**
-     * Mutex that guards access to the jobs list.
+     * Mutex that guards access to the jobs heap.
      */
     avs_mutex_t *mutex;
 
@@ -96,8 +246,39 @@ struct avs_sched_struct {
     avs_condvar_t *task_condvar;
 #    endif // AVS_COMMONS_SCHED_THREAD_SAFE
 
-    /** Scheduled jobs. */
-    AVS_LIST(avs_sched_job_t) jobs;
+    /**
+     * Scheduled jobs, organized as a binary min-heap ordered by
+     * <c>(instant, seq)</c>. Each job stores its own position in
+     * <c>heap_index</c>, which allows removing arbitrary jobs in logarithmic
+     * time.
+     */
+    avs_sched_job_t **heap;
+
+    /** Number of jobs currently stored in @ref avs_sched_struct::heap . */
+    size_t heap_size;
+
+    /** Number of allocated slots in @ref avs_sched_struct::heap . */
+    size_t heap_capacity;
+
+    /** Sequence number that will be assigned to the next scheduled job. */
+    uint64_t next_seq;
+
+    /**
+     * Timing wheel, if the scheduler uses
+     * @ref AVS_SCHED_BACKEND_TIMING_WHEEL . The heap is still used for jobs
+     * that are too far in the future to fit in the wheel. NULL otherwise.
+     */
+    sched_wheel_t *wheel;
+
+    /** Unused job structures. */
+    sched_pool_t pool;
+
+    /**
+     * Statistics, allocated only if enabled with
+     * @ref avs_sched_stats_enable . The <c>queue_depth</c> field is not
+     * maintained, and computed when the statistics are retrieved instead.
+     */
+    avs_sched_stats_t *stats;
 
     /**
      * A flag that prevents scheduling new jobs while the scheduler is shutting
@@ -107,21 +288,6 @@ struct avs_sched_struct {
 };
 
 #    ifdef AVS_COMMONS_SCHED_THREAD_SAFE
-/**
- * The global mutex that guards accesses to all @ref avs_sched_handle_t
- * variables.
- *
- * That could be guarded by the normal per-scheduler mutexes, but that would
- * require passing the scheduler to functions such as @ref avs_sched_del .
- */
-static avs_mutex_t *g_handle_access_mutex;
-static volatile avs_init_once_handle_t g_init_handle;
-
-static int init_globals(void *dummy) {
-    (void) dummy;
-    return avs_mutex_create(&g_handle_access_mutex);
-}
-
 static void nonfailing_mutex_lock(avs_mutex_t *mutex) {
     if (avs_mutex_lock(mutex)) {
         AVS_UNREACHABLE("could not lock mutex");
@@ -131,14 +297,6 @@ static void nonfailing_mutex_lock(avs_mutex_t *mutex) {
 #        define nonfailing_mutex_lock(...) ((void) 0)
 #    endif // AVS_COMMONS_SCHED_THREAD_SAFE
 
-void _avs_sched_cleanup_global_state(void);
-void _avs_sched_cleanup_global_state(void) {
-#    ifdef AVS_COMMONS_SCHED_THREAD_SAFE
-    avs_mutex_cleanup(&g_handle_access_mutex);
-    g_init_handle = NULL;
-#    endif // AVS_COMMONS_SCHED_THREAD_SAFE
-}
-
 #    define SCHED_LOG(Sched, Level, ...)                          \
         LOG(Level, "Scheduler \"%s\": " AVS_VARARG0(__VA_ARGS__), \
             ((Sched)->name ? (Sched)->name                        \
@@ -189,13 +347,688 @@ static const char *job_log_id_impl(char buf[static JOB_LOG_ID_MAX_LENGTH],
 
 #    endif // AVS_COMMONS_WITH_INTERNAL_LOGS
 
-avs_sched_t *avs_sched_new(const char *name, void *data) {
-#    ifdef AVS_COMMONS_SCHED_THREAD_SAFE
-    if (avs_init_once(&g_init_handle, init_globals, NULL)) {
-        LOG(ERROR, _("Could not initialize globals"));
+#    define HEAP_INITIAL_CAPACITY 16
+
+static bool job_before(const avs_sched_job_t *a, const avs_sched_job_t *b) {
+    if (avs_time_monotonic_before(a->instant, b->instant)) {
+        return true;
+    } else if (avs_time_monotonic_before(b->instant, a->instant)) {
+        return false;
+    }
+    return a->seq < b->seq;
+}
+
+static void heap_set(avs_sched_t *sched, size_t index, avs_sched_job_t *job) {
+    sched->heap[index] = job;
+    job->heap_index = index;
+}
+
+static void heap_sift_up(avs_sched_t *sched, size_t index) {
+    avs_sched_job_t *job = sched->heap[index];
+    while (index > 0) {
+        size_t parent = (index - 1) / 2;
+        if (!job_before(job, sched->heap[parent])) {
+            break;
+        }
+        heap_set(sched, index, sched->heap[parent]);
+        index = parent;
+    }
+    heap_set(sched, index, job);
+}
+
+static void heap_sift_down(avs_sched_t *sched, size_t index) {
+    avs_sched_job_t *job = sched->heap[index];
+    while (2 * index + 1 < sched->heap_size) {
+        size_t child = 2 * index + 1;
+        if (child + 1 < sched->heap_size
+                && job_before(sched->heap[child + 1], sched->heap[child])) {
+            ++child;
+        }
+        if (!job_before(sched->heap[child], job)) {
+            break;
+        }
+        heap_set(sched, index, sched->heap[child]);
+        index = child;
+    }
+    heap_set(sched, index, job);
+}
+
+static void heap_fix(avs_sched_t *sched, size_t index) {
+    if (index > 0
+            && job_before(sched->heap[index], sched->heap[(index - 1) / 2])) {
+        heap_sift_up(sched, index);
+    } else {
+        heap_sift_down(sched, index);
+    }
+}
+
+static int heap_reserve(avs_sched_t *sched, size_t size) {
+    if (size <= sched->heap_capacity) {
+        return 0;
+    }
+    size_t new_capacity =
+            sched->heap_capacity ? sched->heap_capacity : HEAP_INITIAL_CAPACITY;
+    while (new_capacity < size) {
+        if (new_capacity > SIZE_MAX / (2 * sizeof(avs_sched_job_t *))) {
+            return -1;
+        }
+        new_capacity *= 2;
+    }
+    avs_sched_job_t **new_heap = (avs_sched_job_t **) avs_realloc(
+            sched->heap, new_capacity * sizeof(avs_sched_job_t *));
+    if (!new_heap) {
+        return -1;
+    }
+    sched->heap = new_heap;
+    sched->heap_capacity = new_capacity;
+    return 0;
+}
+
+/**
+ * Inserts @p job into the heap. Capacity must have been ensured earlier using
+ * @ref heap_reserve .
+ */
+static void heap_insert(avs_sched_t *sched, avs_sched_job_t *job) {
+    assert(sched->heap_size < sched->heap_capacity);
+    job->in_wheel = false;
+    sched->heap[sched->heap_size] = job;
+    heap_sift_up(sched, sched->heap_size++);
+}
+
+static void heap_remove(avs_sched_t *sched, avs_sched_job_t *job) {
+    size_t index = job->heap_index;
+    assert(index < sched->heap_size);
+    assert(sched->heap[index] == job);
+    avs_sched_job_t *last = sched->heap[--sched->heap_size];
+    if (index < sched->heap_size) {
+        heap_set(sched, index, last);
+        heap_fix(sched, index);
+    }
+    job->heap_index = SIZE_MAX;
+}
+
+static bool job_in_heap(avs_sched_t *sched, const avs_sched_job_t *job) {
+    return job->heap_index < sched->heap_size
+           && sched->heap[job->heap_index] == job;
+}
+
+#    define WHEEL_DEFAULT_TICK_MS 10
+#    define WHEEL_DEFAULT_SLOTS 1024
+#    define WHEEL_MIN_SLOTS 64
+
+static sched_wheel_t *wheel_new(avs_time_duration_t tick, size_t slots) {
+    int64_t tick_ns;
+    if (!avs_time_duration_valid(tick)
+            || !avs_time_duration_less(AVS_TIME_DURATION_ZERO, tick)) {
+        tick = avs_time_duration_from_scalar(WHEEL_DEFAULT_TICK_MS,
+                                             AVS_TIME_MS);
+    }
+    if (avs_time_duration_to_scalar(&tick_ns, AVS_TIME_NS, tick)) {
+        LOG(ERROR, _("timing wheel tick too long"));
         return NULL;
     }
-#    endif // AVS_COMMONS_SCHED_THREAD_SAFE
+    if (!slots) {
+        slots = WHEEL_DEFAULT_SLOTS;
+    }
+    size_t slot_count = WHEEL_MIN_SLOTS;
+    while (slot_count < slots) {
+        if (slot_count > SIZE_MAX / (2 * sizeof(sched_wheel_slot_t))) {
+            LOG(ERROR, _("too many timing wheel slots"));
+            return NULL;
+        }
+        slot_count *= 2;
+    }
+    sched_wheel_t *wheel = (sched_wheel_t *) avs_calloc(
+            1, sizeof(sched_wheel_t) + slot_count * sizeof(sched_wheel_slot_t)
+                       + slot_count / 64 * sizeof(uint64_t));
+    if (!wheel) {
+        return NULL;
+    }
+    wheel->tick_ns = tick_ns;
+    wheel->slot_count = slot_count;
+    wheel->occupied = (uint64_t *) &wheel->slots[slot_count];
+    int64_t now_ns;
+    if (!avs_time_monotonic_to_scalar(&now_ns, AVS_TIME_NS,
+                                      avs_time_monotonic_now())) {
+        wheel->base_tick = now_ns / tick_ns;
+    }
+    return wheel;
+}
+
+/**
+ * Converts @p instant to a number of tick, rounding up if @p instant is not a
+ * multiple of the tick length.
+ *
+ * @returns 0 on success, or a negative value if the tick number cannot be
+ *          represented, which may only happen for instants hundreds of years
+ *          away from the monotonic clock's epoch.
+ */
+static int wheel_tick_of(const sched_wheel_t *wheel,
+                         avs_time_monotonic_t instant,
+                         int64_t *out_tick) {
+    int64_t ns;
+    if (avs_time_monotonic_to_scalar(&ns, AVS_TIME_NS, instant)
+            || ns > INT64_MAX - wheel->tick_ns) {
+        return -1;
+    }
+    *out_tick = ns / wheel->tick_ns;
+    if (ns % wheel->tick_ns > 0) {
+        ++*out_tick;
+    }
+    return 0;
+}
+
+static avs_time_monotonic_t wheel_instant_of(const sched_wheel_t *wheel,
+                                             int64_t tick) {
+    return avs_time_monotonic_from_scalar(tick * wheel->tick_ns, AVS_TIME_NS);
+}
+
+static size_t wheel_slot_index(const sched_wheel_t *wheel, int64_t tick) {
+    return (size_t) ((uint64_t) tick & (wheel->slot_count - 1));
+}
+
+static unsigned lowest_bit_set(uint64_t word) {
+    assert(word);
+    unsigned result = 0;
+    for (unsigned shift = 32; shift; shift /= 2) {
+        if (!(word & ((UINT64_C(1) << shift) - 1))) {
+            word >>= shift;
+            result += shift;
+        }
+    }
+    return result;
+}
+
+/**
+ * Finds the earliest non-empty slot of the wheel.
+ *
+ * @returns Pointer to the slot, or NULL if the wheel is empty. The tick number
+ *          of the slot is stored in @p out_tick .
+ */
+static sched_wheel_slot_t *wheel_first_slot(sched_wheel_t *wheel,
+                                             int64_t *out_tick) {
+    if (!wheel->job_count) {
+        return NULL;
+    }
+    const size_t words = wheel->slot_count / 64;
+    const size_t start = wheel_slot_index(wheel, wheel->base_tick);
+    // the first word is visited twice: first for the slots at or after start,
+    // then, after wrapping around, for the slots before it
+    for (size_t i = 0; i <= words; ++i) {
+        size_t word_index = (start / 64 + i) % words;
+        uint64_t word = wheel->occupied[word_index];
+        if (i == 0) {
+            word &= ~UINT64_C(0) << (start % 64);
+        } else if (i == words) {
+            word &= (UINT64_C(1) << (start % 64)) - 1;
+        }
+        if (word) {
+            size_t index = word_index * 64 + lowest_bit_set(word);
+            *out_tick = wheel->base_tick
+                        + (int64_t) ((index - start)
+                                     & (wheel->slot_count - 1));
+            return &wheel->slots[index];
+        }
+    }
+    AVS_UNREACHABLE("timing wheel job count inconsistent with its bitmap");
+    return NULL;
+}
+
+static void wheel_slot_insert(sched_wheel_t *wheel,
+                              int64_t tick,
+                              avs_sched_job_t *job) {
+    size_t index = wheel_slot_index(wheel, tick);
+    sched_wheel_slot_t *slot = &wheel->slots[index];
+    // jobs are normally appended, as they are scheduled in seq order; only
+    // jobs migrated from the heap might need to be placed earlier
+    avs_sched_job_t *prev = slot->tail;
+    while (prev && prev->seq > job->seq) {
+        prev = prev->wheel_prev;
+    }
+    job->wheel_prev = prev;
+    job->wheel_next = prev ? prev->wheel_next : slot->head;
+    if (job->wheel_next) {
+        job->wheel_next->wheel_prev = job;
+    } else {
+        slot->tail = job;
+    }
+    if (prev) {
+        prev->wheel_next = job;
+    } else {
+        slot->head = job;
+    }
+    job->in_wheel = true;
+    job->wheel_tick = tick;
+    wheel->occupied[index / 64] |= UINT64_C(1) << (index % 64);
+    ++wheel->job_count;
+}
+
+static void wheel_remove(sched_wheel_t *wheel, avs_sched_job_t *job) {
+    assert(job->in_wheel);
+    size_t index = wheel_slot_index(wheel, job->wheel_tick);
+    sched_wheel_slot_t *slot = &wheel->slots[index];
+    if (job->wheel_prev) {
+        job->wheel_prev->wheel_next = job->wheel_next;
+    } else {
+        slot->head = job->wheel_next;
+    }
+    if (job->wheel_next) {
+        job->wheel_next->wheel_prev = job->wheel_prev;
+    } else {
+        slot->tail = job->wheel_prev;
+    }
+    if (!slot->head) {
+        wheel->occupied[index / 64] &= ~(UINT64_C(1) << (index % 64));
+    }
+    job->wheel_prev = NULL;
+    job->wheel_next = NULL;
+    job->in_wheel = false;
+    --wheel->job_count;
+}
+
+/**
+ * Inserts @p job into the timing wheel if it fits in its range, or into the
+ * heap otherwise. The job's instant is rounded up to a multiple of the tick
+ * length, and moved to the wheel's base tick if earlier than that.
+ */
+static void wheel_insert(avs_sched_t *sched, avs_sched_job_t *job) {
+    sched_wheel_t *wheel = sched->wheel;
+    int64_t tick;
+    if (wheel_tick_of(wheel, job->instant, &tick)) {
+        heap_insert(sched, job);
+        return;
+    }
+    if (tick < wheel->base_tick) {
+        tick = wheel->base_tick;
+    }
+    job->instant = wheel_instant_of(wheel, tick);
+    if (tick - wheel->base_tick >= (int64_t) wheel->slot_count) {
+        heap_insert(sched, job);
+    } else {
+        wheel_slot_insert(wheel, tick, job);
+    }
+}
+
+/**
+ * Moves the base of the timing wheel forward, up to the tick containing
+ * @p now , but not beyond the earliest scheduled job. Jobs from the heap that
+ * fit in the wheel's range afterwards are migrated into the wheel.
+ */
+static void wheel_advance(avs_sched_t *sched, avs_time_monotonic_t now) {
+    sched_wheel_t *wheel = sched->wheel;
+    int64_t now_ns;
+    if (avs_time_monotonic_to_scalar(&now_ns, AVS_TIME_NS, now)) {
+        return;
+    }
+    int64_t target = now_ns / wheel->tick_ns;
+    int64_t first_tick;
+    if (wheel_first_slot(wheel, &first_tick) && first_tick < target) {
+        target = first_tick;
+    }
+    if (target <= wheel->base_tick) {
+        return;
+    }
+    wheel->base_tick = target;
+    int64_t tick;
+    while (sched->heap_size
+           && !wheel_tick_of(wheel, sched->heap[0]->instant, &tick)
+           && tick - wheel->base_tick < (int64_t) wheel->slot_count) {
+        avs_sched_job_t *job = sched->heap[0];
+        heap_remove(sched, job);
+        wheel_slot_insert(wheel, AVS_MAX(tick, wheel->base_tick), job);
+    }
+}
+
+/**
+ * Inserts @p job into the job store appropriate for the scheduler's backend.
+ * Heap capacity must have been ensured earlier using @ref heap_reserve .
+ */
+static void store_insert(avs_sched_t *sched, avs_sched_job_t *job) {
+    if (sched->wheel) {
+        if (!sched->wheel->job_count) {
+            // make sure that the wheel covers as much of the future as
+            // possible, as it might have not been advanced for a long time
+            wheel_advance(sched, avs_time_monotonic_now());
+        }
+        wheel_insert(sched, job);
+    } else {
+        heap_insert(sched, job);
+    }
+}
+
+static void store_remove(avs_sched_t *sched, avs_sched_job_t *job) {
+    if (job->in_wheel) {
+        wheel_remove(sched->wheel, job);
+    } else {
+        heap_remove(sched, job);
+    }
+}
+
+static avs_sched_job_t *store_first(avs_sched_t *sched) {
+    avs_sched_job_t *result = sched->heap_size ? sched->heap[0] : NULL;
+    int64_t tick;
+    sched_wheel_slot_t *slot;
+    if (sched->wheel && (slot = wheel_first_slot(sched->wheel, &tick))
+            && (!result || job_before(slot->head, result))) {
+        result = slot->head;
+    }
+    return result;
+}
+
+static bool job_scheduled(avs_sched_t *sched, const avs_sched_job_t *job) {
+    return job->in_wheel ? !!sched->wheel : job_in_heap(sched, job);
+}
+
+static size_t store_size(avs_sched_t *sched) {
+    return sched->heap_size + (sched->wheel ? sched->wheel->job_count : 0);
+}
+
+/**
+ * Removes all jobs from the scheduler's job store.
+ *
+ * @returns List of all removed jobs, in unspecified order.
+ */
+static AVS_LIST(avs_sched_job_t) store_detach_all(avs_sched_t *sched) {
+    AVS_LIST(avs_sched_job_t) result = NULL;
+    avs_sched_job_t *job;
+    while ((job = store_first(sched))) {
+        store_remove(sched, job);
+        AVS_LIST_INSERT(&result, job);
+    }
+    return result;
+}
+
+#    if defined(AVS_COMMONS_SCHED_THREAD_SAFE) && defined(__GNUC__)
+/*
+ * Handle variables are owned by the user and have a plain pointer type, so they
+ * are accessed using atomic builtins, which, unlike the C11 generic functions,
+ * may be applied to non-atomic objects.
+ */
+#        define HANDLE_LOAD(Ptr) __atomic_load_n((Ptr), __ATOMIC_ACQUIRE)
+#        define HANDLE_STORE(Ptr, Value) \
+            __atomic_store_n((Ptr), (Value), __ATOMIC_RELEASE)
+#    elif defined(AVS_COMMONS_SCHED_THREAD_SAFE) \
+            && defined(AVS_COMMONS_HAVE_C11_STDATOMIC)
+/* this relies on atomic pointers having the same representation as plain ones,
+ * which is the case for all mainstream implementations */
+#        define HANDLE_LOAD(Ptr)                                               \
+            atomic_load_explicit((avs_sched_job_t *_Atomic *) (Ptr),           \
+                                 memory_order_acquire)
+#        define HANDLE_STORE(Ptr, Value)                                       \
+            atomic_store_explicit((avs_sched_job_t *_Atomic *) (Ptr), (Value), \
+                                  memory_order_release)
+#    else
+#        define HANDLE_LOAD(Ptr) (*(Ptr))
+#        define HANDLE_STORE(Ptr, Value) (*(Ptr) = (Value))
+#    endif
+
+/**
+ * Reads the value of a handle variable, which might be concurrently modified by
+ * a thread that holds the mutex of the scheduler owning the referenced job.
+ *
+ * The read has acquire semantics, pairing with the release store in
+ * @ref handle_write_locked , so the fields of the job that are written before
+ * it is linked to the handle (in particular <c>job->sched</c>) may be safely
+ * accessed afterwards.
+ */
+static avs_sched_job_t *handle_read(avs_sched_handle_t *handle_ptr) {
+    return HANDLE_LOAD(handle_ptr);
+}
+
+/**
+ * Modifies the value of a handle variable. Must be called with the mutex of the
+ * scheduler owning the job (previously) referenced by the handle locked.
+ */
+static void handle_write_locked(avs_sched_handle_t *handle_ptr,
+                                avs_sched_job_t *job) {
+    HANDLE_STORE(handle_ptr, job);
+}
+
+/**
+ * Locks the scheduler owning the job referenced by @p handle_ptr, and returns
+ * that job. Returns NULL, without locking anything, if the handle does not
+ * refer to any job.
+ *
+ * The handle is read without holding any lock, so the job might be unlinked
+ * from it, and released to the pool, concurrently. This relies on the
+ * following invariant: a job structure that has ever been linked to a handle
+ * (<c>job->handle_linked</c>) is never freed before the scheduler is destroyed
+ * - @ref pool_release keeps such structures in the pool regardless of its
+ * limit - and never changes its owning scheduler, so <c>job->sched</c> is
+ * always valid. Handles are only modified under the owning scheduler's mutex,
+ * so it is enough to verify that the handle still refers to the same job after
+ * locking it.
+ */
+static avs_sched_job_t *lock_job_by_handle(avs_sched_handle_t *handle_ptr) {
+    avs_sched_job_t *job;
+    while ((job = handle_read(handle_ptr))) {
+        nonfailing_mutex_lock(job->sched->mutex);
+        if (handle_read(handle_ptr) == job) {
+            AVS_ASSERT(handle_ptr == job->handle_ptr,
+                       "accessing job via non-original handle");
+            AVS_ASSERT(job_scheduled(job->sched, job),
+                       "dangling handle detected");
+            return job;
+        }
+        // job has been unlinked by another thread in the meantime
+        avs_mutex_unlock(job->sched->mutex);
+    }
+    return NULL;
+}
+
+static size_t pool_class_of(size_t clb_data_size) {
+    size_t result = 0;
+    size_t capacity = POOL_MIN_DATA_CAPACITY;
+    while (result < POOL_CLASSES && capacity < clb_data_size) {
+        ++result;
+        capacity *= 2;
+    }
+    return result;
+}
+
+static avs_sched_job_t *pool_new_job(avs_sched_t *sched,
+                                     size_t clb_data_size) {
+    size_t pool_class = pool_class_of(clb_data_size);
+    size_t capacity = pool_class < POOL_CLASSES
+                              ? (size_t) POOL_MIN_DATA_CAPACITY << pool_class
+                              : clb_data_size;
+    AVS_LIST(avs_sched_job_t) job = (avs_sched_job_t *) AVS_LIST_NEW_BUFFER(
+            sizeof(avs_sched_job_t) + capacity);
+    if (job) {
+        job->sched = sched;
+        job->handle_linked = false;
+        job->clb_data_capacity = capacity;
+    }
+    return job;
+}
+
+/**
+ * Takes a job structure that can hold @p clb_data_size bytes of callback data
+ * from the pool, or allocates a new one if there is none available.
+ */
+static avs_sched_job_t *pool_take(avs_sched_t *sched, size_t clb_data_size) {
+    size_t pool_class = pool_class_of(clb_data_size);
+    AVS_LIST(avs_sched_job_t) *job_ptr = &sched->pool.free_jobs[pool_class];
+    if (pool_class == POOL_CLASSES) {
+        // oversized job structures have varying sizes
+        while (*job_ptr && (*job_ptr)->clb_data_capacity < clb_data_size) {
+            AVS_LIST_ADVANCE_PTR(&job_ptr);
+        }
+    }
+    if (*job_ptr) {
+        ++sched->pool.hits;
+        --sched->pool.free_count;
+        return AVS_LIST_DETACH(job_ptr);
+    }
+    ++sched->pool.misses;
+    return pool_new_job(sched, clb_data_size);
+}
+
+/**
+ * Returns a job structure that is no longer scheduled to the pool, or frees it
+ * if the pool is full and the structure may be safely freed.
+ */
+static void pool_release(avs_sched_t *sched, AVS_LIST(avs_sched_job_t) job) {
+    assert(!AVS_LIST_NEXT(job));
+    if (sched->pool.free_count >= sched->pool.max_free_count
+            && !job->handle_linked) {
+        // may not be reachable by lock_job_by_handle(), so it's safe to free
+        AVS_LIST_DELETE(&job);
+        return;
+    }
+    size_t pool_class = pool_class_of(job->clb_data_capacity);
+    AVS_LIST_INSERT(&sched->pool.free_jobs[pool_class], job);
+    ++sched->pool.free_count;
+}
+
+static int pool_prealloc(avs_sched_t *sched, size_t count, size_t data_size) {
+    for (size_t i = 0; i < count; ++i) {
+        avs_sched_job_t *job = pool_new_job(sched, data_size);
+        if (!job) {
+            return -1;
+        }
+        pool_release(sched, job);
+    }
+    return 0;
+}
+
+static void pool_cleanup(avs_sched_t *sched) {
+    for (size_t i = 0; i < AVS_ARRAY_SIZE(sched->pool.free_jobs); ++i) {
+        AVS_LIST_CLEAR(&sched->pool.free_jobs[i]);
+    }
+    sched->pool.free_count = 0;
+}
+
+/**
+ * Points in time between which a job callback was executing.
+ */
+typedef struct {
+    avs_time_monotonic_t started;
+    avs_time_monotonic_t finished;
+} job_timing_t;
+
+static void histogram_record(avs_sched_histogram_t *histogram,
+                             avs_time_duration_t duration) {
+    if (avs_time_duration_less(duration, AVS_TIME_DURATION_ZERO)) {
+        duration = AVS_TIME_DURATION_ZERO;
+    }
+    int64_t us = 0;
+    avs_time_duration_to_scalar(&us, AVS_TIME_US, duration);
+    size_t bucket = 0;
+    while (us > 0 && bucket < AVS_SCHED_STATS_HISTOGRAM_BUCKETS - 1) {
+        us >>= 1;
+        ++bucket;
+    }
+    ++histogram->buckets[bucket];
+    ++histogram->count;
+    histogram->total = avs_time_duration_add(histogram->total, duration);
+    if (avs_time_duration_less(histogram->max, duration)) {
+        histogram->max = duration;
+    }
+}
+
+static void slowest_callbacks_record(avs_sched_stats_t *stats,
+                                     const avs_sched_job_t *job,
+                                     avs_time_duration_t exec_time) {
+    const char *file = NULL;
+    unsigned line = 0;
+    const char *name = NULL;
+#    ifdef AVS_COMMONS_WITH_INTERNAL_LOGS
+    file = job->log_info.file;
+    line = job->log_info.line;
+    name = job->log_info.name;
+#    endif // AVS_COMMONS_WITH_INTERNAL_LOGS
+    avs_sched_callback_stats_t *entry = NULL;
+    for (size_t i = 0; i < stats->slowest_callbacks_count; ++i) {
+        avs_sched_callback_stats_t *candidate = &stats->slowest_callbacks[i];
+        if (candidate->clb == job->clb && candidate->line == line
+                && candidate->file == file) {
+            entry = candidate;
+            break;
+        }
+    }
+    if (!entry) {
+        if (stats->slowest_callbacks_count
+                < AVS_SCHED_STATS_SLOWEST_CALLBACKS) {
+            entry = &stats->slowest_callbacks[stats->slowest_callbacks_count++];
+        } else {
+            // replace the call site with the shortest maximum execution time,
+            // if it is shorter than the current one
+            entry = &stats->slowest_callbacks[0];
+            for (size_t i = 1; i < AVS_SCHED_STATS_SLOWEST_CALLBACKS; ++i) {
+                if (avs_time_duration_less(
+                            stats->slowest_callbacks[i].max_exec_time,
+                            entry->max_exec_time)) {
+                    entry = &stats->slowest_callbacks[i];
+                }
+            }
+            if (!avs_time_duration_less(entry->max_exec_time, exec_time)) {
+                return;
+            }
+        }
+        entry->file = file;
+        entry->line = line;
+        entry->name = name;
+        entry->clb = job->clb;
+        entry->executions = 0;
+        entry->total_exec_time = AVS_TIME_DURATION_ZERO;
+        entry->max_exec_time = AVS_TIME_DURATION_ZERO;
+    }
+    ++entry->executions;
+    entry->total_exec_time =
+            avs_time_duration_add(entry->total_exec_time, exec_time);
+    if (avs_time_duration_less(entry->max_exec_time, exec_time)) {
+        entry->max_exec_time = exec_time;
+    }
+}
+
+/**
+ * Records the execution of @p job in the statistics, if they are enabled. Must
+ * be called with the scheduler mutex locked.
+ */
+static void stats_record_locked(avs_sched_t *sched,
+                                const avs_sched_job_t *job,
+                                const job_timing_t *timing) {
+    if (!sched->stats) {
+        return;
+    }
+    avs_time_duration_t exec_time =
+            avs_time_monotonic_diff(timing->finished, timing->started);
+    histogram_record(&sched->stats->lateness,
+                     avs_time_monotonic_diff(timing->started, job->instant));
+    histogram_record(&sched->stats->exec_time, exec_time);
+    slowest_callbacks_record(sched->stats, job, exec_time);
+}
+
+/**
+ * Updates the maximum queue depth in the statistics, if they are enabled. Must
+ * be called with the scheduler mutex locked.
+ */
+static void stats_update_queue_depth_locked(avs_sched_t *sched) {
+    if (sched->stats) {
+        size_t depth = store_size(sched);
+        if (depth > sched->stats->max_queue_depth) {
+            sched->stats->max_queue_depth = depth;
+        }
+    }
+}
+
+const avs_sched_config_t AVS_SCHED_DEFAULT_CONFIG = {
+    .backend = AVS_SCHED_BACKEND_HEAP,
+    .wheel_tick = { WHEEL_DEFAULT_TICK_MS / 1000,
+                    (WHEEL_DEFAULT_TICK_MS % 1000) * 1000000 },
+    .wheel_slots = WHEEL_DEFAULT_SLOTS,
+    .job_pool_prealloc = 0,
+    .job_pool_prealloc_data_size = 0
+};
+
+avs_sched_t *avs_sched_new(const char *name, void *data) {
+    return avs_sched_new_with_config(name, data, NULL);
+}
+
+avs_sched_t *avs_sched_new_with_config(const char *name,
+                                       void *data,
+                                       const avs_sched_config_t *config) {
     (void) name;
     avs_sched_t *sched = (avs_sched_t *) avs_calloc(1, sizeof(avs_sched_t));
     if (!sched) {
@@ -214,6 +1047,32 @@ avs_sched_t *avs_sched_new(const char *name, void *data) {
         avs_free(sched);
         return NULL;
     }
+    if (!config) {
+        config = &AVS_SCHED_DEFAULT_CONFIG;
+    }
+    if (config->backend == AVS_SCHED_BACKEND_TIMING_WHEEL
+            && !(sched->wheel =
+                         wheel_new(config->wheel_tick, config->wheel_slots))) {
+        LOG(ERROR, _("Could not create timing wheel"));
+        avs_condvar_cleanup(&sched->task_condvar);
+        avs_mutex_cleanup(&sched->mutex);
+        avs_free(sched);
+        return NULL;
+    }
+    sched->pool.max_free_count =
+            AVS_MAX(config->job_pool_prealloc, POOL_MAX_FREE_JOBS);
+    if (heap_reserve(sched, config->job_pool_prealloc)
+            || pool_prealloc(sched, config->job_pool_prealloc,
+                             config->job_pool_prealloc_data_size)) {
+        LOG(ERROR, _("Could not preallocate jobs"));
+        pool_cleanup(sched);
+        avs_free(sched->heap);
+        avs_free(sched->wheel);
+        avs_condvar_cleanup(&sched->task_condvar);
+        avs_mutex_cleanup(&sched->mutex);
+        avs_free(sched);
+        return NULL;
+    }
     sched->data = data;
     LOG(DEBUG, _("Scheduler \"") "%s" _("\" created, data == ") "%p",
         (sched->name = (name ? name : "(unknown)")), data);
@@ -231,13 +1090,18 @@ void avs_sched_cleanup(avs_sched_t **sched_ptr) {
     // execute any tasks remaining for now
     avs_sched_run(*sched_ptr);
 
-    nonfailing_mutex_lock(g_handle_access_mutex);
-    AVS_LIST_CLEAR(&(*sched_ptr)->jobs) {
-        if ((*sched_ptr)->jobs->handle_ptr) {
-            *(*sched_ptr)->jobs->handle_ptr = NULL;
+    nonfailing_mutex_lock((*sched_ptr)->mutex);
+    AVS_LIST(avs_sched_job_t) jobs = store_detach_all(*sched_ptr);
+    AVS_LIST_CLEAR(&jobs) {
+        if (jobs->handle_ptr) {
+            handle_write_locked(jobs->handle_ptr, NULL);
         }
     }
-    avs_mutex_unlock(g_handle_access_mutex);
+    avs_mutex_unlock((*sched_ptr)->mutex);
+    pool_cleanup(*sched_ptr);
+    avs_free((*sched_ptr)->stats);
+    avs_free((*sched_ptr)->heap);
+    avs_free((*sched_ptr)->wheel);
 
     avs_condvar_cleanup(&(*sched_ptr)->task_condvar);
     avs_mutex_cleanup(&(*sched_ptr)->mutex);
@@ -254,8 +1118,9 @@ void *avs_sched_data(avs_sched_t *sched) {
 
 static avs_time_monotonic_t sched_time_of_next_locked(avs_sched_t *sched) {
     assert(sched);
-    if (sched->jobs) {
-        return sched->jobs->instant;
+    avs_sched_job_t *first = store_first(sched);
+    if (first) {
+        return first->instant;
     }
     return AVS_TIME_MONOTONIC_INVALID;
 }
@@ -307,33 +1172,82 @@ int avs_sched_wait_until_next(avs_sched_t *sched,
 #    endif // AVS_COMMONS_SCHED_THREAD_SAFE
 }
 
-static AVS_LIST(avs_sched_job_t) fetch_job(avs_sched_t *sched,
-                                           avs_time_monotonic_t deadline) {
+/**
+ * Detaches the earliest job scheduled before @p deadline from the scheduler.
+ * Must be called with the scheduler mutex locked.
+ */
+static AVS_LIST(avs_sched_job_t)
+fetch_job_locked(avs_sched_t *sched, avs_time_monotonic_t deadline) {
     AVS_LIST(avs_sched_job_t) result = NULL;
+    if (sched->wheel) {
+        wheel_advance(sched, deadline);
+    }
+    avs_sched_job_t *first = store_first(sched);
+    if (first && avs_time_monotonic_before(first->instant, deadline)) {
+        result = first;
+        if (result->handle_ptr) {
+            assert(*result->handle_ptr == result);
+            handle_write_locked(result->handle_ptr, NULL);
+            result->handle_ptr = NULL;
+        }
+        store_remove(sched, result);
+    }
+    return result;
+}
+
+/**
+ * Locks the scheduler and calls @ref fetch_job_locked .
+ *
+ * @param done_job        If not NULL, a previously fetched job that has already
+ *                        been executed. It is returned to the pool while the
+ *                        scheduler is locked anyway.
+ *
+ * @param done_job_timing If not NULL, execution timing of @p done_job, to
+ *                        record in the statistics.
+ *
+ * @param out_measure     Set to true if the execution timing of the fetched
+ *                        job shall be measured for the statistics.
+ */
+static AVS_LIST(avs_sched_job_t)
+fetch_job(avs_sched_t *sched,
+          avs_time_monotonic_t deadline,
+          AVS_LIST(avs_sched_job_t) done_job,
+          const job_timing_t *done_job_timing,
+          bool *out_measure) {
     nonfailing_mutex_lock(sched->mutex);
-    if (sched->jobs
-            && avs_time_monotonic_before(sched->jobs->instant, deadline)) {
-        if (sched->jobs->handle_ptr) {
-            nonfailing_mutex_lock(g_handle_access_mutex);
-            assert(*sched->jobs->handle_ptr == sched->jobs);
-            *sched->jobs->handle_ptr = NULL;
-            avs_mutex_unlock(g_handle_access_mutex);
-            sched->jobs->handle_ptr = NULL;
+    if (done_job) {
+        if (done_job_timing) {
+            stats_record_locked(sched, done_job, done_job_timing);
         }
-        result = AVS_LIST_DETACH(&sched->jobs);
+        pool_release(sched, done_job);
     }
+    AVS_LIST(avs_sched_job_t) result = fetch_job_locked(sched, deadline);
+    *out_measure = (sched->stats != NULL);
     avs_mutex_unlock(sched->mutex);
     return result;
 }
 
-static void execute_job(avs_sched_t *sched, AVS_LIST(avs_sched_job_t) job) {
+/**
+ * Executes the job callback.
+ *
+ * @param out_timing If not NULL, the time of execution will be measured and
+ *                   stored there.
+ */
+static void execute_job(avs_sched_t *sched,
+                        AVS_LIST(avs_sched_job_t) job,
+                        job_timing_t *out_timing) {
     // make sure that the task is detached
     assert(!AVS_LIST_NEXT(job));
 
     SCHED_LOG(sched, TRACE, _("executing job") "%s", JOB_LOG_ID(job));
 
+    if (out_timing) {
+        out_timing->started = avs_time_monotonic_now();
+    }
     job->clb(sched, job->clb_data);
-    AVS_LIST_DELETE(&job);
+    if (out_timing) {
+        out_timing->finished = avs_time_monotonic_now();
+    }
 }
 
 void avs_sched_run(avs_sched_t *sched) {
@@ -342,9 +1256,12 @@ void avs_sched_run(avs_sched_t *sched) {
 
     uint32_t tasks_executed = 0;
     AVS_LIST(avs_sched_job_t) job = NULL;
-    while ((job = fetch_job(sched, now))) {
+    job_timing_t timing;
+    bool measure = false;
+    while ((job = fetch_job(sched, now, job, measure ? &timing : NULL,
+                            &measure))) {
         assert(job->sched == sched);
-        execute_job(sched, job);
+        execute_job(sched, job, measure ? &timing : NULL);
         ++tasks_executed;
     }
 
@@ -364,48 +1281,21 @@ void avs_sched_run(avs_sched_t *sched) {
 #    endif // AVS_COMMONS_WITH_INTERNAL_TRACE
 }
 
-static void schedule_job(avs_sched_t *sched, avs_sched_job_t *job) {
-    AVS_LIST(avs_sched_job_t) *insert_ptr = &sched->jobs;
-    while (*insert_ptr
-           && !avs_time_monotonic_before(job->instant,
-                                         (*insert_ptr)->instant)) {
-        AVS_LIST_ADVANCE_PTR(&insert_ptr);
-    }
-    AVS_LIST_INSERT(insert_ptr, job);
-}
-
-static int sched_at_locked(avs_sched_t *sched,
-                           avs_sched_handle_t *out_handle,
-                           avs_time_monotonic_t instant,
-                           const char *log_file,
-                           unsigned log_line,
-                           const char *log_name,
-                           avs_sched_clb_t *clb,
-                           const void *clb_data,
-                           size_t clb_data_size) {
+static void job_init(avs_sched_job_t *job,
+                     avs_time_monotonic_t instant,
+                     uint64_t affinity_key,
+                     const char *log_file,
+                     unsigned log_line,
+                     const char *log_name,
+                     avs_sched_clb_t *clb,
+                     const void *clb_data,
+                     size_t clb_data_size) {
     (void) log_file;
     (void) log_line;
     (void) log_name;
-    assert(sched);
-    assert(clb);
-    assert(avs_time_monotonic_valid(instant));
-    if (sched->shutting_down) {
-        SCHED_LOG(sched, DEBUG,
-                  _("scheduler already shut down when attempting ")
-                          _("to schedule") "%s",
-                  JOB_LOG_ID_EXPLICIT(log_file, log_line, log_name));
-        return -1;
-    }
-
-    AVS_LIST(avs_sched_job_t) job = (avs_sched_job_t *) AVS_LIST_NEW_BUFFER(
-            sizeof(avs_sched_job_t) + clb_data_size);
-    if (!job) {
-        SCHED_LOG(sched, ERROR, _("could not allocate scheduler task"));
-        return -1;
-    }
-
-    job->sched = sched;
+    job->handle_ptr = NULL;
     job->instant = instant;
+    job->affinity_key = affinity_key;
 #    ifdef AVS_COMMONS_WITH_INTERNAL_LOGS
     job->log_info.file = log_file;
     job->log_info.line = log_line;
@@ -415,39 +1305,82 @@ static int sched_at_locked(avs_sched_t *sched,
     if (clb_data_size) {
         memcpy(job->clb_data, clb_data, clb_data_size);
     }
+}
 
+/**
+ * Inserts an initialized job into the scheduler, and links it with
+ * @p out_handle if not NULL. Heap capacity for the job must have already been
+ * reserved. Must be called with the scheduler mutex locked.
+ */
+static void job_insert_locked(avs_sched_t *sched,
+                              avs_sched_job_t *job,
+                              avs_sched_handle_t *out_handle) {
+    assert(job->sched == sched);
     if (out_handle) {
         job->handle_ptr = out_handle;
-        nonfailing_mutex_lock(g_handle_access_mutex);
+        job->handle_linked = true;
         if (*out_handle) {
             AVS_ASSERT((*out_handle)->sched == sched,
                        "Replacing handles used by a different scheduler is "
                        "not supported");
-            AVS_LIST(avs_sched_job_t) *job_ptr =
-                    (AVS_LIST(avs_sched_job_t) *) AVS_LIST_FIND_PTR(
-                            &sched->jobs, *out_handle);
-            AVS_ASSERT(job_ptr, "dangling handle detected");
+            AVS_LIST(avs_sched_job_t) old_job = *out_handle;
+            AVS_ASSERT(job_scheduled(sched, old_job),
+                       "dangling handle detected");
             SCHED_LOG(sched, TRACE,
                       _("cancelling job") "%s" _(
                               " due to reschedule policy for job") "%s",
-                      JOB_LOG_ID(*job_ptr),
-                      JOB_LOG_ID_EXPLICIT(log_file, log_line, log_name));
-            AVS_LIST_DELETE(job_ptr);
+                      JOB_LOG_ID(old_job), JOB_LOG_ID(job));
+            store_remove(sched, old_job);
+            pool_release(sched, old_job);
         }
-        *out_handle = job;
-        avs_mutex_unlock(g_handle_access_mutex);
+        handle_write_locked(out_handle, job);
     }
 
-    schedule_job(sched, job);
+    job->seq = sched->next_seq++;
+    store_insert(sched, job);
+    stats_update_queue_depth_locked(sched);
 #    ifdef AVS_COMMONS_WITH_INTERNAL_TRACE
     avs_time_duration_t remaining =
-            avs_time_monotonic_diff(instant, avs_time_monotonic_now());
+            avs_time_monotonic_diff(job->instant, avs_time_monotonic_now());
     SCHED_LOG(sched, TRACE,
               _("scheduled job") "%s" _(" at ") "%s" _(" (+") "%s" _(")"),
               JOB_LOG_ID(job),
-              AVS_TIME_DURATION_AS_STRING(instant.since_monotonic_epoch),
+              AVS_TIME_DURATION_AS_STRING(job->instant.since_monotonic_epoch),
               AVS_TIME_DURATION_AS_STRING(remaining));
 #    endif // AVS_COMMONS_WITH_INTERNAL_TRACE
+}
+
+static int sched_at_locked(avs_sched_t *sched,
+                           avs_sched_handle_t *out_handle,
+                           avs_time_monotonic_t instant,
+                           uint64_t affinity_key,
+                           const char *log_file,
+                           unsigned log_line,
+                           const char *log_name,
+                           avs_sched_clb_t *clb,
+                           const void *clb_data,
+                           size_t clb_data_size) {
+    assert(sched);
+    assert(clb);
+    assert(avs_time_monotonic_valid(instant));
+    if (sched->shutting_down) {
+        SCHED_LOG(sched, DEBUG,
+                  _("scheduler already shut down when attempting ")
+                          _("to schedule") "%s",
+                  JOB_LOG_ID_EXPLICIT(log_file, log_line, log_name));
+        return -1;
+    }
+
+    AVS_LIST(avs_sched_job_t) job = NULL;
+    if (heap_reserve(sched, sched->heap_size + 1)
+            || !(job = pool_take(sched, clb_data_size))) {
+        SCHED_LOG(sched, ERROR, _("could not allocate scheduler task"));
+        return -1;
+    }
+
+    job_init(job, instant, affinity_key, log_file, log_line, log_name, clb,
+             clb_data, clb_data_size);
+    job_insert_locked(sched, job, out_handle);
     return 0;
 }
 
@@ -460,6 +1393,21 @@ int avs_sched_at_impl__(avs_sched_t *sched,
                         avs_sched_clb_t *clb,
                         const void *clb_data,
                         size_t clb_data_size) {
+    return avs_sched_at_with_affinity_impl__(
+            sched, out_handle, instant, AVS_SCHED_NO_AFFINITY, log_file,
+            log_line, log_name, clb, clb_data, clb_data_size);
+}
+
+int avs_sched_at_with_affinity_impl__(avs_sched_t *sched,
+                                      avs_sched_handle_t *out_handle,
+                                      avs_time_monotonic_t instant,
+                                      uint64_t affinity_key,
+                                      const char *log_file,
+                                      unsigned log_line,
+                                      const char *log_name,
+                                      avs_sched_clb_t *clb,
+                                      const void *clb_data,
+                                      size_t clb_data_size) {
     assert(sched);
     if (!clb) {
         SCHED_LOG(sched, ERROR,
@@ -477,8 +1425,8 @@ int avs_sched_at_impl__(avs_sched_t *sched,
 
     int result = -1;
     nonfailing_mutex_lock(sched->mutex);
-    if (!(result = sched_at_locked(sched, out_handle, instant, log_file,
-                                   log_line, log_name, clb, clb_data,
+    if (!(result = sched_at_locked(sched, out_handle, instant, affinity_key,
+                                   log_file, log_line, log_name, clb, clb_data,
                                    clb_data_size))) {
         avs_condvar_notify_all(sched->task_condvar);
     }
@@ -486,13 +1434,88 @@ int avs_sched_at_impl__(avs_sched_t *sched,
     return result;
 }
 
+int avs_sched_at_batch(avs_sched_t *sched,
+                       const avs_sched_batch_entry_t *entries,
+                       size_t count) {
+    assert(sched);
+    assert(entries || !count);
+    for (size_t i = 0; i < count; ++i) {
+        if (!entries[i].clb) {
+            SCHED_LOG(sched, ERROR,
+                      _("attempted to schedule a null callback pointer") "%s",
+                      JOB_LOG_ID_EXPLICIT(entries[i].log_file,
+                                          entries[i].log_line,
+                                          entries[i].log_name));
+            return -1;
+        }
+        if (!avs_time_monotonic_valid(entries[i].instant)) {
+            SCHED_LOG(sched, ERROR,
+                      _("attempted to schedule job") "%s" _(
+                              " at an invalid time point"),
+                      JOB_LOG_ID_EXPLICIT(entries[i].log_file,
+                                          entries[i].log_line,
+                                          entries[i].log_name));
+            return -1;
+        }
+    }
+
+    int result = -1;
+    AVS_LIST(avs_sched_job_t) jobs = NULL;
+    AVS_LIST(avs_sched_job_t) *jobs_tail = &jobs;
+    nonfailing_mutex_lock(sched->mutex);
+    if (sched->shutting_down) {
+        SCHED_LOG(sched, DEBUG,
+                  _("scheduler already shut down when attempting to ")
+                          _("schedule a batch of jobs"));
+        goto finish;
+    }
+    // all the memory is allocated up front, so that either all the jobs are
+    // scheduled, or none of them
+    if (heap_reserve(sched, sched->heap_size + count)) {
+        goto out_of_memory;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        AVS_LIST(avs_sched_job_t) job =
+                pool_take(sched, entries[i].clb_data_size);
+        if (!job) {
+            while (jobs) {
+                pool_release(sched, AVS_LIST_DETACH(&jobs));
+            }
+            goto out_of_memory;
+        }
+        job_init(job, entries[i].instant, entries[i].affinity_key,
+                 entries[i].log_file, entries[i].log_line, entries[i].log_name,
+                 entries[i].clb, entries[i].clb_data,
+                 entries[i].clb_data_size);
+        AVS_LIST_INSERT(jobs_tail, job);
+        AVS_LIST_ADVANCE_PTR(&jobs_tail);
+    }
+    for (size_t i = 0; i < count; ++i) {
+        job_insert_locked(sched, AVS_LIST_DETACH(&jobs),
+                          entries[i].out_handle);
+    }
+    SCHED_LOG(sched, TRACE, _("scheduled a batch of ") "%lu" _(" jobs"),
+              (unsigned long) count);
+    if (count) {
+        avs_condvar_notify_all(sched->task_condvar);
+    }
+    result = 0;
+    goto finish;
+
+out_of_memory:
+    SCHED_LOG(sched, ERROR, _("could not allocate scheduler tasks"));
+finish:
+    avs_mutex_unlock(sched->mutex);
+    return result;
+}
+
 avs_time_monotonic_t avs_sched_time(avs_sched_handle_t *handle_ptr) {
     avs_time_monotonic_t result = AVS_TIME_MONOTONIC_INVALID;
-    nonfailing_mutex_lock(g_handle_access_mutex);
-    if (handle_ptr && *handle_ptr) {
-        result = (*handle_ptr)->instant;
+    avs_sched_job_t *job;
+    if (handle_ptr && (job = lock_job_by_handle(handle_ptr))) {
+        result = job->instant;
+        avs_mutex_unlock(job->sched->mutex);
     }
-    avs_mutex_unlock(g_handle_access_mutex);
     return result;
 }
 
@@ -500,77 +1523,209 @@ void avs_sched_del(avs_sched_handle_t *handle_ptr) {
     if (!handle_ptr) {
         return;
     }
+    // Job might have been removed by another thread, don't do anything then
+    avs_sched_job_t *job = lock_job_by_handle(handle_ptr);
+    if (!job) {
+        return;
+    }
+
+    avs_sched_t *sched = job->sched;
+    SCHED_LOG(sched, TRACE, _("cancelling job") "%s", JOB_LOG_ID(job));
+    handle_write_locked(handle_ptr, NULL);
+
+    store_remove(sched, job);
+    pool_release(sched, job);
+    avs_mutex_unlock(sched->mutex);
+}
+
+void avs_sched_del_batch(avs_sched_handle_t *const *handle_ptrs,
+                         size_t count) {
+    assert(handle_ptrs || !count);
+    // scheduler that is currently locked
     avs_sched_t *sched = NULL;
-    avs_sched_job_t *job = NULL;
-    nonfailing_mutex_lock(g_handle_access_mutex);
-    if (*handle_ptr) {
-        AVS_ASSERT(handle_ptr == (*handle_ptr)->handle_ptr,
+    for (size_t i = 0; i < count; ++i) {
+        if (!handle_ptrs[i]) {
+            continue;
+        }
+        avs_sched_job_t *job = handle_read(handle_ptrs[i]);
+        if (!job) {
+            continue;
+        }
+        if (job->sched != sched) {
+            // lock the scheduler that owns the job; consecutive handles of
+            // jobs owned by the same scheduler are cancelled under one lock
+            if (sched) {
+                avs_mutex_unlock(sched->mutex);
+                sched = NULL;
+            }
+            if (!(job = lock_job_by_handle(handle_ptrs[i]))) {
+                continue;
+            }
+            sched = job->sched;
+        }
+        // handles are only modified with the owning scheduler locked, so the
+        // value read above is still valid
+        AVS_ASSERT(handle_ptrs[i] == job->handle_ptr,
                    "accessing job via non-original handle");
-        job = *handle_ptr;
-        sched = (*handle_ptr)->sched;
+        SCHED_LOG(sched, TRACE, _("cancelling job") "%s", JOB_LOG_ID(job));
+        handle_write_locked(handle_ptrs[i], NULL);
+        store_remove(sched, job);
+        pool_release(sched, job);
     }
-    avs_mutex_unlock(g_handle_access_mutex);
-    if (!job) {
-        return;
+    if (sched) {
+        avs_mutex_unlock(sched->mutex);
     }
+}
 
+void avs_sched_pool_stats(avs_sched_t *sched,
+                          avs_sched_pool_stats_t *out_stats) {
     assert(sched);
+    assert(out_stats);
     nonfailing_mutex_lock(sched->mutex);
-    AVS_LIST(avs_sched_job_t) *job_ptr =
-            (AVS_LIST(avs_sched_job_t) *) AVS_LIST_FIND_PTR(&sched->jobs, job);
-    if (!job_ptr) {
-#    ifndef AVS_COMMONS_SCHED_THREAD_SAFE
-        AVS_ASSERT(job_ptr, "dangling handle detected");
-#    endif // AVS_COMMONS_SCHED_THREAD_SAFE
-           // Job might have been removed by another thread, don't do anything
-    } else {
-        SCHED_LOG(sched, TRACE, _("cancelling job") "%s", JOB_LOG_ID(job));
-        nonfailing_mutex_lock(g_handle_access_mutex);
-        assert(*job->handle_ptr == job);
-        *job->handle_ptr = NULL;
-        avs_mutex_unlock(g_handle_access_mutex);
+    out_stats->hits = sched->pool.hits;
+    out_stats->misses = sched->pool.misses;
+    out_stats->free_jobs = sched->pool.free_count;
+    avs_mutex_unlock(sched->mutex);
+}
+
+int avs_sched_stats_enable(avs_sched_t *sched, bool enabled) {
+    assert(sched);
+    avs_sched_stats_t *new_stats = NULL;
+    if (enabled
+            && !(new_stats = (avs_sched_stats_t *) avs_calloc(
+                         1, sizeof(avs_sched_stats_t)))) {
+        SCHED_LOG(sched, ERROR, _("out of memory"));
+        return -1;
+    }
+    nonfailing_mutex_lock(sched->mutex);
+    avs_sched_stats_t *old_stats = sched->stats;
+    sched->stats = new_stats;
+    stats_update_queue_depth_locked(sched);
+    avs_mutex_unlock(sched->mutex);
+    avs_free(old_stats);
+    return 0;
+}
+
+static int compare_slowest_callbacks(const void *a, const void *b) {
+    avs_time_duration_t a_time =
+            ((const avs_sched_callback_stats_t *) a)->max_exec_time;
+    avs_time_duration_t b_time =
+            ((const avs_sched_callback_stats_t *) b)->max_exec_time;
+    if (avs_time_duration_less(b_time, a_time)) {
+        return -1;
+    } else if (avs_time_duration_less(a_time, b_time)) {
+        return 1;
+    }
+    return 0;
+}
 
-        AVS_LIST_DELETE(job_ptr);
+int avs_sched_stats_get(avs_sched_t *sched, avs_sched_stats_t *out_stats) {
+    assert(sched);
+    assert(out_stats);
+    int result = -1;
+    nonfailing_mutex_lock(sched->mutex);
+    if (sched->stats) {
+        *out_stats = *sched->stats;
+        out_stats->queue_depth = store_size(sched);
+        result = 0;
     }
     avs_mutex_unlock(sched->mutex);
+    if (!result) {
+        qsort(out_stats->slowest_callbacks, out_stats->slowest_callbacks_count,
+              sizeof(*out_stats->slowest_callbacks), compare_slowest_callbacks);
+    }
+    return result;
+}
+
+#    ifdef AVS_COMMONS_WITH_AVS_STREAM
+static int64_t duration_us(avs_time_duration_t duration) {
+    int64_t result = 0;
+    avs_time_duration_to_scalar(&result, AVS_TIME_US, duration);
+    return result;
 }
 
+static avs_error_t histogram_dump(avs_stream_t *stream,
+                                  const char *title,
+                                  const avs_sched_histogram_t *histogram) {
+    int64_t mean_us = 0;
+    if (histogram->count) {
+        mean_us = duration_us(histogram->total) / (int64_t) histogram->count;
+    }
+    avs_error_t err =
+            avs_stream_write_f(stream,
+                               "%s: %" PRIu64 " jobs, mean %" PRId64
+                               " us, max %" PRId64 " us\n",
+                               title, histogram->count, mean_us,
+                               duration_us(histogram->max));
+    for (size_t i = 0; avs_is_ok(err) && i < AVS_SCHED_STATS_HISTOGRAM_BUCKETS;
+         ++i) {
+        if (!histogram->buckets[i]) {
+            continue;
+        }
+        if (i < AVS_SCHED_STATS_HISTOGRAM_BUCKETS - 1) {
+            err = avs_stream_write_f(stream, "  < %" PRIu64 " us: %" PRIu64 "\n",
+                                     (uint64_t) 1 << i, histogram->buckets[i]);
+        } else {
+            err = avs_stream_write_f(stream,
+                                     "  >= %" PRIu64 " us: %" PRIu64 "\n",
+                                     (uint64_t) 1 << (i - 1),
+                                     histogram->buckets[i]);
+        }
+    }
+    return err;
+}
+
+avs_error_t avs_sched_stats_dump(avs_sched_t *sched, avs_stream_t *stream) {
+    assert(sched);
+    avs_sched_stats_t stats;
+    if (avs_sched_stats_get(sched, &stats)) {
+        SCHED_LOG(sched, ERROR, _("statistics are not enabled"));
+        return avs_errno(AVS_EINVAL);
+    }
+    avs_error_t err = avs_stream_write_f(stream,
+                                         "queue depth: %lu (max %lu)\n",
+                                         (unsigned long) stats.queue_depth,
+                                         (unsigned long) stats.max_queue_depth);
+    if (avs_is_ok(err)) {
+        err = histogram_dump(stream, "lateness", &stats.lateness);
+    }
+    if (avs_is_ok(err)) {
+        err = histogram_dump(stream, "execution time", &stats.exec_time);
+    }
+    if (avs_is_ok(err)) {
+        err = avs_stream_write_f(stream, "slowest callbacks:\n");
+    }
+    for (size_t i = 0; avs_is_ok(err) && i < stats.slowest_callbacks_count;
+         ++i) {
+        const avs_sched_callback_stats_t *entry = &stats.slowest_callbacks[i];
+        err = avs_stream_write_f(
+                stream,
+                "  %s (%s:%u): max %" PRId64 " us, mean %" PRId64
+                " us, %" PRIu64 " executions\n",
+                entry->name ? entry->name : "(unknown)",
+                entry->file ? entry->file : "(unknown)", entry->line,
+                duration_us(entry->max_exec_time),
+                duration_us(entry->total_exec_time)
+                        / (int64_t) entry->executions,
+                entry->executions);
+    }
+    return err;
+}
+#    endif // AVS_COMMONS_WITH_AVS_STREAM
+
 void avs_sched_detach(avs_sched_handle_t *handle_ptr) {
     if (!handle_ptr) {
         return;
     }
-    avs_sched_t *sched = NULL;
-    avs_sched_job_t *job = NULL;
-    nonfailing_mutex_lock(g_handle_access_mutex);
-    if (*handle_ptr) {
-        AVS_ASSERT(handle_ptr == (*handle_ptr)->handle_ptr,
-                   "accessing job via non-original handle");
-        job = *handle_ptr;
-        sched = (*handle_ptr)->sched;
-    }
-    avs_mutex_unlock(g_handle_access_mutex);
+    // Job might have been removed by another thread, don't do anything then
+    avs_sched_job_t *job = lock_job_by_handle(handle_ptr);
     if (!job) {
         return;
     }
 
-    assert(sched);
-    nonfailing_mutex_lock(sched->mutex);
-    AVS_LIST(avs_sched_job_t) *job_ptr =
-            (AVS_LIST(avs_sched_job_t) *) AVS_LIST_FIND_PTR(&sched->jobs, job);
-    if (!job_ptr) {
-#    ifndef AVS_COMMONS_SCHED_THREAD_SAFE
-        AVS_ASSERT(job_ptr, "dangling handle detected");
-#    endif // AVS_COMMONS_SCHED_THREAD_SAFE
-           // Job might have been removed by another thread, don't do anything
-    } else {
-        nonfailing_mutex_lock(g_handle_access_mutex);
-        assert(*job->handle_ptr == job);
-        *job->handle_ptr = NULL;
-        avs_mutex_unlock(g_handle_access_mutex);
-
-        job->handle_ptr = NULL;
-    }
-    avs_mutex_unlock(sched->mutex);
+    handle_write_locked(handle_ptr, NULL);
+    job->handle_ptr = NULL;
+    avs_mutex_unlock(job->sched->mutex);
 }
 
 int avs_sched_leap_time(avs_sched_t *sched, avs_time_duration_t diff) {
@@ -585,9 +1740,28 @@ int avs_sched_leap_time(avs_sched_t *sched, avs_time_duration_t diff) {
     SCHED_LOG(sched, INFO, _("moving all jobs by ") "%s" _(" s"),
               AVS_TIME_DURATION_AS_STRING(diff));
 
-    AVS_LIST(avs_sched_job_t) job;
-    AVS_LIST_FOREACH(job, sched->jobs) {
-        job->instant = avs_time_monotonic_add(job->instant, diff);
+    if (sched->wheel) {
+        // timing wheel slots depend on the instants, so the jobs need to be
+        // reinserted; they retain their sequence numbers, so the relative
+        // order of jobs scheduled for the same instant is preserved
+        if (heap_reserve(sched, sched->heap_size + sched->wheel->job_count)) {
+            SCHED_LOG(sched, ERROR, _("out of memory"));
+            avs_mutex_unlock(sched->mutex);
+            return -1;
+        }
+        AVS_LIST(avs_sched_job_t) jobs = store_detach_all(sched);
+        while (jobs) {
+            avs_sched_job_t *job = AVS_LIST_DETACH(&jobs);
+            job->instant = avs_time_monotonic_add(job->instant, diff);
+            store_insert(sched, job);
+        }
+    } else {
+        // all jobs are moved by the same amount, so the heap order is
+        // preserved
+        for (size_t i = 0; i < sched->heap_size; ++i) {
+            sched->heap[i]->instant =
+                    avs_time_monotonic_add(sched->heap[i]->instant, diff);
+        }
     }
     avs_condvar_notify_all(sched->task_condvar);
 
@@ -605,43 +1779,310 @@ int avs_resched_at_impl__(avs_sched_handle_t *handle_ptr,
         return -1;
     }
 
-    avs_sched_t *sched = NULL;
-    avs_sched_job_t *job = NULL;
-    nonfailing_mutex_lock(g_handle_access_mutex);
-    if (*handle_ptr) {
-        AVS_ASSERT(handle_ptr == (*handle_ptr)->handle_ptr,
-                   "accessing job via non-original handle");
-        sched = (*handle_ptr)->sched;
-        job = *handle_ptr;
-    }
-    avs_mutex_unlock(g_handle_access_mutex);
+    avs_sched_job_t *job = lock_job_by_handle(handle_ptr);
     if (!job) {
         return -1;
     }
 
     int retval = 0;
+    avs_sched_t *sched = job->sched;
+    SCHED_LOG(sched, TRACE, _("rescheduling job") "%s", JOB_LOG_ID(job));
+
+    // a rescheduled job is ordered after the jobs already scheduled for the
+    // same instant, as if it was newly scheduled
+    if (sched->wheel) {
+        if (heap_reserve(sched, sched->heap_size + 1)) {
+            SCHED_LOG(sched, ERROR, _("out of memory"));
+            retval = -1;
+            goto finish;
+        }
+        store_remove(sched, job);
+        job->instant = instant;
+        job->seq = sched->next_seq++;
+        store_insert(sched, job);
+    } else {
+        job->instant = instant;
+        job->seq = sched->next_seq++;
+        heap_fix(sched, job->heap_index);
+    }
+    avs_condvar_notify_all(sched->task_condvar);
+
+finish:
+    avs_mutex_unlock(sched->mutex);
+    return retval;
+}
+
+#    ifdef AVS_COMMONS_SCHED_THREAD_SAFE
+/**
+ * FIFO queue of jobs fetched for execution by @ref avs_sched_executor_t .
+ */
+typedef struct {
+    AVS_LIST(avs_sched_job_t) head;
+    /** Pointer to the <c>next</c> pointer of the last job, or to <c>head</c>. */
+    AVS_LIST(avs_sched_job_t) *tail_ptr;
+} sched_job_queue_t;
+
+typedef struct {
+    /** Jobs with affinity keys assigned to this worker. */
+    sched_job_queue_t bound_jobs;
+
+    /**
+     * Jobs without an affinity key, fetched from the scheduler by this worker.
+     * These may be executed by any worker.
+     */
+    sched_job_queue_t unbound_jobs;
+
+    /** True if the worker is currently being run by some thread. */
+    bool running;
+} sched_executor_worker_t;
+
+/**
+ * All fields (including the worker queues) are guarded by the mutex of the
+ * scheduler, and the workers wait for jobs on the scheduler's condition
+ * variable, so that they are woken up whenever a job is scheduled.
+ */
+struct avs_sched_executor_struct {
+    avs_sched_t *sched;
+    bool stopping;
+    size_t worker_count;
+    sched_executor_worker_t workers[];
+};
+
+static void job_queue_init(sched_job_queue_t *queue) {
+    queue->head = NULL;
+    queue->tail_ptr = &queue->head;
+}
+
+static void job_queue_push(sched_job_queue_t *queue,
+                           AVS_LIST(avs_sched_job_t) job) {
+    assert(!AVS_LIST_NEXT(job));
+    *queue->tail_ptr = job;
+    queue->tail_ptr = AVS_LIST_NEXT_PTR(queue->tail_ptr);
+}
+
+static AVS_LIST(avs_sched_job_t) job_queue_pop(sched_job_queue_t *queue) {
+    if (!queue->head) {
+        return NULL;
+    }
+    AVS_LIST(avs_sched_job_t) result = AVS_LIST_DETACH(&queue->head);
+    if (!queue->head) {
+        queue->tail_ptr = &queue->head;
+    }
+    return result;
+}
+
+static sched_executor_worker_t *
+executor_worker_for_key(avs_sched_executor_t *executor, uint64_t key) {
+    // keys are often pointers or sequential identifiers, so mix the bits
+    // before reducing them to the worker index
+    uint64_t hash = key * UINT64_C(0x9E3779B97F4A7C15);
+    return &executor->workers[(hash >> 32) % executor->worker_count];
+}
+
+/**
+ * Moves all the jobs that are due at @p now from the scheduler to the worker
+ * queues. Must be called with the scheduler mutex locked.
+ *
+ * @returns Number of jobs moved.
+ */
+static size_t executor_dispatch_locked(avs_sched_executor_t *executor,
+                                       sched_executor_worker_t *worker,
+                                       avs_time_monotonic_t now) {
+    size_t result = 0;
+    AVS_LIST(avs_sched_job_t) job;
+    while ((job = fetch_job_locked(executor->sched, now))) {
+        if (job->affinity_key == AVS_SCHED_NO_AFFINITY) {
+            job_queue_push(&worker->unbound_jobs, job);
+        } else {
+            job_queue_push(
+                    &executor_worker_for_key(executor, job->affinity_key)
+                             ->bound_jobs,
+                    job);
+        }
+        ++result;
+    }
+    return result;
+}
+
+/**
+ * Takes the next job to execute by @p worker: the earliest of its own jobs
+ * first, then jobs without an affinity key queued on the other workers. Must be
+ * called with the scheduler mutex locked.
+ */
+static AVS_LIST(avs_sched_job_t)
+executor_take_job_locked(avs_sched_executor_t *executor,
+                         sched_executor_worker_t *worker) {
+    AVS_LIST(avs_sched_job_t) result = NULL;
+    if (worker->bound_jobs.head
+            && (!worker->unbound_jobs.head
+                || job_before(worker->bound_jobs.head,
+                              worker->unbound_jobs.head))) {
+        result = job_queue_pop(&worker->bound_jobs);
+    } else {
+        result = job_queue_pop(&worker->unbound_jobs);
+    }
+    size_t index = (size_t) (worker - executor->workers);
+    for (size_t i = 1; !result && i < executor->worker_count; ++i) {
+        result = job_queue_pop(
+                &executor->workers[(index + i) % executor->worker_count]
+                         .unbound_jobs);
+    }
+    return result;
+}
+
+avs_sched_executor_t *avs_sched_executor_new(avs_sched_t *sched,
+                                             size_t worker_count) {
     assert(sched);
+    if (!worker_count) {
+        SCHED_LOG(sched, ERROR, _("executor requires at least one worker"));
+        return NULL;
+    }
+    avs_sched_executor_t *executor = (avs_sched_executor_t *) avs_calloc(
+            1, sizeof(avs_sched_executor_t)
+                       + worker_count * sizeof(sched_executor_worker_t));
+    if (!executor) {
+        SCHED_LOG(sched, ERROR, _("out of memory"));
+        return NULL;
+    }
+    executor->sched = sched;
+    executor->worker_count = worker_count;
+    for (size_t i = 0; i < worker_count; ++i) {
+        job_queue_init(&executor->workers[i].bound_jobs);
+        job_queue_init(&executor->workers[i].unbound_jobs);
+    }
+    SCHED_LOG(sched, DEBUG, _("executor created with ") "%lu" _(" workers"),
+              (unsigned long) worker_count);
+    return executor;
+}
+
+int avs_sched_executor_run_worker(avs_sched_executor_t *executor,
+                                  size_t worker_index) {
+    assert(executor);
+    avs_sched_t *sched = executor->sched;
+    if (worker_index >= executor->worker_count) {
+        SCHED_LOG(sched, ERROR, _("invalid executor worker index: ") "%lu",
+                  (unsigned long) worker_index);
+        return -1;
+    }
+    sched_executor_worker_t *worker = &executor->workers[worker_index];
+    int result = 0;
     nonfailing_mutex_lock(sched->mutex);
-    AVS_LIST(avs_sched_job_t) *job_ptr =
-            (AVS_LIST(avs_sched_job_t) *) AVS_LIST_FIND_PTR(&sched->jobs, job);
-    if (job_ptr) {
-        SCHED_LOG(sched, TRACE, _("rescheduling job") "%s",
-                  JOB_LOG_ID(*job_ptr));
+    AVS_ASSERT(!worker->running, "executor worker run by multiple threads");
+    worker->running = true;
+    while (!executor->stopping) {
+        AVS_LIST(avs_sched_job_t) job =
+                executor_take_job_locked(executor, worker);
+        if (!job) {
+            if (executor_dispatch_locked(executor, worker,
+                                         avs_time_monotonic_now())) {
+                // wake up the other workers, so that they can execute their
+                // bound jobs or steal some of ours
+                avs_condvar_notify_all(sched->task_condvar);
+            } else if (avs_condvar_wait(sched->task_condvar, sched->mutex,
+                                        sched_time_of_next_locked(sched))
+                       < 0) {
+                SCHED_LOG(sched, ERROR,
+                          _("could not wait on condition variable"));
+                result = -1;
+                break;
+            }
+            continue;
+        }
+        job_timing_t timing;
+        bool measure = (sched->stats != NULL);
+        avs_mutex_unlock(sched->mutex);
+        execute_job(sched, job, measure ? &timing : NULL);
+        nonfailing_mutex_lock(sched->mutex);
+        if (measure) {
+            stats_record_locked(sched, job, &timing);
+        }
+        pool_release(sched, job);
+    }
+    worker->running = false;
+    avs_mutex_unlock(sched->mutex);
+    return result;
+}
 
-        avs_sched_job_t *detached_job = AVS_LIST_DETACH(job_ptr);
-        detached_job->instant = instant;
+void avs_sched_executor_stop(avs_sched_executor_t *executor) {
+    assert(executor);
+    nonfailing_mutex_lock(executor->sched->mutex);
+    executor->stopping = true;
+    avs_condvar_notify_all(executor->sched->task_condvar);
+    avs_mutex_unlock(executor->sched->mutex);
+}
 
-        schedule_job(sched, detached_job);
-        avs_condvar_notify_all(sched->task_condvar);
-    } else {
-#    ifndef AVS_COMMONS_SCHED_THREAD_SAFE
-        AVS_ASSERT(job_ptr, "dangling handle detected");
-#    endif // AVS_COMMONS_SCHED_THREAD_SAFE
-        retval = -1;
+void avs_sched_executor_cleanup(avs_sched_executor_t **executor_ptr) {
+    if (!executor_ptr || !*executor_ptr) {
+        return;
     }
+    avs_sched_executor_t *executor = *executor_ptr;
+    avs_sched_t *sched = executor->sched;
+    AVS_LIST(avs_sched_job_t) orphaned_jobs = NULL;
+    AVS_LIST(avs_sched_job_t) *orphaned_jobs_tail = &orphaned_jobs;
+    size_t orphaned_count = 0;
 
+    nonfailing_mutex_lock(sched->mutex);
+    for (size_t i = 0; i < executor->worker_count; ++i) {
+        AVS_ASSERT(!executor->workers[i].running,
+                   "executor cleaned up while its workers are running");
+        AVS_LIST(avs_sched_job_t) job;
+        while ((job = job_queue_pop(&executor->workers[i].bound_jobs))
+               || (job = job_queue_pop(&executor->workers[i].unbound_jobs))) {
+            AVS_LIST_INSERT(orphaned_jobs_tail, job);
+            AVS_LIST_ADVANCE_PTR(&orphaned_jobs_tail);
+            ++orphaned_count;
+        }
+    }
+    if (orphaned_count
+            && !heap_reserve(sched, sched->heap_size + orphaned_count)) {
+        // jobs retain their sequence numbers, so they will be executed in
+        // their original order
+        while (orphaned_jobs) {
+            store_insert(sched, AVS_LIST_DETACH(&orphaned_jobs));
+        }
+        avs_condvar_notify_all(sched->task_condvar);
+    }
     avs_mutex_unlock(sched->mutex);
-    return retval;
+
+    if (orphaned_jobs) {
+        SCHED_LOG(sched, WARNING,
+                  _("could not return jobs to the scheduler, executing them ")
+                          _("immediately"));
+        AVS_LIST(avs_sched_job_t) job;
+        while ((job = AVS_LIST_DETACH(&orphaned_jobs))) {
+            execute_job(sched, job, NULL);
+            nonfailing_mutex_lock(sched->mutex);
+            pool_release(sched, job);
+            avs_mutex_unlock(sched->mutex);
+        }
+    }
+    avs_free(executor);
+    *executor_ptr = NULL;
+}
+#    else  // AVS_COMMONS_SCHED_THREAD_SAFE
+avs_sched_executor_t *avs_sched_executor_new(avs_sched_t *sched,
+                                             size_t worker_count) {
+    (void) worker_count;
+    SCHED_LOG(sched, ERROR,
+              _("avs_sched_executor_new() is not supported because avs_sched ")
+                      _("was compiled with thread safety disabled"));
+    return NULL;
 }
 
+int avs_sched_executor_run_worker(avs_sched_executor_t *executor,
+                                  size_t worker_index) {
+    (void) executor;
+    (void) worker_index;
+    return -1;
+}
+
+void avs_sched_executor_stop(avs_sched_executor_t *executor) {
+    (void) executor;
+}
+
+void avs_sched_executor_cleanup(avs_sched_executor_t **executor_ptr) {
+    (void) executor_ptr;
+}
+#    endif // AVS_COMMONS_SCHED_THREAD_SAFE
+
 #endif // AVS_COMMONS_WITH_AVS_SCHED
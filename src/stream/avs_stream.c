@@ -21,6 +21,7 @@
 #    include <assert.h>
 #    include <stdarg.h>
 #    include <stdbool.h>
+#    include <stdint.h>
 #    include <stdlib.h>
 #    include <string.h>
 
@@ -117,6 +118,11 @@ avs_error_t avs_stream_write_f(avs_stream_t *stream, const char *msg, ...) {
     return err;
 }
 
+static bool is_fallback_error(avs_error_t err) {
+    return err.category == AVS_ERRNO_CATEGORY
+           && (err.code == AVS_ENOBUFS || err.code == AVS_ENOTSUP);
+}
+
 static avs_error_t try_write_fv(avs_stream_t *stream,
                                 const char *msg,
                                 va_list args,
@@ -154,6 +160,43 @@ static avs_error_t try_heap_write_fv(avs_stream_t *stream,
     return err;
 }
 
+static const avs_stream_v_table_extension_write_buffer_t *
+get_write_buffer_extension(avs_stream_t *stream) {
+    return (const avs_stream_v_table_extension_write_buffer_t *)
+            avs_stream_v_table_find_extension(
+                    stream, AVS_STREAM_V_TABLE_EXTENSION_WRITE_BUFFER);
+}
+
+/*
+ * Formats the message directly into the output buffer of the stream. On
+ * ENOBUFS, *inout_size is set to the space required, including the terminating
+ * nullbyte written by vsnprintf().
+ */
+static avs_error_t try_span_write_fv(avs_stream_t *stream,
+                                     const char *msg,
+                                     va_list args,
+                                     size_t *inout_size) {
+    const avs_stream_v_table_extension_write_buffer_t *ext =
+            get_write_buffer_extension(stream);
+    if (!ext || !ext->reserve_span || !ext->commit_bytes) {
+        return avs_errno(AVS_ENOTSUP);
+    }
+    char *span;
+    size_t span_size;
+    avs_error_t err = ext->reserve_span(stream, *inout_size, &span, &span_size);
+    if (avs_is_err(err)) {
+        return err;
+    }
+    int retval = vsnprintf(span, span_size, msg, args);
+    if (retval < 0) {
+        return avs_errno(AVS_EIO);
+    } else if ((size_t) retval >= span_size) {
+        *inout_size = (size_t) retval + 1;
+        return avs_errno(AVS_ENOBUFS);
+    }
+    return ext->commit_bytes(stream, (size_t) retval);
+}
+
 #    ifndef va_copy
 #        define va_copy(dest, src) ((dest) = (src))
 #    endif
@@ -162,11 +205,30 @@ avs_error_t
 avs_stream_write_fv(avs_stream_t *stream, const char *msg, va_list args) {
     avs_error_t err;
     size_t previous_buffer_size = 0;
-    size_t buffer_size;
+    size_t buffer_size = 0;
     va_list copy;
-    va_copy(copy, args);
-    err = try_stack_write_fv(stream, msg, copy, &buffer_size);
-    va_end(copy);
+    // first try whatever space is available, then exactly as much as needed
+    for (int attempt = 0; attempt < 2; ++attempt) {
+        size_t required_size = buffer_size;
+        va_copy(copy, args);
+        err = try_span_write_fv(stream, msg, copy, &required_size);
+        va_end(copy);
+        if (!is_fallback_error(err)) {
+            return err;
+        }
+        if (required_size == buffer_size) {
+            break;
+        }
+        buffer_size = required_size;
+    }
+    if (buffer_size <= AVS_STREAM_STACK_BUFFER_SIZE) {
+        va_copy(copy, args);
+        err = try_stack_write_fv(stream, msg, copy, &buffer_size);
+        va_end(copy);
+    } else {
+        // the required size is already known, the stack buffer is too small
+        err = avs_errno(AVS_ENOBUFS);
+    }
     while (err.category == AVS_ERRNO_CATEGORY && err.code == AVS_ENOBUFS
            && buffer_size > previous_buffer_size) {
         previous_buffer_size = buffer_size;
@@ -198,11 +260,11 @@ avs_error_t avs_stream_read_reliably(avs_stream_t *stream,
 }
 
 avs_error_t avs_stream_ignore_to_end(avs_stream_t *stream) {
-    char tmp_char;
+    size_t bytes_skipped;
     avs_error_t err;
     do {
-        err = avs_stream_getch(stream, &tmp_char, NULL);
-    } while (avs_is_ok(err));
+        err = avs_stream_skip(stream, &bytes_skipped, NULL, SIZE_MAX);
+    } while (avs_is_ok(err) && bytes_skipped > 0);
     if (avs_is_eof(err)) {
         return AVS_OK;
     }
@@ -228,6 +290,11 @@ typedef struct getline_provider_struct {
     avs_error_t (*peek)(struct getline_provider_struct *self,
                         size_t offset,
                         char *out_value);
+    // optional, may be NULL if the stream does not expose its read buffer
+    avs_error_t (*peek_span)(struct getline_provider_struct *self,
+                             const char **out_data,
+                             size_t *out_size);
+    void (*consume)(struct getline_provider_struct *self, size_t size);
 } getline_provider_t;
 
 static avs_error_t validate_line_finished(getline_provider_t *provider,
@@ -269,6 +336,53 @@ static avs_error_t consume_line_terminator(getline_provider_t *provider,
     return err;
 }
 
+/*
+ * Copies characters that do not need any special handling, i.e. anything other
+ * than '\n', '\r' and '\0', directly from the exposed read buffer, for as long
+ * as they fit in the buffer. The remaining characters are left for the
+ * byte-by-byte loop in getline_helper().
+ *
+ * End of stream, a buffer too small to expose any more data and a stream that
+ * does not actually have a read buffer are not treated as errors here - the
+ * byte-by-byte loop will handle these conditions. Other errors (e.g. timeouts)
+ * are returned, so that the read is not retried.
+ */
+static avs_error_t getline_copy_spans(getline_provider_t *provider,
+                                      size_t *inout_bytes_read,
+                                      char *buffer,
+                                      size_t buffer_length) {
+    while (*inout_bytes_read < buffer_length - 1) {
+        const char *data;
+        size_t size;
+        avs_error_t err = provider->peek_span(provider, &data, &size);
+        if (avs_is_eof(err)
+                || (err.category == AVS_ERRNO_CATEGORY
+                    && (err.code == AVS_ENOBUFS || err.code == AVS_ENOTSUP))) {
+            return AVS_OK;
+        } else if (avs_is_err(err)) {
+            return err;
+        }
+        size = AVS_MIN(size, buffer_length - 1 - *inout_bytes_read);
+        const char *special = (const char *) memchr(data, '\n', size);
+        size_t plain_size = special ? (size_t) (special - data) : size;
+        if ((special = (const char *) memchr(data, '\r', plain_size))) {
+            plain_size = (size_t) (special - data);
+        }
+        if ((special = (const char *) memchr(data, '\0', plain_size))) {
+            plain_size = (size_t) (special - data);
+        }
+        if (plain_size) {
+            memcpy(buffer + *inout_bytes_read, data, plain_size);
+            provider->consume(provider, plain_size);
+            *inout_bytes_read += plain_size;
+        }
+        if (plain_size < size) {
+            break;
+        }
+    }
+    return AVS_OK;
+}
+
 static avs_error_t getline_helper(getline_provider_t *provider,
                                   size_t *out_bytes_read,
                                   bool *out_message_finished,
@@ -280,6 +394,10 @@ static avs_error_t getline_helper(getline_provider_t *provider,
     char next_char;
     avs_error_t err = AVS_OK;
     *out_message_finished = false;
+    if (provider->peek_span) {
+        err = getline_copy_spans(provider, out_bytes_read, buffer,
+                                 buffer_length);
+    }
     while (avs_is_ok(err) && *out_bytes_read < buffer_length - 1) {
         err = provider->getch(provider, &tmp_char, out_message_finished);
         if (avs_is_err(err)) {
@@ -327,6 +445,30 @@ static avs_error_t getline_reader_peek_func(getline_provider_t *self_,
     return avs_stream_peek(self->stream, offset, out_value);
 }
 
+static avs_error_t getline_reader_peek_span_func(getline_provider_t *self_,
+                                                 const char **out_data,
+                                                 size_t *out_size) {
+    getline_reader_provider_t *self =
+            AVS_CONTAINER_OF(self_, getline_reader_provider_t, vtable);
+    return avs_stream_peek_span(self->stream, 0, out_data, out_size);
+}
+
+static void getline_reader_consume_func(getline_provider_t *self_,
+                                        size_t size) {
+    getline_reader_provider_t *self =
+            AVS_CONTAINER_OF(self_, getline_reader_provider_t, vtable);
+    if (avs_is_err(avs_stream_consume_bytes(self->stream, size))) {
+        AVS_UNREACHABLE("consuming peeked data failed");
+    }
+}
+
+static const avs_stream_v_table_extension_read_buffer_t *
+get_read_buffer_extension(avs_stream_t *stream) {
+    return (const avs_stream_v_table_extension_read_buffer_t *)
+            avs_stream_v_table_find_extension(
+                    stream, AVS_STREAM_V_TABLE_EXTENSION_READ_BUFFER);
+}
+
 avs_error_t avs_stream_getline(avs_stream_t *stream,
                                size_t *out_bytes_read,
                                bool *out_message_finished,
@@ -344,6 +486,10 @@ avs_error_t avs_stream_getline(avs_stream_t *stream,
         },
         .stream = stream
     };
+    if (get_read_buffer_extension(stream)) {
+        provider.vtable.peek_span = getline_reader_peek_span_func;
+        provider.vtable.consume = getline_reader_consume_func;
+    }
     return getline_helper(
             &provider.vtable, out_bytes_read ? out_bytes_read : &bytes_read,
             out_message_finished ? out_message_finished : &message_finished,
@@ -378,6 +524,20 @@ static avs_error_t getline_peeker_peek_func(getline_provider_t *self_,
     return avs_stream_peek(self->stream, self->offset + offset, out_value);
 }
 
+static avs_error_t getline_peeker_peek_span_func(getline_provider_t *self_,
+                                                 const char **out_data,
+                                                 size_t *out_size) {
+    getline_peeker_provider_t *self =
+            AVS_CONTAINER_OF(self_, getline_peeker_provider_t, vtable);
+    return avs_stream_peek_span(self->stream, self->offset, out_data,
+                                out_size);
+}
+
+static void getline_peeker_consume_func(getline_provider_t *self_,
+                                        size_t size) {
+    AVS_CONTAINER_OF(self_, getline_peeker_provider_t, vtable)->offset += size;
+}
+
 avs_error_t avs_stream_peekline(avs_stream_t *stream,
                                 size_t offset,
                                 size_t *out_bytes_peeked,
@@ -396,6 +556,10 @@ avs_error_t avs_stream_peekline(avs_stream_t *stream,
         .stream = stream,
         .offset = offset
     };
+    if (get_read_buffer_extension(stream)) {
+        provider.vtable.peek_span = getline_peeker_peek_span_func;
+        provider.vtable.consume = getline_peeker_consume_func;
+    }
     avs_error_t err =
             getline_helper(&provider.vtable,
                            out_bytes_peeked ? out_bytes_peeked : &bytes_peeked,
@@ -406,13 +570,65 @@ avs_error_t avs_stream_peekline(avs_stream_t *stream,
     return err;
 }
 
+static avs_error_t copy_transfer(avs_stream_t *output_stream,
+                                 avs_stream_t *input_stream) {
+    const avs_stream_v_table_extension_transfer_t *ext =
+            (const avs_stream_v_table_extension_transfer_t *)
+                    avs_stream_v_table_find_extension(
+                            output_stream,
+                            AVS_STREAM_V_TABLE_EXTENSION_TRANSFER);
+    if (!ext) {
+        return avs_errno(AVS_ENOTSUP);
+    }
+    bool message_finished = false;
+    while (!message_finished) {
+        size_t bytes_transferred = 0;
+        avs_error_t err =
+                ext->transfer_from(output_stream, input_stream,
+                                   &bytes_transferred, &message_finished);
+        if (avs_is_err(err)) {
+            return err;
+        }
+        if (!bytes_transferred && !message_finished) {
+            return avs_errno(AVS_EINVAL);
+        }
+    }
+    return AVS_OK;
+}
+
+static avs_error_t copy_spans(avs_stream_t *output_stream,
+                              avs_stream_t *input_stream) {
+    while (true) {
+        const char *data;
+        size_t size;
+        avs_error_t err;
+        if (avs_is_err((err = avs_stream_peek_span(input_stream, 0, &data,
+                                                   &size)))) {
+            return avs_is_eof(err) ? AVS_OK : err;
+        }
+        if (avs_is_err((err = avs_stream_write(output_stream, data, size)))
+                || avs_is_err((err = avs_stream_consume_bytes(input_stream,
+                                                              size)))) {
+            return err;
+        }
+    }
+}
+
 avs_error_t avs_stream_copy(avs_stream_t *output_stream,
                             avs_stream_t *input_stream) {
+    avs_error_t err = copy_transfer(output_stream, input_stream);
+    if (!is_fallback_error(err)) {
+        return err;
+    }
+    // data exposed by the input stream is written directly from its buffer
+    if (!is_fallback_error((err = copy_spans(output_stream, input_stream)))) {
+        return err;
+    }
+
     char buf[AVS_STREAM_STACK_BUFFER_SIZE];
     size_t bytes_read;
     bool message_finished = false;
     while (!message_finished) {
-        avs_error_t err;
         if (avs_is_err((err = avs_stream_read(input_stream, &bytes_read,
                                               &message_finished, buf,
                                               sizeof(buf))))
@@ -477,6 +693,201 @@ avs_error_t avs_stream_offset(avs_stream_t *stream, avs_off_t *out_offset) {
     return avs_errno(AVS_ENOTSUP);
 }
 
+avs_error_t avs_stream_peek_span(avs_stream_t *stream,
+                                 size_t offset,
+                                 const char **out_data,
+                                 size_t *out_size) {
+    const avs_stream_v_table_extension_read_buffer_t *ext =
+            get_read_buffer_extension(stream);
+    if (ext && ext->peek_span) {
+        return ext->peek_span(stream, offset, out_data, out_size);
+    }
+    return avs_errno(AVS_ENOTSUP);
+}
+
+avs_error_t avs_stream_consume_bytes(avs_stream_t *stream, size_t size) {
+    const avs_stream_v_table_extension_read_buffer_t *ext =
+            get_read_buffer_extension(stream);
+    if (ext && ext->consume_bytes) {
+        return ext->consume_bytes(stream, size);
+    }
+    return avs_errno(AVS_ENOTSUP);
+}
+
+avs_error_t avs_stream_reserve_span(avs_stream_t *stream,
+                                    size_t min_size,
+                                    char **out_data,
+                                    size_t *out_size) {
+    const avs_stream_v_table_extension_write_buffer_t *ext =
+            get_write_buffer_extension(stream);
+    if (ext && ext->reserve_span) {
+        return ext->reserve_span(stream, min_size, out_data, out_size);
+    }
+    return avs_errno(AVS_ENOTSUP);
+}
+
+avs_error_t avs_stream_commit_bytes(avs_stream_t *stream, size_t size) {
+    const avs_stream_v_table_extension_write_buffer_t *ext =
+            get_write_buffer_extension(stream);
+    if (ext && ext->commit_bytes) {
+        return ext->commit_bytes(stream, size);
+    }
+    return avs_errno(AVS_ENOTSUP);
+}
+
+static const avs_stream_v_table_extension_vector_t *
+get_vector_extension(avs_stream_t *stream) {
+    return (const avs_stream_v_table_extension_vector_t *)
+            avs_stream_v_table_find_extension(
+                    stream, AVS_STREAM_V_TABLE_EXTENSION_VECTOR);
+}
+
+static avs_error_t
+write_some_vector_generic(avs_stream_t *stream,
+                          const avs_stream_const_iovec_t *iov,
+                          size_t iovcnt,
+                          size_t *out_bytes_written) {
+    for (size_t i = 0; i < iovcnt; ++i) {
+        if (!iov[i].size) {
+            continue;
+        }
+        size_t bytes_written = iov[i].size;
+        avs_error_t err =
+                avs_stream_write_some(stream, iov[i].data, &bytes_written);
+        if (avs_is_err(err)) {
+            return err;
+        }
+        *out_bytes_written += bytes_written;
+        if (bytes_written < iov[i].size) {
+            break;
+        }
+    }
+    return AVS_OK;
+}
+
+avs_error_t avs_stream_write_some_vector(avs_stream_t *stream,
+                                         const avs_stream_const_iovec_t *iov,
+                                         size_t iovcnt,
+                                         size_t *out_bytes_written) {
+    const avs_stream_v_table_extension_vector_t *ext =
+            get_vector_extension(stream);
+    size_t bytes_written = 0;
+    avs_error_t err;
+    if (ext && ext->write_some_vector) {
+        err = ext->write_some_vector(stream, iov, iovcnt, &bytes_written);
+    } else {
+        err = write_some_vector_generic(stream, iov, iovcnt, &bytes_written);
+    }
+    if (out_bytes_written) {
+        *out_bytes_written = bytes_written;
+    }
+    return err;
+}
+
+avs_error_t avs_stream_write_vector(avs_stream_t *stream,
+                                    const avs_stream_const_iovec_t *iov,
+                                    size_t iovcnt) {
+    size_t total_size = 0;
+    for (size_t i = 0; i < iovcnt; ++i) {
+        total_size += iov[i].size;
+    }
+    size_t bytes_written;
+    avs_error_t err =
+            avs_stream_write_some_vector(stream, iov, iovcnt, &bytes_written);
+    if (avs_is_ok(err) && bytes_written != total_size) {
+        return avs_errno(AVS_EMSGSIZE);
+    }
+    return err;
+}
+
+static avs_error_t read_vector_generic(avs_stream_t *stream,
+                                       size_t *out_bytes_read,
+                                       bool *out_message_finished,
+                                       const avs_stream_iovec_t *iov,
+                                       size_t iovcnt) {
+    size_t i = 0;
+    while (i < iovcnt && !iov[i].size) {
+        ++i;
+    }
+    if (i == iovcnt) {
+        char dummy;
+        return avs_stream_read(stream, NULL, out_message_finished, &dummy, 0);
+    }
+    for (; i < iovcnt; ++i) {
+        if (!iov[i].size) {
+            continue;
+        }
+        // do not block if some data is already available for the caller
+        if (*out_bytes_read && !avs_stream_nonblock_read_ready(stream)) {
+            break;
+        }
+        size_t bytes_read = 0;
+        avs_error_t err = avs_stream_read(stream, &bytes_read,
+                                          out_message_finished, iov[i].data,
+                                          iov[i].size);
+        *out_bytes_read += bytes_read;
+        if (avs_is_err(err)) {
+            return err;
+        }
+        if (*out_message_finished || bytes_read < iov[i].size) {
+            break;
+        }
+    }
+    return AVS_OK;
+}
+
+avs_error_t avs_stream_read_vector(avs_stream_t *stream,
+                                   size_t *out_bytes_read,
+                                   bool *out_message_finished,
+                                   const avs_stream_iovec_t *iov,
+                                   size_t iovcnt) {
+    const avs_stream_v_table_extension_vector_t *ext =
+            get_vector_extension(stream);
+    size_t bytes_read = 0;
+    bool message_finished = false;
+    avs_error_t err;
+    if (ext && ext->read_vector) {
+        err = ext->read_vector(stream, &bytes_read, &message_finished, iov,
+                               iovcnt);
+    } else {
+        err = read_vector_generic(stream, &bytes_read, &message_finished, iov,
+                                  iovcnt);
+    }
+    if (out_bytes_read) {
+        *out_bytes_read = bytes_read;
+    }
+    if (out_message_finished) {
+        *out_message_finished = message_finished;
+    }
+    return err;
+}
+
+avs_error_t avs_stream_skip(avs_stream_t *stream,
+                            size_t *out_bytes_skipped,
+                            bool *out_message_finished,
+                            size_t size) {
+    const avs_stream_v_table_extension_skip_t *ext =
+            (const avs_stream_v_table_extension_skip_t *)
+                    avs_stream_v_table_find_extension(
+                            stream, AVS_STREAM_V_TABLE_EXTENSION_SKIP);
+    if (ext && ext->skip) {
+        size_t bytes_skipped = 0;
+        bool message_finished = false;
+        avs_error_t err =
+                ext->skip(stream, &bytes_skipped, &message_finished, size);
+        if (out_bytes_skipped) {
+            *out_bytes_skipped = bytes_skipped;
+        }
+        if (out_message_finished) {
+            *out_message_finished = message_finished;
+        }
+        return err;
+    }
+    char buf[AVS_STREAM_STACK_BUFFER_SIZE];
+    return avs_stream_read(stream, out_bytes_skipped, out_message_finished, buf,
+                           AVS_MIN(size, sizeof(buf)));
+}
+
 #    ifdef AVS_UNIT_TESTING
 #        include "tests/stream/test_stream_generic.c"
 #    endif
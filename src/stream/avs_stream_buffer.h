@@ -0,0 +1,157 @@
+/*
+ * Copyright 2023 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef STREAM_BUFFER_H
+#define STREAM_BUFFER_H
+
+#include <assert.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <avsystem/commons/avs_buffer.h>
+#include <avsystem/commons/avs_defs.h>
+#include <avsystem/commons/avs_stream.h>
+
+VISIBILITY_PRIVATE_HEADER_BEGIN
+
+/*
+ * Buffer used by the buffered and netbuf streams: either avs_ring_buffer_t or
+ * avs_buffer_t, depending on AVS_COMMONS_STREAM_WITH_RING_BUFFER. Both are
+ * accessed through the segment-based interface of avs_ring_buffer_t; a plain
+ * avs_buffer_t always exposes a single segment of data and of free space.
+ */
+#ifdef AVS_COMMONS_STREAM_WITH_RING_BUFFER
+typedef avs_ring_buffer_t _avs_stream_buffer_t;
+
+#    define _avs_stream_buffer_create avs_ring_buffer_create
+#    define _avs_stream_buffer_free avs_ring_buffer_free
+#    define _avs_stream_buffer_reset avs_ring_buffer_reset
+#    define _avs_stream_buffer_data_size avs_ring_buffer_data_size
+#    define _avs_stream_buffer_capacity avs_ring_buffer_capacity
+#    define _avs_stream_buffer_space_left avs_ring_buffer_space_left
+#    define _avs_stream_buffer_data_segments avs_ring_buffer_data_segments
+#    define _avs_stream_buffer_space_segments avs_ring_buffer_space_segments
+#    define _avs_stream_buffer_copy_data avs_ring_buffer_copy_data
+#    define _avs_stream_buffer_consume_bytes avs_ring_buffer_consume_bytes
+#    define _avs_stream_buffer_append_bytes avs_ring_buffer_append_bytes
+#    define _avs_stream_buffer_advance_ptr avs_ring_buffer_advance_ptr
+#else // AVS_COMMONS_STREAM_WITH_RING_BUFFER
+typedef avs_buffer_t _avs_stream_buffer_t;
+
+#    define _avs_stream_buffer_create avs_buffer_create
+#    define _avs_stream_buffer_free avs_buffer_free
+#    define _avs_stream_buffer_reset avs_buffer_reset
+#    define _avs_stream_buffer_data_size avs_buffer_data_size
+#    define _avs_stream_buffer_capacity avs_buffer_capacity
+#    define _avs_stream_buffer_space_left avs_buffer_space_left
+#    define _avs_stream_buffer_consume_bytes avs_buffer_consume_bytes
+#    define _avs_stream_buffer_append_bytes avs_buffer_append_bytes
+#    define _avs_stream_buffer_advance_ptr avs_buffer_advance_ptr
+
+static inline size_t
+_avs_stream_buffer_data_segments(avs_buffer_t *buffer,
+                                 avs_ring_buffer_segment_t out_segments[2]) {
+    out_segments[0].ptr = (char *) (intptr_t) avs_buffer_data(buffer);
+    out_segments[0].size = avs_buffer_data_size(buffer);
+    out_segments[1].ptr = out_segments[0].ptr + out_segments[0].size;
+    out_segments[1].size = 0;
+    return out_segments[0].size ? 1 : 0;
+}
+
+static inline size_t
+_avs_stream_buffer_space_segments(avs_buffer_t *buffer,
+                                  avs_ring_buffer_segment_t out_segments[2]) {
+    out_segments[0].ptr = avs_buffer_raw_insert_ptr(buffer);
+    out_segments[0].size = avs_buffer_space_left(buffer);
+    out_segments[1].ptr = out_segments[0].ptr + out_segments[0].size;
+    out_segments[1].size = 0;
+    return out_segments[0].size ? 1 : 0;
+}
+
+static inline int _avs_stream_buffer_copy_data(const avs_buffer_t *buffer,
+                                               size_t offset,
+                                               void *dest,
+                                               size_t size) {
+    if (offset > avs_buffer_data_size(buffer)
+            || size > avs_buffer_data_size(buffer) - offset) {
+        return -1;
+    }
+    memcpy(dest, avs_buffer_data(buffer) + offset, size);
+    return 0;
+}
+#endif // AVS_COMMONS_STREAM_WITH_RING_BUFFER
+
+/*
+ * Returns the contiguous fragment of buffered data that starts at the given
+ * offset, which MUST be less than the amount of buffered data.
+ */
+static inline void _avs_stream_buffer_span(_avs_stream_buffer_t *buffer,
+                                           size_t offset,
+                                           const char **out_data,
+                                           size_t *out_size) {
+    avs_ring_buffer_segment_t segments[2];
+    _avs_stream_buffer_data_segments(buffer, segments);
+    assert(offset < segments[0].size + segments[1].size);
+    if (offset < segments[0].size) {
+        *out_data = segments[0].ptr + offset;
+        *out_size = segments[0].size - offset;
+    } else {
+        *out_data = segments[1].ptr + (offset - segments[0].size);
+        *out_size = segments[1].size - (offset - segments[0].size);
+    }
+}
+
+/*
+ * Moves as much data as possible from the buffer into the buffers described by
+ * iov. Returns the number of bytes moved.
+ */
+static inline size_t
+_avs_stream_buffer_read_vector(_avs_stream_buffer_t *buffer,
+                               const avs_stream_iovec_t *iov,
+                               size_t iovcnt) {
+    size_t bytes_read = 0;
+    for (size_t i = 0;
+         i < iovcnt && _avs_stream_buffer_data_size(buffer) > 0;
+         ++i) {
+        size_t chunk_size =
+                AVS_MIN(iov[i].size, _avs_stream_buffer_data_size(buffer));
+        if (chunk_size) {
+            _avs_stream_buffer_copy_data(buffer, 0, iov[i].data, chunk_size);
+            _avs_stream_buffer_consume_bytes(buffer, chunk_size);
+            bytes_read += chunk_size;
+        }
+    }
+    return bytes_read;
+}
+
+/*
+ * Appends data from all the buffers described by iov. The caller is
+ * responsible for ensuring that there is enough space.
+ */
+static inline void
+_avs_stream_buffer_append_vector(_avs_stream_buffer_t *buffer,
+                                 const avs_stream_const_iovec_t *iov,
+                                 size_t iovcnt) {
+    for (size_t i = 0; i < iovcnt; ++i) {
+        if (iov[i].size) {
+            _avs_stream_buffer_append_bytes(buffer, iov[i].data, iov[i].size);
+        }
+    }
+}
+
+VISIBILITY_PRIVATE_HEADER_END
+
+#endif /* STREAM_BUFFER_H */
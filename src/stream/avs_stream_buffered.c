@@ -29,55 +29,68 @@
  */
 #    include <limits.h>
 
-#    include <avsystem/commons/avs_buffer.h>
 #    include <avsystem/commons/avs_errno.h>
 #    include <avsystem/commons/avs_memory.h>
 #    include <avsystem/commons/avs_stream_v_table.h>
 
+#    include "avs_stream_buffer.h"
+
 #    define MODULE_NAME stream_buffered
 #    include <avs_x_log_config.h>
 
 VISIBILITY_SOURCE_BEGIN
 
+/*
+ * Maximum number of user-provided buffers passed, along with the buffered data,
+ * to a single vectored write on the underlying stream
+ */
+#    define WRITE_VECTOR_BATCH_SIZE 16
+
 typedef struct {
     const void *const vtable;
     avs_stream_t *underlying_stream;
-    avs_buffer_t *in_buffer;
-    avs_buffer_t *out_buffer;
+    _avs_stream_buffer_t *in_buffer;
+    _avs_stream_buffer_t *out_buffer;
     bool message_finished;
 } buffered_stream_t;
 
 static avs_error_t flush_data(buffered_stream_t *stream,
                               size_t *out_bytes_written) {
-    if (!(*out_bytes_written = avs_buffer_data_size(stream->out_buffer))) {
-        return AVS_OK;
-    }
-
-    avs_error_t err = avs_stream_write_some(stream->underlying_stream,
-                                            avs_buffer_data(stream->out_buffer),
-                                            out_bytes_written);
-    if (avs_is_err(err)) {
-        return err;
+    avs_ring_buffer_segment_t segments[2];
+    size_t segment_count =
+            _avs_stream_buffer_data_segments(stream->out_buffer, segments);
+    *out_bytes_written = 0;
+    for (size_t i = 0; i < segment_count; ++i) {
+        size_t bytes_written = segments[i].size;
+        avs_error_t err = avs_stream_write_some(stream->underlying_stream,
+                                                segments[i].ptr,
+                                                &bytes_written);
+        if (avs_is_err(err)) {
+            return err;
+        }
+        _avs_stream_buffer_consume_bytes(stream->out_buffer, bytes_written);
+        *out_bytes_written += bytes_written;
+        if (bytes_written < segments[i].size) {
+            break;
+        }
     }
-
-    avs_buffer_consume_bytes(stream->out_buffer, *out_bytes_written);
     return AVS_OK;
 }
 
 static avs_error_t fetch_data(buffered_stream_t *stream,
                               size_t *out_bytes_read) {
-    char *insert_ptr = avs_buffer_raw_insert_ptr(stream->in_buffer);
-    size_t bytes_to_read = avs_buffer_space_left(stream->in_buffer);
+    avs_ring_buffer_segment_t segments[2];
+    _avs_stream_buffer_space_segments(stream->in_buffer, segments);
 
     avs_error_t err = avs_stream_read(stream->underlying_stream, out_bytes_read,
-                                      &stream->message_finished, insert_ptr,
-                                      bytes_to_read);
+                                      &stream->message_finished,
+                                      segments[0].ptr, segments[0].size);
     if (avs_is_err(err)) {
         return err;
     }
 
-    assert(*out_bytes_read <= avs_buffer_capacity(stream->in_buffer));
-    avs_buffer_advance_ptr(stream->in_buffer, *out_bytes_read);
+    assert(*out_bytes_read <= segments[0].size);
+    _avs_stream_buffer_advance_ptr(stream->in_buffer, *out_bytes_read);
     return AVS_OK;
 }
 
@@ -102,13 +115,14 @@ static avs_error_t stream_buffered_write_some(avs_stream_t *stream_,
     size_t total_written = 0;
     while (total_written < *inout_data_length) {
         size_t bytes_to_write =
-                AVS_MIN(avs_buffer_space_left(stream->out_buffer),
+                AVS_MIN(_avs_stream_buffer_space_left(stream->out_buffer),
                         *inout_data_length - total_written);
-        avs_buffer_append_bytes(stream->out_buffer,
-                                (const uint8_t *) buffer + total_written,
-                                bytes_to_write);
+        _avs_stream_buffer_append_bytes(stream->out_buffer,
+                                        (const uint8_t *) buffer
+                                                + total_written,
+                                        bytes_to_write);
         total_written += bytes_to_write;
-        if (avs_buffer_space_left(stream->out_buffer) == 0) {
+        if (_avs_stream_buffer_space_left(stream->out_buffer) == 0) {
             size_t bytes_flushed;
             avs_error_t err = flush_data(stream, &bytes_flushed);
             if (avs_is_err(err)) {
@@ -123,6 +137,86 @@ static avs_error_t stream_buffered_write_some(avs_stream_t *stream_,
     return AVS_OK;
 }
 
+static size_t vector_size(const avs_stream_const_iovec_t *iov, size_t iovcnt) {
+    size_t result = 0;
+    for (size_t i = 0; i < iovcnt; ++i) {
+        result += iov[i].size;
+    }
+    return result;
+}
+
+static avs_error_t
+stream_buffered_write_some_vector(avs_stream_t *stream_,
+                                  const avs_stream_const_iovec_t *iov,
+                                  size_t iovcnt,
+                                  size_t *out_bytes_written) {
+    buffered_stream_t *stream = (buffered_stream_t *) stream_;
+    if (!stream->out_buffer) {
+        return avs_stream_write_some_vector(stream->underlying_stream, iov,
+                                            iovcnt, out_bytes_written);
+    }
+
+    size_t index = 0;
+    size_t offset = 0;
+    while (index < iovcnt) {
+        size_t bytes_left = vector_size(&iov[index], iovcnt - index) - offset;
+        if (bytes_left <= _avs_stream_buffer_space_left(stream->out_buffer)) {
+            _avs_stream_buffer_append_bytes(
+                    stream->out_buffer,
+                    (const char *) iov[index].data + offset,
+                    iov[index].size - offset);
+            _avs_stream_buffer_append_vector(stream->out_buffer,
+                                             &iov[index + 1],
+                                             iovcnt - index - 1);
+            *out_bytes_written += bytes_left;
+            break;
+        }
+
+        // Pass the buffered data to the underlying stream along with as much
+        // of the new data as possible, without copying the latter
+        avs_stream_const_iovec_t vector[2 + WRITE_VECTOR_BATCH_SIZE];
+        avs_ring_buffer_segment_t segments[2];
+        size_t buffered_size = _avs_stream_buffer_data_size(stream->out_buffer);
+        size_t count =
+                _avs_stream_buffer_data_segments(stream->out_buffer, segments);
+        for (size_t i = 0; i < count; ++i) {
+            vector[i].data = segments[i].ptr;
+            vector[i].size = segments[i].size;
+        }
+        for (size_t i = index, i_offset = offset;
+             i < iovcnt && count < AVS_ARRAY_SIZE(vector);
+             ++i, i_offset = 0) {
+            if (iov[i].size > i_offset) {
+                vector[count].data = (const char *) iov[i].data + i_offset;
+                vector[count].size = iov[i].size - i_offset;
+                ++count;
+            }
+        }
+
+        size_t bytes_written = 0;
+        avs_error_t err =
+                avs_stream_write_some_vector(stream->underlying_stream, vector,
+                                             count, &bytes_written);
+        if (avs_is_err(err)) {
+            return err;
+        }
+        if (bytes_written == 0) {
+            break;
+        }
+        size_t bytes_flushed = AVS_MIN(bytes_written, buffered_size);
+        _avs_stream_buffer_consume_bytes(stream->out_buffer, bytes_flushed);
+        bytes_written -= bytes_flushed;
+        *out_bytes_written += bytes_written;
+        while (index < iovcnt && bytes_written >= iov[index].size - offset) {
+            bytes_written -= iov[index].size - offset;
+            ++index;
+            offset = 0;
+        }
+        offset += bytes_written;
+    }
+    return AVS_OK;
+}
+
 static avs_error_t stream_buffered_read(avs_stream_t *stream_,
                                         size_t *out_bytes_read,
                                         bool *out_message_finished,
@@ -149,18 +243,19 @@ static avs_error_t stream_buffered_read(avs_stream_t *stream_,
         goto finish;
     }
 
-    if (avs_buffer_data_size(stream->in_buffer) == 0) {
+    if (_avs_stream_buffer_data_size(stream->in_buffer) == 0) {
         avs_error_t err = fetch_data(stream, &(size_t) { 0 });
         if (avs_is_err(err)) {
             return err;
         }
     }
 
-    bytes_read =
-            AVS_MIN(avs_buffer_data_size(stream->in_buffer), buffer_length);
+    bytes_read = AVS_MIN(_avs_stream_buffer_data_size(stream->in_buffer),
+                         buffer_length);
     if (bytes_read) {
-        memcpy(buffer, avs_buffer_data(stream->in_buffer), bytes_read);
-        avs_buffer_consume_bytes(stream->in_buffer, bytes_read);
+        _avs_stream_buffer_copy_data(stream->in_buffer, 0, buffer,
+                                     bytes_read);
+        _avs_stream_buffer_consume_bytes(stream->in_buffer, bytes_read);
     }
 
 finish:
@@ -173,9 +268,47 @@ finish:
     return AVS_OK;
 }
 
+static avs_error_t stream_buffered_read_vector(avs_stream_t *stream_,
+                                               size_t *out_bytes_read,
+                                               bool *out_message_finished,
+                                               const avs_stream_iovec_t *iov,
+                                               size_t iovcnt) {
+    buffered_stream_t *stream = (buffered_stream_t *) stream_;
+    avs_error_t err = AVS_OK;
+    if (stream->in_buffer
+            && _avs_stream_buffer_data_size(stream->in_buffer) > 0) {
+        *out_bytes_read =
+                _avs_stream_buffer_read_vector(stream->in_buffer, iov, iovcnt);
+    } else {
+        size_t bytes_to_read = 0;
+        for (size_t i = 0; i < iovcnt; ++i) {
+            bytes_to_read += iov[i].size;
+        }
+        size_t capacity = stream->in_buffer ? _avs_stream_buffer_capacity(
+                                                      stream->in_buffer)
+                                            : 0;
+        if (bytes_to_read >= capacity) {
+            // buffering would not help, read directly into user buffers
+            err = avs_stream_read_vector(stream->underlying_stream,
+                                         out_bytes_read,
+                                         &stream->message_finished, iov,
+                                         iovcnt);
+        } else if (bytes_to_read > 0
+                   && avs_is_ok((err = fetch_data(stream, &(size_t) { 0 })))) {
+            *out_bytes_read = _avs_stream_buffer_read_vector(stream->in_buffer,
+                                                             iov, iovcnt);
+        }
+    }
+    *out_message_finished =
+            stream->message_finished
+            && (!stream->in_buffer
+                || _avs_stream_buffer_data_size(stream->in_buffer) == 0);
+    return err;
+}
+
 static avs_error_t finish_message(buffered_stream_t *stream) {
     assert(stream->out_buffer);
-    size_t data_size = avs_buffer_data_size(stream->out_buffer);
+    size_t data_size = _avs_stream_buffer_data_size(stream->out_buffer);
     size_t bytes_flushed;
     avs_error_t err = flush_data(stream, &bytes_flushed);
     if (avs_is_ok(err) && bytes_flushed < data_size) {
@@ -204,8 +337,8 @@ stream_buffered_peek(avs_stream_t *stream_, size_t offset, char *out_value) {
         return avs_stream_peek(stream->underlying_stream, offset, out_value);
     }
 
-    if (offset < avs_buffer_capacity(stream->in_buffer)) {
-        while (offset >= avs_buffer_data_size(stream->in_buffer)) {
+    if (offset < _avs_stream_buffer_capacity(stream->in_buffer)) {
+        while (offset >= _avs_stream_buffer_data_size(stream->in_buffer)) {
             size_t bytes_read;
             avs_error_t err = fetch_data(stream, &bytes_read);
             if (avs_is_err(err)) {
@@ -217,14 +350,14 @@ stream_buffered_peek(avs_stream_t *stream_, size_t offset, char *out_value) {
                                                 : avs_errno(AVS_ENOBUFS);
             }
         }
-        *out_value = avs_buffer_data(stream->in_buffer)[offset];
+        _avs_stream_buffer_copy_data(stream->in_buffer, offset, out_value, 1);
         return AVS_OK;
     }
 
-    avs_error_t err =
-            avs_stream_peek(stream->underlying_stream,
-                            offset - avs_buffer_data_size(stream->in_buffer),
-                            out_value);
+    avs_error_t err = avs_stream_peek(
+            stream->underlying_stream,
+            offset - _avs_stream_buffer_data_size(stream->in_buffer),
+            out_value);
     if (avs_is_err(err)) {
         LOG(ERROR,
             _("cannot peek - buffer is too small and underlying stream's ")
@@ -237,15 +370,92 @@ stream_buffered_peek(avs_stream_t *stream_, size_t offset, char *out_value) {
     return err;
 }
 
+static avs_error_t stream_buffered_peek_span(avs_stream_t *stream_,
+                                             size_t offset,
+                                             const char **out_data,
+                                             size_t *out_size) {
+    buffered_stream_t *stream = (buffered_stream_t *) stream_;
+    if (!stream->in_buffer) {
+        return avs_errno(AVS_ENOTSUP);
+    }
+    if (offset >= _avs_stream_buffer_capacity(stream->in_buffer)) {
+        return avs_errno(AVS_ENOBUFS);
+    }
+    while (offset >= _avs_stream_buffer_data_size(stream->in_buffer)) {
+        size_t bytes_read;
+        avs_error_t err = fetch_data(stream, &bytes_read);
+        if (avs_is_err(err)) {
+            return err;
+        } else if (bytes_read == 0) {
+            return stream->message_finished ? AVS_EOF : avs_errno(AVS_ENOBUFS);
+        }
+    }
+    _avs_stream_buffer_span(stream->in_buffer, offset, out_data, out_size);
+    return AVS_OK;
+}
+
+static avs_error_t stream_buffered_consume_bytes(avs_stream_t *stream_,
+                                                 size_t size) {
+    buffered_stream_t *stream = (buffered_stream_t *) stream_;
+    if (!stream->in_buffer
+            || size > _avs_stream_buffer_data_size(stream->in_buffer)) {
+        return avs_errno(AVS_EINVAL);
+    }
+    _avs_stream_buffer_consume_bytes(stream->in_buffer, size);
+    return AVS_OK;
+}
+
+static avs_error_t stream_buffered_reserve_span(avs_stream_t *stream_,
+                                                size_t min_size,
+                                                char **out_data,
+                                                size_t *out_size) {
+    buffered_stream_t *stream = (buffered_stream_t *) stream_;
+    if (!stream->out_buffer) {
+        return avs_errno(AVS_ENOTSUP);
+    }
+    if (min_size > _avs_stream_buffer_capacity(stream->out_buffer)) {
+        return avs_errno(AVS_ENOBUFS);
+    }
+    avs_ring_buffer_segment_t segments[2];
+    _avs_stream_buffer_space_segments(stream->out_buffer, segments);
+    // free space becomes contiguous once all buffered data is flushed
+    while (segments[0].size < min_size) {
+        size_t bytes_flushed;
+        avs_error_t err = flush_data(stream, &bytes_flushed);
+        if (avs_is_err(err)) {
+            return err;
+        } else if (bytes_flushed == 0) {
+            return avs_errno(AVS_ENOBUFS);
+        }
+        _avs_stream_buffer_space_segments(stream->out_buffer, segments);
+    }
+    *out_data = segments[0].ptr;
+    *out_size = segments[0].size;
+    return AVS_OK;
+}
+
+static avs_error_t stream_buffered_commit_bytes(avs_stream_t *stream_,
+                                                size_t size) {
+    buffered_stream_t *stream = (buffered_stream_t *) stream_;
+    if (!stream->out_buffer
+            || _avs_stream_buffer_advance_ptr(stream->out_buffer, size)) {
+        return avs_errno(AVS_EINVAL);
+    }
+    if (_avs_stream_buffer_space_left(stream->out_buffer) == 0) {
+        return flush_data(stream, &(size_t) { 0 });
+    }
+    return AVS_OK;
+}
+
 static avs_error_t stream_buffered_close(avs_stream_t *stream_) {
     buffered_stream_t *stream = (buffered_stream_t *) stream_;
     avs_error_t err = AVS_OK;
     if (stream->out_buffer) {
         err = finish_message(stream);
-        avs_buffer_free(&stream->out_buffer);
+        _avs_stream_buffer_free(&stream->out_buffer);
     }
     if (stream->in_buffer) {
-        avs_buffer_free(&stream->in_buffer);
+        _avs_stream_buffer_free(&stream->in_buffer);
     }
 
     avs_error_t backend_err = avs_stream_cleanup(&stream->underlying_stream);
@@ -256,10 +466,10 @@ static avs_error_t stream_buffered_close(avs_stream_t *stream_) {
 static avs_error_t stream_buffered_reset(avs_stream_t *stream_) {
     buffered_stream_t *stream = (buffered_stream_t *) stream_;
     if (stream->in_buffer) {
-        avs_buffer_reset(stream->in_buffer);
+        _avs_stream_buffer_reset(stream->in_buffer);
     }
     if (stream->out_buffer) {
-        avs_buffer_reset(stream->out_buffer);
+        _avs_stream_buffer_reset(stream->out_buffer);
     }
     return avs_stream_reset(stream->underlying_stream);
 }
@@ -270,7 +480,22 @@ static const avs_stream_v_table_t buffered_stream_vtable = {
     .read = stream_buffered_read,
     .peek = stream_buffered_peek,
     .reset = stream_buffered_reset,
-    .close = stream_buffered_close
+    .close = stream_buffered_close,
+    .extension_list =
+            (const avs_stream_v_table_extension_t[]) {
+                    { AVS_STREAM_V_TABLE_EXTENSION_VECTOR,
+                      &(const avs_stream_v_table_extension_vector_t) {
+                              stream_buffered_write_some_vector,
+                              stream_buffered_read_vector } },
+                    { AVS_STREAM_V_TABLE_EXTENSION_READ_BUFFER,
+                      &(const avs_stream_v_table_extension_read_buffer_t) {
+                              stream_buffered_peek_span,
+                              stream_buffered_consume_bytes } },
+                    { AVS_STREAM_V_TABLE_EXTENSION_WRITE_BUFFER,
+                      &(const avs_stream_v_table_extension_write_buffer_t) {
+                              stream_buffered_reserve_span,
+                              stream_buffered_commit_bytes } },
+                    AVS_STREAM_V_TABLE_EXTENSION_NULL }
 };
 
 int avs_stream_buffered_create(avs_stream_t **inout_stream,
@@ -296,11 +521,12 @@ int avs_stream_buffered_create(avs_stream_t **inout_stream,
     }
 
     if ((in_buffer_size > 0
-         && avs_buffer_create(&stream->in_buffer, in_buffer_size))
+         && _avs_stream_buffer_create(&stream->in_buffer, in_buffer_size))
             || (out_buffer_size > 0
-                && avs_buffer_create(&stream->out_buffer, out_buffer_size))) {
-        avs_buffer_free(&stream->in_buffer);
-        avs_buffer_free(&stream->out_buffer);
+                && _avs_stream_buffer_create(&stream->out_buffer,
+                                             out_buffer_size))) {
+        _avs_stream_buffer_free(&stream->in_buffer);
+        _avs_stream_buffer_free(&stream->out_buffer);
         avs_stream_cleanup((avs_stream_t **) &stream);
         return -1;
     }
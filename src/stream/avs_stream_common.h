@@ -27,6 +27,16 @@ VISIBILITY_PRIVATE_HEADER_BEGIN
 
 avs_error_t _avs_stream_empty_finish_message(avs_stream_t *stream);
 
+#    if defined(AVS_COMMONS_STREAM_WITH_FILE) \
+            && defined(AVS_COMMONS_STREAM_FILE_WITH_MMAP)
+/*
+ * Creates a read-only file stream backed by a memory mapping of the whole file.
+ * Returns NULL if the file cannot be mapped.
+ */
+avs_stream_t *_avs_stream_file_mmap_create(const char *path);
+#    endif // defined(AVS_COMMONS_STREAM_WITH_FILE) &&
+           // defined(AVS_COMMONS_STREAM_FILE_WITH_MMAP)
+
 VISIBILITY_PRIVATE_HEADER_END
 
 #endif // AVS_COMMONS_WITH_AVS_STREAM
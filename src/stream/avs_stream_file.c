@@ -67,6 +67,19 @@ avs_error_t avs_stream_file_seek(avs_stream_t *stream,
     return avs_errno(AVS_ENOTSUP);
 }
 
+avs_error_t avs_stream_file_handle(avs_stream_t *stream,
+                                   FILE **out_file,
+                                   avs_off_t *out_offset) {
+    const avs_stream_v_table_extension_file_handle_t *ext =
+            (const avs_stream_v_table_extension_file_handle_t *)
+                    avs_stream_v_table_find_extension(
+                            stream, AVS_STREAM_V_TABLE_EXTENSION_FILE_HANDLE);
+    if (ext) {
+        return ext->handle(stream, out_file, out_offset);
+    }
+    return avs_errno(AVS_ENOTSUP);
+}
+
 static avs_error_t stream_file_write_some(avs_stream_t *stream_,
                                           const void *buffer,
                                           size_t *inout_data_length) {
@@ -194,6 +207,22 @@ static avs_error_t stream_file_length(avs_stream_t *stream,
     return avs_is_ok(err) ? seek_err : err;
 }
 
+static avs_error_t stream_file_handle(avs_stream_t *stream,
+                                      FILE **out_file,
+                                      avs_off_t *out_offset) {
+    avs_stream_file_t *file = (avs_stream_file_t *) stream;
+    if ((file->mode & AVS_STREAM_FILE_READ) == 0) {
+        return avs_errno(AVS_ENOTSUP);
+    }
+    // seeking writes out any data buffered by stdio
+    avs_error_t err = stream_file_offset(stream, out_offset);
+    if (avs_is_ok(err)
+            && avs_is_ok((err = stream_file_seek(stream, *out_offset)))) {
+        *out_file = file->fp;
+    }
+    return err;
+}
+
 static const avs_stream_v_table_t file_stream_vtable = {
     .write_some = stream_file_write_some,
     .read = stream_file_read,
@@ -209,10 +238,23 @@ static const avs_stream_v_table_t file_stream_vtable = {
                     { AVS_STREAM_V_TABLE_EXTENSION_FILE,
                       &(const avs_stream_v_table_extension_file_t) {
                               stream_file_length, stream_file_seek } },
+                    { AVS_STREAM_V_TABLE_EXTENSION_FILE_HANDLE,
+                      &(const avs_stream_v_table_extension_file_handle_t) {
+                              stream_file_handle } },
                     AVS_STREAM_V_TABLE_EXTENSION_NULL }
 };
 
 avs_stream_t *avs_stream_file_create(const char *path, uint8_t mode) {
+    if (mode == (AVS_STREAM_FILE_READ | AVS_STREAM_FILE_MMAP)) {
+#    ifdef AVS_COMMONS_STREAM_FILE_WITH_MMAP
+        avs_stream_t *stream = _avs_stream_file_mmap_create(path);
+        if (stream) {
+            return stream;
+        }
+#    endif // AVS_COMMONS_STREAM_FILE_WITH_MMAP
+        mode = AVS_STREAM_FILE_READ;
+    }
+
     avs_stream_file_t *file =
             (avs_stream_file_t *) avs_calloc(1, sizeof(avs_stream_file_t));
     const void *vtable = &file_stream_vtable;
@@ -134,6 +134,49 @@ static avs_error_t stream_membuf_write_some(avs_stream_t *stream_,
     return AVS_OK;
 }
 
+static avs_error_t
+stream_membuf_write_some_vector(avs_stream_t *stream_,
+                                const avs_stream_const_iovec_t *iov,
+                                size_t iovcnt,
+                                size_t *out_bytes_written) {
+    avs_stream_membuf_t *stream = (avs_stream_membuf_t *) stream_;
+    size_t data_length = 0;
+    for (size_t i = 0; i < iovcnt; ++i) {
+        if (iov[i].size > SIZE_MAX - data_length) {
+            return avs_errno(AVS_ENOMEM);
+        }
+        data_length += iov[i].size;
+    }
+    if (data_length == 0) {
+        return AVS_OK;
+    }
+    if (stream->buffer_size < stream->index_write + data_length) {
+        defragment_membuf(stream);
+    }
+    if (stream->buffer_size < stream->index_write + data_length) {
+        avs_error_t err =
+                realloc_membuf(stream, 2 * stream->buffer_size + data_length);
+        if (avs_is_err(err)) {
+            data_length = stream->buffer_size - stream->index_write;
+            if (data_length == 0) {
+                return err;
+            }
+        }
+        assert(stream->buffer);
+    }
+    for (size_t i = 0; i < iovcnt && *out_bytes_written < data_length; ++i) {
+        size_t chunk_size =
+                AVS_MIN(iov[i].size, data_length - *out_bytes_written);
+        if (chunk_size) {
+            memcpy(stream->buffer + stream->index_write, iov[i].data,
+                   chunk_size);
+            stream->index_write += chunk_size;
+            *out_bytes_written += chunk_size;
+        }
+    }
+    return AVS_OK;
+}
+
 static avs_error_t stream_membuf_read(avs_stream_t *stream_,
                                       size_t *out_bytes_read,
                                       bool *out_message_finished,
@@ -164,6 +207,32 @@ static avs_error_t stream_membuf_read(avs_stream_t *stream_,
     return AVS_OK;
 }
 
+static avs_error_t stream_membuf_read_vector(avs_stream_t *stream_,
+                                             size_t *out_bytes_read,
+                                             bool *out_message_finished,
+                                             const avs_stream_iovec_t *iov,
+                                             size_t iovcnt) {
+    avs_stream_membuf_t *stream = (avs_stream_membuf_t *) stream_;
+    assert(stream->index_read <= stream->index_write);
+    for (size_t i = 0; i < iovcnt && stream->index_read < stream->index_write;
+         ++i) {
+        size_t chunk_size = AVS_MIN(iov[i].size,
+                                    stream->index_write - stream->index_read);
+        if (chunk_size) {
+            memcpy(iov[i].data, stream->buffer + stream->index_read,
+                   chunk_size);
+            stream->index_read += chunk_size;
+            *out_bytes_read += chunk_size;
+        }
+    }
+    *out_message_finished = (stream->index_read == stream->index_write);
+    if (*out_message_finished) {
+        stream->index_read = 0;
+        stream->index_write = 0;
+    }
+    return AVS_OK;
+}
+
 static avs_error_t
 stream_membuf_peek(avs_stream_t *stream_, size_t offset, char *out_value) {
     avs_stream_membuf_t *stream = (avs_stream_membuf_t *) stream_;
@@ -174,6 +243,34 @@ stream_membuf_peek(avs_stream_t *stream_, size_t offset, char *out_value) {
     return AVS_OK;
 }
 
+static avs_error_t stream_membuf_peek_span(avs_stream_t *stream_,
+                                           size_t offset,
+                                           const char **out_data,
+                                           size_t *out_size) {
+    avs_stream_membuf_t *stream = (avs_stream_membuf_t *) stream_;
+    assert(stream->index_read <= stream->index_write);
+    if (offset >= stream->index_write - stream->index_read) {
+        return AVS_EOF;
+    }
+    *out_data = stream->buffer + stream->index_read + offset;
+    *out_size = stream->index_write - stream->index_read - offset;
+    return AVS_OK;
+}
+
+static avs_error_t stream_membuf_consume_bytes(avs_stream_t *stream_,
+                                               size_t size) {
+    avs_stream_membuf_t *stream = (avs_stream_membuf_t *) stream_;
+    if (size > stream->index_write - stream->index_read) {
+        return avs_errno(AVS_EINVAL);
+    }
+    stream->index_read += size;
+    if (stream->index_read == stream->index_write) {
+        stream->index_read = 0;
+        stream->index_write = 0;
+    }
+    return AVS_OK;
+}
+
 static avs_error_t stream_membuf_reset(avs_stream_t *stream_) {
     avs_stream_membuf_t *stream = (avs_stream_membuf_t *) stream_;
     stream->index_read = 0;
@@ -241,6 +338,39 @@ static avs_error_t stream_membuf_take_ownership(avs_stream_t *stream_,
     return AVS_OK;
 }
 
+static avs_error_t stream_membuf_reserve_span(avs_stream_t *stream_,
+                                              size_t min_size,
+                                              char **out_data,
+                                              size_t *out_size) {
+    avs_stream_membuf_t *stream = (avs_stream_membuf_t *) stream_;
+    if (stream->buffer_size - stream->index_write < min_size) {
+        defragment_membuf(stream);
+    }
+    if (stream->buffer_size - stream->index_write < min_size) {
+        if (stream->buffer_size > (SIZE_MAX - min_size) / 2) {
+            return avs_errno(AVS_ENOMEM);
+        }
+        avs_error_t err =
+                realloc_membuf(stream, 2 * stream->buffer_size + min_size);
+        if (avs_is_err(err)) {
+            return err;
+        }
+    }
+    *out_size = stream->buffer_size - stream->index_write;
+    *out_data = stream->buffer ? stream->buffer + stream->index_write : NULL;
+    return AVS_OK;
+}
+
+static avs_error_t stream_membuf_commit_bytes(avs_stream_t *stream_,
+                                              size_t size) {
+    avs_stream_membuf_t *stream = (avs_stream_membuf_t *) stream_;
+    if (size > stream->buffer_size - stream->index_write) {
+        return avs_errno(AVS_EINVAL);
+    }
+    stream->index_write += size;
+    return AVS_OK;
+}
+
 static const avs_stream_v_table_t membuf_stream_vtable = {
     .write_some = stream_membuf_write_some,
     .read = stream_membuf_read,
@@ -258,10 +388,509 @@ static const avs_stream_v_table_t membuf_stream_vtable = {
                               stream_membuf_ensure_free_bytes,
                               stream_membuf_fit,
                               stream_membuf_take_ownership } },
+                    { AVS_STREAM_V_TABLE_EXTENSION_VECTOR,
+                      &(const avs_stream_v_table_extension_vector_t) {
+                              stream_membuf_write_some_vector,
+                              stream_membuf_read_vector } },
+                    { AVS_STREAM_V_TABLE_EXTENSION_READ_BUFFER,
+                      &(const avs_stream_v_table_extension_read_buffer_t) {
+                              stream_membuf_peek_span,
+                              stream_membuf_consume_bytes } },
+                    { AVS_STREAM_V_TABLE_EXTENSION_WRITE_BUFFER,
+                      &(const avs_stream_v_table_extension_write_buffer_t) {
+                              stream_membuf_reserve_span,
+                              stream_membuf_commit_bytes } },
                     AVS_STREAM_V_TABLE_EXTENSION_NULL }
 };
 
-avs_stream_t *avs_stream_membuf_create(void) {
+/*
+ * Chunked storage: data is kept in a list of chunks that is only ever appended
+ * to, so writing never moves the data that is already stored. Each new chunk is
+ * at least as large as all the previous ones combined, so the number of chunks
+ * grows logarithmically with the amount of data.
+ */
+
+/* Size of the first chunk, if not specified at creation time */
+#    define MEMBUF_MIN_CHUNK_SIZE 256
+
+typedef struct membuf_chunk_struct {
+    struct membuf_chunk_struct *next;
+    size_t capacity;
+    size_t size;
+    char data[];
+} membuf_chunk_t;
+
+typedef struct {
+    const void *const vtable;
+    membuf_chunk_t *head;
+    /* chunk that is currently written to; all the chunks after it are empty */
+    membuf_chunk_t *write_chunk;
+    membuf_chunk_t *tail;
+    /* number of bytes already read from the head chunk */
+    size_t head_read;
+    /* number of unread bytes in all the chunks */
+    size_t data_size;
+    /* free space in write_chunk and all the chunks after it */
+    size_t space_left;
+    /* sum of capacities of all the chunks */
+    size_t capacity;
+} chunked_membuf_t;
+
+static membuf_chunk_t *alloc_chunk(size_t capacity) {
+    membuf_chunk_t *chunk = NULL;
+    if (capacity <= SIZE_MAX - sizeof(membuf_chunk_t)) {
+        chunk = (membuf_chunk_t *) avs_malloc(sizeof(membuf_chunk_t)
+                                              + capacity);
+    }
+    if (chunk) {
+        chunk->next = NULL;
+        chunk->capacity = capacity;
+        chunk->size = 0;
+    }
+    return chunk;
+}
+
+static void link_chunk(chunked_membuf_t *stream, membuf_chunk_t *chunk) {
+    if (stream->tail) {
+        stream->tail->next = chunk;
+    } else {
+        stream->head = chunk;
+        stream->write_chunk = chunk;
+    }
+    stream->tail = chunk;
+    stream->capacity += chunk->capacity;
+    stream->space_left += chunk->capacity - chunk->size;
+    stream->data_size += chunk->size;
+}
+
+static avs_error_t append_chunk(chunked_membuf_t *stream, size_t capacity) {
+    membuf_chunk_t *chunk = alloc_chunk(capacity);
+    if (!chunk) {
+        return avs_errno(AVS_ENOMEM);
+    }
+    link_chunk(stream, chunk);
+    return AVS_OK;
+}
+
+/*
+ * Makes sure that at least min_size bytes can be written without allocating
+ * memory. On failure, returns the amount of space available anyway.
+ */
+static size_t reserve_chunk_space(chunked_membuf_t *stream, size_t min_size) {
+    if (stream->space_left < min_size) {
+        size_t capacity =
+                AVS_MAX(min_size - stream->space_left,
+                        AVS_MAX(stream->capacity, MEMBUF_MIN_CHUNK_SIZE));
+        // if the geometric size cannot be allocated, try the minimum one
+        if (avs_is_err(append_chunk(stream, capacity))
+                && capacity > min_size - stream->space_left) {
+            append_chunk(stream, min_size - stream->space_left);
+        }
+    }
+    return AVS_MIN(min_size, stream->space_left);
+}
+
+static void append_chunk_data(chunked_membuf_t *stream,
+                              const void *data,
+                              size_t size) {
+    assert(size <= stream->space_left);
+    stream->space_left -= size;
+    stream->data_size += size;
+    while (size) {
+        membuf_chunk_t *chunk = stream->write_chunk;
+        if (chunk->size == chunk->capacity) {
+            chunk = stream->write_chunk = chunk->next;
+        }
+        size_t chunk_size = AVS_MIN(size, chunk->capacity - chunk->size);
+        memcpy(chunk->data + chunk->size, data, chunk_size);
+        chunk->size += chunk_size;
+        data = (const char *) data + chunk_size;
+        size -= chunk_size;
+    }
+}
+
+static avs_error_t chunked_membuf_write_some(avs_stream_t *stream_,
+                                             const void *buffer,
+                                             size_t *inout_data_length) {
+    chunked_membuf_t *stream = (chunked_membuf_t *) stream_;
+    if (*inout_data_length == 0) {
+        return AVS_OK;
+    }
+    size_t space = reserve_chunk_space(stream, *inout_data_length);
+    if (space == 0) {
+        return avs_errno(AVS_ENOMEM);
+    }
+    *inout_data_length = AVS_MIN(*inout_data_length, space);
+    append_chunk_data(stream, buffer, *inout_data_length);
+    return AVS_OK;
+}
+
+static avs_error_t
+chunked_membuf_write_some_vector(avs_stream_t *stream_,
+                                 const avs_stream_const_iovec_t *iov,
+                                 size_t iovcnt,
+                                 size_t *out_bytes_written) {
+    chunked_membuf_t *stream = (chunked_membuf_t *) stream_;
+    size_t data_length = 0;
+    for (size_t i = 0; i < iovcnt; ++i) {
+        if (iov[i].size > SIZE_MAX - data_length) {
+            return avs_errno(AVS_ENOMEM);
+        }
+        data_length += iov[i].size;
+    }
+    if (data_length == 0) {
+        return AVS_OK;
+    }
+    size_t space = reserve_chunk_space(stream, data_length);
+    if (space == 0) {
+        return avs_errno(AVS_ENOMEM);
+    }
+    for (size_t i = 0; i < iovcnt && *out_bytes_written < space; ++i) {
+        size_t chunk_size = AVS_MIN(iov[i].size, space - *out_bytes_written);
+        append_chunk_data(stream, iov[i].data, chunk_size);
+        *out_bytes_written += chunk_size;
+    }
+    return AVS_OK;
+}
+
+/*
+ * Finds the chunk that contains the unread byte at the given offset. Returns
+ * NULL if there is no such byte.
+ */
+static membuf_chunk_t *find_chunk(chunked_membuf_t *stream,
+                                  size_t offset,
+                                  size_t *out_offset_in_chunk) {
+    if (offset >= stream->data_size) {
+        return NULL;
+    }
+    offset += stream->head_read;
+    membuf_chunk_t *chunk = stream->head;
+    while (offset >= chunk->size) {
+        offset -= chunk->size;
+        chunk = chunk->next;
+    }
+    *out_offset_in_chunk = offset;
+    return chunk;
+}
+
+static void consume_chunk_data(chunked_membuf_t *stream, size_t size) {
+    assert(size <= stream->data_size);
+    stream->data_size -= size;
+    size += stream->head_read;
+    while (stream->head != stream->write_chunk && size >= stream->head->size) {
+        membuf_chunk_t *chunk = stream->head;
+        size -= chunk->size;
+        stream->head = chunk->next;
+        stream->capacity -= chunk->capacity;
+        avs_free(chunk);
+    }
+    stream->head_read = size;
+    if (stream->data_size == 0 && stream->head) {
+        // the chunk being written has been fully read - reuse it
+        stream->space_left += stream->head->size;
+        stream->head->size = 0;
+        stream->head_read = 0;
+    }
+}
+
+static avs_error_t chunked_membuf_read(avs_stream_t *stream_,
+                                       size_t *out_bytes_read,
+                                       bool *out_message_finished,
+                                       void *buffer,
+                                       size_t buffer_length) {
+    chunked_membuf_t *stream = (chunked_membuf_t *) stream_;
+    if (!buffer && buffer_length) {
+        return avs_errno(AVS_EINVAL);
+    }
+    size_t bytes_read = AVS_MIN(buffer_length, stream->data_size);
+    size_t copied = 0;
+    membuf_chunk_t *chunk = stream->head;
+    size_t offset = stream->head_read;
+    while (copied < bytes_read) {
+        size_t chunk_size = AVS_MIN(bytes_read - copied, chunk->size - offset);
+        memcpy((char *) buffer + copied, chunk->data + offset, chunk_size);
+        copied += chunk_size;
+        chunk = chunk->next;
+        offset = 0;
+    }
+    consume_chunk_data(stream, bytes_read);
+    if (out_bytes_read) {
+        *out_bytes_read = bytes_read;
+    }
+    if (out_message_finished) {
+        *out_message_finished = (stream->data_size == 0);
+    }
+    return AVS_OK;
+}
+
+static avs_error_t chunked_membuf_read_vector(avs_stream_t *stream,
+                                              size_t *out_bytes_read,
+                                              bool *out_message_finished,
+                                              const avs_stream_iovec_t *iov,
+                                              size_t iovcnt) {
+    for (size_t i = 0; i < iovcnt; ++i) {
+        size_t bytes_read;
+        chunked_membuf_read(stream, &bytes_read, out_message_finished,
+                            iov[i].data, iov[i].size);
+        *out_bytes_read += bytes_read;
+    }
+    *out_message_finished = (((chunked_membuf_t *) stream)->data_size == 0);
+    return AVS_OK;
+}
+
+static avs_error_t
+chunked_membuf_peek(avs_stream_t *stream_, size_t offset, char *out_value) {
+    size_t offset_in_chunk;
+    membuf_chunk_t *chunk = find_chunk((chunked_membuf_t *) stream_, offset,
+                                       &offset_in_chunk);
+    if (!chunk) {
+        return AVS_EOF;
+    }
+    *out_value = chunk->data[offset_in_chunk];
+    return AVS_OK;
+}
+
+static avs_error_t chunked_membuf_peek_span(avs_stream_t *stream_,
+                                            size_t offset,
+                                            const char **out_data,
+                                            size_t *out_size) {
+    size_t offset_in_chunk;
+    membuf_chunk_t *chunk = find_chunk((chunked_membuf_t *) stream_, offset,
+                                       &offset_in_chunk);
+    if (!chunk) {
+        return AVS_EOF;
+    }
+    *out_data = chunk->data + offset_in_chunk;
+    *out_size = chunk->size - offset_in_chunk;
+    return AVS_OK;
+}
+
+static avs_error_t chunked_membuf_consume_bytes(avs_stream_t *stream_,
+                                                size_t size) {
+    chunked_membuf_t *stream = (chunked_membuf_t *) stream_;
+    if (size > stream->data_size) {
+        return avs_errno(AVS_EINVAL);
+    }
+    consume_chunk_data(stream, size);
+    return AVS_OK;
+}
+
+static avs_error_t chunked_membuf_reset(avs_stream_t *stream) {
+    consume_chunk_data((chunked_membuf_t *) stream,
+                       ((chunked_membuf_t *) stream)->data_size);
+    return AVS_OK;
+}
+
+static void free_chunks(chunked_membuf_t *stream) {
+    while (stream->head) {
+        membuf_chunk_t *chunk = stream->head;
+        stream->head = chunk->next;
+        avs_free(chunk);
+    }
+    stream->write_chunk = NULL;
+    stream->tail = NULL;
+    stream->head_read = 0;
+    stream->data_size = 0;
+    stream->space_left = 0;
+    stream->capacity = 0;
+}
+
+static avs_error_t chunked_membuf_close(avs_stream_t *stream) {
+    free_chunks((chunked_membuf_t *) stream);
+    return AVS_OK;
+}
+
+static avs_error_t chunked_membuf_offset(avs_stream_t *stream,
+                                         avs_off_t *out_offset) {
+    size_t offset = ((chunked_membuf_t *) stream)->data_size;
+    if (offset > LONG_MAX) {
+        return avs_errno(AVS_E2BIG);
+    }
+    *out_offset = (avs_off_t) offset;
+    return AVS_OK;
+}
+
+static avs_error_t chunked_membuf_ensure_free_bytes(avs_stream_t *stream,
+                                                    size_t additional_size) {
+    if (reserve_chunk_space((chunked_membuf_t *) stream, additional_size)
+            < additional_size) {
+        return avs_errno(AVS_ENOMEM);
+    }
+    return AVS_OK;
+}
+
+/*
+ * Copies all the unread data into a single newly allocated buffer of exactly
+ * the right size. Returns NULL if there is no data.
+ */
+static avs_error_t linearize_chunks(chunked_membuf_t *stream, char **out_ptr) {
+    *out_ptr = NULL;
+    if (stream->data_size
+            && !(*out_ptr = (char *) avs_malloc(stream->data_size))) {
+        return avs_errno(AVS_ENOMEM);
+    }
+    size_t bytes_read;
+    chunked_membuf_read((avs_stream_t *) stream, &bytes_read, NULL, *out_ptr,
+                        stream->data_size);
+    return AVS_OK;
+}
+
+static avs_error_t chunked_membuf_fit(avs_stream_t *stream_) {
+    chunked_membuf_t *stream = (chunked_membuf_t *) stream_;
+    if (stream->head == stream->tail && stream->head_read == 0
+            && stream->space_left == 0) {
+        return AVS_OK;
+    }
+    membuf_chunk_t *chunk = NULL;
+    if (stream->data_size && !(chunk = alloc_chunk(stream->data_size))) {
+        return avs_errno(AVS_ENOMEM);
+    }
+    if (chunk) {
+        chunked_membuf_read(stream_, &chunk->size, NULL, chunk->data,
+                            chunk->capacity);
+    }
+    free_chunks(stream);
+    if (chunk) {
+        link_chunk(stream, chunk);
+    }
+    return AVS_OK;
+}
+
+static avs_error_t chunked_membuf_take_ownership(avs_stream_t *stream_,
+                                                 void **out_ptr,
+                                                 size_t *out_size) {
+    chunked_membuf_t *stream = (chunked_membuf_t *) stream_;
+    size_t data_size = stream->data_size;
+    char *data;
+    avs_error_t err = linearize_chunks(stream, &data);
+    if (avs_is_err(err)) {
+        return err;
+    }
+    free_chunks(stream);
+    *out_ptr = data;
+    if (out_size) {
+        *out_size = data_size;
+    }
+    return AVS_OK;
+}
+
+/*
+ * Gives up the free space left in write_chunk, so that it can be skipped.
+ */
+static void seal_write_chunk(chunked_membuf_t *stream) {
+    membuf_chunk_t *chunk = stream->write_chunk;
+    size_t free_space = chunk->capacity - chunk->size;
+    stream->space_left -= free_space;
+    stream->capacity -= free_space;
+    chunk->capacity = chunk->size;
+}
+
+static avs_error_t chunked_membuf_reserve_span(avs_stream_t *stream_,
+                                               size_t min_size,
+                                               char **out_data,
+                                               size_t *out_size) {
+    chunked_membuf_t *stream = (chunked_membuf_t *) stream_;
+    size_t wanted_size = AVS_MAX(min_size, 1);
+    membuf_chunk_t *chunk = stream->write_chunk;
+    while (chunk && chunk->next
+           && chunk->capacity - chunk->size < wanted_size) {
+        seal_write_chunk(stream);
+        chunk = stream->write_chunk = chunk->next;
+    }
+    if (min_size && (!chunk || chunk->capacity - chunk->size < min_size)) {
+        size_t capacity = AVS_MAX(min_size, AVS_MAX(stream->capacity,
+                                                    MEMBUF_MIN_CHUNK_SIZE));
+        // if the geometric size cannot be allocated, try the minimum one
+        avs_error_t err = append_chunk(stream, capacity);
+        if (avs_is_err(err) && capacity > min_size) {
+            err = append_chunk(stream, min_size);
+        }
+        if (avs_is_err(err)) {
+            return err;
+        }
+        if (chunk) {
+            seal_write_chunk(stream);
+        }
+        chunk = stream->write_chunk = stream->tail;
+    }
+    if (chunk) {
+        *out_data = chunk->data + chunk->size;
+        *out_size = chunk->capacity - chunk->size;
+    } else {
+        *out_data = NULL;
+        *out_size = 0;
+    }
+    return AVS_OK;
+}
+
+static avs_error_t chunked_membuf_commit_bytes(avs_stream_t *stream_,
+                                               size_t size) {
+    chunked_membuf_t *stream = (chunked_membuf_t *) stream_;
+    membuf_chunk_t *chunk = stream->write_chunk;
+    if (!size) {
+        return AVS_OK;
+    }
+    if (!chunk || size > chunk->capacity - chunk->size) {
+        return avs_errno(AVS_EINVAL);
+    }
+    chunk->size += size;
+    stream->space_left -= size;
+    stream->data_size += size;
+    return AVS_OK;
+}
+
+static const avs_stream_v_table_t chunked_membuf_stream_vtable = {
+    .write_some = chunked_membuf_write_some,
+    .read = chunked_membuf_read,
+    .peek = chunked_membuf_peek,
+    .reset = chunked_membuf_reset,
+    .finish_message = _avs_stream_empty_finish_message,
+    .close = chunked_membuf_close,
+    .extension_list =
+            (const avs_stream_v_table_extension_t[]) {
+                    { AVS_STREAM_V_TABLE_EXTENSION_OFFSET,
+                      &(const avs_stream_v_table_extension_offset_t) {
+                              chunked_membuf_offset } },
+                    { AVS_STREAM_V_TABLE_EXTENSION_MEMBUF,
+                      &(const avs_stream_v_table_extension_membuf_t) {
+                              chunked_membuf_ensure_free_bytes,
+                              chunked_membuf_fit,
+                              chunked_membuf_take_ownership } },
+                    { AVS_STREAM_V_TABLE_EXTENSION_VECTOR,
+                      &(const avs_stream_v_table_extension_vector_t) {
+                              chunked_membuf_write_some_vector,
+                              chunked_membuf_read_vector } },
+                    { AVS_STREAM_V_TABLE_EXTENSION_READ_BUFFER,
+                      &(const avs_stream_v_table_extension_read_buffer_t) {
+                              chunked_membuf_peek_span,
+                              chunked_membuf_consume_bytes } },
+                    { AVS_STREAM_V_TABLE_EXTENSION_WRITE_BUFFER,
+                      &(const avs_stream_v_table_extension_write_buffer_t) {
+                              chunked_membuf_reserve_span,
+                              chunked_membuf_commit_bytes } },
+                    AVS_STREAM_V_TABLE_EXTENSION_NULL }
+};
+
+static avs_stream_t *chunked_membuf_create(size_t reserve_size) {
+    chunked_membuf_t *membuf =
+            (chunked_membuf_t *) avs_calloc(1, sizeof(chunked_membuf_t));
+    const void *vtable = &chunked_membuf_stream_vtable;
+    if (!membuf) {
+        return NULL;
+    }
+    memcpy((void *) (intptr_t) &membuf->vtable, &vtable, sizeof(void *));
+    if (reserve_size && avs_is_err(append_chunk(membuf, reserve_size))) {
+        avs_free(membuf);
+        return NULL;
+    }
+    return (avs_stream_t *) membuf;
+}
+
+avs_stream_t *avs_stream_membuf_create_ex(avs_stream_membuf_storage_t storage,
+                                          size_t reserve_size) {
+    if (storage == AVS_STREAM_MEMBUF_CHUNKED) {
+        return chunked_membuf_create(reserve_size);
+    }
     avs_stream_membuf_t *membuf =
             (avs_stream_membuf_t *) avs_calloc(1, sizeof(avs_stream_membuf_t));
     const void *vtable = &membuf_stream_vtable;
@@ -269,9 +898,17 @@ avs_stream_t *avs_stream_membuf_create(void) {
         return NULL;
     }
     memcpy((void *) (intptr_t) &membuf->vtable, &vtable, sizeof(void *));
+    if (reserve_size && avs_is_err(realloc_membuf(membuf, reserve_size))) {
+        avs_free(membuf);
+        return NULL;
+    }
     return (avs_stream_t *) membuf;
 }
 
+avs_stream_t *avs_stream_membuf_create(void) {
+    return avs_stream_membuf_create_ex(AVS_STREAM_MEMBUF_CONTIGUOUS, 0);
+}
+
 #    ifdef AVS_UNIT_TESTING
 #        include "tests/stream/test_stream_membuf.c"
 #    endif
@@ -66,6 +66,34 @@ static avs_error_t outbuf_stream_offset(avs_stream_t *stream,
     return AVS_OK;
 }
 
+static avs_error_t outbuf_stream_reserve_span(avs_stream_t *stream_,
+                                              size_t min_size,
+                                              char **out_data,
+                                              size_t *out_size) {
+    avs_stream_outbuf_t *stream = (avs_stream_outbuf_t *) stream_;
+    if (stream->message_finished) {
+        return avs_errno(AVS_EBADF);
+    }
+    assert(stream->buffer_offset <= stream->buffer_size);
+    *out_size = stream->buffer_size - stream->buffer_offset;
+    if (*out_size < min_size) {
+        return avs_errno(AVS_ENOBUFS);
+    }
+    *out_data = *out_size ? (char *) stream->buffer + stream->buffer_offset
+                          : NULL;
+    return AVS_OK;
+}
+
+static avs_error_t outbuf_stream_commit_bytes(avs_stream_t *stream_,
+                                              size_t size) {
+    avs_stream_outbuf_t *stream = (avs_stream_outbuf_t *) stream_;
+    if (size > stream->buffer_size - stream->buffer_offset) {
+        return avs_errno(AVS_EINVAL);
+    }
+    stream->buffer_offset += size;
+    return AVS_OK;
+}
+
 static const avs_stream_v_table_t outbuf_stream_vtable = {
     .reset = outbuf_stream_reset,
     .write_some = outbuf_stream_write_some,
@@ -75,6 +103,10 @@ static const avs_stream_v_table_t outbuf_stream_vtable = {
                     { AVS_STREAM_V_TABLE_EXTENSION_OFFSET,
                       &(const avs_stream_v_table_extension_offset_t) {
                               outbuf_stream_offset } },
+                    { AVS_STREAM_V_TABLE_EXTENSION_WRITE_BUFFER,
+                      &(const avs_stream_v_table_extension_write_buffer_t) {
+                              outbuf_stream_reserve_span,
+                              outbuf_stream_commit_bytes } },
                     AVS_STREAM_V_TABLE_EXTENSION_NULL }
 };
 
@@ -0,0 +1,227 @@
+/*
+ * Copyright 2023 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <avsystem/commons/avs_commons_config.h>
+
+#if defined(AVS_COMMONS_WITH_AVS_STREAM)          \
+        && defined(AVS_COMMONS_STREAM_WITH_FILE) \
+        && defined(AVS_COMMONS_STREAM_FILE_WITH_MMAP)
+
+#    include <avs_commons_posix_init.h>
+
+#    include <stdint.h>
+#    include <string.h>
+
+#    include <sys/mman.h>
+#    include <sys/stat.h>
+
+#    include <avsystem/commons/avs_errno.h>
+#    include <avsystem/commons/avs_memory.h>
+#    include <avsystem/commons/avs_stream_file.h>
+#    include <avsystem/commons/avs_stream_v_table.h>
+
+#    include "../../avs_stream_common.h"
+
+VISIBILITY_SOURCE_BEGIN
+
+typedef struct {
+    const avs_stream_v_table_t *const vtable;
+    /* NULL if the file is empty, as zero-length mappings are not allowed */
+    const char *data;
+    size_t size;
+    size_t offset;
+} file_mmap_stream_t;
+
+static size_t bytes_left(const file_mmap_stream_t *stream) {
+    return stream->offset < stream->size ? stream->size - stream->offset : 0;
+}
+
+static avs_error_t file_mmap_write_some(avs_stream_t *stream,
+                                        const void *buffer,
+                                        size_t *inout_data_length) {
+    (void) stream;
+    (void) buffer;
+    (void) inout_data_length;
+    return avs_errno(AVS_EBADF);
+}
+
+static avs_error_t file_mmap_read(avs_stream_t *stream_,
+                                  size_t *out_bytes_read,
+                                  bool *out_message_finished,
+                                  void *buffer,
+                                  size_t buffer_length) {
+    file_mmap_stream_t *stream = (file_mmap_stream_t *) stream_;
+    size_t bytes_read = AVS_MIN(buffer_length, bytes_left(stream));
+    if (bytes_read) {
+        memcpy(buffer, stream->data + stream->offset, bytes_read);
+        stream->offset += bytes_read;
+    }
+    if (out_bytes_read) {
+        *out_bytes_read = bytes_read;
+    }
+    if (out_message_finished) {
+        *out_message_finished = (bytes_left(stream) == 0);
+    }
+    return AVS_OK;
+}
+
+static avs_error_t
+file_mmap_peek(avs_stream_t *stream_, size_t offset, char *out_value) {
+    file_mmap_stream_t *stream = (file_mmap_stream_t *) stream_;
+    if (offset >= bytes_left(stream)) {
+        return AVS_EOF;
+    }
+    *out_value = stream->data[stream->offset + offset];
+    return AVS_OK;
+}
+
+static avs_error_t file_mmap_peek_span(avs_stream_t *stream_,
+                                       size_t offset,
+                                       const char **out_data,
+                                       size_t *out_size) {
+    file_mmap_stream_t *stream = (file_mmap_stream_t *) stream_;
+    if (offset >= bytes_left(stream)) {
+        return AVS_EOF;
+    }
+    *out_data = stream->data + stream->offset + offset;
+    *out_size = bytes_left(stream) - offset;
+    return AVS_OK;
+}
+
+static avs_error_t file_mmap_consume_bytes(avs_stream_t *stream_,
+                                           size_t size) {
+    file_mmap_stream_t *stream = (file_mmap_stream_t *) stream_;
+    if (size > bytes_left(stream)) {
+        return avs_errno(AVS_EINVAL);
+    }
+    stream->offset += size;
+    return AVS_OK;
+}
+
+static avs_error_t file_mmap_skip(avs_stream_t *stream_,
+                                  size_t *out_bytes_skipped,
+                                  bool *out_message_finished,
+                                  size_t size) {
+    file_mmap_stream_t *stream = (file_mmap_stream_t *) stream_;
+    *out_bytes_skipped = AVS_MIN(size, bytes_left(stream));
+    stream->offset += *out_bytes_skipped;
+    *out_message_finished = (bytes_left(stream) == 0);
+    return AVS_OK;
+}
+
+static avs_error_t file_mmap_reset(avs_stream_t *stream) {
+    ((file_mmap_stream_t *) stream)->offset = 0;
+    return AVS_OK;
+}
+
+static avs_error_t file_mmap_close(avs_stream_t *stream_) {
+    file_mmap_stream_t *stream = (file_mmap_stream_t *) stream_;
+    if (stream->data
+            && munmap((void *) (intptr_t) stream->data, stream->size)) {
+        return avs_errno(AVS_EIO);
+    }
+    return AVS_OK;
+}
+
+static avs_error_t file_mmap_offset(avs_stream_t *stream,
+                                    avs_off_t *out_offset) {
+    *out_offset = (avs_off_t) ((file_mmap_stream_t *) stream)->offset;
+    return AVS_OK;
+}
+
+static avs_error_t file_mmap_seek(avs_stream_t *stream,
+                                  avs_off_t offset_from_start) {
+    if (offset_from_start < 0) {
+        return avs_errno(AVS_ERANGE);
+    }
+    ((file_mmap_stream_t *) stream)->offset = (size_t) offset_from_start;
+    return AVS_OK;
+}
+
+static avs_error_t file_mmap_length(avs_stream_t *stream,
+                                    avs_off_t *out_length) {
+    *out_length = (avs_off_t) ((file_mmap_stream_t *) stream)->size;
+    return AVS_OK;
+}
+
+static const avs_stream_v_table_t file_mmap_stream_vtable = {
+    .write_some = file_mmap_write_some,
+    .read = file_mmap_read,
+    .peek = file_mmap_peek,
+    .reset = file_mmap_reset,
+    .close = file_mmap_close,
+    .finish_message = _avs_stream_empty_finish_message,
+    .extension_list =
+            (const avs_stream_v_table_extension_t[]) {
+                    { AVS_STREAM_V_TABLE_EXTENSION_OFFSET,
+                      &(const avs_stream_v_table_extension_offset_t) {
+                              file_mmap_offset } },
+                    { AVS_STREAM_V_TABLE_EXTENSION_FILE,
+                      &(const avs_stream_v_table_extension_file_t) {
+                              file_mmap_length, file_mmap_seek } },
+                    { AVS_STREAM_V_TABLE_EXTENSION_READ_BUFFER,
+                      &(const avs_stream_v_table_extension_read_buffer_t) {
+                              file_mmap_peek_span, file_mmap_consume_bytes } },
+                    { AVS_STREAM_V_TABLE_EXTENSION_SKIP,
+                      &(const avs_stream_v_table_extension_skip_t) {
+                              file_mmap_skip } },
+                    AVS_STREAM_V_TABLE_EXTENSION_NULL }
+};
+
+static int map_file(const char *path, const char **out_data, size_t *out_size) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return -1;
+    }
+    int result = -1;
+    struct stat st;
+    if (!fstat(fd, &st) && S_ISREG(st.st_mode) && st.st_size >= 0
+            && (uintmax_t) st.st_size <= SIZE_MAX) {
+        *out_size = (size_t) st.st_size;
+        *out_data = NULL;
+        result = 0;
+        if (*out_size) {
+            void *data = mmap(NULL, *out_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (data == MAP_FAILED) {
+                result = -1;
+            } else {
+                *out_data = (const char *) data;
+            }
+        }
+    }
+    // the mapping stays valid after closing the descriptor
+    close(fd);
+    return result;
+}
+
+avs_stream_t *_avs_stream_file_mmap_create(const char *path) {
+    file_mmap_stream_t *stream =
+            (file_mmap_stream_t *) avs_calloc(1, sizeof(file_mmap_stream_t));
+    if (!stream) {
+        return NULL;
+    }
+    const void *vtable = &file_mmap_stream_vtable;
+    memcpy((void *) (intptr_t) &stream->vtable, &vtable, sizeof(void *));
+    if (map_file(path, &stream->data, &stream->size)) {
+        avs_free(stream);
+        return NULL;
+    }
+    return (avs_stream_t *) stream;
+}
+
+#endif // defined(AVS_COMMONS_WITH_AVS_STREAM) &&
+       // defined(AVS_COMMONS_STREAM_WITH_FILE) &&
+       // defined(AVS_COMMONS_STREAM_FILE_WITH_MMAP)
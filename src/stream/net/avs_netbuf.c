@@ -20,40 +20,51 @@
         && defined(AVS_COMMONS_WITH_AVS_BUFFER) \
         && defined(AVS_COMMONS_WITH_AVS_NET)
 
+#    include <stdint.h>
 #    include <stdio.h>
 #    include <string.h>
 
-#    include <avsystem/commons/avs_buffer.h>
 #    include <avsystem/commons/avs_errno.h>
 #    include <avsystem/commons/avs_memory.h>
 #    include <avsystem/commons/avs_net.h>
+#    include <avsystem/commons/avs_stream_file.h>
 #    include <avsystem/commons/avs_stream_netbuf.h>
 #    include <avsystem/commons/avs_stream_v_table.h>
 
 #    include <avsystem/commons/avs_stream_net.h>
 
+#    include "../avs_stream_buffer.h"
+
 #    define MODULE_NAME avs_stream
 #    include <avs_x_log_config.h>
 
 VISIBILITY_SOURCE_BEGIN
 
+/*
+ * Size of the stack buffer used for discarding data if the stream has been
+ * created without an input buffer
+ */
+#    define SKIP_SCRATCH_SIZE 256
+
 typedef struct buffered_netstream_struct {
     const avs_stream_v_table_t *const vtable;
     avs_net_socket_t *socket;
 
-    avs_buffer_t *out_buffer;
-    avs_buffer_t *in_buffer;
+    _avs_stream_buffer_t *out_buffer;
+    _avs_stream_buffer_t *in_buffer;
 } buffered_netstream_t;
 
 static avs_error_t out_buffer_flush(buffered_netstream_t *stream) {
     avs_error_t err = AVS_OK;
-    if (avs_buffer_data_size(stream->out_buffer)) {
-        err = avs_net_socket_send(stream->socket,
-                                  avs_buffer_data(stream->out_buffer),
-                                  avs_buffer_data_size(stream->out_buffer));
+    avs_ring_buffer_segment_t segments[2];
+    size_t segment_count =
+            _avs_stream_buffer_data_segments(stream->out_buffer, segments);
+    for (size_t i = 0; avs_is_ok(err) && i < segment_count; ++i) {
+        err = avs_net_socket_send(stream->socket, segments[i].ptr,
+                                  segments[i].size);
     }
     if (avs_is_ok(err)) {
-        avs_buffer_reset(stream->out_buffer);
+        _avs_stream_buffer_reset(stream->out_buffer);
     }
     return err;
 }
@@ -63,10 +74,10 @@ static avs_error_t buffered_netstream_write_some(avs_stream_t *stream_,
                                                  size_t *inout_data_length) {
     buffered_netstream_t *stream = (buffered_netstream_t *) stream_;
     avs_error_t err;
-    size_t space_left = avs_buffer_space_left(stream->out_buffer);
+    size_t space_left = _avs_stream_buffer_space_left(stream->out_buffer);
     if (*inout_data_length <= space_left) {
-        if (avs_buffer_append_bytes(stream->out_buffer, data,
-                                    *inout_data_length)) {
+        if (_avs_stream_buffer_append_bytes(stream->out_buffer, data,
+                                            *inout_data_length)) {
             return avs_errno(AVS_ENOBUFS);
         }
         if (*inout_data_length == space_left) {
@@ -80,25 +91,91 @@ static avs_error_t buffered_netstream_write_some(avs_stream_t *stream_,
     }
 }
 
+static avs_error_t socket_send_vector(avs_net_socket_t *socket,
+                                      const avs_net_socket_iovec_t *iov,
+                                      size_t iovcnt) {
+    avs_error_t err = avs_net_socket_send_vector(socket, iov, iovcnt);
+    if (err.category == AVS_ERRNO_CATEGORY && err.code == AVS_ENOTSUP) {
+        err = AVS_OK;
+        for (size_t i = 0; avs_is_ok(err) && i < iovcnt; ++i) {
+            if (iov[i].size) {
+                err = avs_net_socket_send(socket, iov[i].data, iov[i].size);
+            }
+        }
+    }
+    return err;
+}
+
+static avs_error_t
+buffered_netstream_write_some_vector(avs_stream_t *stream_,
+                                     const avs_stream_const_iovec_t *iov,
+                                     size_t iovcnt,
+                                     size_t *out_bytes_written) {
+    buffered_netstream_t *stream = (buffered_netstream_t *) stream_;
+    size_t data_length = 0;
+    for (size_t i = 0; i < iovcnt; ++i) {
+        data_length += iov[i].size;
+    }
+    size_t space_left = _avs_stream_buffer_space_left(stream->out_buffer);
+    if (data_length <= space_left) {
+        _avs_stream_buffer_append_vector(stream->out_buffer, iov, iovcnt);
+        *out_bytes_written = data_length;
+        if (data_length == space_left) {
+            return out_buffer_flush(stream);
+        }
+        return AVS_OK;
+    }
+
+    // Send the buffered data along with the new data, without copying the
+    // latter, in batches of up to AVS_ARRAY_SIZE(vector) buffers; the limit
+    // also applies to the first batch, which includes the buffered data
+    avs_net_socket_iovec_t vector[AVS_NET_SOCKET_SEND_VECTOR_MAX_IOVCNT];
+    avs_ring_buffer_segment_t segments[2];
+    size_t count =
+            _avs_stream_buffer_data_segments(stream->out_buffer, segments);
+    for (size_t i = 0; i < count; ++i) {
+        vector[i].data = segments[i].ptr;
+        vector[i].size = segments[i].size;
+    }
+    size_t index = 0;
+    do {
+        for (; index < iovcnt && count < AVS_ARRAY_SIZE(vector); ++index) {
+            vector[count].data = iov[index].data;
+            vector[count].size = iov[index].size;
+            ++count;
+        }
+        avs_error_t err = socket_send_vector(stream->socket, vector, count);
+        if (avs_is_err(err)) {
+            return err;
+        }
+        _avs_stream_buffer_reset(stream->out_buffer);
+        count = 0;
+    } while (index < iovcnt);
+
+    *out_bytes_written = data_length;
+    return AVS_OK;
+}
+
 static size_t buffered_netstream_nonblock_write_ready(avs_stream_t *stream) {
-    return avs_buffer_space_left(((buffered_netstream_t *) stream)->out_buffer);
+    return _avs_stream_buffer_space_left(
+            ((buffered_netstream_t *) stream)->out_buffer);
 }
 
 static avs_error_t buffered_netstream_finish_message(avs_stream_t *stream) {
     return out_buffer_flush((buffered_netstream_t *) stream);
 }
 
-static void return_data_from_buffer(avs_buffer_t *in_buffer,
+static void return_data_from_buffer(_avs_stream_buffer_t *in_buffer,
                                     size_t *out_bytes_read,
                                     void *buffer,
                                     size_t buffer_length) {
-    *out_bytes_read = avs_buffer_data_size(in_buffer);
+    *out_bytes_read = _avs_stream_buffer_data_size(in_buffer);
     if (buffer_length < *out_bytes_read) {
         *out_bytes_read = buffer_length;
     }
 
-    memcpy(buffer, avs_buffer_data(in_buffer), *out_bytes_read);
-    if (avs_buffer_consume_bytes(in_buffer, *out_bytes_read)) {
+    if (_avs_stream_buffer_copy_data(in_buffer, 0, buffer, *out_bytes_read)
+            || _avs_stream_buffer_consume_bytes(in_buffer, *out_bytes_read)) {
         AVS_UNREACHABLE();
     }
 }
@@ -116,20 +193,18 @@ static avs_error_t read_data_to_user_buffer(buffered_netstream_t *stream,
 
 static avs_error_t in_buffer_read_some(buffered_netstream_t *stream,
                                        size_t *out_bytes_read) {
-    avs_buffer_t *in_buffer = stream->in_buffer;
-    size_t space_left = avs_buffer_space_left(in_buffer);
+    _avs_stream_buffer_t *in_buffer = stream->in_buffer;
+    avs_ring_buffer_segment_t segments[2];
 
-    if (!space_left) {
+    if (!_avs_stream_buffer_space_segments(in_buffer, segments)) {
         LOG(ERROR, _("cannot read more data - buffer is full"));
         return avs_errno(AVS_ENOBUFS);
     }
 
-    avs_error_t err =
-            avs_net_socket_receive(stream->socket, out_bytes_read,
-                                   avs_buffer_raw_insert_ptr(in_buffer),
-                                   space_left);
+    avs_error_t err = avs_net_socket_receive(stream->socket, out_bytes_read,
+                                             segments[0].ptr, segments[0].size);
     if (avs_is_ok(err)) {
-        avs_buffer_advance_ptr(in_buffer, *out_bytes_read);
+        _avs_stream_buffer_advance_ptr(in_buffer, *out_bytes_read);
     }
     return err;
 }
@@ -145,7 +220,7 @@ read_data_through_internal_buffer(buffered_netstream_t *stream,
         *out_message_finished = false;
         return err;
     }
-    if (avs_buffer_data_size(stream->in_buffer) > 0) {
+    if (_avs_stream_buffer_data_size(stream->in_buffer) > 0) {
         return_data_from_buffer(stream->in_buffer, out_bytes_read, buffer,
                                 buffer_length);
         *out_message_finished = false;
@@ -161,7 +236,7 @@ static avs_error_t read_new_data(buffered_netstream_t *stream,
                                  bool *out_message_finished,
                                  void *buffer,
                                  size_t buffer_length) {
-    if (buffer_length >= avs_buffer_capacity(stream->in_buffer)) {
+    if (buffer_length >= _avs_stream_buffer_capacity(stream->in_buffer)) {
         return read_data_to_user_buffer(stream, out_bytes_read,
                                         out_message_finished, buffer,
                                         buffer_length);
@@ -187,7 +262,7 @@ static avs_error_t buffered_netstream_read(avs_stream_t *stream_,
         out_message_finished = &message_finished;
     }
 
-    if (avs_buffer_data_size(stream->in_buffer) <= 0) {
+    if (_avs_stream_buffer_data_size(stream->in_buffer) <= 0) {
         return read_new_data(stream, out_bytes_read, out_message_finished,
                              buffer, buffer_length);
     }
@@ -198,6 +273,72 @@ static avs_error_t buffered_netstream_read(avs_stream_t *stream_,
     return AVS_OK;
 }
 
+static avs_error_t
+buffered_netstream_read_vector(avs_stream_t *stream_,
+                               size_t *out_bytes_read,
+                               bool *out_message_finished,
+                               const avs_stream_iovec_t *iov,
+                               size_t iovcnt) {
+    buffered_netstream_t *stream = (buffered_netstream_t *) stream_;
+    if (_avs_stream_buffer_data_size(stream->in_buffer) == 0) {
+        size_t i = 0;
+        while (i < iovcnt && !iov[i].size) {
+            ++i;
+        }
+        size_t capacity = _avs_stream_buffer_capacity(stream->in_buffer);
+        if (i == iovcnt || iov[i].size >= capacity) {
+            // the socket cannot receive into multiple buffers, so just fill
+            // the first one, possibly bypassing the internal buffer
+            return buffered_netstream_read(stream_, out_bytes_read,
+                                           out_message_finished,
+                                           i < iovcnt ? iov[i].data : NULL,
+                                           i < iovcnt ? iov[i].size : 0);
+        }
+        avs_error_t err = in_buffer_read_some(stream, out_bytes_read);
+        if (avs_is_err(err)) {
+            *out_bytes_read = 0;
+            return err;
+        }
+    }
+    *out_bytes_read =
+            _avs_stream_buffer_read_vector(stream->in_buffer, iov, iovcnt);
+    *out_message_finished =
+            (*out_bytes_read == 0
+             && _avs_stream_buffer_data_size(stream->in_buffer) == 0);
+    return AVS_OK;
+}
+
+static avs_error_t buffered_netstream_skip(avs_stream_t *stream_,
+                                           size_t *out_bytes_skipped,
+                                           bool *out_message_finished,
+                                           size_t size) {
+    buffered_netstream_t *stream = (buffered_netstream_t *) stream_;
+    if (_avs_stream_buffer_data_size(stream->in_buffer) == 0) {
+        if (_avs_stream_buffer_capacity(stream->in_buffer) == 0) {
+            char scratch[SKIP_SCRATCH_SIZE];
+            return read_data_to_user_buffer(stream, out_bytes_skipped,
+                                            out_message_finished, scratch,
+                                            AVS_MIN(size, sizeof(scratch)));
+        }
+        // make the whole buffer available for a single receive
+        _avs_stream_buffer_reset(stream->in_buffer);
+        avs_error_t err = in_buffer_read_some(stream, out_bytes_skipped);
+        if (avs_is_err(err)) {
+            *out_bytes_skipped = 0;
+            return err;
+        }
+        if (*out_bytes_skipped == 0) {
+            *out_message_finished = true;
+            return AVS_OK;
+        }
+    }
+    *out_bytes_skipped =
+            AVS_MIN(size, _avs_stream_buffer_data_size(stream->in_buffer));
+    _avs_stream_buffer_consume_bytes(stream->in_buffer, *out_bytes_skipped);
+    *out_message_finished = false;
+    return AVS_OK;
+}
+
 static avs_error_t try_recv_nonblock(buffered_netstream_t *stream) {
     avs_net_socket_opt_value_t old_recv_timeout;
     const avs_net_socket_opt_value_t zero_timeout = {
@@ -238,7 +379,7 @@ static avs_error_t try_recv_nonblock(buffered_netstream_t *stream) {
 
 static bool buffered_netstream_nonblock_read_ready(avs_stream_t *stream_) {
     buffered_netstream_t *stream = (buffered_netstream_t *) stream_;
-    if (avs_buffer_data_size(stream->in_buffer) > 0) {
+    if (_avs_stream_buffer_data_size(stream->in_buffer) > 0) {
         return true;
     }
 
@@ -260,14 +401,14 @@ static bool buffered_netstream_nonblock_read_ready(avs_stream_t *stream_) {
     // the socket with timeout set to 0 before telling the caller nonblock read
     // is not possible.
     return avs_is_ok(try_recv_nonblock(stream))
-           && avs_buffer_data_size(stream->in_buffer) > 0;
+           && _avs_stream_buffer_data_size(stream->in_buffer) > 0;
 }
 
 static avs_error_t
 buffered_netstream_peek(avs_stream_t *stream_, size_t offset, char *out_value) {
     buffered_netstream_t *stream = (buffered_netstream_t *) stream_;
-    if (offset < avs_buffer_capacity(stream->in_buffer)) {
-        while (offset >= avs_buffer_data_size(stream->in_buffer)) {
+    if (offset < _avs_stream_buffer_capacity(stream->in_buffer)) {
+        while (offset >= _avs_stream_buffer_data_size(stream->in_buffer)) {
             size_t bytes_read;
             avs_error_t err = in_buffer_read_some(stream, &bytes_read);
             if (avs_is_err(err)) {
@@ -278,7 +419,7 @@ buffered_netstream_peek(avs_stream_t *stream_, size_t offset, char *out_value) {
                 return AVS_EOF;
             }
         }
-        *out_value = avs_buffer_data(stream->in_buffer)[offset];
+        _avs_stream_buffer_copy_data(stream->in_buffer, offset, out_value, 1);
         return AVS_OK;
     } else {
         LOG(ERROR, _("cannot peek - buffer is too small"));
@@ -286,10 +427,104 @@ buffered_netstream_peek(avs_stream_t *stream_, size_t offset, char *out_value) {
     }
 }
 
+static avs_error_t buffered_netstream_peek_span(avs_stream_t *stream_,
+                                                size_t offset,
+                                                const char **out_data,
+                                                size_t *out_size) {
+    buffered_netstream_t *stream = (buffered_netstream_t *) stream_;
+    if (offset >= _avs_stream_buffer_capacity(stream->in_buffer)) {
+        return avs_errno(AVS_ENOBUFS);
+    }
+    while (offset >= _avs_stream_buffer_data_size(stream->in_buffer)) {
+        size_t bytes_read;
+        avs_error_t err = in_buffer_read_some(stream, &bytes_read);
+        if (avs_is_err(err)) {
+            return err;
+        } else if (bytes_read == 0) {
+            return AVS_EOF;
+        }
+    }
+    _avs_stream_buffer_span(stream->in_buffer, offset, out_data, out_size);
+    return AVS_OK;
+}
+
+static avs_error_t buffered_netstream_consume_bytes(avs_stream_t *stream_,
+                                                    size_t size) {
+    buffered_netstream_t *stream = (buffered_netstream_t *) stream_;
+    if (size > _avs_stream_buffer_data_size(stream->in_buffer)) {
+        return avs_errno(AVS_EINVAL);
+    }
+    _avs_stream_buffer_consume_bytes(stream->in_buffer, size);
+    return AVS_OK;
+}
+
+static avs_error_t buffered_netstream_reserve_span(avs_stream_t *stream_,
+                                                   size_t min_size,
+                                                   char **out_data,
+                                                   size_t *out_size) {
+    buffered_netstream_t *stream = (buffered_netstream_t *) stream_;
+    if (min_size > _avs_stream_buffer_capacity(stream->out_buffer)) {
+        return avs_errno(AVS_ENOBUFS);
+    }
+    avs_ring_buffer_segment_t segments[2];
+    _avs_stream_buffer_space_segments(stream->out_buffer, segments);
+    if (segments[0].size < min_size) {
+        // flushing empties the buffer, so all of it becomes available
+        avs_error_t err = out_buffer_flush(stream);
+        if (avs_is_err(err)) {
+            return err;
+        }
+        _avs_stream_buffer_space_segments(stream->out_buffer, segments);
+    }
+    *out_data = segments[0].ptr;
+    *out_size = segments[0].size;
+    return AVS_OK;
+}
+
+static avs_error_t buffered_netstream_commit_bytes(avs_stream_t *stream_,
+                                                   size_t size) {
+    buffered_netstream_t *stream = (buffered_netstream_t *) stream_;
+    if (_avs_stream_buffer_advance_ptr(stream->out_buffer, size)) {
+        return avs_errno(AVS_EINVAL);
+    }
+    if (_avs_stream_buffer_space_left(stream->out_buffer) == 0) {
+        return out_buffer_flush(stream);
+    }
+    return AVS_OK;
+}
+
+#    ifdef AVS_COMMONS_STREAM_WITH_FILE
+static avs_error_t
+buffered_netstream_transfer_from(avs_stream_t *stream_,
+                                 avs_stream_t *input_stream,
+                                 size_t *out_bytes_transferred,
+                                 bool *out_message_finished) {
+    buffered_netstream_t *stream = (buffered_netstream_t *) stream_;
+    FILE *file;
+    avs_off_t offset;
+    avs_error_t err = avs_stream_file_handle(input_stream, &file, &offset);
+    if (avs_is_err(err) || avs_is_err((err = out_buffer_flush(stream)))) {
+        return err;
+    }
+    // the whole rest of the file is sent in a single call
+    err = avs_net_socket_send_file(stream->socket, file, offset, SIZE_MAX,
+                                   out_bytes_transferred);
+    if (*out_bytes_transferred) {
+        avs_error_t seek_err = avs_stream_file_seek(
+                input_stream, offset + (avs_off_t) *out_bytes_transferred);
+        if (avs_is_ok(err)) {
+            err = seek_err;
+        }
+    }
+    *out_message_finished = avs_is_ok(err);
+    return err;
+}
+#    endif // AVS_COMMONS_STREAM_WITH_FILE
+
 static avs_error_t buffered_netstream_reset(avs_stream_t *stream_) {
     buffered_netstream_t *stream = (buffered_netstream_t *) stream_;
-    avs_buffer_reset(stream->in_buffer);
-    avs_buffer_reset(stream->out_buffer);
+    _avs_stream_buffer_reset(stream->in_buffer);
+    _avs_stream_buffer_reset(stream->out_buffer);
     return AVS_OK;
 }
 
@@ -300,8 +535,8 @@ static avs_error_t buffered_netstream_close(avs_stream_t *stream_) {
         err = avs_net_socket_shutdown(stream->socket);
     }
     avs_net_socket_cleanup(&stream->socket);
-    avs_free(stream->in_buffer);
-    avs_buffer_free(&stream->out_buffer);
+    _avs_stream_buffer_free(&stream->in_buffer);
+    _avs_stream_buffer_free(&stream->out_buffer);
     return err;
 }
 
@@ -334,6 +569,26 @@ static const avs_stream_v_table_t buffered_netstream_vtable = {
                       &(const avs_stream_v_table_extension_nonblock_t) {
                               buffered_netstream_nonblock_read_ready,
                               buffered_netstream_nonblock_write_ready } },
+                    { AVS_STREAM_V_TABLE_EXTENSION_VECTOR,
+                      &(const avs_stream_v_table_extension_vector_t) {
+                              buffered_netstream_write_some_vector,
+                              buffered_netstream_read_vector } },
+                    { AVS_STREAM_V_TABLE_EXTENSION_READ_BUFFER,
+                      &(const avs_stream_v_table_extension_read_buffer_t) {
+                              buffered_netstream_peek_span,
+                              buffered_netstream_consume_bytes } },
+                    { AVS_STREAM_V_TABLE_EXTENSION_WRITE_BUFFER,
+                      &(const avs_stream_v_table_extension_write_buffer_t) {
+                              buffered_netstream_reserve_span,
+                              buffered_netstream_commit_bytes } },
+                    { AVS_STREAM_V_TABLE_EXTENSION_SKIP,
+                      &(const avs_stream_v_table_extension_skip_t) {
+                              buffered_netstream_skip } },
+#    ifdef AVS_COMMONS_STREAM_WITH_FILE
+                    { AVS_STREAM_V_TABLE_EXTENSION_TRANSFER,
+                      &(const avs_stream_v_table_extension_transfer_t) {
+                              buffered_netstream_transfer_from } },
+#    endif // AVS_COMMONS_STREAM_WITH_FILE
                     AVS_STREAM_V_TABLE_EXTENSION_NULL }
 };
 
@@ -355,24 +610,35 @@ int avs_stream_netbuf_create(avs_stream_t **stream_,
             &buffered_netstream_vtable;
 
     stream->socket = socket;
-    if (avs_buffer_create(&stream->in_buffer, in_buffer_size)) {
+    if (_avs_stream_buffer_create(&stream->in_buffer, in_buffer_size)) {
         LOG(ERROR, _("cannot create input buffer"));
         goto buffered_netstream_create_error;
     }
-    if (avs_buffer_create(&stream->out_buffer, out_buffer_size)) {
+    if (_avs_stream_buffer_create(&stream->out_buffer, out_buffer_size)) {
         LOG(ERROR, _("cannot create output buffer"));
         goto buffered_netstream_create_error;
     }
     return 0;
 
 buffered_netstream_create_error:
-    avs_buffer_free(&stream->in_buffer);
-    avs_buffer_free(&stream->out_buffer);
+    _avs_stream_buffer_free(&stream->in_buffer);
+    _avs_stream_buffer_free(&stream->out_buffer);
     avs_free(*stream_);
     *stream_ = NULL;
     return -1;
 }
 
+static void transfer_buffer(_avs_stream_buffer_t *destination,
+                            _avs_stream_buffer_t *source) {
+    avs_ring_buffer_segment_t segments[2];
+    size_t segment_count = _avs_stream_buffer_data_segments(source, segments);
+    for (size_t i = 0; i < segment_count; ++i) {
+        _avs_stream_buffer_append_bytes(destination, segments[i].ptr,
+                                        segments[i].size);
+    }
+    _avs_stream_buffer_reset(source);
+}
+
 int avs_stream_netbuf_transfer(avs_stream_t *destination_,
                                avs_stream_t *source_) {
     buffered_netstream_t *destination = (buffered_netstream_t *) destination_;
@@ -384,24 +650,16 @@ int avs_stream_netbuf_transfer(avs_stream_t *destination_,
         return -1;
     }
 
-    if (avs_buffer_space_left(destination->out_buffer)
-                    < avs_buffer_data_size(source->out_buffer)
-            || avs_buffer_space_left(destination->in_buffer)
-                           < avs_buffer_data_size(source->in_buffer)) {
+    if (_avs_stream_buffer_space_left(destination->out_buffer)
+                    < _avs_stream_buffer_data_size(source->out_buffer)
+            || _avs_stream_buffer_space_left(destination->in_buffer)
+                           < _avs_stream_buffer_data_size(source->in_buffer)) {
         LOG(ERROR, _("no space left in destination buffer"));
         return -1;
     }
 
-    avs_buffer_append_bytes(destination->out_buffer,
-                            avs_buffer_data(source->out_buffer),
-                            avs_buffer_data_size(source->out_buffer));
-    avs_buffer_reset(source->out_buffer);
-
-    avs_buffer_append_bytes(destination->in_buffer,
-                            avs_buffer_data(source->in_buffer),
-                            avs_buffer_data_size(source->in_buffer));
-
-    avs_buffer_reset(source->in_buffer);
+    transfer_buffer(destination->out_buffer, source->out_buffer);
+    transfer_buffer(destination->in_buffer, source->in_buffer);
 
     return 0;
 }
@@ -412,7 +670,7 @@ int avs_stream_netbuf_out_buffer_left(avs_stream_t *str) {
         LOG(ERROR, _("not a buffered_netstream"));
         return -1;
     }
-    return (int) avs_buffer_space_left(stream->out_buffer);
+    return (int) _avs_stream_buffer_space_left(stream->out_buffer);
 }
 
 void avs_stream_netbuf_set_recv_timeout(avs_stream_t *str,
@@ -643,7 +643,12 @@ static avs_error_t mock_shutdown(avs_net_socket_t *socket_) {
 
     err = socket->expected_commands->retval;
     finish_command(socket);
-    AVS_LIST_CLEAR(&socket->expected_data);
+    AVS_LIST_CLEAR(&socket->expected_data) {
+        if (data_has_size(socket->expected_data)) {
+            avs_free(
+                    (void *) (intptr_t) socket->expected_data->args.valid.data);
+        }
+    }
     socket->state = AVS_NET_SOCKET_STATE_SHUTDOWN;
     return err;
 }
@@ -39,11 +39,6 @@ void avs_cleanup_global_state(void) {
     void _avs_log_cleanup_global_state(void);
     _avs_log_cleanup_global_state();
 #    endif // AVS_COMMONS_WITH_AVS_LOG
-
-#    ifdef AVS_COMMONS_WITH_AVS_SCHED
-    void _avs_sched_cleanup_global_state(void);
-    _avs_sched_cleanup_global_state();
-#    endif
 }
 
 #endif // AVS_COMMONS_WITH_AVS_UTILS
@@ -220,3 +220,84 @@ AVS_UNIT_TEST(byte_buffer, fill_bytes) {
 
     avs_buffer_free(&buffer);
 }
+
+AVS_UNIT_TEST(ring_buffer, wrap_around) {
+    avs_ring_buffer_t *buffer;
+    avs_ring_buffer_segment_t segments[2];
+    char data[8];
+    AVS_UNIT_ASSERT_SUCCESS(avs_ring_buffer_create(&buffer, 8));
+    AVS_UNIT_ASSERT_EQUAL(avs_ring_buffer_capacity(buffer), 8);
+
+    AVS_UNIT_ASSERT_SUCCESS(avs_ring_buffer_append_bytes(buffer, "abcdef", 6));
+    AVS_UNIT_ASSERT_SUCCESS(avs_ring_buffer_consume_bytes(buffer, 4));
+    AVS_UNIT_ASSERT_SUCCESS(avs_ring_buffer_append_bytes(buffer, "ghijk", 5));
+    AVS_UNIT_ASSERT_EQUAL(avs_ring_buffer_data_size(buffer), 7);
+    AVS_UNIT_ASSERT_EQUAL(avs_ring_buffer_space_left(buffer), 1);
+
+    // data has not been moved
+    AVS_UNIT_ASSERT_EQUAL(avs_ring_buffer_data_segments(buffer, segments), 2);
+    AVS_UNIT_ASSERT_TRUE(segments[0].ptr == &buffer->data.data[4]);
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(segments[0].ptr, "efgh", 4);
+    AVS_UNIT_ASSERT_EQUAL(segments[0].size, 4);
+    AVS_UNIT_ASSERT_TRUE(segments[1].ptr == buffer->data.data);
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(segments[1].ptr, "ijk", 3);
+    AVS_UNIT_ASSERT_EQUAL(segments[1].size, 3);
+
+    AVS_UNIT_ASSERT_EQUAL(avs_ring_buffer_space_segments(buffer, segments), 1);
+    AVS_UNIT_ASSERT_TRUE(segments[0].ptr == &buffer->data.data[3]);
+    AVS_UNIT_ASSERT_EQUAL(segments[0].size, 1);
+    AVS_UNIT_ASSERT_EQUAL(segments[1].size, 0);
+
+    AVS_UNIT_ASSERT_SUCCESS(avs_ring_buffer_copy_data(buffer, 2, data, 5));
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(data, "ghijk", 5);
+    AVS_UNIT_ASSERT_FAILED(avs_ring_buffer_copy_data(buffer, 3, data, 5));
+    AVS_UNIT_ASSERT_FAILED(avs_ring_buffer_copy_data(buffer, 8, data, 0));
+
+    AVS_UNIT_ASSERT_FAILED(avs_ring_buffer_append_bytes(buffer, "lm", 2));
+    AVS_UNIT_ASSERT_SUCCESS(avs_ring_buffer_fill_bytes(buffer, 'l', 1));
+    AVS_UNIT_ASSERT_EQUAL(avs_ring_buffer_space_segments(buffer, segments), 0);
+    AVS_UNIT_ASSERT_SUCCESS(avs_ring_buffer_copy_data(buffer, 0, data, 8));
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(data, "efghijkl", 8);
+
+    avs_ring_buffer_free(&buffer);
+    AVS_UNIT_ASSERT_NULL(buffer);
+}
+
+AVS_UNIT_TEST(ring_buffer, space_segments) {
+    avs_ring_buffer_t *buffer;
+    avs_ring_buffer_segment_t segments[2];
+    AVS_UNIT_ASSERT_SUCCESS(avs_ring_buffer_create(&buffer, 8));
+
+    AVS_UNIT_ASSERT_SUCCESS(avs_ring_buffer_fill_bytes(buffer, 0, 5));
+    AVS_UNIT_ASSERT_SUCCESS(avs_ring_buffer_consume_bytes(buffer, 3));
+    AVS_UNIT_ASSERT_EQUAL(avs_ring_buffer_space_segments(buffer, segments), 2);
+    AVS_UNIT_ASSERT_TRUE(segments[0].ptr == &buffer->data.data[5]);
+    AVS_UNIT_ASSERT_EQUAL(segments[0].size, 3);
+    AVS_UNIT_ASSERT_TRUE(segments[1].ptr == buffer->data.data);
+    AVS_UNIT_ASSERT_EQUAL(segments[1].size, 3);
+
+    memcpy(segments[0].ptr, "abc", 3);
+    memcpy(segments[1].ptr, "de", 2);
+    AVS_UNIT_ASSERT_SUCCESS(avs_ring_buffer_advance_ptr(buffer, 5));
+    AVS_UNIT_ASSERT_FAILED(avs_ring_buffer_advance_ptr(buffer, 2));
+    AVS_UNIT_ASSERT_SUCCESS(avs_ring_buffer_consume_bytes(buffer, 2));
+
+    char data[5];
+    AVS_UNIT_ASSERT_SUCCESS(avs_ring_buffer_copy_data(buffer, 0, data, 5));
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(data, "abcde", 5);
+
+    // emptied buffer starts over, making the whole capacity contiguous
+    AVS_UNIT_ASSERT_FAILED(avs_ring_buffer_consume_bytes(buffer, 6));
+    AVS_UNIT_ASSERT_SUCCESS(avs_ring_buffer_consume_bytes(buffer, 5));
+    AVS_UNIT_ASSERT_EQUAL(avs_ring_buffer_data_segments(buffer, segments), 0);
+    AVS_UNIT_ASSERT_EQUAL(avs_ring_buffer_space_segments(buffer, segments), 1);
+    AVS_UNIT_ASSERT_TRUE(segments[0].ptr == buffer->data.data);
+    AVS_UNIT_ASSERT_EQUAL(segments[0].size, 8);
+
+    AVS_UNIT_ASSERT_SUCCESS(avs_ring_buffer_fill_bytes(buffer, 0, 8));
+    avs_ring_buffer_reset(buffer);
+    AVS_UNIT_ASSERT_EQUAL(avs_ring_buffer_data_size(buffer), 0);
+    AVS_UNIT_ASSERT_EQUAL(avs_ring_buffer_space_left(buffer), 8);
+
+    avs_ring_buffer_free(&buffer);
+}
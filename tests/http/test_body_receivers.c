@@ -426,3 +426,69 @@ AVS_UNIT_TEST(http, chunked_receiver_peek) {
     avs_unit_mocksock_expect_shutdown(socket);
     AVS_UNIT_ASSERT_SUCCESS(avs_stream_cleanup(&helper_stream));
 }
+
+AVS_UNIT_TEST(http, content_length_receiver_skip) {
+    size_t content_length = strchr(LENGTH_INPUT_DATA, '\n') - LENGTH_INPUT_DATA;
+    char buffer[64];
+    size_t bytes_read;
+    bool message_finished;
+    avs_net_socket_t *socket = NULL;
+    avs_stream_t *helper_stream = NULL;
+    avs_stream_t *receiver = NULL;
+    avs_unit_mocksock_create(&socket);
+    avs_unit_mocksock_expect_connect(socket, "host", "port");
+    AVS_UNIT_ASSERT_SUCCESS(avs_net_socket_connect(socket, "host", "port"));
+    avs_stream_netbuf_create(&helper_stream, socket, 16, 0);
+    AVS_UNIT_ASSERT_NOT_NULL(helper_stream);
+    avs_unit_mocksock_input(socket, LENGTH_INPUT_DATA,
+                            strlen(LENGTH_INPUT_DATA));
+    receiver =
+            create_body_receiver(helper_stream, &AVS_HTTP_DEFAULT_BUFFER_SIZES,
+                                 TRANSFER_LENGTH, content_length);
+    AVS_UNIT_ASSERT_NOT_NULL(receiver);
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_skip(receiver, &bytes_read,
+                                            &message_finished, 10));
+    AVS_UNIT_ASSERT_EQUAL(bytes_read, 10);
+    AVS_UNIT_ASSERT_FALSE(message_finished);
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_ignore_to_end(receiver));
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_read(
+            receiver, &bytes_read, &message_finished, buffer, sizeof(buffer)));
+    AVS_UNIT_ASSERT_EQUAL(bytes_read, 0);
+    AVS_UNIT_ASSERT_TRUE(message_finished);
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_read_reliably(
+            ((fake_receiver_t *) receiver)->backend, buffer,
+            strlen(LENGTH_INPUT_DATA) - content_length));
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(buffer,
+                                      LENGTH_INPUT_DATA + content_length,
+                                      strlen(LENGTH_INPUT_DATA)
+                                              - content_length);
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_cleanup(&receiver));
+    avs_unit_mocksock_expect_shutdown(socket);
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_cleanup(&helper_stream));
+}
+
+AVS_UNIT_TEST(http, chunked_receiver_skip) {
+    char buffer[64];
+    avs_net_socket_t *socket = NULL;
+    avs_stream_t *helper_stream = NULL;
+    avs_stream_t *receiver = NULL;
+    avs_unit_mocksock_create(&socket);
+    avs_unit_mocksock_expect_connect(socket, "host", "port");
+    AVS_UNIT_ASSERT_SUCCESS(avs_net_socket_connect(socket, "host", "port"));
+    avs_stream_netbuf_create(&helper_stream, socket, 256, 0);
+    AVS_UNIT_ASSERT_NOT_NULL(helper_stream);
+    avs_unit_mocksock_input(socket, CHUNKED_DATA, strlen(CHUNKED_DATA));
+    receiver =
+            create_body_receiver(helper_stream, &AVS_HTTP_DEFAULT_BUFFER_SIZES,
+                                 TRANSFER_CHUNKED, 0);
+    AVS_UNIT_ASSERT_NOT_NULL(receiver);
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_ignore_to_end(receiver));
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_read_reliably(
+            ((fake_receiver_t *) receiver)->backend, buffer,
+            strlen(POST_CHUNKED_DATA)));
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(buffer, POST_CHUNKED_DATA,
+                                      strlen(POST_CHUNKED_DATA));
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_cleanup(&receiver));
+    avs_unit_mocksock_expect_shutdown(socket);
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_cleanup(&helper_stream));
+}
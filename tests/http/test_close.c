@@ -45,9 +45,7 @@ static void successful_request(avs_http_t *client,
     avs_unit_mocksock_assert_io_clean(*socket_ptr);
     tmp_data = "POST / HTTP/1.1\r\n"
                "Host: example.com\r\n"
-#ifdef AVS_COMMONS_HTTP_WITH_ZLIB
-               "Accept-Encoding: gzip, deflate\r\n"
-#endif
+               TEST_ACCEPT_ENCODING
                "Content-Length: 0\r\n"
                "\r\n";
     avs_unit_mocksock_expect_output(*socket_ptr, tmp_data, strlen(tmp_data));
@@ -86,9 +84,7 @@ AVS_UNIT_TEST(http_close, chunked_request) {
     // second request retry
     const char *tmp_data = "POST / HTTP/1.1\r\n"
                            "Host: example.com\r\n"
-#ifdef AVS_COMMONS_HTTP_WITH_ZLIB
-                           "Accept-Encoding: gzip, deflate\r\n"
-#endif
+                           TEST_ACCEPT_ENCODING
                            "Expect: 100-continue\r\n"
                            "Transfer-Encoding: chunked\r\n"
                            "\r\n";
@@ -150,9 +146,7 @@ AVS_UNIT_TEST(http_close, chunked_request_error_in_first_chunk) {
     // second request
     const char *tmp_data = "POST / HTTP/1.1\r\n"
                            "Host: example.com\r\n"
-#ifdef AVS_COMMONS_HTTP_WITH_ZLIB
-                           "Accept-Encoding: gzip, deflate\r\n"
-#endif
+                           TEST_ACCEPT_ENCODING
                            "Expect: 100-continue\r\n"
                            "Transfer-Encoding: chunked\r\n"
                            "\r\n";
@@ -195,9 +189,7 @@ AVS_UNIT_TEST(http_close, chunked_request_close_when_receiving) {
     // second request
     const char *tmp_data = "POST / HTTP/1.1\r\n"
                            "Host: example.com\r\n"
-#ifdef AVS_COMMONS_HTTP_WITH_ZLIB
-                           "Accept-Encoding: gzip, deflate\r\n"
-#endif
+                           TEST_ACCEPT_ENCODING
                            "Expect: 100-continue\r\n"
                            "Transfer-Encoding: chunked\r\n"
                            "\r\n";
@@ -239,9 +231,7 @@ AVS_UNIT_TEST(http_close, chunked_request_error_in_second_chunk) {
     // second request
     const char *tmp_data = "POST / HTTP/1.1\r\n"
                            "Host: example.com\r\n"
-#ifdef AVS_COMMONS_HTTP_WITH_ZLIB
-                           "Accept-Encoding: gzip, deflate\r\n"
-#endif
+                           TEST_ACCEPT_ENCODING
                            "Expect: 100-continue\r\n"
                            "Transfer-Encoding: chunked\r\n"
                            "\r\n";
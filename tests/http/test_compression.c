@@ -0,0 +1,175 @@
+/*
+ * Copyright 2023 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <avsystem/commons/avs_unit_test.h>
+
+#define TEST_COMPRESSION_BUF_SIZE 64
+
+static const char TEST_COMPRESSION_DATA[] =
+        "Lorem ipsum dolor sit amet, consectetur adipiscing elit, "
+        "Lorem ipsum dolor sit amet, consectetur adipiscing elit";
+
+static avs_stream_t *create_test_compressor(http_compression_pool_t *pool,
+                                            int level) {
+    avs_stream_t *stream = _avs_http_create_compressor(
+            pool, HTTP_COMPRESSION_GZIP, level,
+            HTTP_COMPRESSOR_WINDOW_BITS_DEFAULT,
+            HTTP_COMPRESSOR_MEM_LEVEL_DEFAULT, TEST_COMPRESSION_BUF_SIZE,
+            TEST_COMPRESSION_BUF_SIZE);
+    AVS_UNIT_ASSERT_NOT_NULL(stream);
+    return stream;
+}
+
+static avs_stream_t *create_test_decompressor(http_compression_pool_t *pool) {
+    avs_stream_t *stream = _avs_http_create_decompressor(
+            pool, HTTP_COMPRESSION_GZIP, HTTP_DECOMPRESSOR_WINDOW_BITS_DEFAULT,
+            TEST_COMPRESSION_BUF_SIZE, TEST_COMPRESSION_BUF_SIZE);
+    AVS_UNIT_ASSERT_NOT_NULL(stream);
+    return stream;
+}
+
+/* writes all of data into the stream, collecting whatever it outputs */
+static size_t
+process_test_data(avs_stream_t *stream, const void *data, size_t size,
+                  char *out_buf, size_t out_buf_size) {
+    size_t out_size = 0;
+    while (size) {
+        size_t chunk_size = size;
+        AVS_UNIT_ASSERT_SUCCESS(
+                avs_stream_write_some(stream, data, &chunk_size));
+        data = (const char *) data + chunk_size;
+        size -= chunk_size;
+        size_t bytes_read;
+        AVS_UNIT_ASSERT_SUCCESS(avs_stream_read(stream, &bytes_read, NULL,
+                                                out_buf + out_size,
+                                                out_buf_size - out_size));
+        out_size += bytes_read;
+    }
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_finish_message(stream));
+    bool finished = false;
+    while (!finished) {
+        size_t bytes_read;
+        AVS_UNIT_ASSERT_SUCCESS(avs_stream_read(stream, &bytes_read, &finished,
+                                                out_buf + out_size,
+                                                out_buf_size - out_size));
+        out_size += bytes_read;
+        AVS_UNIT_ASSERT_TRUE(out_size < out_buf_size);
+    }
+    return out_size;
+}
+
+static void round_trip(http_compression_pool_t *pool) {
+    char compressed[512];
+    char decompressed[512];
+    avs_stream_t *compressor = create_test_compressor(pool, 6);
+    size_t compressed_size =
+            process_test_data(compressor, TEST_COMPRESSION_DATA,
+                              sizeof(TEST_COMPRESSION_DATA), compressed,
+                              sizeof(compressed));
+    avs_stream_cleanup(&compressor);
+    avs_stream_t *decompressor = create_test_decompressor(pool);
+    AVS_UNIT_ASSERT_EQUAL(process_test_data(decompressor, compressed,
+                                            compressed_size, decompressed,
+                                            sizeof(decompressed)),
+                          sizeof(TEST_COMPRESSION_DATA));
+    AVS_UNIT_ASSERT_EQUAL_STRING(decompressed, TEST_COMPRESSION_DATA);
+    avs_stream_cleanup(&decompressor);
+}
+
+AVS_UNIT_TEST(http_compression, pool_reuse) {
+    http_compression_pool_t pool = {
+        .max_idle_states = 4
+    };
+    round_trip(&pool);
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(pool.idle_states), 2);
+    http_zlib_state_t *compressor_state = AVS_LIST_NTH(pool.idle_states, 1);
+    http_zlib_state_t *decompressor_state = pool.idle_states;
+
+    avs_stream_t *stream = create_test_compressor(&pool, 6);
+    AVS_UNIT_ASSERT_TRUE(GET_STATE(stream) == compressor_state);
+    AVS_UNIT_ASSERT_TRUE(pool.idle_states == decompressor_state);
+    avs_stream_cleanup(&stream);
+
+    /* reused states behave exactly like the fresh ones */
+    round_trip(&pool);
+    round_trip(&pool);
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(pool.idle_states), 2);
+
+    pool.max_idle_states = 0;
+    _avs_http_compression_pool_trim(&pool);
+    AVS_UNIT_ASSERT_NULL(pool.idle_states);
+}
+
+AVS_UNIT_TEST(http_compression, pool_parameter_mismatch) {
+    http_compression_pool_t pool = {
+        .max_idle_states = 4
+    };
+    avs_stream_t *stream = create_test_compressor(&pool, 6);
+    avs_stream_cleanup(&stream);
+    http_zlib_state_t *state = pool.idle_states;
+    AVS_UNIT_ASSERT_NOT_NULL(state);
+
+    stream = create_test_compressor(&pool, 1);
+    AVS_UNIT_ASSERT_TRUE(GET_STATE(stream) != state);
+    AVS_UNIT_ASSERT_TRUE(pool.idle_states == state);
+    avs_stream_cleanup(&stream);
+
+    stream = create_test_decompressor(&pool);
+    AVS_UNIT_ASSERT_TRUE(GET_STATE(stream) != state);
+    avs_stream_cleanup(&stream);
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(pool.idle_states), 3);
+
+    pool.max_idle_states = 0;
+    _avs_http_compression_pool_trim(&pool);
+    AVS_UNIT_ASSERT_NULL(pool.idle_states);
+}
+
+AVS_UNIT_TEST(http_compression, pool_limit) {
+    http_compression_pool_t pool = {
+        .max_idle_states = 2
+    };
+    avs_stream_t *streams[3];
+    for (size_t i = 0; i < AVS_ARRAY_SIZE(streams); ++i) {
+        streams[i] = create_test_decompressor(&pool);
+    }
+    http_zlib_state_t *second_state = GET_STATE(streams[1]);
+    http_zlib_state_t *third_state = GET_STATE(streams[2]);
+    for (size_t i = 0; i < AVS_ARRAY_SIZE(streams); ++i) {
+        avs_stream_cleanup(&streams[i]);
+    }
+    /* the state returned first has been evicted */
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(pool.idle_states), 2);
+    AVS_UNIT_ASSERT_TRUE(pool.idle_states == third_state);
+    AVS_UNIT_ASSERT_TRUE(AVS_LIST_NEXT(pool.idle_states) == second_state);
+
+    pool.max_idle_states = 1;
+    _avs_http_compression_pool_trim(&pool);
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(pool.idle_states), 1);
+    AVS_UNIT_ASSERT_TRUE(pool.idle_states == third_state);
+
+    pool.max_idle_states = 0;
+    _avs_http_compression_pool_trim(&pool);
+    AVS_UNIT_ASSERT_NULL(pool.idle_states);
+}
+
+AVS_UNIT_TEST(http_compression, no_pool) {
+    round_trip(NULL);
+    http_compression_pool_t pool = {
+        .max_idle_states = 0
+    };
+    round_trip(&pool);
+    AVS_UNIT_ASSERT_NULL(pool.idle_states);
+}
@@ -0,0 +1,336 @@
+/*
+ * Copyright 2023 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <avsystem/commons/avs_stream_net.h>
+#include <avsystem/commons/avs_unit_mocksock.h>
+#include <avsystem/commons/avs_unit_test.h>
+
+#include "test_http.h"
+
+#define POOL_TEST_REQUEST           \
+    "GET /fw HTTP/1.1\r\n"          \
+    "Host: example.com\r\n"         \
+    TEST_ACCEPT_ENCODING            \
+    "\r\n"
+
+static avs_stream_t *open_pool_test_stream(avs_http_t *client,
+                                           const char *url_string) {
+    avs_url_t *url = avs_url_parse(url_string);
+    AVS_UNIT_ASSERT_NOT_NULL(url);
+    avs_stream_t *stream = NULL;
+    AVS_UNIT_ASSERT_SUCCESS(avs_http_open_stream(&stream, client, AVS_HTTP_GET,
+                                                 AVS_HTTP_CONTENT_IDENTITY, url,
+                                                 NULL, NULL));
+    avs_url_free(url);
+    return stream;
+}
+
+static void perform_pool_test_request(avs_stream_t *stream,
+                                      avs_net_socket_t *socket,
+                                      bool read_to_end) {
+    const char *tmp_data = POOL_TEST_REQUEST;
+    avs_unit_mocksock_expect_output(socket, tmp_data, strlen(tmp_data));
+    tmp_data = "HTTP/1.1 200 OK\r\n"
+               "Content-Length: 2\r\n"
+               "\r\n"
+               "ok";
+    avs_unit_mocksock_input(socket, tmp_data, strlen(tmp_data));
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_finish_message(stream));
+    if (read_to_end) {
+        char buffer[8];
+        size_t bytes_read;
+        bool message_finished;
+        AVS_UNIT_ASSERT_SUCCESS(avs_stream_read(stream, &bytes_read,
+                                                &message_finished, buffer,
+                                                sizeof(buffer)));
+        AVS_UNIT_ASSERT_EQUAL(bytes_read, 2);
+        AVS_UNIT_ASSERT_TRUE(message_finished);
+    }
+    avs_unit_mocksock_assert_io_clean(socket);
+}
+
+AVS_UNIT_TEST(http_connection_pool, reuse) {
+    avs_http_t *client = avs_http_new(&AVS_HTTP_DEFAULT_BUFFER_SIZES);
+    AVS_UNIT_ASSERT_NOT_NULL(client);
+    avs_http_set_connection_pool(client, 2, AVS_TIME_DURATION_INVALID);
+
+    avs_net_socket_t *socket = NULL;
+    avs_unit_mocksock_create(&socket);
+    avs_http_test_expect_create_socket(socket, AVS_NET_TCP_SOCKET);
+    avs_unit_mocksock_expect_connect(socket, "example.com", "80");
+    avs_stream_t *stream =
+            open_pool_test_stream(client, "http://example.com/fw");
+    perform_pool_test_request(stream, socket, true);
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_cleanup(&stream));
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(client->connection_pool), 1);
+
+    // no new socket is created
+    stream = open_pool_test_stream(client, "HTTP://example.com/fw");
+    AVS_UNIT_ASSERT_TRUE(avs_stream_net_getsock(stream) == socket);
+    AVS_UNIT_ASSERT_NULL(client->connection_pool);
+    perform_pool_test_request(stream, socket, true);
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_cleanup(&stream));
+
+    avs_unit_mocksock_expect_shutdown(socket);
+    avs_http_free(client);
+}
+
+AVS_UNIT_TEST(http_connection_pool, disabled) {
+    avs_http_t *client = avs_http_new(&AVS_HTTP_DEFAULT_BUFFER_SIZES);
+    AVS_UNIT_ASSERT_NOT_NULL(client);
+
+    avs_net_socket_t *socket = NULL;
+    avs_unit_mocksock_create(&socket);
+    avs_http_test_expect_create_socket(socket, AVS_NET_TCP_SOCKET);
+    avs_unit_mocksock_expect_connect(socket, "example.com", "80");
+    avs_stream_t *stream =
+            open_pool_test_stream(client, "http://example.com/fw");
+    perform_pool_test_request(stream, socket, true);
+    avs_unit_mocksock_expect_shutdown(socket);
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_cleanup(&stream));
+    AVS_UNIT_ASSERT_NULL(client->connection_pool);
+    avs_http_free(client);
+}
+
+AVS_UNIT_TEST(http_connection_pool, unread_response_not_pooled) {
+    avs_http_t *client = avs_http_new(&AVS_HTTP_DEFAULT_BUFFER_SIZES);
+    AVS_UNIT_ASSERT_NOT_NULL(client);
+    avs_http_set_connection_pool(client, 2, AVS_TIME_DURATION_INVALID);
+
+    avs_net_socket_t *socket = NULL;
+    avs_unit_mocksock_create(&socket);
+    avs_http_test_expect_create_socket(socket, AVS_NET_TCP_SOCKET);
+    avs_unit_mocksock_expect_connect(socket, "example.com", "80");
+    avs_stream_t *stream =
+            open_pool_test_stream(client, "http://example.com/fw");
+    perform_pool_test_request(stream, socket, false);
+    avs_unit_mocksock_expect_shutdown(socket);
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_cleanup(&stream));
+    AVS_UNIT_ASSERT_NULL(client->connection_pool);
+    avs_http_free(client);
+}
+
+AVS_UNIT_TEST(http_connection_pool, unread_empty_body_pooled) {
+    avs_http_t *client = avs_http_new(&AVS_HTTP_DEFAULT_BUFFER_SIZES);
+    AVS_UNIT_ASSERT_NOT_NULL(client);
+    avs_http_set_connection_pool(client, 2, AVS_TIME_DURATION_INVALID);
+
+    avs_net_socket_t *socket = NULL;
+    avs_unit_mocksock_create(&socket);
+    avs_http_test_expect_create_socket(socket, AVS_NET_TCP_SOCKET);
+    avs_unit_mocksock_expect_connect(socket, "example.com", "80");
+    avs_stream_t *stream =
+            open_pool_test_stream(client, "http://example.com/fw");
+    const char *tmp_data = POOL_TEST_REQUEST;
+    avs_unit_mocksock_expect_output(socket, tmp_data, strlen(tmp_data));
+    tmp_data = "HTTP/1.1 200 OK\r\n"
+               "Content-Length: 0\r\n"
+               "\r\n";
+    avs_unit_mocksock_input(socket, tmp_data, strlen(tmp_data));
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_finish_message(stream));
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_cleanup(&stream));
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(client->connection_pool), 1);
+
+    avs_unit_mocksock_expect_shutdown(socket);
+    avs_http_free(client);
+}
+
+AVS_UNIT_TEST(http_connection_pool, chunk_boundary_not_read_on_close) {
+    avs_http_t *client = avs_http_new(&AVS_HTTP_DEFAULT_BUFFER_SIZES);
+    AVS_UNIT_ASSERT_NOT_NULL(client);
+    avs_http_set_connection_pool(client, 2, AVS_TIME_DURATION_INVALID);
+
+    avs_net_socket_t *socket = NULL;
+    avs_unit_mocksock_create(&socket);
+    avs_http_test_expect_create_socket(socket, AVS_NET_TCP_SOCKET);
+    avs_unit_mocksock_expect_connect(socket, "example.com", "80");
+    avs_stream_t *stream =
+            open_pool_test_stream(client, "http://example.com/fw");
+    const char *tmp_data = POOL_TEST_REQUEST;
+    avs_unit_mocksock_expect_output(socket, tmp_data, strlen(tmp_data));
+    tmp_data = "HTTP/1.1 200 OK\r\n"
+               "Transfer-Encoding: chunked\r\n"
+               "\r\n"
+               "2\r\n"
+               "ok\r\n";
+    avs_unit_mocksock_input(socket, tmp_data, strlen(tmp_data));
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_finish_message(stream));
+    char buffer[8];
+    size_t bytes_read;
+    bool message_finished;
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_read(stream, &bytes_read,
+                                            &message_finished, buffer,
+                                            sizeof(buffer)));
+    AVS_UNIT_ASSERT_EQUAL(bytes_read, 2);
+    AVS_UNIT_ASSERT_FALSE(message_finished);
+
+    // whether the body is finished is not known without reading the next
+    // chunk header, which might block, so the connection is not reused even
+    // if the terminating chunk could be received
+    tmp_data = "0\r\n\r\n";
+    avs_unit_mocksock_input(socket, tmp_data, strlen(tmp_data));
+    avs_unit_mocksock_expect_shutdown(socket);
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_cleanup(&stream));
+    AVS_UNIT_ASSERT_NULL(client->connection_pool);
+    avs_http_free(client);
+}
+
+#ifdef AVS_COMMONS_HTTP_WITH_ZLIB
+AVS_UNIT_TEST(http_connection_pool, reuse_after_gzipped_chunked_body) {
+    avs_http_t *client = avs_http_new(&AVS_HTTP_DEFAULT_BUFFER_SIZES);
+    AVS_UNIT_ASSERT_NOT_NULL(client);
+    avs_http_set_connection_pool(client, 2, AVS_TIME_DURATION_INVALID);
+
+    avs_net_socket_t *socket = NULL;
+    avs_unit_mocksock_create(&socket);
+    avs_http_test_expect_create_socket(socket, AVS_NET_TCP_SOCKET);
+    avs_unit_mocksock_expect_connect(socket, "example.com", "80");
+    avs_stream_t *stream =
+            open_pool_test_stream(client, "http://example.com/fw");
+    const char *tmp_data = POOL_TEST_REQUEST;
+    avs_unit_mocksock_expect_output(socket, tmp_data, strlen(tmp_data));
+    // the compressed data ends before the terminating chunk, which is
+    // received separately
+    const char *terminator = "0\r\n\r\n";
+    avs_unit_mocksock_input(socket, TEST_GZIPPED_CHUNKED_OK_RESPONSE,
+                            sizeof(TEST_GZIPPED_CHUNKED_OK_RESPONSE) - 1
+                                    - strlen(terminator));
+    avs_unit_mocksock_input(socket, terminator, strlen(terminator));
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_finish_message(stream));
+    char buffer[8];
+    size_t buffer_pos = 0;
+    bool message_finished = false;
+    while (!message_finished) {
+        size_t bytes_read;
+        AVS_UNIT_ASSERT_SUCCESS(avs_stream_read(
+                stream, &bytes_read, &message_finished, buffer + buffer_pos,
+                sizeof(buffer) - buffer_pos));
+        buffer_pos += bytes_read;
+    }
+    AVS_UNIT_ASSERT_EQUAL(buffer_pos, 2);
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(buffer, "ok", 2);
+    avs_unit_mocksock_assert_io_clean(socket);
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_cleanup(&stream));
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(client->connection_pool), 1);
+
+    // the next response is not confused by leftovers of the previous one
+    stream = open_pool_test_stream(client, "http://example.com/fw");
+    AVS_UNIT_ASSERT_TRUE(avs_stream_net_getsock(stream) == socket);
+    perform_pool_test_request(stream, socket, true);
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_cleanup(&stream));
+
+    avs_unit_mocksock_expect_shutdown(socket);
+    avs_http_free(client);
+}
+#endif // AVS_COMMONS_HTTP_WITH_ZLIB
+
+AVS_UNIT_TEST(http_connection_pool, closed_by_server) {
+    avs_http_t *client = avs_http_new(&AVS_HTTP_DEFAULT_BUFFER_SIZES);
+    AVS_UNIT_ASSERT_NOT_NULL(client);
+    avs_http_set_connection_pool(client, 2, AVS_TIME_DURATION_INVALID);
+
+    avs_net_socket_t *socket = NULL;
+    avs_unit_mocksock_create(&socket);
+    avs_http_test_expect_create_socket(socket, AVS_NET_TCP_SOCKET);
+    avs_unit_mocksock_expect_connect(socket, "example.com", "80");
+    avs_stream_t *stream =
+            open_pool_test_stream(client, "http://example.com/fw");
+    perform_pool_test_request(stream, socket, true);
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_cleanup(&stream));
+
+    // the request is retried after reconnecting
+    stream = open_pool_test_stream(client, "http://example.com/fw");
+    avs_unit_mocksock_output_fail(socket, avs_errno(AVS_EPIPE));
+    avs_unit_mocksock_expect_mid_close(socket);
+    avs_unit_mocksock_expect_connect(socket, "example.com", "80");
+    perform_pool_test_request(stream, socket, true);
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_cleanup(&stream));
+
+    avs_unit_mocksock_expect_shutdown(socket);
+    avs_http_free(client);
+}
+
+AVS_UNIT_TEST(http_connection_pool, different_hosts) {
+    avs_http_t *client = avs_http_new(&AVS_HTTP_DEFAULT_BUFFER_SIZES);
+    AVS_UNIT_ASSERT_NOT_NULL(client);
+    avs_http_set_connection_pool(client, 2, AVS_TIME_DURATION_INVALID);
+
+    avs_net_socket_t *socket = NULL;
+    avs_unit_mocksock_create(&socket);
+    avs_url_t *url = avs_url_parse("http://example.com/");
+    AVS_UNIT_ASSERT_NOT_NULL(url);
+    _avs_http_pool_checkin(client, url, &(avs_net_socket_t *) { socket });
+    avs_url_free(url);
+
+    const char *const other_urls[] = { "https://example.com/",
+                                       "http://example.com:8080/",
+                                       "http://example.org/" };
+    for (size_t i = 0; i < AVS_ARRAY_SIZE(other_urls); ++i) {
+        AVS_UNIT_ASSERT_NOT_NULL((url = avs_url_parse(other_urls[i])));
+        AVS_UNIT_ASSERT_NULL(_avs_http_pool_checkout(client, url));
+        avs_url_free(url);
+    }
+    url = avs_url_parse("http://Example.COM:80/fw");
+    AVS_UNIT_ASSERT_NOT_NULL(url);
+    AVS_UNIT_ASSERT_TRUE(_avs_http_pool_checkout(client, url) == socket);
+    avs_url_free(url);
+
+    avs_unit_mocksock_expect_shutdown(socket);
+    avs_net_socket_shutdown(socket);
+    avs_net_socket_cleanup(&socket);
+    avs_http_free(client);
+}
+
+AVS_UNIT_TEST(http_connection_pool, limits) {
+    avs_http_t *client = avs_http_new(&AVS_HTTP_DEFAULT_BUFFER_SIZES);
+    AVS_UNIT_ASSERT_NOT_NULL(client);
+    avs_http_set_connection_pool(client, 2,
+                                 avs_time_duration_from_scalar(1, AVS_TIME_S));
+    avs_url_t *url = avs_url_parse("http://example.com/");
+    AVS_UNIT_ASSERT_NOT_NULL(url);
+
+    avs_net_socket_t *sockets[3];
+    for (size_t i = 0; i < AVS_ARRAY_SIZE(sockets); ++i) {
+        avs_unit_mocksock_create(&sockets[i]);
+    }
+    _avs_http_pool_checkin(client, url, &(avs_net_socket_t *) { sockets[0] });
+    _avs_http_pool_checkin(client, url, &(avs_net_socket_t *) { sockets[1] });
+    // the connection that has been idle for the longest time is closed
+    avs_unit_mocksock_expect_shutdown(sockets[0]);
+    _avs_http_pool_checkin(client, url, &(avs_net_socket_t *) { sockets[2] });
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(client->connection_pool), 2);
+
+    // expired connections are not reused
+    AVS_LIST_NTH(client->connection_pool, 0)->idle_since =
+            avs_time_monotonic_add(
+                    avs_time_monotonic_now(),
+                    avs_time_duration_from_scalar(-2, AVS_TIME_S));
+    avs_unit_mocksock_expect_shutdown(sockets[2]);
+    avs_net_socket_t *socket = _avs_http_pool_checkout(client, url);
+    AVS_UNIT_ASSERT_TRUE(socket == sockets[1]);
+    AVS_UNIT_ASSERT_NULL(client->connection_pool);
+
+    _avs_http_pool_checkin(client, url, &socket);
+    AVS_UNIT_ASSERT_NULL(socket);
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(client->connection_pool), 1);
+    avs_url_free(url);
+
+    // disabling the pool closes all the connections
+    avs_unit_mocksock_expect_shutdown(sockets[1]);
+    avs_http_set_connection_pool(client, 0, AVS_TIME_DURATION_INVALID);
+    AVS_UNIT_ASSERT_NULL(client->connection_pool);
+    avs_http_free(client);
+}
@@ -0,0 +1,180 @@
+/*
+ * Copyright 2023 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <avsystem/commons/avs_unit_test.h>
+
+/*
+ * Trivial run-length "compression" used to test the stream independently of
+ * any real library: the data is a sequence of (count, value) byte pairs,
+ * terminated by a zero count. A count of 0xFF is invalid.
+ */
+typedef struct {
+    uint8_t pending_count;
+    uint8_t value;
+    size_t count;
+} rle_state_t;
+
+static void *rle_create(void) {
+    return avs_calloc(1, sizeof(rle_state_t));
+}
+
+static http_decompressor_result_t rle_decompress(void *state_,
+                                                 const uint8_t **inout_next_in,
+                                                 size_t *inout_avail_in,
+                                                 uint8_t **inout_next_out,
+                                                 size_t *inout_avail_out) {
+    rle_state_t *state = (rle_state_t *) state_;
+    while (true) {
+        for (; state->count && *inout_avail_out; --state->count) {
+            *(*inout_next_out)++ = state->value;
+            --*inout_avail_out;
+        }
+        if (state->count) {
+            return HTTP_DECOMPRESSOR_OK;
+        }
+        if (!*inout_avail_in) {
+            return HTTP_DECOMPRESSOR_NEED_INPUT;
+        }
+        uint8_t byte = *(*inout_next_in)++;
+        --*inout_avail_in;
+        if (state->pending_count) {
+            state->count = state->pending_count;
+            state->value = byte;
+            state->pending_count = 0;
+        } else if (!byte) {
+            return HTTP_DECOMPRESSOR_FINISHED;
+        } else if (byte == 0xFF) {
+            return HTTP_DECOMPRESSOR_ERROR;
+        } else {
+            state->pending_count = byte;
+        }
+    }
+}
+
+static int rle_reset(void **state_ptr) {
+    memset(*state_ptr, 0, sizeof(rle_state_t));
+    return 0;
+}
+
+static void rle_destroy(void *state) {
+    avs_free(state);
+}
+
+static const http_decompressor_ops_t RLE_DECOMPRESSOR = {
+    .create = rle_create,
+    .decompress = rle_decompress,
+    .reset = rle_reset,
+    .destroy = rle_destroy
+};
+
+static avs_stream_t *create_rle_stream(size_t input_buffer_size,
+                                       size_t output_buffer_size) {
+    avs_stream_t *stream =
+            _avs_http_decompressor_stream_create(&RLE_DECOMPRESSOR,
+                                                 input_buffer_size,
+                                                 output_buffer_size);
+    AVS_UNIT_ASSERT_NOT_NULL(stream);
+    return stream;
+}
+
+/* reads until the message is finished, at most chunk_size bytes at a time */
+static size_t read_all(avs_stream_t *stream,
+                       char *buffer,
+                       size_t buffer_size,
+                       size_t chunk_size) {
+    size_t total = 0;
+    bool finished = false;
+    while (!finished) {
+        size_t bytes_read;
+        AVS_UNIT_ASSERT_SUCCESS(avs_stream_read(
+                stream, &bytes_read, &finished, buffer + total,
+                AVS_MIN(chunk_size, buffer_size - total)));
+        total += bytes_read;
+        AVS_UNIT_ASSERT_TRUE(total < buffer_size);
+    }
+    buffer[total] = '\0';
+    return total;
+}
+
+AVS_UNIT_TEST(http_decompressor, simple) {
+    avs_stream_t *stream = create_rle_stream(16, 16);
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_write(stream, "\x05" "a", 2));
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_write(stream, "\x03", 1));
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_write(stream, "b\x00", 2));
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_finish_message(stream));
+    char buffer[32];
+    AVS_UNIT_ASSERT_EQUAL(read_all(stream, buffer, sizeof(buffer), 3), 8);
+    AVS_UNIT_ASSERT_EQUAL_STRING(buffer, "aaaaabbb");
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_cleanup(&stream));
+}
+
+AVS_UNIT_TEST(http_decompressor, output_larger_than_buffers) {
+    avs_stream_t *stream = create_rle_stream(4, 8);
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_write(stream, "\x64x\x64y", 4));
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_write(stream, "\x00", 1));
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_finish_message(stream));
+
+    char value;
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_peek(stream, 7, &value));
+    AVS_UNIT_ASSERT_EQUAL(value, 'x');
+    AVS_UNIT_ASSERT_EQUAL(avs_stream_peek(stream, 8, &value).code,
+                          AVS_ENOBUFS);
+
+    char buffer[256];
+    AVS_UNIT_ASSERT_EQUAL(read_all(stream, buffer, sizeof(buffer), 7), 200);
+    for (size_t i = 0; i < 200; ++i) {
+        AVS_UNIT_ASSERT_EQUAL(buffer[i], i < 100 ? 'x' : 'y');
+    }
+    AVS_UNIT_ASSERT_TRUE(avs_is_eof(avs_stream_peek(stream, 0, &value)));
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_cleanup(&stream));
+}
+
+AVS_UNIT_TEST(http_decompressor, truncated) {
+    avs_stream_t *stream = create_rle_stream(16, 16);
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_write(stream, "\x05" "a\x03", 3));
+    AVS_UNIT_ASSERT_FAILED(avs_stream_finish_message(stream));
+    char buffer[32];
+    size_t bytes_read;
+    bool finished;
+    AVS_UNIT_ASSERT_FAILED(avs_stream_read(stream, &bytes_read, &finished,
+                                           buffer, sizeof(buffer)));
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_cleanup(&stream));
+}
+
+AVS_UNIT_TEST(http_decompressor, malformed) {
+    avs_stream_t *stream = create_rle_stream(16, 16);
+    AVS_UNIT_ASSERT_FAILED(avs_stream_write(stream, "\x05" "a\xFF", 3));
+    char value;
+    AVS_UNIT_ASSERT_FAILED(avs_stream_peek(stream, 0, &value));
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_cleanup(&stream));
+}
+
+AVS_UNIT_TEST(http_decompressor, reset) {
+    avs_stream_t *stream = create_rle_stream(16, 16);
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_write(stream, "\x02" "a\x00", 3));
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_finish_message(stream));
+    /* no more data is accepted after the end of compressed data */
+    AVS_UNIT_ASSERT_EQUAL(avs_stream_write(stream, "\x02" "b", 2).code,
+                          AVS_EBADF);
+
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_reset(stream));
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_write(stream, "\x02" "b\x00", 3));
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_finish_message(stream));
+    char buffer[32];
+    AVS_UNIT_ASSERT_EQUAL(read_all(stream, buffer, sizeof(buffer), 32), 2);
+    AVS_UNIT_ASSERT_EQUAL_STRING(buffer, "bb");
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_cleanup(&stream));
+}
@@ -19,6 +19,30 @@
 
 #include <avsystem/commons/avs_net.h>
 
+#include "src/http/avs_content_encoding.h"
+
+#ifdef HTTP_ACCEPT_ENCODING
+#    define TEST_ACCEPT_ENCODING \
+        "Accept-Encoding: " HTTP_ACCEPT_ENCODING "\r\n"
+#else // HTTP_ACCEPT_ENCODING
+#    define TEST_ACCEPT_ENCODING ""
+#endif // HTTP_ACCEPT_ENCODING
+
+#ifdef AVS_COMMONS_HTTP_WITH_ZLIB
+/* "ok", compressed with gzip and sent with chunked transfer encoding */
+#    define TEST_GZIPPED_CHUNKED_OK_RESPONSE                                   \
+        "HTTP/1.1 200 OK\r\n"                                                  \
+        "Transfer-Encoding: chunked\r\n"                                       \
+        "Content-Encoding: gzip\r\n"                                           \
+        "\r\n"                                                                 \
+        "16\r\n"                                                               \
+        "\x1f\x8b\x08\x00\x00\x00\x00\x00\x02\x03\xcb\xcf\x06\x00\x47\xdd"     \
+        "\xdc\x79\x02\x00\x00\x00"                                             \
+        "\r\n"                                                                 \
+        "0\r\n"                                                                \
+        "\r\n"
+#endif // AVS_COMMONS_HTTP_WITH_ZLIB
+
 typedef struct expected_socket_struct {
     avs_net_socket_t *socket;
     avs_net_socket_type_t type;
@@ -0,0 +1,155 @@
+/*
+ * Copyright 2023 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <avsystem/commons/avs_unit_test.h>
+
+#define TEST_LINE_PARSER_BUF_SIZE 16
+
+typedef struct {
+    http_line_parser_t parser;
+    char buf[TEST_LINE_PARSER_BUF_SIZE];
+    const char *data;
+    size_t size;
+} line_parser_test_env_t;
+
+static void setup_line_parser(line_parser_test_env_t *env, const char *data) {
+    _avs_http_line_parser_init(&env->parser, env->buf, sizeof(env->buf));
+    env->data = data;
+    env->size = strlen(data);
+}
+
+/* feeds at most chunk_size bytes at a time until a line is found */
+static http_line_parser_result_t next_line(line_parser_test_env_t *env,
+                                           size_t chunk_size,
+                                           http_line_t *out_line) {
+    http_line_parser_result_t result = HTTP_LINE_PARSER_NEED_MORE;
+    while (result == HTTP_LINE_PARSER_NEED_MORE && env->size) {
+        size_t consumed;
+        result = _avs_http_line_parser_feed(&env->parser, env->data,
+                                            AVS_MIN(env->size, chunk_size),
+                                            &consumed, out_line);
+        AVS_UNIT_ASSERT_TRUE(consumed <= env->size);
+        env->data += consumed;
+        env->size -= consumed;
+    }
+    return result;
+}
+
+#define ASSERT_NEXT_LINE(Env, ChunkSize, Result, Expected)                  \
+    do {                                                                    \
+        http_line_t actual_line;                                            \
+        AVS_UNIT_ASSERT_EQUAL(next_line((Env), (ChunkSize), &actual_line),  \
+                              (Result));                                    \
+        AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(actual_line.data, (Expected),     \
+                                          strlen(Expected));                \
+        AVS_UNIT_ASSERT_EQUAL(actual_line.size, strlen(Expected));          \
+    } while (0)
+
+AVS_UNIT_TEST(http_line_parser, zero_copy) {
+    line_parser_test_env_t env;
+    setup_line_parser(&env, "Key: value\r\nOther:x\n\r\n");
+    const char *input = env.data;
+    http_line_t line;
+    AVS_UNIT_ASSERT_EQUAL(next_line(&env, SIZE_MAX, &line),
+                          HTTP_LINE_PARSER_LINE);
+    AVS_UNIT_ASSERT_TRUE(line.data == input);
+    AVS_UNIT_ASSERT_EQUAL(line.size, strlen("Key: value"));
+    ASSERT_NEXT_LINE(&env, SIZE_MAX, HTTP_LINE_PARSER_LINE, "Other:x");
+    ASSERT_NEXT_LINE(&env, SIZE_MAX, HTTP_LINE_PARSER_LINE, "");
+    AVS_UNIT_ASSERT_EQUAL(env.size, 0);
+    AVS_UNIT_ASSERT_FALSE(_avs_http_line_parser_has_partial_line(&env.parser));
+}
+
+AVS_UNIT_TEST(http_line_parser, byte_by_byte) {
+    line_parser_test_env_t env;
+    setup_line_parser(&env, "Key: value\r\nOther:x\n\r\n");
+    ASSERT_NEXT_LINE(&env, 1, HTTP_LINE_PARSER_LINE, "Key: value");
+    ASSERT_NEXT_LINE(&env, 1, HTTP_LINE_PARSER_LINE, "Other:x");
+    ASSERT_NEXT_LINE(&env, 1, HTTP_LINE_PARSER_LINE, "");
+    AVS_UNIT_ASSERT_EQUAL(env.size, 0);
+}
+
+AVS_UNIT_TEST(http_line_parser, partial_line) {
+    line_parser_test_env_t env;
+    setup_line_parser(&env, "Key: val");
+    http_line_t line;
+    AVS_UNIT_ASSERT_EQUAL(next_line(&env, 3, &line),
+                          HTTP_LINE_PARSER_NEED_MORE);
+    AVS_UNIT_ASSERT_TRUE(_avs_http_line_parser_has_partial_line(&env.parser));
+    // parsing is resumed when more data arrives
+    env.data = "ue\r\n";
+    env.size = strlen(env.data);
+    ASSERT_NEXT_LINE(&env, SIZE_MAX, HTTP_LINE_PARSER_LINE, "Key: value");
+    AVS_UNIT_ASSERT_FALSE(_avs_http_line_parser_has_partial_line(&env.parser));
+}
+
+AVS_UNIT_TEST(http_line_parser, too_long) {
+    static const size_t CHUNK_SIZES[] = { 1, 5, SIZE_MAX };
+    for (size_t i = 0; i < AVS_ARRAY_SIZE(CHUNK_SIZES); ++i) {
+        line_parser_test_env_t env;
+        setup_line_parser(&env,
+                          "1234567890123456\r\n"
+                          "This line is way too long\r\n"
+                          "12345678901234\n");
+        ASSERT_NEXT_LINE(&env, CHUNK_SIZES[i], HTTP_LINE_PARSER_LINE_TOO_LONG,
+                         "123456789012345");
+        ASSERT_NEXT_LINE(&env, CHUNK_SIZES[i], HTTP_LINE_PARSER_LINE_TOO_LONG,
+                         "This line is wa");
+        ASSERT_NEXT_LINE(&env, CHUNK_SIZES[i], HTTP_LINE_PARSER_LINE,
+                         "12345678901234");
+        AVS_UNIT_ASSERT_EQUAL(env.size, 0);
+    }
+}
+
+AVS_UNIT_TEST(http_line_parser, longest_line) {
+    // chunk sizes of 16 and 17 split the first line between '\r' and '\n'
+    static const size_t CHUNK_SIZES[] = { 1, 5, 15, 16, 17, SIZE_MAX };
+    for (size_t i = 0; i < AVS_ARRAY_SIZE(CHUNK_SIZES); ++i) {
+        line_parser_test_env_t env;
+        setup_line_parser(&env,
+                          "123456789012345\r\n"
+                          "abcdefghijklmno\n"
+                          "123456789012345\r6\r\n"
+                          "end\n");
+        ASSERT_NEXT_LINE(&env, CHUNK_SIZES[i], HTTP_LINE_PARSER_LINE,
+                         "123456789012345");
+        ASSERT_NEXT_LINE(&env, CHUNK_SIZES[i], HTTP_LINE_PARSER_LINE,
+                         "abcdefghijklmno");
+        // '\r' inside the line counts towards its length
+        ASSERT_NEXT_LINE(&env, CHUNK_SIZES[i], HTTP_LINE_PARSER_LINE_TOO_LONG,
+                         "123456789012345");
+        ASSERT_NEXT_LINE(&env, CHUNK_SIZES[i], HTTP_LINE_PARSER_LINE, "end");
+        AVS_UNIT_ASSERT_EQUAL(env.size, 0);
+    }
+}
+
+AVS_UNIT_TEST(http_line_parser, split_header) {
+    http_header_span_t header;
+    http_line_t line = { "Content-Length: \t 42", 20 };
+    AVS_UNIT_ASSERT_TRUE(_avs_http_split_header(&line, &header));
+    AVS_UNIT_ASSERT_TRUE(header.key == line.data);
+    AVS_UNIT_ASSERT_EQUAL(header.key_len, strlen("Content-Length"));
+    AVS_UNIT_ASSERT_EQUAL(header.value_len, 2);
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(header.value, "42", 2);
+
+    line = (http_line_t) { "X-Empty:", 8 };
+    AVS_UNIT_ASSERT_TRUE(_avs_http_split_header(&line, &header));
+    AVS_UNIT_ASSERT_EQUAL(header.key_len, strlen("X-Empty"));
+    AVS_UNIT_ASSERT_EQUAL(header.value_len, 0);
+
+    line = (http_line_t) { "No colon here", 13 };
+    AVS_UNIT_ASSERT_FALSE(_avs_http_split_header(&line, &header));
+}
@@ -0,0 +1,316 @@
+/*
+ * Copyright 2023 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <avsystem/commons/avs_http.h>
+#include <avsystem/commons/avs_unit_mocksock.h>
+#include <avsystem/commons/avs_unit_test.h>
+
+#include "test_http.h"
+
+#define PIPELINE_TEST_REQUEST(Body)   \
+    "POST / HTTP/1.1\r\n"             \
+    "Host: example.com\r\n"           \
+    TEST_ACCEPT_ENCODING              \
+    "Content-Length: 1\r\n"           \
+    "\r\n" Body
+
+#define PIPELINE_TEST_RESPONSE(Body) \
+    "HTTP/1.1 200 OK\r\n"            \
+    "Content-Length: 1\r\n"          \
+    "\r\n" Body
+
+typedef struct {
+    avs_http_t *client;
+    avs_net_socket_t *socket;
+    avs_stream_t *stream;
+} pipelining_test_env_t;
+
+static void setup_pipelining(pipelining_test_env_t *env,
+                             const avs_http_buffer_sizes_t *buffer_sizes) {
+    AVS_UNIT_ASSERT_NOT_NULL((env->client = avs_http_new(buffer_sizes)));
+    env->socket = NULL;
+    avs_unit_mocksock_create(&env->socket);
+    avs_http_test_expect_create_socket(env->socket, AVS_NET_TCP_SOCKET);
+    avs_unit_mocksock_expect_connect(env->socket, "example.com", "80");
+    avs_url_t *url = avs_url_parse("http://example.com/");
+    AVS_UNIT_ASSERT_NOT_NULL(url);
+    env->stream = NULL;
+    AVS_UNIT_ASSERT_SUCCESS(avs_http_open_stream(&env->stream, env->client,
+                                                 AVS_HTTP_POST,
+                                                 AVS_HTTP_CONTENT_IDENTITY, url,
+                                                 NULL, NULL));
+    avs_url_free(url);
+    AVS_UNIT_ASSERT_SUCCESS(avs_http_set_pipelining(env->stream, true));
+}
+
+static void teardown_pipelining(pipelining_test_env_t *env) {
+    avs_unit_mocksock_assert_io_clean(env->socket);
+    avs_unit_mocksock_expect_shutdown(env->socket);
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_cleanup(&env->stream));
+    avs_http_free(env->client);
+}
+
+static void expect_test_output(pipelining_test_env_t *env, const char *data) {
+    avs_unit_mocksock_expect_output(env->socket, data, strlen(data));
+}
+
+static void test_input(pipelining_test_env_t *env, const char *data) {
+    avs_unit_mocksock_input(env->socket, data, strlen(data));
+}
+
+static void send_test_request(pipelining_test_env_t *env, const char *body) {
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_write(env->stream, body, strlen(body)));
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_finish_message(env->stream));
+}
+
+static void receive_test_response(pipelining_test_env_t *env,
+                                  const char *body) {
+    AVS_UNIT_ASSERT_SUCCESS(avs_http_receive_response(env->stream));
+    char buffer[16];
+    size_t buffer_pos = 0;
+    bool message_finished = false;
+    while (!message_finished) {
+        size_t bytes_read;
+        AVS_UNIT_ASSERT_SUCCESS(avs_stream_read(
+                env->stream, &bytes_read, &message_finished,
+                buffer + buffer_pos, sizeof(buffer) - buffer_pos));
+        buffer_pos += bytes_read;
+    }
+    AVS_UNIT_ASSERT_EQUAL(buffer_pos, strlen(body));
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(buffer, body, buffer_pos);
+}
+
+/* performs a complete exchange, after which the server may close the
+ * connection at any time */
+static void complete_exchange(pipelining_test_env_t *env) {
+    expect_test_output(env, PIPELINE_TEST_REQUEST("0"));
+    send_test_request(env, "0");
+    test_input(env, PIPELINE_TEST_RESPONSE("0"));
+    receive_test_response(env, "0");
+    avs_unit_mocksock_assert_io_clean(env->socket);
+}
+
+AVS_UNIT_TEST(http_pipelining, responses_in_order) {
+    pipelining_test_env_t env;
+    setup_pipelining(&env, &AVS_HTTP_DEFAULT_BUFFER_SIZES);
+    char value[] = "first";
+    AVS_UNIT_ASSERT_SUCCESS(avs_http_add_header(env.stream, "X-Id", value));
+    expect_test_output(&env, "POST / HTTP/1.1\r\n"
+                             "Host: example.com\r\n"
+                             TEST_ACCEPT_ENCODING
+                             "X-Id: first\r\n"
+                             "Content-Length: 1\r\n"
+                             "\r\n"
+                             "a");
+    send_test_request(&env, "a");
+    // the header value is copied
+    memcpy(value, "wrong", sizeof(value));
+    expect_test_output(&env, PIPELINE_TEST_REQUEST("b"));
+    send_test_request(&env, "b");
+    AVS_UNIT_ASSERT_EQUAL(avs_http_pending_responses(env.stream), 2);
+    const http_pipelined_request_t *request =
+            ((http_stream_t *) env.stream)->pipeline;
+    AVS_UNIT_ASSERT_EQUAL(AVS_LIST_SIZE(request->user_headers), 1);
+    AVS_UNIT_ASSERT_EQUAL_STRING(request->user_headers->value, "first");
+
+    test_input(&env, "HTTP/1.1 200 OK\r\n"
+                     "Transfer-Encoding: chunked\r\n"
+                     "\r\n"
+                     "1\r\n"
+                     "A\r\n"
+                     "0\r\n"
+                     "\r\n" PIPELINE_TEST_RESPONSE("B"));
+    receive_test_response(&env, "A");
+    AVS_UNIT_ASSERT_EQUAL(avs_http_pending_responses(env.stream), 1);
+    receive_test_response(&env, "B");
+    AVS_UNIT_ASSERT_EQUAL(avs_http_pending_responses(env.stream), 0);
+
+    avs_error_t err = avs_http_receive_response(env.stream);
+    AVS_UNIT_ASSERT_EQUAL(err.category, AVS_ERRNO_CATEGORY);
+    AVS_UNIT_ASSERT_EQUAL(err.code, AVS_ENOENT);
+    teardown_pipelining(&env);
+}
+
+AVS_UNIT_TEST(http_pipelining, unread_body) {
+    pipelining_test_env_t env;
+    setup_pipelining(&env, &AVS_HTTP_DEFAULT_BUFFER_SIZES);
+    expect_test_output(&env, PIPELINE_TEST_REQUEST("a"));
+    send_test_request(&env, "a");
+    expect_test_output(&env, PIPELINE_TEST_REQUEST("b"));
+    send_test_request(&env, "b");
+    test_input(&env, PIPELINE_TEST_RESPONSE("A"));
+    AVS_UNIT_ASSERT_SUCCESS(avs_http_receive_response(env.stream));
+    avs_error_t err = avs_http_receive_response(env.stream);
+    AVS_UNIT_ASSERT_EQUAL(err.category, AVS_ERRNO_CATEGORY);
+    AVS_UNIT_ASSERT_EQUAL(err.code, AVS_EBUSY);
+    AVS_UNIT_ASSERT_FAILED(avs_http_set_pipelining(env.stream, false));
+    teardown_pipelining(&env);
+}
+
+AVS_UNIT_TEST(http_pipelining, chunk_boundary_not_read_ahead) {
+    pipelining_test_env_t env;
+    setup_pipelining(&env, &AVS_HTTP_DEFAULT_BUFFER_SIZES);
+    expect_test_output(&env, PIPELINE_TEST_REQUEST("a"));
+    send_test_request(&env, "a");
+    expect_test_output(&env, PIPELINE_TEST_REQUEST("b"));
+    send_test_request(&env, "b");
+    test_input(&env, "HTTP/1.1 200 OK\r\n"
+                     "Transfer-Encoding: chunked\r\n"
+                     "\r\n"
+                     "1\r\n"
+                     "A\r\n");
+    AVS_UNIT_ASSERT_SUCCESS(avs_http_receive_response(env.stream));
+    char buffer[16];
+    size_t bytes_read;
+    bool message_finished;
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_read(env.stream, &bytes_read,
+                                            &message_finished, buffer,
+                                            sizeof(buffer)));
+    AVS_UNIT_ASSERT_EQUAL(bytes_read, 1);
+    AVS_UNIT_ASSERT_FALSE(message_finished);
+
+    // the end of the body is not known yet; checking it must not read from
+    // the socket, as that might block
+    test_input(&env, "0\r\n"
+                     "\r\n" PIPELINE_TEST_RESPONSE("B"));
+    avs_error_t err = avs_http_receive_response(env.stream);
+    AVS_UNIT_ASSERT_EQUAL(err.category, AVS_ERRNO_CATEGORY);
+    AVS_UNIT_ASSERT_EQUAL(err.code, AVS_EBUSY);
+
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_read(env.stream, &bytes_read,
+                                            &message_finished, buffer,
+                                            sizeof(buffer)));
+    AVS_UNIT_ASSERT_EQUAL(bytes_read, 0);
+    AVS_UNIT_ASSERT_TRUE(message_finished);
+    receive_test_response(&env, "B");
+    teardown_pipelining(&env);
+}
+
+#ifdef AVS_COMMONS_HTTP_WITH_ZLIB
+AVS_UNIT_TEST(http_pipelining, gzipped_chunked_responses) {
+    pipelining_test_env_t env;
+    setup_pipelining(&env, &AVS_HTTP_DEFAULT_BUFFER_SIZES);
+    expect_test_output(&env, PIPELINE_TEST_REQUEST("a"));
+    send_test_request(&env, "a");
+    expect_test_output(&env, PIPELINE_TEST_REQUEST("b"));
+    send_test_request(&env, "b");
+    // the compressed data ends before the terminating chunk, and the next
+    // response is already buffered at that point
+    const char responses[] = TEST_GZIPPED_CHUNKED_OK_RESPONSE
+            TEST_GZIPPED_CHUNKED_OK_RESPONSE;
+    avs_unit_mocksock_input(env.socket, responses, sizeof(responses) - 1);
+    receive_test_response(&env, "ok");
+    receive_test_response(&env, "ok");
+    AVS_UNIT_ASSERT_EQUAL(avs_http_pending_responses(env.stream), 0);
+    teardown_pipelining(&env);
+}
+#endif // AVS_COMMONS_HTTP_WITH_ZLIB
+
+AVS_UNIT_TEST(http_pipelining, error_responses) {
+    pipelining_test_env_t env;
+    setup_pipelining(&env, &AVS_HTTP_DEFAULT_BUFFER_SIZES);
+    for (int i = 0; i < 3; ++i) {
+        expect_test_output(&env, PIPELINE_TEST_REQUEST("a"));
+        send_test_request(&env, "a");
+    }
+    test_input(&env, "HTTP/1.1 404 Not Found\r\n"
+                     "Content-Length: 9\r\n"
+                     "\r\n"
+                     "not found"
+                     "HTTP/1.1 301 Moved Permanently\r\n"
+                     "Location: http://example.org/\r\n"
+                     "Content-Length: 0\r\n"
+                     "\r\n" PIPELINE_TEST_RESPONSE("A"));
+    avs_error_t err = avs_http_receive_response(env.stream);
+    AVS_UNIT_ASSERT_EQUAL(err.category, AVS_HTTP_ERROR_CATEGORY);
+    AVS_UNIT_ASSERT_EQUAL(err.code, 404);
+    // redirects are not followed, as the next request is already sent
+    err = avs_http_receive_response(env.stream);
+    AVS_UNIT_ASSERT_EQUAL(err.category, AVS_HTTP_ERROR_CATEGORY);
+    AVS_UNIT_ASSERT_EQUAL(err.code, 301);
+    receive_test_response(&env, "A");
+    teardown_pipelining(&env);
+}
+
+AVS_UNIT_TEST(http_pipelining, replay_after_close_when_receiving) {
+    pipelining_test_env_t env;
+    setup_pipelining(&env, &AVS_HTTP_DEFAULT_BUFFER_SIZES);
+    complete_exchange(&env);
+
+    expect_test_output(&env, PIPELINE_TEST_REQUEST("a"));
+    send_test_request(&env, "a");
+    expect_test_output(&env, PIPELINE_TEST_REQUEST("b"));
+    send_test_request(&env, "b");
+    avs_unit_mocksock_input(env.socket, NULL, 0); // EOF
+    avs_unit_mocksock_expect_mid_close(env.socket);
+    avs_unit_mocksock_expect_connect(env.socket, "example.com", "80");
+    expect_test_output(&env,
+                       PIPELINE_TEST_REQUEST("a") PIPELINE_TEST_REQUEST("b"));
+    test_input(&env, PIPELINE_TEST_RESPONSE("A") PIPELINE_TEST_RESPONSE("B"));
+    receive_test_response(&env, "A");
+    receive_test_response(&env, "B");
+    teardown_pipelining(&env);
+}
+
+AVS_UNIT_TEST(http_pipelining, replay_after_close_when_sending) {
+    pipelining_test_env_t env;
+    setup_pipelining(&env, &AVS_HTTP_DEFAULT_BUFFER_SIZES);
+    complete_exchange(&env);
+
+    expect_test_output(&env, PIPELINE_TEST_REQUEST("a"));
+    send_test_request(&env, "a");
+    avs_unit_mocksock_output_fail(env.socket, avs_errno(AVS_EPIPE));
+    avs_unit_mocksock_expect_mid_close(env.socket);
+    avs_unit_mocksock_expect_connect(env.socket, "example.com", "80");
+    expect_test_output(&env,
+                       PIPELINE_TEST_REQUEST("a") PIPELINE_TEST_REQUEST("b"));
+    send_test_request(&env, "b");
+    AVS_UNIT_ASSERT_EQUAL(avs_http_pending_responses(env.stream), 2);
+    test_input(&env, PIPELINE_TEST_RESPONSE("A") PIPELINE_TEST_RESPONSE("B"));
+    receive_test_response(&env, "A");
+    receive_test_response(&env, "B");
+    teardown_pipelining(&env);
+}
+
+AVS_UNIT_TEST(http_pipelining, reset_drops_pending_requests) {
+    pipelining_test_env_t env;
+    setup_pipelining(&env, &AVS_HTTP_DEFAULT_BUFFER_SIZES);
+    expect_test_output(&env, PIPELINE_TEST_REQUEST("a"));
+    send_test_request(&env, "a");
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_reset(env.stream));
+    AVS_UNIT_ASSERT_EQUAL(avs_http_pending_responses(env.stream), 0);
+
+    // the response to the dropped request must not be taken for the next one
+    avs_unit_mocksock_expect_mid_close(env.socket);
+    avs_unit_mocksock_expect_connect(env.socket, "example.com", "80");
+    expect_test_output(&env, PIPELINE_TEST_REQUEST("b"));
+    send_test_request(&env, "b");
+    test_input(&env, PIPELINE_TEST_RESPONSE("B"));
+    receive_test_response(&env, "B");
+    teardown_pipelining(&env);
+}
+
+AVS_UNIT_TEST(http_pipelining, body_too_big) {
+    avs_http_buffer_sizes_t buffer_sizes = AVS_HTTP_DEFAULT_BUFFER_SIZES;
+    buffer_sizes.body_send = 4;
+    pipelining_test_env_t env;
+    setup_pipelining(&env, &buffer_sizes);
+    avs_error_t err = avs_stream_write(env.stream, "too long", 8);
+    AVS_UNIT_ASSERT_EQUAL(err.category, AVS_ERRNO_CATEGORY);
+    AVS_UNIT_ASSERT_EQUAL(err.code, AVS_EMSGSIZE);
+    AVS_UNIT_ASSERT_EQUAL(avs_http_pending_responses(env.stream), 0);
+    teardown_pipelining(&env);
+}
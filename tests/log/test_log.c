@@ -19,6 +19,13 @@
 
 #include <stdlib.h>
 
+/* provides the external definition of the inline function */
+extern int avs_log_test_inline_function(int value);
+#include "tests/log/test_log_inline.h"
+
+/* defined in tests/log/test_log_inline.c */
+int avs_log_test_call_inline_function(int value);
+
 static avs_log_level_t EXPECTED_LEVEL;
 static char EXPECTED_MODULE[64];
 static char EXPECTED_FILE[256];
@@ -92,8 +99,7 @@ AVS_UNIT_GLOBAL_INIT(verbose) {
     AVS_UNIT_ASSERT_TRUE(g_log.handler.normal == default_log_handler);
     AVS_UNIT_ASSERT_FALSE(g_log.is_extended_handler);
 #ifndef AVS_LOGS_CHECKED_DURING_COMPILE_TIME
-    AVS_UNIT_ASSERT_EQUAL(g_log.default_level, AVS_LOG_INFO);
-    AVS_UNIT_ASSERT_TRUE(g_log.module_levels == NULL);
+    AVS_UNIT_ASSERT_NULL(LEVELS_LOAD(&g_log.levels));
 #endif /*AVS_LOGS_CHECKED_DURING_COMPILE_TIME*/
     reset_everything();
 }
@@ -294,6 +300,173 @@ AVS_UNIT_TEST(log, module_levels) {
 #endif /*AVS_LOGS_CHECKED_DURING_COMPILE_TIME*/
 }
 
+#ifndef AVS_LOGS_CHECKED_DURING_COMPILE_TIME
+AVS_UNIT_TEST(log, module_levels_snapshot) {
+    static const char *const MODULES[] = { "mod_d", "mod_b", "mod_f", "mod_a",
+                                           "mod_e", "mod_c" };
+    for (size_t i = 0; i < AVS_ARRAY_SIZE(MODULES); ++i) {
+        AVS_UNIT_ASSERT_SUCCESS(avs_log_set_level__(MODULES[i], AVS_LOG_ERROR));
+    }
+    AVS_UNIT_ASSERT_SUCCESS(avs_log_set_level__("mod_c", AVS_LOG_DEBUG));
+    AVS_UNIT_ASSERT_SUCCESS(avs_log_set_level__(NULL, AVS_LOG_WARNING));
+
+    const log_levels_t *levels = LEVELS_LOAD(&g_log.levels);
+    // modules configured by other tests are kept after resets
+    AVS_UNIT_ASSERT_TRUE(levels->module_count >= AVS_ARRAY_SIZE(MODULES));
+    for (size_t i = 1; i < levels->module_count; ++i) {
+        AVS_UNIT_ASSERT_TRUE(module_cmp(&levels->modules[i - 1],
+                                        levels->modules[i].hash,
+                                        levels->modules[i].module)
+                             < 0);
+    }
+
+    for (size_t i = 0; i < AVS_ARRAY_SIZE(MODULES); ++i) {
+        AVS_UNIT_ASSERT_EQUAL(avs_log_should_log__(AVS_LOG_WARNING, MODULES[i]),
+                              strcmp(MODULES[i], "mod_c") == 0);
+        AVS_UNIT_ASSERT_TRUE(avs_log_should_log__(AVS_LOG_ERROR, MODULES[i]));
+    }
+    AVS_UNIT_ASSERT_TRUE(avs_log_should_log__(AVS_LOG_DEBUG, "mod_c"));
+    AVS_UNIT_ASSERT_FALSE(avs_log_should_log__(AVS_LOG_INFO, "mod_0"));
+    AVS_UNIT_ASSERT_TRUE(avs_log_should_log__(AVS_LOG_WARNING, "mod_z"));
+
+    reset_everything();
+    AVS_UNIT_ASSERT_TRUE(avs_log_should_log__(AVS_LOG_INFO, "mod_a"));
+    AVS_UNIT_ASSERT_FALSE(avs_log_should_log__(AVS_LOG_DEBUG, "mod_c"));
+    AVS_UNIT_ASSERT_TRUE(avs_log_should_log__(AVS_LOG_INFO, "mod_z"));
+}
+
+AVS_UNIT_TEST(log, module_levels_updated_in_place) {
+    AVS_UNIT_ASSERT_SUCCESS(avs_log_set_level__("inplace_a", AVS_LOG_ERROR));
+    const log_levels_t *levels = LEVELS_LOAD(&g_log.levels);
+    AVS_UNIT_ASSERT_NOT_NULL(levels);
+#    ifdef AVS_LOG_LOCK_FREE_LEVELS
+    const log_levels_t *retired = g_log.retired_levels;
+#    endif // AVS_LOG_LOCK_FREE_LEVELS
+
+    // changing levels of known modules does not create new snapshots
+    for (int i = 0; i < 100; ++i) {
+        AVS_UNIT_ASSERT_SUCCESS(avs_log_set_level__(
+                "inplace_a", i % 2 ? AVS_LOG_ERROR : AVS_LOG_DEBUG));
+        AVS_UNIT_ASSERT_SUCCESS(avs_log_set_level__(
+                NULL, i % 2 ? AVS_LOG_WARNING : AVS_LOG_INFO));
+        AVS_UNIT_ASSERT_TRUE(LEVELS_LOAD(&g_log.levels) == levels);
+    }
+    AVS_UNIT_ASSERT_TRUE(avs_log_should_log__(AVS_LOG_ERROR, "inplace_a"));
+    AVS_UNIT_ASSERT_FALSE(avs_log_should_log__(AVS_LOG_DEBUG, "inplace_a"));
+    AVS_UNIT_ASSERT_FALSE(avs_log_should_log__(AVS_LOG_INFO, "inplace_b"));
+
+    // adding a module does, and the replaced one is retired
+    AVS_UNIT_ASSERT_SUCCESS(avs_log_set_level__("inplace_b", AVS_LOG_DEBUG));
+    AVS_UNIT_ASSERT_TRUE(LEVELS_LOAD(&g_log.levels) != levels);
+#    ifdef AVS_LOG_LOCK_FREE_LEVELS
+    AVS_UNIT_ASSERT_TRUE(g_log.retired_levels == levels);
+    AVS_UNIT_ASSERT_TRUE(g_log.retired_levels->retired_next == retired);
+#    endif // AVS_LOG_LOCK_FREE_LEVELS
+    AVS_UNIT_ASSERT_TRUE(avs_log_should_log__(AVS_LOG_ERROR, "inplace_a"));
+    AVS_UNIT_ASSERT_FALSE(avs_log_should_log__(AVS_LOG_DEBUG, "inplace_a"));
+    AVS_UNIT_ASSERT_TRUE(avs_log_should_log__(AVS_LOG_DEBUG, "inplace_b"));
+    AVS_UNIT_ASSERT_FALSE(avs_log_should_log__(AVS_LOG_INFO, "inplace_c"));
+
+    // known modules are kept after a reset, but use the default level
+    reset_everything();
+    levels = LEVELS_LOAD(&g_log.levels);
+    AVS_UNIT_ASSERT_TRUE(avs_log_should_log__(AVS_LOG_INFO, "inplace_a"));
+    AVS_UNIT_ASSERT_FALSE(avs_log_should_log__(AVS_LOG_DEBUG, "inplace_b"));
+    AVS_UNIT_ASSERT_SUCCESS(avs_log_set_level__("inplace_b", AVS_LOG_ERROR));
+    AVS_UNIT_ASSERT_TRUE(LEVELS_LOAD(&g_log.levels) == levels);
+    AVS_UNIT_ASSERT_FALSE(avs_log_should_log__(AVS_LOG_WARNING, "inplace_b"));
+    AVS_UNIT_ASSERT_TRUE(avs_log_should_log__(AVS_LOG_WARNING, "inplace_a"));
+
+    reset_everything();
+}
+
+static int g_evaluated_args;
+static int g_logged_messages;
+
+static int evaluated_arg(void) {
+    return ++g_evaluated_args;
+}
+
+static void counting_handler(avs_log_level_t level,
+                             const char *module,
+                             const char *message) {
+    (void) level;
+    (void) message;
+    AVS_UNIT_ASSERT_EQUAL_STRING(module, "cached_module");
+    ++g_logged_messages;
+}
+
+static void log_from_call_sites(void) {
+    avs_log(cached_module, DEBUG, "Call site %d", evaluated_arg());
+    avs_log(cached_module, LAZY_DEBUG, "Lazy call site %d", evaluated_arg());
+}
+
+AVS_UNIT_TEST(log, call_site_cache) {
+    avs_log_set_handler(counting_handler);
+    g_evaluated_args = 0;
+    g_logged_messages = 0;
+
+    log_from_call_sites();
+    log_from_call_sites();
+    // non-lazy arguments are evaluated even if the message is discarded
+    AVS_UNIT_ASSERT_EQUAL(g_evaluated_args, 2);
+    AVS_UNIT_ASSERT_EQUAL(g_logged_messages, 0);
+
+    // results cached at call sites shall be invalidated by level changes
+    avs_log_set_level(cached_module, AVS_LOG_DEBUG);
+    log_from_call_sites();
+    AVS_UNIT_ASSERT_EQUAL(g_evaluated_args, 4);
+    AVS_UNIT_ASSERT_EQUAL(g_logged_messages, 2);
+
+    avs_log_set_level(cached_module, AVS_LOG_INFO);
+    log_from_call_sites();
+    AVS_UNIT_ASSERT_EQUAL(g_evaluated_args, 5);
+    AVS_UNIT_ASSERT_EQUAL(g_logged_messages, 2);
+
+    avs_log_set_default_level(AVS_LOG_TRACE);
+    log_from_call_sites();
+    AVS_UNIT_ASSERT_EQUAL(g_evaluated_args, 6);
+    AVS_UNIT_ASSERT_EQUAL(g_logged_messages, 2);
+
+    reset_everything();
+    avs_log_set_handler(counting_handler);
+    avs_log_set_default_level(AVS_LOG_DEBUG);
+    log_from_call_sites();
+    AVS_UNIT_ASSERT_EQUAL(g_evaluated_args, 8);
+    AVS_UNIT_ASSERT_EQUAL(g_logged_messages, 4);
+
+    reset_everything();
+}
+
+static int g_inline_logged_messages;
+
+static void inline_counting_handler(avs_log_level_t level,
+                                    const char *module,
+                                    const char *message) {
+    (void) level;
+    (void) message;
+    AVS_UNIT_ASSERT_EQUAL_STRING(module, "inline_module");
+    ++g_inline_logged_messages;
+}
+
+AVS_UNIT_TEST(log, inline_function) {
+    avs_log_set_handler(inline_counting_handler);
+    g_inline_logged_messages = 0;
+
+    avs_log_set_level(inline_module, AVS_LOG_DEBUG);
+    AVS_UNIT_ASSERT_EQUAL(avs_log_test_inline_function(1), 1);
+    AVS_UNIT_ASSERT_EQUAL(avs_log_test_call_inline_function(2), 2);
+    AVS_UNIT_ASSERT_EQUAL(g_inline_logged_messages, 2);
+
+    avs_log_set_level(inline_module, AVS_LOG_INFO);
+    AVS_UNIT_ASSERT_EQUAL(avs_log_test_inline_function(3), 3);
+    AVS_UNIT_ASSERT_EQUAL(avs_log_test_call_inline_function(4), 4);
+    AVS_UNIT_ASSERT_EQUAL(g_inline_logged_messages, 2);
+
+    reset_everything();
+}
+#endif /*AVS_LOGS_CHECKED_DURING_COMPILE_TIME*/
+
 static int fail(void) {
     AVS_UNIT_ASSERT_TRUE(0);
     return -1;
@@ -441,3 +614,417 @@ AVS_UNIT_TEST(log, extended) {
 #    define AVS_LOG_LEVEL_DEFAULT INFO
 #endif /*AVS_LOGS_CHECKED_DURING_COMPILE_TIME*/
 }
+
+#ifdef AVS_LOG_WITH_ASYNC
+#    include <pthread.h>
+#    include <sched.h>
+
+#    define ASYNC_MAX_RECORDED 256
+
+static struct {
+    size_t count;
+    char messages[ASYNC_MAX_RECORDED][64];
+} g_recorded;
+
+static void recording_handler(avs_log_level_t level,
+                              const char *module,
+                              const char *file,
+                              unsigned line,
+                              const char *message) {
+    (void) level;
+    (void) module;
+    (void) file;
+    (void) line;
+    AVS_UNIT_ASSERT_TRUE(g_recorded.count < ASYNC_MAX_RECORDED);
+    snprintf(g_recorded.messages[g_recorded.count],
+             sizeof(g_recorded.messages[g_recorded.count]), "%s", message);
+    ++g_recorded.count;
+}
+
+static void async_setup(size_t queue_size,
+                        avs_log_async_overflow_policy_t policy) {
+    const avs_log_async_config_t config = {
+        .queue_size = queue_size,
+        .overflow_policy = policy
+    };
+    memset(&g_recorded, 0, sizeof(g_recorded));
+    avs_log_set_extended_handler(recording_handler);
+    AVS_UNIT_ASSERT_SUCCESS(avs_log_async_enable(&config));
+}
+
+AVS_UNIT_TEST(log_async, drop) {
+    async_setup(4, AVS_LOG_ASYNC_OVERFLOW_DROP);
+    for (int i = 0; i < 6; ++i) {
+        avs_log(test, INFO, "message %d", i);
+    }
+    AVS_UNIT_ASSERT_EQUAL(g_recorded.count, 0);
+    avs_log_async_flush();
+    AVS_UNIT_ASSERT_EQUAL(g_recorded.count, 4);
+    AVS_UNIT_ASSERT_EQUAL_STRING(g_recorded.messages[0], "message 0");
+    AVS_UNIT_ASSERT_EQUAL_STRING(g_recorded.messages[3], "message 3");
+    AVS_UNIT_ASSERT_EQUAL(avs_log_async_dropped_count(), 2);
+
+    // queue is usable again after flushing
+    avs_log(test, INFO, "message %d", 6);
+    avs_log_async_disable();
+    AVS_UNIT_ASSERT_EQUAL(g_recorded.count, 5);
+    AVS_UNIT_ASSERT_EQUAL_STRING(g_recorded.messages[4], "message 6");
+    AVS_UNIT_ASSERT_EQUAL(avs_log_async_dropped_count(), 2);
+
+    // logging is synchronous after disabling
+    avs_log(test, INFO, "message %d", 7);
+    AVS_UNIT_ASSERT_EQUAL(g_recorded.count, 6);
+    reset_everything();
+}
+
+AVS_UNIT_TEST(log_async, count) {
+    async_setup(2, AVS_LOG_ASYNC_OVERFLOW_COUNT);
+    for (int i = 0; i < 5; ++i) {
+        avs_log(test, INFO, "message %d", i);
+    }
+    avs_log_async_flush();
+    AVS_UNIT_ASSERT_EQUAL(g_recorded.count, 3);
+    AVS_UNIT_ASSERT_EQUAL_STRING(g_recorded.messages[0], "message 0");
+    AVS_UNIT_ASSERT_EQUAL_STRING(g_recorded.messages[1], "message 1");
+    AVS_UNIT_ASSERT_EQUAL_STRING(g_recorded.messages[2],
+                                 "3 log messages dropped due to full queue");
+
+    // dropped messages are reported only once
+    avs_log_async_flush();
+    AVS_UNIT_ASSERT_EQUAL(g_recorded.count, 3);
+    reset_everything();
+}
+
+AVS_UNIT_TEST(log_async, block) {
+    async_setup(2, AVS_LOG_ASYNC_OVERFLOW_BLOCK);
+    for (int i = 0; i < 5; ++i) {
+        avs_log(test, INFO, "message %d", i);
+    }
+    // without a delivery thread, the logging thread delivers messages itself
+    AVS_UNIT_ASSERT_EQUAL(g_recorded.count, 4);
+    avs_log_reset();
+    AVS_UNIT_ASSERT_EQUAL(g_recorded.count, 5);
+    for (int i = 0; i < 5; ++i) {
+        char expected[64];
+        snprintf(expected, sizeof(expected), "message %d", i);
+        AVS_UNIT_ASSERT_EQUAL_STRING(g_recorded.messages[i], expected);
+    }
+    AVS_UNIT_ASSERT_EQUAL(avs_log_async_dropped_count(), 0);
+    reset_everything();
+}
+
+static void *async_block_thread(void *unused) {
+    (void) unused;
+    for (int i = 0; i < 64; ++i) {
+        avs_log(test, INFO, "message %d", i);
+    }
+    return NULL;
+}
+
+AVS_UNIT_TEST(log_async, block_concurrent) {
+    async_setup(2, AVS_LOG_ASYNC_OVERFLOW_BLOCK);
+    pthread_t threads[4];
+    for (size_t i = 0; i < AVS_ARRAY_SIZE(threads); ++i) {
+        AVS_UNIT_ASSERT_SUCCESS(
+                pthread_create(&threads[i], NULL, async_block_thread, NULL));
+    }
+    for (size_t i = 0; i < AVS_ARRAY_SIZE(threads); ++i) {
+        AVS_UNIT_ASSERT_SUCCESS(pthread_join(threads[i], NULL));
+    }
+    avs_log_async_disable();
+    AVS_UNIT_ASSERT_EQUAL(g_recorded.count, 4 * 64);
+    AVS_UNIT_ASSERT_EQUAL(avs_log_async_dropped_count(), 0);
+    reset_everything();
+}
+
+AVS_UNIT_TEST(log_async, queues_reclaimed) {
+    for (int i = 0; i < 3; ++i) {
+        async_setup(4, AVS_LOG_ASYNC_OVERFLOW_DROP);
+        for (int j = 0; j < 6; ++j) {
+            avs_log(test, INFO, "message %d", j);
+        }
+        avs_log_async_disable();
+        AVS_UNIT_ASSERT_NULL(g_log.retired_async);
+        // dropped count is still available after the queue is freed
+        AVS_UNIT_ASSERT_EQUAL(avs_log_async_dropped_count(), 2);
+    }
+    reset_everything();
+}
+
+AVS_UNIT_TEST(log_async, already_enabled) {
+    async_setup(0, AVS_LOG_ASYNC_OVERFLOW_BLOCK);
+    AVS_UNIT_ASSERT_FAILED(avs_log_async_enable(NULL));
+    reset_everything();
+    AVS_UNIT_ASSERT_FAILED(avs_log_async_run());
+}
+
+static void *async_run_thread(void *result) {
+    *(int *) result = avs_log_async_run();
+    return NULL;
+}
+
+AVS_UNIT_TEST(log_async, delivery_thread) {
+    async_setup(8, AVS_LOG_ASYNC_OVERFLOW_BLOCK);
+    pthread_t thread;
+    int run_result = -1;
+    AVS_UNIT_ASSERT_SUCCESS(
+            pthread_create(&thread, NULL, async_run_thread, &run_result));
+    // make sure the delivery thread has started before disabling the queue
+    while (!atomic_load(&async_load()->consumers_sleeping)) {
+        sched_yield();
+    }
+    for (int i = 0; i < ASYNC_MAX_RECORDED; ++i) {
+        avs_log(test, INFO, "message %d", i);
+    }
+    avs_log_async_disable();
+    AVS_UNIT_ASSERT_SUCCESS(pthread_join(thread, NULL));
+    AVS_UNIT_ASSERT_SUCCESS(run_result);
+    // the delivery thread might still have been using the queue when it was
+    // disabled; it is reclaimed by the next configuration change
+    AVS_UNIT_ASSERT_SUCCESS(avs_log_async_enable(NULL));
+    AVS_UNIT_ASSERT_NULL(g_log.retired_async);
+    avs_log_async_disable();
+    AVS_UNIT_ASSERT_NULL(g_log.retired_async);
+
+    AVS_UNIT_ASSERT_EQUAL(g_recorded.count, ASYNC_MAX_RECORDED);
+    for (int i = 0; i < ASYNC_MAX_RECORDED; ++i) {
+        char expected[64];
+        snprintf(expected, sizeof(expected), "message %d", i);
+        AVS_UNIT_ASSERT_EQUAL_STRING(g_recorded.messages[i], expected);
+    }
+    reset_everything();
+}
+#    define ASSERT_DEFERRED_FORMAT(...)                                    \
+        do {                                                               \
+            char expected[64];                                             \
+            snprintf(expected, sizeof(expected), __VA_ARGS__);             \
+            avs_log(test, INFO, __VA_ARGS__);                              \
+            avs_log_async_flush();                                         \
+            AVS_UNIT_ASSERT_EQUAL_STRING(                                  \
+                    g_recorded.messages[g_recorded.count - 1], expected);  \
+        } while (0)
+
+AVS_UNIT_TEST(log_async, deferred_formatting) {
+    const avs_log_async_config_t config = {
+        .deferred_formatting = true
+    };
+    memset(&g_recorded, 0, sizeof(g_recorded));
+    avs_log_set_extended_handler(recording_handler);
+    AVS_UNIT_ASSERT_SUCCESS(avs_log_async_enable(&config));
+
+    ASSERT_DEFERRED_FORMAT("%d %i %5u|%-4x|%#o %X", -42, 7, 3u, 0xabu, 8u,
+                           0xbeefu);
+    ASSERT_DEFERRED_FORMAT("%hhd %hu %ld %lld %zu %jd %td", 300, 70000, -1L,
+                           LLONG_MIN, (size_t) 123, (intmax_t) -9,
+                           (ptrdiff_t) -3);
+    ASSERT_DEFERRED_FORMAT("%.3f %e %g %10.2Lf|%+08.1f", 3.14159, 1e-10, 0.5,
+                           2.5L, -1.25);
+    ASSERT_DEFERRED_FORMAT("[%s] [%.3s] [%-6s] [%*d] [%.*s] [%-*.*s]", "str",
+                           "abcdef", "ab", 5, 42, 2, "xyz", 6, 2, "hello");
+    ASSERT_DEFERRED_FORMAT("%c%c %p %% %.*s", 'o', 'k', (const void *) &config, -1,
+                           "negative precision");
+    // format strings built out of AVS_DISPOSABLE_LOG() fragments
+    ASSERT_DEFERRED_FORMAT(AVS_DISPOSABLE_LOG("level = ") "%u" AVS_DISPOSABLE_LOG(
+                                   ", description = ") "%s",
+                           2u, "alert");
+    ASSERT_DEFERRED_FORMAT(" %u %s", 2u, "alert");
+    // wide characters cannot be deferred, so are formatted right away
+    ASSERT_DEFERRED_FORMAT("%ls", L"wide");
+
+    AVS_UNIT_ASSERT_EQUAL(g_recorded.count, 8);
+    reset_everything();
+}
+
+AVS_UNIT_TEST(log_async, deferred_long_message) {
+    const avs_log_async_config_t config = {
+        .queue_size = 1,
+        .deferred_formatting = true
+    };
+    memset(&g_recorded, 0, sizeof(g_recorded));
+    avs_log_set_extended_handler(recording_handler);
+    AVS_UNIT_ASSERT_SUCCESS(avs_log_async_enable(&config));
+
+    // the string takes all the space for arguments, so the message is
+    // formatted right away, filling the whole single (last) queue slot
+    char str[2 * AVS_COMMONS_LOG_MAX_LINE_LENGTH];
+    memset(str, 'x', sizeof(str) - 1);
+    str[sizeof(str) - 1] = '\0';
+    avs_log(test, INFO, "%s %d", str, 42);
+    avs_log_async_flush();
+    AVS_UNIT_ASSERT_EQUAL(g_recorded.count, 1);
+    AVS_UNIT_ASSERT_EQUAL(strspn(g_recorded.messages[0], "x"),
+                          sizeof(g_recorded.messages[0]) - 1);
+    reset_everything();
+}
+
+static int put_preformatted(deferred_args_t *args, const char *msg, ...) {
+    va_list ap;
+    va_start(ap, msg);
+    int result = put_preformatted_v(args, msg, ap);
+    va_end(ap);
+    return result;
+}
+
+AVS_UNIT_TEST(log_async, preformatted_fills_buffer) {
+    // allocated on the heap, so that overflows are caught by sanitizers
+    deferred_args_t args = {
+        .size = 600
+    };
+    AVS_UNIT_ASSERT_NOT_NULL((args.data = (char *) avs_malloc(args.size)));
+    char str[1024];
+    memset(str, 'x', sizeof(str) - 1);
+    str[sizeof(str) - 1] = '\0';
+    AVS_UNIT_ASSERT_SUCCESS(put_preformatted(&args, "%s", str));
+    AVS_UNIT_ASSERT_EQUAL(args.used, args.size - 1);
+    AVS_UNIT_ASSERT_EQUAL(memcmp(&args.data[args.used - 3], "...", 3), 0);
+    avs_free(args.data);
+}
+
+static struct {
+    size_t size;
+    char data[1024];
+} g_binary_log;
+
+static void binary_writer(const void *data, size_t size, void *arg) {
+    AVS_UNIT_ASSERT_TRUE(arg == &g_binary_log);
+    AVS_UNIT_ASSERT_TRUE(size <= sizeof(g_binary_log.data) - g_binary_log.size);
+    memcpy(&g_binary_log.data[g_binary_log.size], data, size);
+    g_binary_log.size += size;
+}
+
+static const char *read_binary_string(size_t *pos, size_t *out_len) {
+    const uint8_t *data = (const uint8_t *) &g_binary_log.data[*pos];
+    *out_len = (size_t) (data[0] | data[1] << 8);
+    *pos += 2 + *out_len;
+    AVS_UNIT_ASSERT_TRUE(*pos <= g_binary_log.size);
+    return (const char *) &data[2];
+}
+
+AVS_UNIT_TEST(log_async, binary_writer) {
+    const avs_log_async_config_t config = {
+        .queue_size = 2,
+        .overflow_policy = AVS_LOG_ASYNC_OVERFLOW_COUNT,
+        .binary_writer = binary_writer,
+        .binary_writer_arg = &g_binary_log
+    };
+    memset(&g_recorded, 0, sizeof(g_recorded));
+    memset(&g_binary_log, 0, sizeof(g_binary_log));
+    avs_log_set_extended_handler(recording_handler);
+    AVS_UNIT_ASSERT_SUCCESS(avs_log_async_enable(&config));
+    for (int i = 0; i < 3; ++i) {
+        avs_log(test, INFO, "value %d %s", i, "x");
+    }
+    unsigned expected_line = __LINE__ - 2;
+    avs_log_async_disable();
+    AVS_UNIT_ASSERT_EQUAL(g_recorded.count, 0);
+
+    AVS_UNIT_ASSERT_TRUE(g_binary_log.size > 8);
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(g_binary_log.data, "AVSLOGB1", 8);
+    size_t pos = 8;
+    const char *expected_messages[] = { "value 0 x", "value 1 x",
+                                        "1 log messages dropped due to full "
+                                        "queue" };
+    for (size_t i = 0; i < AVS_ARRAY_SIZE(expected_messages); ++i) {
+        const uint8_t *header = (const uint8_t *) &g_binary_log.data[pos];
+        AVS_UNIT_ASSERT_EQUAL(header[0], i < 2 ? AVS_LOG_INFO : AVS_LOG_WARNING);
+        unsigned line = (unsigned) (header[1] | header[2] << 8
+                                    | header[3] << 16
+                                    | (unsigned) header[4] << 24);
+        pos += 5;
+
+        size_t len;
+        const char *str = read_binary_string(&pos, &len);
+        AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(str, i < 2 ? "test" : "avs_log",
+                                          len);
+        str = read_binary_string(&pos, &len);
+        if (i < 2) {
+            AVS_UNIT_ASSERT_EQUAL(line, expected_line);
+            AVS_UNIT_ASSERT_EQUAL(len, strlen(__FILE__));
+            AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(str, __FILE__, len);
+        }
+
+        char format[64];
+        str = read_binary_string(&pos, &len);
+        AVS_UNIT_ASSERT_TRUE(len < sizeof(format));
+        memcpy(format, str, len);
+        format[len] = '\0';
+
+        const char *args = read_binary_string(&pos, &len);
+        char message[64];
+        AVS_UNIT_ASSERT_SUCCESS(
+                format_deferred(message, sizeof(message), format, args, len));
+        AVS_UNIT_ASSERT_EQUAL_STRING(message, expected_messages[i]);
+    }
+    AVS_UNIT_ASSERT_EQUAL(pos, g_binary_log.size);
+    reset_everything();
+}
+
+AVS_UNIT_TEST(log_async, deferred_args_errors) {
+    char buf[16];
+    deferred_args_t args = {
+        .data = buf,
+        .size = sizeof(buf)
+    };
+    int n;
+    AVS_UNIT_ASSERT_FAILED(put_deferred_args(&args, "%n", &n));
+    args.used = 0;
+    AVS_UNIT_ASSERT_FAILED(put_deferred_args(&args, "%d %d", 1, 2));
+    args.used = 0;
+    AVS_UNIT_ASSERT_FAILED(put_deferred_args(&args, "%d %", 1));
+    args.used = 0;
+    AVS_UNIT_ASSERT_SUCCESS(put_deferred_args(&args, "%s", "0123456789abcdef"));
+    AVS_UNIT_ASSERT_EQUAL(args.used, sizeof(buf));
+
+    char message[32];
+    AVS_UNIT_ASSERT_SUCCESS(
+            format_deferred(message, sizeof(message), "<%s>", buf, args.used));
+    AVS_UNIT_ASSERT_EQUAL_STRING(message, "<0123456789abc>");
+    // arguments not matching the format
+    AVS_UNIT_ASSERT_FAILED(
+            format_deferred(message, sizeof(message), "%d", buf, args.used));
+    AVS_UNIT_ASSERT_FAILED(format_deferred(message, sizeof(message), "%s %s",
+                                           buf, args.used));
+    // truncated output
+    AVS_UNIT_ASSERT_SUCCESS(
+            format_deferred(message, 8, "%s", buf, args.used));
+    AVS_UNIT_ASSERT_EQUAL_STRING(message, "0123...");
+}
+
+#    ifdef AVS_LOG_LOCK_FREE_LEVELS
+static atomic_bool g_levels_readers_stop;
+
+static void *levels_reader_thread(void *unused) {
+    (void) unused;
+    while (!atomic_load(&g_levels_readers_stop)) {
+        // ERROR is enabled for all the modules at all times
+        AVS_UNIT_ASSERT_TRUE(avs_log_should_log__(AVS_LOG_ERROR, "reader_0"));
+        AVS_UNIT_ASSERT_TRUE(avs_log_should_log__(AVS_LOG_ERROR, "reader_9"));
+        (void) avs_log_should_log__(AVS_LOG_INFO, "reader_5");
+    }
+    return NULL;
+}
+
+AVS_UNIT_TEST(log, levels_changed_while_read) {
+    atomic_store(&g_levels_readers_stop, false);
+    pthread_t threads[4];
+    for (size_t i = 0; i < AVS_ARRAY_SIZE(threads); ++i) {
+        AVS_UNIT_ASSERT_SUCCESS(
+                pthread_create(&threads[i], NULL, levels_reader_thread, NULL));
+    }
+    for (int i = 0; i < 1000; ++i) {
+        // adds modules at first, and then only updates them
+        char module[sizeof("reader_0")];
+        snprintf(module, sizeof(module), "reader_%d", i % 10);
+        AVS_UNIT_ASSERT_SUCCESS(avs_log_set_level__(
+                module, i % 3 ? AVS_LOG_ERROR : AVS_LOG_DEBUG));
+        AVS_UNIT_ASSERT_SUCCESS(
+                avs_log_set_level__(NULL, i % 2 ? AVS_LOG_INFO : AVS_LOG_ERROR));
+    }
+    atomic_store(&g_levels_readers_stop, true);
+    for (size_t i = 0; i < AVS_ARRAY_SIZE(threads); ++i) {
+        AVS_UNIT_ASSERT_SUCCESS(pthread_join(threads[i], NULL));
+    }
+    reset_everything();
+}
+#    endif // AVS_LOG_LOCK_FREE_LEVELS
+#endif // AVS_LOG_WITH_ASYNC
@@ -0,0 +1,29 @@
+/*
+ * Copyright 2023 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Compile-time test: this translation unit contains an inline definition of
+ * avs_log_test_inline_function(), and is compiled with -pedantic-errors, so it
+ * would fail to build if avs_log() declared a static call site cache. The
+ * external definition is provided by tests/log/test_log.c.
+ */
+#define AVS_LOG_WITHOUT_CALL_SITE_CACHE
+#include "tests/log/test_log_inline.h"
+
+int avs_log_test_call_inline_function(int value);
+int avs_log_test_call_inline_function(int value) {
+    return avs_log_test_inline_function(value);
+}
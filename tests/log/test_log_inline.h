@@ -0,0 +1,34 @@
+/*
+ * Copyright 2023 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef AVS_TEST_LOG_INLINE_H
+#define AVS_TEST_LOG_INLINE_H
+
+#include <avsystem/commons/avs_log.h>
+
+/*
+ * Inline function with external linkage that uses avs_log(), as it might
+ * appear in a header. Translation units that include this file without
+ * declaring the function extern contain an inline definition, which shall not
+ * define static variables (C99 6.7.4p3), so they need to define
+ * AVS_LOG_WITHOUT_CALL_SITE_CACHE.
+ */
+inline int avs_log_test_inline_function(int value) {
+    avs_log(inline_module, DEBUG, "inline function called with %d", value);
+    return value;
+}
+
+#endif /* AVS_TEST_LOG_INLINE_H */
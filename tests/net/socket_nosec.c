@@ -275,3 +275,172 @@ AVS_UNIT_TEST(socket, udp_connect_ipv4v6) {
 }
 #endif // defined(AVS_COMMONS_NET_WITH_IPV4) &&
        // defined(AVS_COMMONS_NET_WITH_IPV6)
+
+//// avs_net_socket_send_vector ////////////////////////////////////////////////
+
+#ifdef AVS_COMMONS_NET_POSIX_AVS_SOCKET_HAVE_SENDMSG
+AVS_UNIT_TEST(socket, tcp_send_vector) {
+    avs_net_socket_t *listening_socket = NULL;
+    AVS_UNIT_ASSERT_SUCCESS(avs_net_tcp_socket_create(&listening_socket, NULL));
+    AVS_UNIT_ASSERT_SUCCESS(
+            avs_net_socket_bind(listening_socket, "127.0.0.1", "0"));
+
+    char listen_port[sizeof("65536")];
+    AVS_UNIT_ASSERT_SUCCESS(avs_net_socket_get_local_port(
+            listening_socket, listen_port, sizeof(listen_port)));
+
+    avs_net_socket_t *client_socket = NULL;
+    AVS_UNIT_ASSERT_SUCCESS(avs_net_tcp_socket_create(&client_socket, NULL));
+    AVS_UNIT_ASSERT_SUCCESS(
+            avs_net_socket_connect(client_socket, "127.0.0.1", listen_port));
+
+    avs_net_socket_t *server_socket = NULL;
+    AVS_UNIT_ASSERT_SUCCESS(avs_net_tcp_socket_create(&server_socket, NULL));
+    AVS_UNIT_ASSERT_SUCCESS(
+            avs_net_socket_accept(listening_socket, server_socket));
+
+    // more buffers than passed to a single sendmsg() call
+    avs_net_socket_iovec_t iov[40];
+    char expected[sizeof(iov) / sizeof(*iov) * 2];
+    size_t expected_size = 0;
+    for (size_t i = 0; i < AVS_ARRAY_SIZE(iov); ++i) {
+        iov[i].data = &expected[expected_size];
+        iov[i].size = i % 3;
+        for (size_t j = 0; j < iov[i].size; ++j) {
+            expected[expected_size++] = (char) ('a' + i % 26);
+        }
+    }
+    AVS_UNIT_ASSERT_SUCCESS(avs_net_socket_send_vector(
+            client_socket, iov, AVS_ARRAY_SIZE(iov)));
+
+    char received[sizeof(expected)];
+    size_t received_size = 0;
+    while (received_size < expected_size) {
+        size_t bytes_received;
+        AVS_UNIT_ASSERT_SUCCESS(avs_net_socket_receive(
+                server_socket, &bytes_received, &received[received_size],
+                sizeof(received) - received_size));
+        AVS_UNIT_ASSERT_NOT_EQUAL(bytes_received, 0);
+        received_size += bytes_received;
+    }
+    AVS_UNIT_ASSERT_EQUAL(received_size, expected_size);
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(received, expected, expected_size);
+
+    AVS_UNIT_ASSERT_SUCCESS(avs_net_socket_cleanup(&server_socket));
+    AVS_UNIT_ASSERT_SUCCESS(avs_net_socket_cleanup(&client_socket));
+    AVS_UNIT_ASSERT_SUCCESS(avs_net_socket_cleanup(&listening_socket));
+}
+
+AVS_UNIT_TEST(socket, udp_send_vector) {
+    avs_net_socket_t *server_socket = NULL;
+    AVS_UNIT_ASSERT_SUCCESS(avs_net_udp_socket_create(&server_socket, NULL));
+    AVS_UNIT_ASSERT_SUCCESS(
+            avs_net_socket_bind(server_socket, "127.0.0.1", "0"));
+
+    char listen_port[sizeof("65536")];
+    AVS_UNIT_ASSERT_SUCCESS(avs_net_socket_get_local_port(
+            server_socket, listen_port, sizeof(listen_port)));
+
+    avs_net_socket_t *client_socket = NULL;
+    AVS_UNIT_ASSERT_SUCCESS(avs_net_udp_socket_create(&client_socket, NULL));
+    AVS_UNIT_ASSERT_SUCCESS(
+            avs_net_socket_connect(client_socket, "127.0.0.1", listen_port));
+
+    // one empty buffer, which does not count towards the limit
+    avs_net_socket_iovec_t iov[AVS_NET_SOCKET_SEND_VECTOR_MAX_IOVCNT + 2];
+    char expected[AVS_NET_SOCKET_SEND_VECTOR_MAX_IOVCNT + 1];
+    iov[0].data = NULL;
+    iov[0].size = 0;
+    for (size_t i = 1; i < AVS_ARRAY_SIZE(iov); ++i) {
+        expected[i - 1] = (char) ('a' + i);
+        iov[i].data = &expected[i - 1];
+        iov[i].size = 1;
+    }
+
+    // exactly the maximum number of buffers - sent as a single datagram
+    AVS_UNIT_ASSERT_SUCCESS(avs_net_socket_send_vector(
+            client_socket, iov, AVS_ARRAY_SIZE(iov) - 1));
+    char received[sizeof(expected)];
+    size_t bytes_received;
+    AVS_UNIT_ASSERT_SUCCESS(avs_net_socket_receive(
+            server_socket, &bytes_received, received, sizeof(received)));
+    AVS_UNIT_ASSERT_EQUAL(bytes_received,
+                          AVS_NET_SOCKET_SEND_VECTOR_MAX_IOVCNT);
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(received, expected, bytes_received);
+
+    // one buffer too many - nothing is sent
+    avs_error_t err = avs_net_socket_send_vector(client_socket, iov,
+                                                 AVS_ARRAY_SIZE(iov));
+    AVS_UNIT_ASSERT_EQUAL(err.category, AVS_ERRNO_CATEGORY);
+    AVS_UNIT_ASSERT_EQUAL(err.code, AVS_EMSGSIZE);
+
+    AVS_UNIT_ASSERT_SUCCESS(avs_net_socket_cleanup(&client_socket));
+    AVS_UNIT_ASSERT_SUCCESS(avs_net_socket_cleanup(&server_socket));
+}
+#endif // AVS_COMMONS_NET_POSIX_AVS_SOCKET_HAVE_SENDMSG
+
+//// avs_net_socket_send_file //////////////////////////////////////////////////
+
+#ifdef AVS_COMMONS_NET_POSIX_AVS_SOCKET_HAVE_SENDFILE
+AVS_UNIT_TEST(socket, tcp_send_file) {
+    avs_net_socket_t *listening_socket = NULL;
+    AVS_UNIT_ASSERT_SUCCESS(avs_net_tcp_socket_create(&listening_socket, NULL));
+    AVS_UNIT_ASSERT_SUCCESS(
+            avs_net_socket_bind(listening_socket, "127.0.0.1", "0"));
+
+    char listen_port[sizeof("65536")];
+    AVS_UNIT_ASSERT_SUCCESS(avs_net_socket_get_local_port(
+            listening_socket, listen_port, sizeof(listen_port)));
+
+    avs_net_socket_t *client_socket = NULL;
+    AVS_UNIT_ASSERT_SUCCESS(avs_net_tcp_socket_create(&client_socket, NULL));
+    AVS_UNIT_ASSERT_SUCCESS(
+            avs_net_socket_connect(client_socket, "127.0.0.1", listen_port));
+
+    avs_net_socket_t *server_socket = NULL;
+    AVS_UNIT_ASSERT_SUCCESS(avs_net_tcp_socket_create(&server_socket, NULL));
+    AVS_UNIT_ASSERT_SUCCESS(
+            avs_net_socket_accept(listening_socket, server_socket));
+
+    char data[10000];
+    for (size_t i = 0; i < sizeof(data); ++i) {
+        data[i] = (char) ('a' + i % 26);
+    }
+    FILE *file = tmpfile();
+    AVS_UNIT_ASSERT_NOT_NULL(file);
+    AVS_UNIT_ASSERT_EQUAL(fwrite(data, 1, sizeof(data), file), sizeof(data));
+    AVS_UNIT_ASSERT_SUCCESS(fflush(file));
+
+    size_t bytes_sent;
+    AVS_UNIT_ASSERT_SUCCESS(avs_net_socket_send_file(client_socket, file, 100,
+                                                     5000, &bytes_sent));
+    AVS_UNIT_ASSERT_EQUAL(bytes_sent, 5000);
+    AVS_UNIT_ASSERT_SUCCESS(avs_net_socket_send_file(
+            client_socket, file, 5100, SIZE_MAX, &bytes_sent));
+    AVS_UNIT_ASSERT_EQUAL(bytes_sent, sizeof(data) - 5100);
+    AVS_UNIT_ASSERT_SUCCESS(avs_net_socket_send_file(
+            client_socket, file, (avs_off_t) sizeof(data), SIZE_MAX,
+            &bytes_sent));
+    AVS_UNIT_ASSERT_EQUAL(bytes_sent, 0);
+    // the stdio position is not affected
+    AVS_UNIT_ASSERT_EQUAL(ftell(file), (long) sizeof(data));
+    fclose(file);
+
+    char received[sizeof(data)];
+    size_t received_size = 0;
+    while (received_size < sizeof(data) - 100) {
+        size_t bytes_received;
+        AVS_UNIT_ASSERT_SUCCESS(avs_net_socket_receive(
+                server_socket, &bytes_received, &received[received_size],
+                sizeof(received) - received_size));
+        AVS_UNIT_ASSERT_NOT_EQUAL(bytes_received, 0);
+        received_size += bytes_received;
+    }
+    AVS_UNIT_ASSERT_EQUAL(received_size, sizeof(data) - 100);
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(received, &data[100], received_size);
+
+    AVS_UNIT_ASSERT_SUCCESS(avs_net_socket_cleanup(&server_socket));
+    AVS_UNIT_ASSERT_SUCCESS(avs_net_socket_cleanup(&client_socket));
+    AVS_UNIT_ASSERT_SUCCESS(avs_net_socket_cleanup(&listening_socket));
+}
+#endif // AVS_COMMONS_NET_POSIX_AVS_SOCKET_HAVE_SENDFILE
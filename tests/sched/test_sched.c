@@ -20,11 +20,19 @@
 #include <time.h>
 
 #include <dlfcn.h>
+#include <pthread.h>
+#include <string.h>
 
+#include <avsystem/commons/avs_mutex.h>
+#include <avsystem/commons/avs_memory.h>
 #include <avsystem/commons/avs_sched.h>
 #include <avsystem/commons/avs_time.h>
 #include <avsystem/commons/avs_unit_test.h>
 
+#ifdef AVS_COMMONS_WITH_AVS_STREAM
+#    include <avsystem/commons/avs_stream_membuf.h>
+#endif // AVS_COMMONS_WITH_AVS_STREAM
+
 #define MODULE_NAME sched_test
 #include <avs_x_log_config.h>
 
@@ -79,11 +87,24 @@ typedef struct {
     avs_sched_t *sched;
 } sched_test_env_t;
 
-static sched_test_env_t setup_test(void) {
+static sched_test_env_t
+setup_test_with_config(const avs_sched_config_t *config) {
     mock_clock_start(avs_time_monotonic_from_scalar(0, AVS_TIME_S));
-    return (sched_test_env_t) { avs_sched_new("test", NULL) };
+    sched_test_env_t env = { avs_sched_new_with_config("test", NULL, config) };
+    AVS_UNIT_ASSERT_NOT_NULL(env.sched);
+    return env;
 }
 
+static sched_test_env_t setup_test(void) {
+    return setup_test_with_config(NULL);
+}
+
+static const avs_sched_config_t TEST_WHEEL_CONFIG = {
+    .backend = AVS_SCHED_BACKEND_TIMING_WHEEL,
+    .wheel_tick = { 0, 10000000 }, // 10 ms
+    .wheel_slots = 64
+};
+
 static void teardown_test(sched_test_env_t *env) {
     mock_clock_finish();
     avs_sched_cleanup(&env->sched);
@@ -285,4 +306,633 @@ AVS_UNIT_TEST(sched, rescheduling_in_callback) {
     teardown_test(&env);
 }
 
+typedef struct {
+    int *log;
+    size_t *log_size;
+    int value;
+} order_logger_args_t;
+
+static void order_logger(avs_sched_t *sched, const void *args_) {
+    (void) sched;
+    const order_logger_args_t *args = (const order_logger_args_t *) args_;
+    args->log[(*args->log_size)++] = args->value;
+}
+
+AVS_UNIT_TEST(sched, execution_order) {
+    sched_test_env_t env = setup_test();
+
+    enum { JOB_COUNT = 100 };
+    int log[JOB_COUNT];
+    size_t log_size = 0;
+    avs_sched_handle_t tasks[JOB_COUNT] = { NULL };
+    // schedule in a scrambled order; 37 is coprime with 100
+    for (int i = 0; i < JOB_COUNT; ++i) {
+        int value = (i * 37) % JOB_COUNT;
+        const order_logger_args_t args = { log, &log_size, value };
+        AVS_UNIT_ASSERT_SUCCESS(AVS_SCHED_DELAYED(
+                env.sched, &tasks[value],
+                avs_time_duration_from_scalar(value, AVS_TIME_MS), order_logger,
+                &args, sizeof(args)));
+    }
+    // cancel every third job
+    for (int i = 0; i < JOB_COUNT; i += 3) {
+        avs_sched_del(&tasks[i]);
+        AVS_UNIT_ASSERT_NULL(tasks[i]);
+    }
+
+    mock_clock_advance(avs_time_duration_from_scalar(1, AVS_TIME_S));
+    avs_sched_run(env.sched);
+
+    size_t expected_size = 0;
+    for (int i = 0; i < JOB_COUNT; ++i) {
+        AVS_UNIT_ASSERT_NULL(tasks[i]);
+        if (i % 3) {
+            AVS_UNIT_ASSERT_EQUAL(log[expected_size++], i);
+        }
+    }
+    AVS_UNIT_ASSERT_EQUAL(log_size, expected_size);
+
+    teardown_test(&env);
+}
+
+AVS_UNIT_TEST(sched, wheel_execution_order) {
+    // jobs are scheduled up to 2 seconds ahead, beyond the range of the wheel
+    sched_test_env_t env = setup_test_with_config(&TEST_WHEEL_CONFIG);
+
+    enum { JOB_COUNT = 100 };
+    int log[JOB_COUNT];
+    size_t log_size = 0;
+    avs_sched_handle_t tasks[JOB_COUNT] = { NULL };
+    // schedule in a scrambled order; 37 is coprime with 100
+    for (int i = 0; i < JOB_COUNT; ++i) {
+        int value = (i * 37) % JOB_COUNT;
+        const order_logger_args_t args = { log, &log_size, value };
+        AVS_UNIT_ASSERT_SUCCESS(AVS_SCHED_DELAYED(
+                env.sched, &tasks[value],
+                avs_time_duration_from_scalar(value * 20, AVS_TIME_MS),
+                order_logger, &args, sizeof(args)));
+    }
+    // cancel every third job
+    for (int i = 0; i < JOB_COUNT; i += 3) {
+        avs_sched_del(&tasks[i]);
+        AVS_UNIT_ASSERT_NULL(tasks[i]);
+    }
+
+    for (int i = 0; i < JOB_COUNT; ++i) {
+        mock_clock_advance(avs_time_duration_from_scalar(20, AVS_TIME_MS));
+        avs_sched_run(env.sched);
+    }
+
+    size_t expected_size = 0;
+    for (int i = 0; i < JOB_COUNT; ++i) {
+        AVS_UNIT_ASSERT_NULL(tasks[i]);
+        if (i % 3) {
+            AVS_UNIT_ASSERT_EQUAL(log[expected_size++], i);
+        }
+    }
+    AVS_UNIT_ASSERT_EQUAL(log_size, expected_size);
+
+    teardown_test(&env);
+}
+
+AVS_UNIT_TEST(sched, wheel_rounding) {
+    sched_test_env_t env = setup_test_with_config(&TEST_WHEEL_CONFIG);
+
+    int counter = 0;
+    avs_sched_handle_t task = NULL;
+    AVS_UNIT_ASSERT_SUCCESS(AVS_SCHED_DELAYED(
+            env.sched, &task, avs_time_duration_from_scalar(25, AVS_TIME_MS),
+            increment_task, &(int *) { &counter }, sizeof(int *)));
+    AVS_UNIT_ASSERT_TRUE(
+            avs_time_monotonic_equal(avs_sched_time(&task),
+                                     avs_time_monotonic_from_scalar(
+                                             30, AVS_TIME_MS)));
+    AVS_UNIT_ASSERT_TRUE(
+            avs_time_monotonic_equal(avs_sched_time_of_next(env.sched),
+                                     avs_sched_time(&task)));
+
+    mock_clock_advance(avs_time_duration_from_scalar(25, AVS_TIME_MS));
+    avs_sched_run(env.sched);
+    AVS_UNIT_ASSERT_EQUAL(counter, 0);
+    AVS_UNIT_ASSERT_NOT_NULL(task);
+
+    mock_clock_advance(avs_time_duration_from_scalar(5, AVS_TIME_MS));
+    avs_sched_run(env.sched);
+    AVS_UNIT_ASSERT_EQUAL(counter, 1);
+    AVS_UNIT_ASSERT_NULL(task);
+
+    teardown_test(&env);
+}
+
+AVS_UNIT_TEST(sched, wheel_far_jobs) {
+    sched_test_env_t env = setup_test_with_config(&TEST_WHEEL_CONFIG);
+
+    int counter = 0;
+    avs_sched_handle_t near_task = NULL;
+    avs_sched_handle_t far_task = NULL;
+    avs_sched_handle_t cancelled_task = NULL;
+    AVS_UNIT_ASSERT_SUCCESS(AVS_SCHED_DELAYED(
+            env.sched, &near_task, avs_time_duration_from_scalar(1, AVS_TIME_S),
+            increment_task, &(int *) { &counter }, sizeof(int *)));
+    AVS_UNIT_ASSERT_SUCCESS(AVS_SCHED_DELAYED(
+            env.sched, &far_task, avs_time_duration_from_scalar(1, AVS_TIME_HOUR),
+            increment_task, &(int *) { &counter }, sizeof(int *)));
+    AVS_UNIT_ASSERT_SUCCESS(
+            AVS_SCHED_DELAYED(env.sched, &cancelled_task,
+                              avs_time_duration_from_scalar(30, AVS_TIME_MIN),
+                              increment_task, &(int *) { &counter },
+                              sizeof(int *)));
+
+    avs_sched_del(&cancelled_task);
+    AVS_UNIT_ASSERT_NULL(cancelled_task);
+
+    // move the far job into the range of the wheel and back out of it
+    AVS_UNIT_ASSERT_SUCCESS(AVS_RESCHED_DELAYED(
+            &far_task, avs_time_duration_from_scalar(100, AVS_TIME_MS)));
+    AVS_UNIT_ASSERT_SUCCESS(AVS_RESCHED_DELAYED(
+            &far_task, avs_time_duration_from_scalar(2, AVS_TIME_MIN)));
+
+    // the instant is rounded up to the next tick
+    mock_clock_advance(avs_time_duration_from_scalar(1010, AVS_TIME_MS));
+    avs_sched_run(env.sched);
+    AVS_UNIT_ASSERT_EQUAL(counter, 1);
+    AVS_UNIT_ASSERT_NULL(near_task);
+    AVS_UNIT_ASSERT_NOT_NULL(far_task);
+    AVS_UNIT_ASSERT_TRUE(
+            avs_time_monotonic_equal(avs_sched_time_of_next(env.sched),
+                                     avs_sched_time(&far_task)));
+
+    // advance in steps shorter than the range of the wheel, so that the job
+    // is migrated from the heap into the wheel before it is executed
+    while (far_task) {
+        mock_clock_advance(avs_time_duration_from_scalar(500, AVS_TIME_MS));
+        avs_sched_run(env.sched);
+    }
+    AVS_UNIT_ASSERT_EQUAL(counter, 2);
+    AVS_UNIT_ASSERT_FALSE(
+            avs_time_monotonic_valid(avs_sched_time_of_next(env.sched)));
+
+    teardown_test(&env);
+}
+
+AVS_UNIT_TEST(sched, wheel_clock_jump) {
+    sched_test_env_t env = setup_test_with_config(&TEST_WHEEL_CONFIG);
+
+    enum { JOB_COUNT = 3 };
+    int log[JOB_COUNT];
+    size_t log_size = 0;
+    avs_sched_handle_t tasks[JOB_COUNT] = { NULL };
+    order_logger_args_t args[JOB_COUNT];
+    for (int i = 0; i < JOB_COUNT; ++i) {
+        args[i] = (order_logger_args_t) { log, &log_size, i };
+    }
+    AVS_UNIT_ASSERT_SUCCESS(AVS_SCHED_DELAYED(
+            env.sched, &tasks[0], avs_time_duration_from_scalar(2, AVS_TIME_S),
+            order_logger, &args[0], sizeof(args[0])));
+
+    // advance past the range of the wheel in one step, so that the overdue job
+    // is migrated from the heap into a slot other than the one of its instant
+    mock_clock_advance(avs_time_duration_from_scalar(3, AVS_TIME_S));
+    AVS_UNIT_ASSERT_SUCCESS(AVS_SCHED_DELAYED(
+            env.sched, &tasks[2],
+            avs_time_duration_from_scalar(50, AVS_TIME_MS), order_logger,
+            &args[2], sizeof(args[2])));
+    AVS_UNIT_ASSERT_SUCCESS(AVS_SCHED_NOW(env.sched, &tasks[1], order_logger,
+                                          &args[1], sizeof(args[1])));
+
+    // the job scheduled "now" is rounded up to the next tick, so only the
+    // overdue one is executed immediately
+    avs_sched_run(env.sched);
+    AVS_UNIT_ASSERT_EQUAL(log_size, 1);
+    AVS_UNIT_ASSERT_NULL(tasks[0]);
+    AVS_UNIT_ASSERT_NOT_NULL(tasks[1]);
+    AVS_UNIT_ASSERT_NOT_NULL(tasks[2]);
+
+    mock_clock_advance(avs_time_duration_from_scalar(100, AVS_TIME_MS));
+    avs_sched_run(env.sched);
+    AVS_UNIT_ASSERT_EQUAL(log_size, JOB_COUNT);
+    for (int i = 0; i < JOB_COUNT; ++i) {
+        AVS_UNIT_ASSERT_NULL(tasks[i]);
+        AVS_UNIT_ASSERT_EQUAL(log[i], i);
+    }
+    AVS_UNIT_ASSERT_FALSE(
+            avs_time_monotonic_valid(avs_sched_time_of_next(env.sched)));
+
+    teardown_test(&env);
+}
+
+AVS_UNIT_TEST(sched, same_instant_fifo) {
+    sched_test_env_t env = setup_test();
+
+    enum { JOB_COUNT = 20 };
+    int log[JOB_COUNT];
+    size_t log_size = 0;
+    const avs_time_monotonic_t instant = avs_time_monotonic_add(
+            avs_time_monotonic_now(),
+            avs_time_duration_from_scalar(1, AVS_TIME_S));
+    avs_sched_handle_t first = NULL;
+    for (int i = 0; i < JOB_COUNT; ++i) {
+        const order_logger_args_t args = { log, &log_size, i };
+        AVS_UNIT_ASSERT_SUCCESS(AVS_SCHED_AT(env.sched, i ? NULL : &first,
+                                             instant, order_logger, &args,
+                                             sizeof(args)));
+    }
+    // rescheduling to the same instant moves the job to the end of the queue
+    AVS_UNIT_ASSERT_SUCCESS(AVS_RESCHED_AT(&first, instant));
+
+    mock_clock_advance(avs_time_duration_from_scalar(1, AVS_TIME_S));
+    avs_sched_run(env.sched);
+
+    AVS_UNIT_ASSERT_EQUAL(log_size, JOB_COUNT);
+    for (int i = 1; i < JOB_COUNT; ++i) {
+        AVS_UNIT_ASSERT_EQUAL(log[i - 1], i);
+    }
+    AVS_UNIT_ASSERT_EQUAL(log[JOB_COUNT - 1], 0);
+
+    teardown_test(&env);
+}
+
+AVS_UNIT_TEST(sched, job_pool) {
+    const avs_sched_config_t config = {
+        .backend = AVS_SCHED_BACKEND_HEAP,
+        .job_pool_prealloc = 4,
+        .job_pool_prealloc_data_size = sizeof(int *)
+    };
+    sched_test_env_t env = setup_test_with_config(&config);
+
+    avs_sched_pool_stats_t stats;
+    avs_sched_pool_stats(env.sched, &stats);
+    AVS_UNIT_ASSERT_EQUAL(stats.hits, 0);
+    AVS_UNIT_ASSERT_EQUAL(stats.misses, 0);
+    AVS_UNIT_ASSERT_EQUAL(stats.free_jobs, 4);
+
+    int counter = 0;
+    for (int i = 0; i < 5; ++i) {
+        AVS_UNIT_ASSERT_SUCCESS(AVS_SCHED_NOW(env.sched, NULL, increment_task,
+                                              &(int *) { &counter },
+                                              sizeof(int *)));
+    }
+    avs_sched_pool_stats(env.sched, &stats);
+    AVS_UNIT_ASSERT_EQUAL(stats.hits, 4);
+    AVS_UNIT_ASSERT_EQUAL(stats.misses, 1);
+    AVS_UNIT_ASSERT_EQUAL(stats.free_jobs, 0);
+
+    avs_sched_run(env.sched);
+    AVS_UNIT_ASSERT_EQUAL(counter, 5);
+    avs_sched_pool_stats(env.sched, &stats);
+    AVS_UNIT_ASSERT_EQUAL(stats.free_jobs, 5);
+
+    // job structures are reused for cancelled jobs as well
+    avs_sched_handle_t task = NULL;
+    AVS_UNIT_ASSERT_SUCCESS(AVS_SCHED_DELAYED(
+            env.sched, &task, avs_time_duration_from_scalar(1, AVS_TIME_S),
+            increment_task, &(int *) { &counter }, sizeof(int *)));
+    avs_sched_del(&task);
+
+    // larger data does not fit in the pooled structures
+    char large_data[1024] = "";
+    AVS_UNIT_ASSERT_SUCCESS(AVS_SCHED_DELAYED(
+            env.sched, NULL, avs_time_duration_from_scalar(1, AVS_TIME_S),
+            global_value_setter, large_data, sizeof(large_data)));
+
+    avs_sched_pool_stats(env.sched, &stats);
+    AVS_UNIT_ASSERT_EQUAL(stats.hits, 5);
+    AVS_UNIT_ASSERT_EQUAL(stats.misses, 2);
+    AVS_UNIT_ASSERT_EQUAL(stats.free_jobs, 5);
+
+    teardown_test(&env);
+}
+
+AVS_UNIT_TEST(sched, job_pool_limit) {
+    sched_test_env_t env = setup_test();
+
+    // idle job structures above the limit are freed after a burst...
+    int counter = 0;
+    for (int i = 0; i < 200; ++i) {
+        AVS_UNIT_ASSERT_SUCCESS(AVS_SCHED_NOW(env.sched, NULL, increment_task,
+                                              &(int *) { &counter },
+                                              sizeof(int *)));
+    }
+    avs_sched_run(env.sched);
+    AVS_UNIT_ASSERT_EQUAL(counter, 200);
+
+    avs_sched_pool_stats_t stats;
+    avs_sched_pool_stats(env.sched, &stats);
+    AVS_UNIT_ASSERT_EQUAL(stats.free_jobs, 64);
+
+    // ...unless they have been linked to a handle
+    avs_sched_handle_t handles[100] = { NULL };
+    for (size_t i = 0; i < AVS_ARRAY_SIZE(handles); ++i) {
+        AVS_UNIT_ASSERT_SUCCESS(AVS_SCHED_NOW(env.sched, &handles[i],
+                                              increment_task,
+                                              &(int *) { &counter },
+                                              sizeof(int *)));
+    }
+    avs_sched_run(env.sched);
+    AVS_UNIT_ASSERT_EQUAL(counter, 300);
+
+    avs_sched_pool_stats(env.sched, &stats);
+    AVS_UNIT_ASSERT_EQUAL(stats.free_jobs, 100);
+
+    teardown_test(&env);
+}
+
+AVS_UNIT_TEST(sched, batch) {
+    sched_test_env_t env = setup_test();
+
+    int log[3];
+    size_t log_size = 0;
+    const order_logger_args_t args[] = { { log, &log_size, 0 },
+                                         { log, &log_size, 1 },
+                                         { log, &log_size, 2 } };
+    const avs_time_monotonic_t now = avs_time_monotonic_now();
+    const avs_time_monotonic_t later = avs_time_monotonic_add(
+            now, avs_time_duration_from_scalar(1, AVS_TIME_S));
+    avs_sched_handle_t handles[3] = { NULL };
+    const avs_sched_batch_entry_t entries[] = {
+        AVS_SCHED_BATCH_ENTRY(&handles[0], later, order_logger, &args[0],
+                              sizeof(args[0])),
+        AVS_SCHED_BATCH_ENTRY(&handles[1], now, order_logger, &args[1],
+                              sizeof(args[1])),
+        AVS_SCHED_BATCH_ENTRY(&handles[2], later, order_logger, &args[2],
+                              sizeof(args[2]))
+    };
+    AVS_UNIT_ASSERT_SUCCESS(
+            avs_sched_at_batch(env.sched, entries, AVS_ARRAY_SIZE(entries)));
+    for (size_t i = 0; i < AVS_ARRAY_SIZE(handles); ++i) {
+        AVS_UNIT_ASSERT_NOT_NULL(handles[i]);
+    }
+
+    mock_clock_advance(avs_time_duration_from_scalar(1, AVS_TIME_S));
+    avs_sched_run(env.sched);
+    AVS_UNIT_ASSERT_EQUAL(log_size, 3);
+    AVS_UNIT_ASSERT_EQUAL(log[0], 1);
+    AVS_UNIT_ASSERT_EQUAL(log[1], 0);
+    AVS_UNIT_ASSERT_EQUAL(log[2], 2);
+    for (size_t i = 0; i < AVS_ARRAY_SIZE(handles); ++i) {
+        AVS_UNIT_ASSERT_NULL(handles[i]);
+    }
+
+    teardown_test(&env);
+}
+
+AVS_UNIT_TEST(sched, batch_invalid_entry) {
+    sched_test_env_t env = setup_test();
+
+    int counter = 0;
+    int *counter_ptr = &counter;
+    avs_sched_handle_t handle = NULL;
+    const avs_sched_batch_entry_t entries[] = {
+        AVS_SCHED_BATCH_ENTRY(&handle, avs_time_monotonic_now(),
+                              increment_task, &counter_ptr,
+                              sizeof(counter_ptr)),
+        AVS_SCHED_BATCH_ENTRY(NULL, avs_time_monotonic_now(), NULL, NULL, 0)
+    };
+    // none of the jobs are scheduled if any of them is invalid
+    AVS_UNIT_ASSERT_FAILED(
+            avs_sched_at_batch(env.sched, entries, AVS_ARRAY_SIZE(entries)));
+    AVS_UNIT_ASSERT_NULL(handle);
+    AVS_UNIT_ASSERT_FALSE(
+            avs_time_monotonic_valid(avs_sched_time_of_next(env.sched)));
+
+    teardown_test(&env);
+}
+
+AVS_UNIT_TEST(sched, del_batch) {
+    sched_test_env_t env = setup_test();
+
+    int counter = 0;
+    avs_sched_handle_t handles[5] = { NULL };
+    for (size_t i = 0; i < AVS_ARRAY_SIZE(handles); ++i) {
+        AVS_UNIT_ASSERT_SUCCESS(AVS_SCHED_NOW(env.sched, &handles[i],
+                                              increment_task,
+                                              &(int *) { &counter },
+                                              sizeof(int *)));
+    }
+    avs_sched_handle_t unused_handle = NULL;
+    avs_sched_handle_t *const to_cancel[] = { &handles[0], NULL, &handles[2],
+                                              &unused_handle, &handles[4] };
+    avs_sched_del_batch(to_cancel, AVS_ARRAY_SIZE(to_cancel));
+    AVS_UNIT_ASSERT_NULL(handles[0]);
+    AVS_UNIT_ASSERT_NULL(handles[2]);
+    AVS_UNIT_ASSERT_NULL(handles[4]);
+
+    avs_sched_run(env.sched);
+    AVS_UNIT_ASSERT_EQUAL(counter, 2);
+
+    teardown_test(&env);
+}
+
+static void slow_task(avs_sched_t *sched, const void *duration_ms) {
+    (void) sched;
+    mock_clock_advance(avs_time_duration_from_scalar(
+            *(const int *) duration_ms, AVS_TIME_MS));
+}
+
+AVS_UNIT_TEST(sched, stats) {
+    sched_test_env_t env = setup_test();
+
+    avs_sched_stats_t stats;
+    AVS_UNIT_ASSERT_FAILED(avs_sched_stats_get(env.sched, &stats));
+    AVS_UNIT_ASSERT_SUCCESS(avs_sched_stats_enable(env.sched, true));
+
+    const int durations_ms[] = { 5, 20 };
+    for (size_t i = 0; i < AVS_ARRAY_SIZE(durations_ms); ++i) {
+        AVS_UNIT_ASSERT_SUCCESS(AVS_SCHED_DELAYED(
+                env.sched, NULL,
+                avs_time_duration_from_scalar((int64_t) i, AVS_TIME_S),
+                slow_task, &durations_ms[i], sizeof(durations_ms[i])));
+    }
+    int counter = 0;
+    AVS_UNIT_ASSERT_SUCCESS(AVS_SCHED_NOW(env.sched, NULL, increment_task,
+                                          &(int *) { &counter },
+                                          sizeof(int *)));
+
+    mock_clock_advance(avs_time_duration_from_scalar(1003, AVS_TIME_MS));
+    avs_sched_run(env.sched);
+    AVS_UNIT_ASSERT_EQUAL(counter, 1);
+
+    AVS_UNIT_ASSERT_SUCCESS(avs_sched_stats_get(env.sched, &stats));
+    AVS_UNIT_ASSERT_EQUAL(stats.queue_depth, 0);
+    AVS_UNIT_ASSERT_EQUAL(stats.max_queue_depth, 3);
+    AVS_UNIT_ASSERT_EQUAL(stats.exec_time.count, 3);
+    AVS_UNIT_ASSERT_EQUAL(stats.lateness.count, 3);
+    // 20 ms falls into the [2^14, 2^15) us bucket
+    AVS_UNIT_ASSERT_EQUAL(stats.exec_time.buckets[15], 1);
+    // the second job is delayed by the first one
+    AVS_UNIT_ASSERT_TRUE(avs_time_duration_less(
+            avs_time_duration_from_scalar(8, AVS_TIME_MS), stats.lateness.max));
+
+    AVS_UNIT_ASSERT_EQUAL(stats.slowest_callbacks_count, 2);
+    AVS_UNIT_ASSERT_TRUE(stats.slowest_callbacks[0].clb == slow_task);
+    AVS_UNIT_ASSERT_EQUAL(stats.slowest_callbacks[0].executions, 2);
+    AVS_UNIT_ASSERT_TRUE(avs_time_duration_less(
+            avs_time_duration_from_scalar(20, AVS_TIME_MS),
+            stats.slowest_callbacks[0].max_exec_time));
+    AVS_UNIT_ASSERT_TRUE(stats.slowest_callbacks[1].clb == increment_task);
+
+#    ifdef AVS_COMMONS_WITH_AVS_STREAM
+    avs_stream_t *stream = avs_stream_membuf_create();
+    AVS_UNIT_ASSERT_NOT_NULL(stream);
+    AVS_UNIT_ASSERT_SUCCESS(avs_sched_stats_dump(env.sched, stream));
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_write(stream, "", 1));
+    char *dump = NULL;
+    AVS_UNIT_ASSERT_SUCCESS(
+            avs_stream_membuf_take_ownership(stream, (void **) &dump, NULL));
+    AVS_UNIT_ASSERT_NOT_NULL(strstr(dump, "queue depth: 0 (max 3)"));
+    AVS_UNIT_ASSERT_NOT_NULL(strstr(dump, "execution time: 3 jobs"));
+    AVS_UNIT_ASSERT_NOT_NULL(strstr(dump, "slowest callbacks:"));
+    avs_free(dump);
+    avs_stream_cleanup(&stream);
+#    endif // AVS_COMMONS_WITH_AVS_STREAM
+
+    // disabling and re-enabling resets the statistics
+    AVS_UNIT_ASSERT_SUCCESS(avs_sched_stats_enable(env.sched, false));
+    AVS_UNIT_ASSERT_FAILED(avs_sched_stats_get(env.sched, &stats));
+    AVS_UNIT_ASSERT_SUCCESS(avs_sched_stats_enable(env.sched, true));
+    AVS_UNIT_ASSERT_SUCCESS(avs_sched_stats_get(env.sched, &stats));
+    AVS_UNIT_ASSERT_EQUAL(stats.exec_time.count, 0);
+
+    teardown_test(&env);
+}
+
+#ifdef AVS_COMMONS_SCHED_THREAD_SAFE
+static void executor_stopper(avs_sched_t *sched, const void *executor_ptr) {
+    (void) sched;
+    avs_sched_executor_stop(*(avs_sched_executor_t *const *) executor_ptr);
+}
+
+AVS_UNIT_TEST(sched, executor_cleanup_returns_jobs) {
+    sched_test_env_t env = setup_test();
+
+    avs_sched_executor_t *executor = avs_sched_executor_new(env.sched, 2);
+    AVS_UNIT_ASSERT_NOT_NULL(executor);
+    AVS_UNIT_ASSERT_SUCCESS(AVS_SCHED_NOW(env.sched, NULL, executor_stopper,
+                                          &executor, sizeof(executor)));
+
+    enum { JOB_COUNT = 10 };
+    int log[JOB_COUNT];
+    size_t log_size = 0;
+    for (int i = 0; i < JOB_COUNT; ++i) {
+        const order_logger_args_t args = { log, &log_size, i };
+        AVS_UNIT_ASSERT_SUCCESS(AVS_SCHED_NOW_WITH_AFFINITY(
+                env.sched, NULL, (uint64_t) (i % 3 + 1), order_logger, &args,
+                sizeof(args)));
+    }
+
+    // the first job stops the executor, so all the other ones are left in the
+    // worker queues
+    AVS_UNIT_ASSERT_SUCCESS(avs_sched_executor_run_worker(executor, 0));
+    AVS_UNIT_ASSERT_EQUAL(log_size, 0);
+    avs_sched_executor_cleanup(&executor);
+    AVS_UNIT_ASSERT_NULL(executor);
+
+    avs_sched_run(env.sched);
+    AVS_UNIT_ASSERT_EQUAL(log_size, JOB_COUNT);
+    for (int i = 0; i < JOB_COUNT; ++i) {
+        AVS_UNIT_ASSERT_EQUAL(log[i], i);
+    }
+
+    teardown_test(&env);
+}
+
+enum { EXECUTOR_WORKERS = 4, EXECUTOR_KEYS = 8, EXECUTOR_JOBS_PER_KEY = 200 };
+
+typedef struct {
+    avs_sched_executor_t *executor;
+    avs_mutex_t *mutex;
+    size_t jobs_remaining;
+    size_t bound_jobs_executed[EXECUTOR_KEYS];
+    bool order_violated;
+    pthread_t threads[EXECUTOR_WORKERS];
+} executor_test_env_t;
+
+typedef struct {
+    executor_test_env_t *env;
+    size_t key;
+    size_t seq;
+} executor_job_args_t;
+
+static void executor_job(avs_sched_t *sched, const void *args_) {
+    (void) sched;
+    const executor_job_args_t *args = (const executor_job_args_t *) args_;
+    executor_test_env_t *env = args->env;
+    if (args->key < EXECUTOR_KEYS) {
+        // jobs with the same key are never executed concurrently, so the
+        // counter does not need to be locked
+        if (env->bound_jobs_executed[args->key]++ != args->seq) {
+            env->order_violated = true;
+        }
+    }
+    AVS_UNIT_ASSERT_SUCCESS(avs_mutex_lock(env->mutex));
+    if (!--env->jobs_remaining) {
+        avs_sched_executor_stop(env->executor);
+    }
+    AVS_UNIT_ASSERT_SUCCESS(avs_mutex_unlock(env->mutex));
+}
+
+static void *executor_worker_thread(void *env_) {
+    executor_test_env_t *env = (executor_test_env_t *) env_;
+    size_t index = 0;
+    // wait until all the threads are created
+    AVS_UNIT_ASSERT_SUCCESS(avs_mutex_lock(env->mutex));
+    while (!pthread_equal(env->threads[index], pthread_self())) {
+        ++index;
+    }
+    AVS_UNIT_ASSERT_SUCCESS(avs_mutex_unlock(env->mutex));
+    AVS_UNIT_ASSERT_SUCCESS(
+            avs_sched_executor_run_worker(env->executor, index));
+    return NULL;
+}
+
+AVS_UNIT_TEST(sched, executor_affinity_order) {
+    // this test uses real threads, so it needs the real clock
+    MOCK_CLOCK = AVS_TIME_MONOTONIC_INVALID;
+    avs_sched_t *sched = avs_sched_new("test", NULL);
+    AVS_UNIT_ASSERT_NOT_NULL(sched);
+
+    executor_test_env_t env = {
+        .executor = avs_sched_executor_new(sched, EXECUTOR_WORKERS),
+        .jobs_remaining = 2 * EXECUTOR_KEYS * EXECUTOR_JOBS_PER_KEY
+    };
+    AVS_UNIT_ASSERT_NOT_NULL(env.executor);
+    AVS_UNIT_ASSERT_SUCCESS(avs_mutex_create(&env.mutex));
+
+    AVS_UNIT_ASSERT_SUCCESS(avs_mutex_lock(env.mutex));
+    for (size_t i = 0; i < EXECUTOR_WORKERS; ++i) {
+        AVS_UNIT_ASSERT_SUCCESS(pthread_create(&env.threads[i], NULL,
+                                               executor_worker_thread, &env));
+    }
+    AVS_UNIT_ASSERT_SUCCESS(avs_mutex_unlock(env.mutex));
+
+    for (size_t seq = 0; seq < EXECUTOR_JOBS_PER_KEY; ++seq) {
+        for (size_t key = 0; key < EXECUTOR_KEYS; ++key) {
+            const executor_job_args_t bound_args = { &env, key, seq };
+            AVS_UNIT_ASSERT_SUCCESS(AVS_SCHED_NOW_WITH_AFFINITY(
+                    sched, NULL, (uint64_t) key + 1, executor_job,
+                    &bound_args, sizeof(bound_args)));
+            const executor_job_args_t unbound_args = { &env, EXECUTOR_KEYS,
+                                                       seq };
+            AVS_UNIT_ASSERT_SUCCESS(AVS_SCHED_NOW(sched, NULL, executor_job,
+                                                  &unbound_args,
+                                                  sizeof(unbound_args)));
+        }
+    }
+
+    for (size_t i = 0; i < EXECUTOR_WORKERS; ++i) {
+        AVS_UNIT_ASSERT_SUCCESS(pthread_join(env.threads[i], NULL));
+    }
+    AVS_UNIT_ASSERT_EQUAL(env.jobs_remaining, 0);
+    AVS_UNIT_ASSERT_FALSE(env.order_violated);
+    for (size_t key = 0; key < EXECUTOR_KEYS; ++key) {
+        AVS_UNIT_ASSERT_EQUAL(env.bound_jobs_executed[key],
+                              EXECUTOR_JOBS_PER_KEY);
+    }
+
+    avs_sched_executor_cleanup(&env.executor);
+    avs_mutex_cleanup(&env.mutex);
+    avs_sched_cleanup(&sched);
+}
+#endif // AVS_COMMONS_SCHED_THREAD_SAFE
+
 #warning "TODO: More tests"
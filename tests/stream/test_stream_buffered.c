@@ -387,3 +387,200 @@ AVS_UNIT_TEST(stream_buffered, peek) {
 
     teardown_stream(&stream, &ctx);
 }
+
+AVS_UNIT_TEST(stream_buffered, peek_after_partial_read) {
+    stream_ctx_t ctx;
+    avs_stream_t *stream = setup_input_stream(&ctx);
+    char data[STREAM_SIZE];
+
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_read_reliably(stream, data, 10));
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(data, TEST_DATA, 10);
+
+    // requires fetching more data than fits in the buffer without wrapping
+    char value;
+    AVS_UNIT_ASSERT_SUCCESS(
+            avs_stream_peek(stream, STREAM_BUFFER_SIZE - 1, &value));
+    AVS_UNIT_ASSERT_EQUAL(value, TEST_DATA[10 + STREAM_BUFFER_SIZE - 1]);
+
+    AVS_UNIT_ASSERT_SUCCESS(
+            avs_stream_read_reliably(stream, data, STREAM_SIZE - 10));
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(data, TEST_DATA + 10, STREAM_SIZE - 10);
+
+    teardown_stream(&stream, &ctx);
+}
+
+AVS_UNIT_TEST(stream_buffered, write_vector_more_than_buffer_size) {
+    stream_ctx_t ctx;
+    avs_stream_t *stream = setup_output_stream(&ctx);
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_write(stream, TEST_DATA, 10));
+    AVS_UNIT_ASSERT_EQUAL(ctx.curr_offset, 0);
+
+    const avs_stream_const_iovec_t iov[] = {
+        { TEST_DATA + 10, 50 },
+        { TEST_DATA + 60, 40 }
+    };
+    size_t bytes_written = 0;
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_write_some_vector(
+            stream, iov, AVS_ARRAY_SIZE(iov), &bytes_written));
+    AVS_UNIT_ASSERT_EQUAL(bytes_written, 90);
+    // the data has been passed through without buffering
+    AVS_UNIT_ASSERT_EQUAL(ctx.curr_offset, 100);
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(ctx.data, TEST_DATA, 100);
+
+    teardown_stream(&stream, &ctx);
+}
+
+AVS_UNIT_TEST(stream_buffered, write_vector_writer_fail) {
+    stream_ctx_t ctx;
+    avs_stream_t *stream = setup_output_stream(&ctx);
+    WRITER_WRITE_ZERO = true;
+
+    const avs_stream_const_iovec_t iov[] = {
+        { TEST_DATA, STREAM_BUFFER_SIZE },
+        { TEST_DATA + STREAM_BUFFER_SIZE, 1 }
+    };
+    size_t bytes_written = 0;
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_write_some_vector(
+            stream, iov, AVS_ARRAY_SIZE(iov), &bytes_written));
+    AVS_UNIT_ASSERT_EQUAL(bytes_written, 0);
+    AVS_UNIT_ASSERT_FAILED(
+            avs_stream_write_vector(stream, iov, AVS_ARRAY_SIZE(iov)));
+
+    WRITER_WRITE_ZERO = false;
+    AVS_UNIT_ASSERT_SUCCESS(
+            avs_stream_write_vector(stream, iov, AVS_ARRAY_SIZE(iov)));
+    AVS_UNIT_ASSERT_EQUAL(ctx.curr_offset, STREAM_BUFFER_SIZE + 1);
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(ctx.data, TEST_DATA,
+                                      STREAM_BUFFER_SIZE + 1);
+
+    teardown_stream(&stream, &ctx);
+}
+
+AVS_UNIT_TEST(stream_buffered, read_vector) {
+    stream_ctx_t ctx;
+    avs_stream_t *stream = setup_input_stream(&ctx);
+    char first[10];
+    char second[20];
+    const avs_stream_iovec_t iov[] = {
+        { first, sizeof(first) },
+        { second, sizeof(second) }
+    };
+    size_t bytes_read;
+    bool message_finished;
+
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_read_vector(stream, &bytes_read,
+                                                   &message_finished, iov,
+                                                   AVS_ARRAY_SIZE(iov)));
+    AVS_UNIT_ASSERT_EQUAL(bytes_read, sizeof(first) + sizeof(second));
+    AVS_UNIT_ASSERT_FALSE(message_finished);
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(first, TEST_DATA, sizeof(first));
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(second, TEST_DATA + sizeof(first),
+                                      sizeof(second));
+
+    // the rest of the buffered data
+    char rest[STREAM_SIZE];
+    const avs_stream_iovec_t rest_iov = { rest, sizeof(rest) };
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_read_vector(
+            stream, &bytes_read, &message_finished, &rest_iov, 1));
+    AVS_UNIT_ASSERT_EQUAL(bytes_read, STREAM_BUFFER_SIZE - 30);
+    AVS_UNIT_ASSERT_FALSE(message_finished);
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(rest, TEST_DATA + 30, bytes_read);
+
+    teardown_stream(&stream, &ctx);
+}
+
+AVS_UNIT_TEST(stream_buffered, peek_span) {
+    stream_ctx_t ctx;
+    avs_stream_t *stream = setup_input_stream(&ctx);
+    const char *data;
+    size_t size;
+
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_peek_span(stream, 10, &data, &size));
+    AVS_UNIT_ASSERT_EQUAL(size, STREAM_BUFFER_SIZE - 10);
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(data, TEST_DATA + 10, size);
+
+    avs_error_t err =
+            avs_stream_peek_span(stream, STREAM_BUFFER_SIZE, &data, &size);
+    AVS_UNIT_ASSERT_EQUAL(err.category, AVS_ERRNO_CATEGORY);
+    AVS_UNIT_ASSERT_EQUAL(err.code, AVS_ENOBUFS);
+
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_consume_bytes(stream, 20));
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_peek_span(stream, 0, &data, &size));
+    AVS_UNIT_ASSERT_EQUAL(size, STREAM_BUFFER_SIZE - 20);
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(data, TEST_DATA + 20, size);
+
+    // the next spans may be split, but must contain all the data
+    size_t offset = 20;
+    while (offset < STREAM_SIZE) {
+        AVS_UNIT_ASSERT_SUCCESS(avs_stream_peek_span(stream, 0, &data, &size));
+        AVS_UNIT_ASSERT_TRUE(size > 0);
+        AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(data, TEST_DATA + offset, size);
+        AVS_UNIT_ASSERT_SUCCESS(avs_stream_consume_bytes(stream, size));
+        offset += size;
+    }
+    AVS_UNIT_ASSERT_EQUAL(offset, STREAM_SIZE);
+    AVS_UNIT_ASSERT_TRUE(
+            avs_is_eof(avs_stream_peek_span(stream, 0, &data, &size)));
+
+    teardown_stream(&stream, &ctx);
+}
+
+AVS_UNIT_TEST(stream_buffered, getline_across_buffer_fills) {
+    stream_ctx_t ctx;
+    avs_stream_t *stream = setup_input_stream(&ctx);
+    char expected[STREAM_BUFFER_SIZE];
+    // the first "\r\n" is split between two fills of the buffer
+    memset(ctx.data, 'a', STREAM_BUFFER_SIZE - 1);
+    memcpy(ctx.data + STREAM_BUFFER_SIZE - 1, "\r\n", 2);
+    memset(ctx.data + STREAM_BUFFER_SIZE + 1, 'b', 40);
+    memcpy(ctx.data + STREAM_BUFFER_SIZE + 41, "\n", 1);
+    memset(ctx.data + STREAM_BUFFER_SIZE + 42, 'c', 20);
+    memcpy(ctx.data + STREAM_BUFFER_SIZE + 62, "\r\n", 2);
+    AVS_STATIC_ASSERT(STREAM_BUFFER_SIZE + 64 == STREAM_SIZE, bad_test_data);
+
+    char line[STREAM_BUFFER_SIZE + 16];
+    size_t bytes_read;
+    bool message_finished;
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_getline(
+            stream, &bytes_read, &message_finished, line, sizeof(line)));
+    memset(expected, 'a', STREAM_BUFFER_SIZE - 1);
+    AVS_UNIT_ASSERT_EQUAL(bytes_read, STREAM_BUFFER_SIZE - 1);
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(line, expected, bytes_read);
+    AVS_UNIT_ASSERT_FALSE(message_finished);
+
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_peekline(stream, 41, NULL, NULL, line,
+                                                sizeof(line)));
+    AVS_UNIT_ASSERT_EQUAL_STRING(line, "cccccccccccccccccccc");
+
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_getline(
+            stream, &bytes_read, &message_finished, line, sizeof(line)));
+    memset(expected, 'b', 40);
+    AVS_UNIT_ASSERT_EQUAL(bytes_read, 40);
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(line, expected, bytes_read);
+
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_getline(
+            stream, &bytes_read, &message_finished, line, sizeof(line)));
+    AVS_UNIT_ASSERT_EQUAL_STRING(line, "cccccccccccccccccccc");
+
+    teardown_stream(&stream, &ctx);
+}
+
+AVS_UNIT_TEST(stream_buffered, write_f) {
+    stream_ctx_t ctx;
+    avs_stream_t *stream = setup_output_stream(&ctx);
+
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_write(stream, TEST_DATA, 14));
+    // does not fit in the space left along with the terminating nullbyte,
+    // so the buffer is flushed first
+    AVS_UNIT_ASSERT_SUCCESS(
+            avs_stream_write_f(stream, "%.*s", 50, TEST_DATA + 14));
+    AVS_UNIT_ASSERT_EQUAL(ctx.curr_offset, 14);
+    // does not fit in the buffer at all
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_write_f(
+            stream, "%.*s", STREAM_BUFFER_SIZE, TEST_DATA + 64));
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_finish_message(stream));
+    AVS_UNIT_ASSERT_EQUAL(ctx.curr_offset, STREAM_SIZE);
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(ctx.data, TEST_DATA, STREAM_SIZE);
+
+    teardown_stream(&stream, &ctx);
+}
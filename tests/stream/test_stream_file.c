@@ -169,3 +169,135 @@ AVS_UNIT_TEST(stream_file, extensions_length) {
     AVS_UNIT_ASSERT_SUCCESS(avs_stream_cleanup(&stream));
     unlink(filename);
 }
+
+AVS_UNIT_TEST(stream_file, handle) {
+    char filename[sizeof(TEMPLATE)];
+    avs_stream_t *stream;
+    FILE *file;
+    avs_off_t offset;
+    char value;
+
+    AVS_UNIT_ASSERT_SUCCESS(make_temporary(filename));
+    AVS_UNIT_ASSERT_NOT_NULL(
+            (stream = avs_stream_file_create(filename, AVS_STREAM_FILE_WRITE)));
+    AVS_UNIT_ASSERT_FAILED(avs_stream_file_handle(stream, &file, &offset));
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_cleanup(&stream));
+
+    AVS_UNIT_ASSERT_NOT_NULL(
+            (stream = avs_stream_file_create(
+                     filename, AVS_STREAM_FILE_WRITE | AVS_STREAM_FILE_READ)));
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_write(stream, "0123456789", 10));
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_file_seek(stream, 3));
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_file_handle(stream, &file, &offset));
+    AVS_UNIT_ASSERT_NOT_NULL(file);
+    AVS_UNIT_ASSERT_EQUAL(offset, 3);
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_getch(stream, &value, NULL));
+    AVS_UNIT_ASSERT_EQUAL(value, '3');
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_cleanup(&stream));
+    unlink(filename);
+}
+
+static void write_file(const char *filename, const char *data, size_t size) {
+    avs_stream_t *stream;
+    AVS_UNIT_ASSERT_NOT_NULL(
+            (stream = avs_stream_file_create(filename, AVS_STREAM_FILE_WRITE)));
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_write(stream, data, size));
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_cleanup(&stream));
+}
+
+AVS_UNIT_TEST(stream_file, mmap_read_peek_and_seek) {
+    char filename[sizeof(TEMPLATE)];
+    char buf[16];
+    size_t bytes_read;
+    bool end_of_msg;
+    char value;
+    avs_off_t offset;
+    avs_stream_t *stream;
+
+    AVS_UNIT_ASSERT_SUCCESS(make_temporary(filename));
+    write_file(filename, "0123456789", 10);
+    AVS_UNIT_ASSERT_NULL(avs_stream_file_create(
+            filename, AVS_STREAM_FILE_WRITE | AVS_STREAM_FILE_MMAP));
+    AVS_UNIT_ASSERT_NOT_NULL((stream = avs_stream_file_create(
+                                      filename, AVS_STREAM_FILE_READ
+                                                        | AVS_STREAM_FILE_MMAP)));
+    AVS_UNIT_ASSERT_FAILED(avs_stream_write(stream, "x", 1));
+
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_file_length(stream, &offset));
+    AVS_UNIT_ASSERT_EQUAL(offset, 10);
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_peek(stream, 9, &value));
+    AVS_UNIT_ASSERT_EQUAL(value, '9');
+    AVS_UNIT_ASSERT_TRUE(avs_is_eof(avs_stream_peek(stream, 10, &value)));
+
+    AVS_UNIT_ASSERT_SUCCESS(
+            avs_stream_read(stream, &bytes_read, &end_of_msg, buf, 4));
+    AVS_UNIT_ASSERT_EQUAL(bytes_read, 4);
+    AVS_UNIT_ASSERT_FALSE(end_of_msg);
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(buf, "0123", 4);
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_file_offset(stream, &offset));
+    AVS_UNIT_ASSERT_EQUAL(offset, 4);
+
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_file_seek(stream, 7));
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_read(stream, &bytes_read, &end_of_msg,
+                                            buf, sizeof(buf)));
+    AVS_UNIT_ASSERT_EQUAL(bytes_read, 3);
+    AVS_UNIT_ASSERT_TRUE(end_of_msg);
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(buf, "789", 3);
+
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_reset(stream));
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_getch(stream, &value, NULL));
+    AVS_UNIT_ASSERT_EQUAL(value, '0');
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_cleanup(&stream));
+    unlink(filename);
+}
+
+AVS_UNIT_TEST(stream_file, mmap_empty) {
+    char filename[sizeof(TEMPLATE)];
+    char buf[16];
+    size_t bytes_read;
+    bool end_of_msg;
+    avs_stream_t *stream;
+
+    AVS_UNIT_ASSERT_SUCCESS(make_temporary(filename));
+    AVS_UNIT_ASSERT_NOT_NULL((stream = avs_stream_file_create(
+                                      filename, AVS_STREAM_FILE_READ
+                                                        | AVS_STREAM_FILE_MMAP)));
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_read(stream, &bytes_read, &end_of_msg,
+                                            buf, sizeof(buf)));
+    AVS_UNIT_ASSERT_EQUAL(bytes_read, 0);
+    AVS_UNIT_ASSERT_TRUE(end_of_msg);
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_cleanup(&stream));
+    unlink(filename);
+
+    AVS_UNIT_ASSERT_NULL(avs_stream_file_create(
+            filename, AVS_STREAM_FILE_READ | AVS_STREAM_FILE_MMAP));
+}
+
+#ifdef AVS_COMMONS_STREAM_FILE_WITH_MMAP
+AVS_UNIT_TEST(stream_file, mmap_peek_span) {
+    char filename[sizeof(TEMPLATE)];
+    const char *data;
+    size_t size;
+    avs_stream_t *stream;
+
+    AVS_UNIT_ASSERT_SUCCESS(make_temporary(filename));
+    write_file(filename, "foo\nbar", 7);
+    AVS_UNIT_ASSERT_NOT_NULL((stream = avs_stream_file_create(
+                                      filename, AVS_STREAM_FILE_READ
+                                                        | AVS_STREAM_FILE_MMAP)));
+
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_peek_span(stream, 2, &data, &size));
+    AVS_UNIT_ASSERT_EQUAL(size, 5);
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(data, "o\nbar", 5);
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_consume_bytes(stream, 4));
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_peek_span(stream, 0, &data, &size));
+    AVS_UNIT_ASSERT_EQUAL(size, 3);
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(data, "bar", 3);
+    AVS_UNIT_ASSERT_FAILED(avs_stream_consume_bytes(stream, 4));
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_consume_bytes(stream, 3));
+    AVS_UNIT_ASSERT_TRUE(
+            avs_is_eof(avs_stream_peek_span(stream, 0, &data, &size)));
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_cleanup(&stream));
+    unlink(filename);
+}
+#endif // AVS_COMMONS_STREAM_FILE_WITH_MMAP
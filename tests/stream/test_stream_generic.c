@@ -217,6 +217,25 @@ AVS_UNIT_TEST(stream_generic, write_f) {
     test_output_streams(write_f_test);
 }
 
+static void write_vector_test(avs_stream_t *stream) {
+    const avs_stream_const_iovec_t iov[] = {
+        { TEST_DATA, 10 },
+        { NULL, 0 },
+        { TEST_DATA + 10, STREAM_SIZE - 11 }
+    };
+    size_t bytes_written = 0;
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_write_some_vector(
+            stream, iov, AVS_ARRAY_SIZE(iov), &bytes_written));
+    AVS_UNIT_ASSERT_EQUAL(bytes_written, STREAM_SIZE - 1);
+    const avs_stream_const_iovec_t last_byte = { TEST_DATA + STREAM_SIZE - 1,
+                                                 1 };
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_write_vector(stream, &last_byte, 1));
+}
+
+AVS_UNIT_TEST(stream_generic, write_vector) {
+    test_output_streams(write_vector_test);
+}
+
 /**
  * Input streams
  */
@@ -485,6 +504,32 @@ AVS_UNIT_TEST(stream_generic, ignore_to_end) {
     test_input_streams(ignore_to_end_test);
 }
 
+static void skip_test(avs_stream_t *stream) {
+    size_t bytes_skipped;
+    bool message_finished;
+    AVS_UNIT_ASSERT_SUCCESS(
+            avs_stream_skip(stream, &bytes_skipped, &message_finished, 5));
+    AVS_UNIT_ASSERT_EQUAL(bytes_skipped, 5);
+    AVS_UNIT_ASSERT_FALSE(message_finished);
+
+    char c;
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_getch(stream, &c, NULL));
+    AVS_UNIT_ASSERT_EQUAL(c, TEST_DATA[5]);
+
+    size_t offset = 6;
+    do {
+        AVS_UNIT_ASSERT_SUCCESS(avs_stream_skip(stream, &bytes_skipped,
+                                                &message_finished, SIZE_MAX));
+        offset += bytes_skipped;
+    } while (bytes_skipped > 0);
+    AVS_UNIT_ASSERT_EQUAL(offset, STREAM_SIZE);
+    AVS_UNIT_ASSERT_TRUE(message_finished);
+}
+
+AVS_UNIT_TEST(stream_generic, skip) {
+    test_input_streams(skip_test);
+}
+
 static void getch_test(avs_stream_t *stream) {
     char c;
     bool message_finished;
@@ -596,6 +641,39 @@ AVS_UNIT_TEST(stream_generic, getline_errors) {
     test_input_streams(getline_errors_test);
 }
 
+static void read_vector_test(avs_stream_t *stream) {
+    char buffer[STREAM_SIZE];
+    size_t already_read_bytes = 0;
+    bool message_finished = false;
+
+    while (!message_finished) {
+        char first[7];
+        char second[20];
+        const avs_stream_iovec_t iov[] = {
+            { first, sizeof(first) },
+            { NULL, 0 },
+            { second, sizeof(second) }
+        };
+        size_t bytes_read;
+        AVS_UNIT_ASSERT_SUCCESS(
+                avs_stream_read_vector(stream, &bytes_read, &message_finished,
+                                       iov, AVS_ARRAY_SIZE(iov)));
+        AVS_UNIT_ASSERT_TRUE(bytes_read > 0 || message_finished);
+        AVS_UNIT_ASSERT_TRUE(already_read_bytes + bytes_read <= STREAM_SIZE);
+        size_t first_size = AVS_MIN(bytes_read, sizeof(first));
+        memcpy(buffer + already_read_bytes, first, first_size);
+        memcpy(buffer + already_read_bytes + first_size, second,
+               bytes_read - first_size);
+        already_read_bytes += bytes_read;
+    }
+    AVS_UNIT_ASSERT_EQUAL(already_read_bytes, STREAM_SIZE);
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(buffer, TEST_DATA, STREAM_SIZE);
+}
+
+AVS_UNIT_TEST(stream_generic, read_vector) {
+    test_input_streams(read_vector_test);
+}
+
 //
 // Input + output
 //
@@ -136,6 +136,161 @@ AVS_UNIT_TEST(stream_membuf, defragment_partial) {
     AVS_UNIT_ASSERT_SUCCESS(avs_stream_cleanup(&stream));
 }
 
+AVS_UNIT_TEST(stream_membuf, reserve) {
+    avs_stream_t *stream =
+            avs_stream_membuf_create_ex(AVS_STREAM_MEMBUF_CONTIGUOUS, 100);
+    AVS_UNIT_ASSERT_NOT_NULL(stream);
+    avs_stream_membuf_t *internal = (avs_stream_membuf_t *) stream;
+    AVS_UNIT_ASSERT_EQUAL(internal->buffer_size, 100);
+    const char *buffer = internal->buffer;
+    char data[100] = "";
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_write(stream, data, sizeof(data)));
+    AVS_UNIT_ASSERT_TRUE(internal->buffer == buffer);
+    AVS_UNIT_ASSERT_EQUAL(internal->buffer_size, 100);
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_cleanup(&stream));
+}
+
+static size_t count_chunks(const chunked_membuf_t *stream) {
+    size_t count = 0;
+    for (const membuf_chunk_t *chunk = stream->head; chunk;
+         chunk = chunk->next) {
+        ++count;
+    }
+    return count;
+}
+
+AVS_UNIT_TEST(stream_membuf, chunked_write_read) {
+    avs_stream_t *stream =
+            avs_stream_membuf_create_ex(AVS_STREAM_MEMBUF_CHUNKED, 0);
+    AVS_UNIT_ASSERT_NOT_NULL(stream);
+    chunked_membuf_t *internal = (chunked_membuf_t *) stream;
+
+    char data[100000];
+    for (size_t i = 0; i < sizeof(data); ++i) {
+        data[i] = (char) ('a' + i % 26);
+    }
+    for (size_t i = 0; i < sizeof(data); i += 100) {
+        AVS_UNIT_ASSERT_SUCCESS(avs_stream_write(stream, &data[i], 100));
+    }
+    // chunk sizes grow geometrically
+    AVS_UNIT_ASSERT_TRUE(count_chunks(internal) <= 10);
+
+    avs_off_t offset;
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_offset(stream, &offset));
+    AVS_UNIT_ASSERT_EQUAL(offset, sizeof(data));
+    char value;
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_peek(stream, 99999, &value));
+    AVS_UNIT_ASSERT_EQUAL(value, data[99999]);
+    AVS_UNIT_ASSERT_TRUE(avs_is_eof(avs_stream_peek(stream, 100000, &value)));
+
+    char buf[sizeof(data)];
+    size_t bytes_read;
+    bool message_finished;
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_read(stream, &bytes_read,
+                                            &message_finished, buf, 1000));
+    AVS_UNIT_ASSERT_EQUAL(bytes_read, 1000);
+    AVS_UNIT_ASSERT_FALSE(message_finished);
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_read(stream, &bytes_read,
+                                            &message_finished, &buf[1000],
+                                            sizeof(buf)));
+    AVS_UNIT_ASSERT_EQUAL(bytes_read, sizeof(data) - 1000);
+    AVS_UNIT_ASSERT_TRUE(message_finished);
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(buf, data, sizeof(data));
+    // only the last chunk is kept for reuse
+    AVS_UNIT_ASSERT_EQUAL(count_chunks(internal), 1);
+    AVS_UNIT_ASSERT_EQUAL(internal->space_left, internal->head->capacity);
+
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_cleanup(&stream));
+}
+
+AVS_UNIT_TEST(stream_membuf, chunked_peek_span) {
+    avs_stream_t *stream =
+            avs_stream_membuf_create_ex(AVS_STREAM_MEMBUF_CHUNKED, 4);
+    AVS_UNIT_ASSERT_NOT_NULL(stream);
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_write(stream, "foo\nbar", 7));
+    AVS_UNIT_ASSERT_EQUAL(count_chunks((chunked_membuf_t *) stream), 2);
+
+    const char *data;
+    size_t size;
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_peek_span(stream, 2, &data, &size));
+    AVS_UNIT_ASSERT_EQUAL(size, 2);
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(data, "o\n", 2);
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_peek_span(stream, 4, &data, &size));
+    AVS_UNIT_ASSERT_EQUAL(size, 3);
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(data, "bar", 3);
+    AVS_UNIT_ASSERT_TRUE(
+            avs_is_eof(avs_stream_peek_span(stream, 7, &data, &size)));
+
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_consume_bytes(stream, 5));
+    AVS_UNIT_ASSERT_EQUAL(count_chunks((chunked_membuf_t *) stream), 1);
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_peek_span(stream, 0, &data, &size));
+    AVS_UNIT_ASSERT_EQUAL(size, 2);
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(data, "ar", 2);
+    AVS_UNIT_ASSERT_FAILED(avs_stream_consume_bytes(stream, 3));
+
+    char line[16];
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_reset(stream));
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_write(stream, "foo\nbar", 7));
+    AVS_UNIT_ASSERT_SUCCESS(
+            avs_stream_getline(stream, NULL, NULL, line, sizeof(line)));
+    AVS_UNIT_ASSERT_EQUAL_STRING(line, "foo");
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_cleanup(&stream));
+}
+
+AVS_UNIT_TEST(stream_membuf, chunked_ensure_free_bytes) {
+    avs_stream_t *stream =
+            avs_stream_membuf_create_ex(AVS_STREAM_MEMBUF_CHUNKED, 0);
+    AVS_UNIT_ASSERT_NOT_NULL(stream);
+    chunked_membuf_t *internal = (chunked_membuf_t *) stream;
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_write(stream, "x", 1));
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_membuf_ensure_free_bytes(stream, 1000));
+    size_t capacity = internal->capacity;
+    char data[1000] = "";
+    avs_stream_const_iovec_t iov[] = { { data, 500 }, { data, 500 } };
+    AVS_UNIT_ASSERT_SUCCESS(
+            avs_stream_write_vector(stream, iov, AVS_ARRAY_SIZE(iov)));
+    AVS_UNIT_ASSERT_EQUAL(internal->capacity, capacity);
+    avs_off_t offset;
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_offset(stream, &offset));
+    AVS_UNIT_ASSERT_EQUAL(offset, 1001);
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_cleanup(&stream));
+}
+
+AVS_UNIT_TEST(stream_membuf, chunked_take_ownership) {
+    avs_stream_t *stream =
+            avs_stream_membuf_create_ex(AVS_STREAM_MEMBUF_CHUNKED, 0);
+    AVS_UNIT_ASSERT_NOT_NULL(stream);
+    char data[2000];
+    for (size_t i = 0; i < sizeof(data); ++i) {
+        data[i] = (char) ('a' + i % 26);
+    }
+    for (size_t i = 0; i < sizeof(data); i += 10) {
+        AVS_UNIT_ASSERT_SUCCESS(avs_stream_write(stream, &data[i], 10));
+    }
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_consume_bytes(stream, 3));
+
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_membuf_fit(stream));
+    AVS_UNIT_ASSERT_EQUAL(count_chunks((chunked_membuf_t *) stream), 1);
+    AVS_UNIT_ASSERT_EQUAL(((chunked_membuf_t *) stream)->capacity,
+                          sizeof(data) - 3);
+
+    void *ptr;
+    size_t size;
+    AVS_UNIT_ASSERT_SUCCESS(
+            avs_stream_membuf_take_ownership(stream, &ptr, &size));
+    AVS_UNIT_ASSERT_EQUAL(size, sizeof(data) - 3);
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(ptr, &data[3], size);
+    avs_free(ptr);
+    AVS_UNIT_ASSERT_EQUAL(count_chunks((chunked_membuf_t *) stream), 0);
+
+    AVS_UNIT_ASSERT_SUCCESS(
+            avs_stream_membuf_take_ownership(stream, &ptr, &size));
+    AVS_UNIT_ASSERT_NULL(ptr);
+    AVS_UNIT_ASSERT_EQUAL(size, 0);
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_write(stream, "foo", 3));
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_cleanup(&stream));
+}
+
 AVS_UNIT_TEST(stream_getline, simple) {
     avs_stream_t *stream = avs_stream_membuf_create();
     AVS_UNIT_ASSERT_SUCCESS(
@@ -309,3 +464,160 @@ AVS_UNIT_TEST(stream_getline, inline_cr) {
     AVS_UNIT_ASSERT_TRUE(msg_finished);
     AVS_UNIT_ASSERT_SUCCESS(avs_stream_cleanup(&stream));
 }
+
+AVS_UNIT_TEST(stream_membuf, vector) {
+    avs_stream_t *stream = avs_stream_membuf_create();
+    AVS_UNIT_ASSERT_NOT_NULL(stream);
+    const avs_stream_const_iovec_t write_iov[] = {
+        { "ab", 2 },
+        { NULL, 0 },
+        { "cdefg", 5 }
+    };
+    size_t bytes_written = 0;
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_write_some_vector(
+            stream, write_iov, AVS_ARRAY_SIZE(write_iov), &bytes_written));
+    AVS_UNIT_ASSERT_EQUAL(bytes_written, 7);
+
+    char first[3];
+    char second[8];
+    const avs_stream_iovec_t read_iov[] = {
+        { first, sizeof(first) },
+        { second, sizeof(second) }
+    };
+    size_t bytes_read;
+    bool message_finished;
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_read_vector(stream, &bytes_read,
+                                                   &message_finished, read_iov,
+                                                   AVS_ARRAY_SIZE(read_iov)));
+    AVS_UNIT_ASSERT_EQUAL(bytes_read, 7);
+    AVS_UNIT_ASSERT_TRUE(message_finished);
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(first, "abc", 3);
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(second, "defg", 4);
+
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_cleanup(&stream));
+}
+
+AVS_UNIT_TEST(stream_membuf, peek_span) {
+    avs_stream_t *stream = avs_stream_membuf_create();
+    AVS_UNIT_ASSERT_NOT_NULL(stream);
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_write(stream, "foo\nbar", 7));
+
+    const char *data;
+    size_t size;
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_peek_span(stream, 2, &data, &size));
+    AVS_UNIT_ASSERT_EQUAL(size, 5);
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(data, "o\nbar", 5);
+    AVS_UNIT_ASSERT_TRUE(
+            avs_is_eof(avs_stream_peek_span(stream, 7, &data, &size)));
+
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_consume_bytes(stream, 4));
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_peek_span(stream, 0, &data, &size));
+    AVS_UNIT_ASSERT_EQUAL(size, 3);
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(data, "bar", 3);
+    AVS_UNIT_ASSERT_FAILED(avs_stream_consume_bytes(stream, 4));
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_consume_bytes(stream, 3));
+    AVS_UNIT_ASSERT_TRUE(
+            avs_is_eof(avs_stream_peek_span(stream, 0, &data, &size)));
+
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_cleanup(&stream));
+}
+
+AVS_UNIT_TEST(stream_membuf, copy) {
+    // larger than the stack buffer used by avs_stream_copy() otherwise
+    char data[2000];
+    for (size_t i = 0; i < sizeof(data); ++i) {
+        data[i] = (char) ('a' + i % 26);
+    }
+    avs_stream_t *input = avs_stream_membuf_create();
+    AVS_UNIT_ASSERT_NOT_NULL(input);
+    avs_stream_t *output = avs_stream_membuf_create();
+    AVS_UNIT_ASSERT_NOT_NULL(output);
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_write(input, data, sizeof(data)));
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_consume_bytes(input, 10));
+
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_copy(output, input));
+    AVS_UNIT_ASSERT_TRUE(avs_is_eof(avs_stream_peek(input, 0, &(char) { 0 })));
+
+    char buf[sizeof(data)];
+    size_t bytes_read;
+    bool message_finished;
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_read(output, &bytes_read,
+                                            &message_finished, buf,
+                                            sizeof(buf)));
+    AVS_UNIT_ASSERT_EQUAL(bytes_read, sizeof(data) - 10);
+    AVS_UNIT_ASSERT_TRUE(message_finished);
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(buf, &data[10], bytes_read);
+
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_cleanup(&input));
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_cleanup(&output));
+}
+
+AVS_UNIT_TEST(stream_membuf, reserve_commit) {
+    avs_stream_t *stream = avs_stream_membuf_create();
+    AVS_UNIT_ASSERT_NOT_NULL(stream);
+    char *span;
+    size_t size;
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_reserve_span(stream, 0, &span, &size));
+    AVS_UNIT_ASSERT_EQUAL(size, 0);
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_reserve_span(stream, 5, &span, &size));
+    AVS_UNIT_ASSERT_TRUE(size >= 5);
+    memcpy(span, "hello", 5);
+    AVS_UNIT_ASSERT_FAILED(avs_stream_commit_bytes(stream, size + 1));
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_commit_bytes(stream, 3));
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_write(stream, "p", 1));
+
+    char buf[16];
+    size_t bytes_read;
+    AVS_UNIT_ASSERT_SUCCESS(
+            avs_stream_read(stream, &bytes_read, NULL, buf, sizeof(buf)));
+    AVS_UNIT_ASSERT_EQUAL(bytes_read, 4);
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(buf, "help", 4);
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_cleanup(&stream));
+}
+
+AVS_UNIT_TEST(stream_membuf, write_f_direct) {
+    // larger than the stack buffer used by avs_stream_write_fv() otherwise
+    char data[1000];
+    memset(data, 'x', sizeof(data) - 1);
+    data[sizeof(data) - 1] = '\0';
+    avs_stream_t *stream =
+            avs_stream_membuf_create_ex(AVS_STREAM_MEMBUF_CONTIGUOUS, 2000);
+    AVS_UNIT_ASSERT_NOT_NULL(stream);
+    avs_stream_membuf_t *internal = (avs_stream_membuf_t *) stream;
+    const char *buffer = internal->buffer;
+
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_write_f(stream, "%s%d", data, 42));
+    // formatted directly into the reserved buffer
+    AVS_UNIT_ASSERT_TRUE(internal->buffer == buffer);
+    AVS_UNIT_ASSERT_EQUAL(internal->index_write, sizeof(data) + 1);
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(buffer, data, sizeof(data) - 1);
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(&buffer[sizeof(data) - 1], "42", 2);
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_cleanup(&stream));
+}
+
+AVS_UNIT_TEST(stream_membuf, chunked_write_f) {
+    char data[1000];
+    memset(data, 'x', sizeof(data) - 1);
+    data[sizeof(data) - 1] = '\0';
+    avs_stream_t *stream =
+            avs_stream_membuf_create_ex(AVS_STREAM_MEMBUF_CHUNKED, 4);
+    AVS_UNIT_ASSERT_NOT_NULL(stream);
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_write(stream, "ab", 2));
+    // does not fit in the first chunk, which is left partially filled
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_write_f(stream, "%s", data));
+    AVS_UNIT_ASSERT_EQUAL(count_chunks((chunked_membuf_t *) stream), 2);
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_write_f(stream, "%d", 42));
+
+    char buf[sizeof(data) + 8];
+    size_t bytes_read;
+    bool message_finished;
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_read(stream, &bytes_read,
+                                            &message_finished, buf,
+                                            sizeof(buf)));
+    AVS_UNIT_ASSERT_EQUAL(bytes_read, sizeof(data) + 3);
+    AVS_UNIT_ASSERT_TRUE(message_finished);
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(buf, "ab", 2);
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(&buf[2], data, sizeof(data) - 1);
+    AVS_UNIT_ASSERT_EQUAL_BYTES_SIZED(&buf[sizeof(data) + 1], "42", 2);
+    AVS_UNIT_ASSERT_SUCCESS(avs_stream_cleanup(&stream));
+}
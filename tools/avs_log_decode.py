@@ -0,0 +1,203 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+#
+# Copyright 2023 AVSystem <avsystem@avsystem.com>
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+'''
+Decodes binary log streams, as passed to avs_log_async_config_t::binary_writer,
+into text. Each message is printed in the same format as used by the default
+avs_log handler:
+
+    LEVEL [module] [file:line]: message
+
+Formatting is done by Python, so it may differ from the C library in corner
+cases, e.g. %a conversions are printed as by float.hex().
+'''
+
+import argparse
+import re
+import struct
+import sys
+
+MAGIC = b'AVSLOGB1'
+LEVELS = ['TRACE', 'DEBUG', 'INFO', 'WARNING', 'ERROR']
+
+SPEC_RE = re.compile(
+    rb"%([-+ #0']*)(\*|[0-9]*)(?:\.(\*|[0-9]*))?(hh|h|ll|l|j|z|t|L)?(.)",
+    re.DOTALL)
+
+ARG_FORMATS = {
+    b'i': '<q',
+    b'u': '<Q',
+    b'f': '<d',
+    b'p': '<Q',
+}
+
+
+class DecodeError(Exception):
+    pass
+
+
+class Reader:
+    def __init__(self, data):
+        self.data = data
+        self.pos = 0
+
+    def eof(self):
+        return self.pos >= len(self.data)
+
+    def take(self, size):
+        if len(self.data) - self.pos < size:
+            raise DecodeError('unexpected end of data')
+        result = self.data[self.pos:self.pos + size]
+        self.pos += size
+        return result
+
+    def unpack(self, fmt):
+        return struct.unpack(fmt, self.take(struct.calcsize(fmt)))[0]
+
+    def string(self):
+        return self.take(self.unpack('<H'))
+
+    def arg(self, tag):
+        if self.take(1) != tag:
+            raise DecodeError('argument type does not match the format')
+        if tag == b's':
+            return self.string()
+        return self.unpack(ARG_FORMATS[tag])
+
+
+def pad(text, flags, width):
+    if width is None or len(text) >= width:
+        return text
+    if '-' in flags:
+        return text.ljust(width)
+    return text.rjust(width)
+
+
+def format_spec(match, args):
+    flags, width, precision, _, conversion = (
+        group.decode('ascii', 'replace') if group is not None else None
+        for group in match.groups())
+    flags = flags.replace("'", '')
+    if conversion == '%':
+        return '%'
+
+    if width == '*':
+        width = args.arg(b'i')
+        if width < 0:
+            flags += '-'
+            width = -width
+    else:
+        width = int(width) if width else None
+    if precision == '*':
+        precision = args.arg(b'i')
+        if precision < 0:
+            precision = None
+    elif precision is not None:
+        precision = int(precision) if precision else 0
+
+    def spec(conv, spec_flags=flags):
+        return '%' + spec_flags + (str(width) if width is not None else '') + (
+            '.' + str(precision) if precision is not None else '') + conv
+
+    if conversion in 'di':
+        return spec('d') % args.arg(b'i')
+    if conversion == 'c':
+        return pad(chr(args.arg(b'i') & 0xff), flags, width)
+    if conversion in 'uxX':
+        value = args.arg(b'u')
+        # C does not prefix zero with 0x
+        return spec('d' if conversion == 'u' else conversion,
+                    flags if value else flags.replace('#', '')) % value
+    if conversion == 'o':
+        value = args.arg(b'u')
+        text = ('%.' + str(precision or 1) + 'o') % value
+        if '#' in flags and not text.startswith('0'):
+            text = '0' + text
+        if '0' in flags and '-' not in flags and precision is None:
+            return text.rjust(width or 0, '0')
+        return pad(text, flags, width)
+    if conversion in 'eEfFgG':
+        return spec(conversion) % args.arg(b'f')
+    if conversion in 'aA':
+        text = re.sub(r'\.?0+p', 'p', float.hex(args.arg(b'f')))
+        return pad(text.upper() if conversion == 'A' else text, flags, width)
+    if conversion == 'p':
+        value = args.arg(b'p')
+        return pad('0x%x' % value if value else '(nil)', flags, width)
+    if conversion == 's':
+        return pad(args.arg(b's').decode('utf-8', 'replace'), flags, width)
+    raise DecodeError('unsupported conversion: %%%s' % (conversion, ))
+
+
+def format_message(fmt, args):
+    reader = Reader(args)
+    result = []
+    pos = 0
+    for match in SPEC_RE.finditer(fmt):
+        result.append(fmt[pos:match.start()].decode('utf-8', 'replace'))
+        result.append(format_spec(match, reader))
+        pos = match.end()
+    if b'%' in fmt[pos:]:
+        raise DecodeError('malformed format string')
+    result.append(fmt[pos:].decode('utf-8', 'replace'))
+    return ''.join(result)
+
+
+def decode(data, out):
+    reader = Reader(data)
+    if reader.take(len(MAGIC)) != MAGIC:
+        raise DecodeError('not a binary log stream')
+    while not reader.eof():
+        # streams may be concatenated
+        if data.startswith(MAGIC, reader.pos):
+            reader.pos += len(MAGIC)
+            continue
+        level = reader.unpack('<B')
+        line = reader.unpack('<I')
+        module = reader.string().decode('utf-8', 'replace')
+        file = reader.string().decode('utf-8', 'replace')
+        fmt = reader.string()
+        message = format_message(fmt, reader.string())
+        level = LEVELS[level] if level < len(LEVELS) else 'WTF'
+        out.write('%s [%s] [%s:%u]: %s\n' % (level, module, file, line,
+                                             message))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('files', metavar='FILE', nargs='*',
+                        help='Binary log files to decode. Standard input is '
+                        'read if none are given.')
+    args = parser.parse_args()
+
+    inputs = args.files or ['-']
+    for name in inputs:
+        if name == '-':
+            data = sys.stdin.buffer.read()
+        else:
+            with open(name, 'rb') as f:
+                data = f.read()
+        try:
+            decode(data, sys.stdout)
+        except DecodeError as e:
+            sys.stderr.write('%s: %s\n' % (name, e))
+            return 1
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,159 @@
+/*
+ * Copyright 2023 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Micro-benchmark comparing avs_buffer_t and avs_ring_buffer_t as used by the
+ * buffered and netbuf streams. Built if the project is configured with
+ * -DWITH_BENCHMARKS=ON.
+ *
+ * Usage: buffer_benchmark [TOTAL_BYTES]
+ *
+ * A producer repeatedly "receives" up to RECV_SIZE bytes into the free space
+ * of the buffer, and a consumer reads fixed-size records out of it. Records
+ * are only read as a whole, so some data is always left pending between
+ * rounds. avs_buffer_t moves that pending data to the front of the buffer
+ * whenever new data is inserted; the number of bytes moved that way is
+ * reported relative to the number of bytes transferred.
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <avsystem/commons/avs_buffer.h>
+#include <avsystem/commons/avs_time.h>
+
+#define DEFAULT_TOTAL_BYTES (256 * 1024 * 1024)
+
+#define BUFFER_SIZE 4096
+#define RECV_SIZE 1460
+
+static const size_t RECORD_SIZES[] = { 16, 200, 1000, 3000 };
+
+static int64_t elapsed_us(avs_time_monotonic_t since) {
+    int64_t result;
+    avs_time_duration_to_scalar(&result, AVS_TIME_US,
+                                avs_time_monotonic_diff(
+                                        avs_time_monotonic_now(), since));
+    return result;
+}
+
+static size_t fake_recv(char *dest, size_t size, size_t *counter) {
+    if (size > RECV_SIZE) {
+        size = RECV_SIZE;
+    }
+    for (size_t i = 0; i < size; ++i) {
+        dest[i] = (char) (*counter)++;
+    }
+    return size;
+}
+
+static int check_record(const char *record, size_t size, size_t *counter) {
+    for (size_t i = 0; i < size; ++i) {
+        if (record[i] != (char) (*counter)++) {
+            fprintf(stderr, "data mismatch\n");
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static int bench_linear(size_t total_bytes, size_t record_size) {
+    avs_buffer_t *buffer;
+    if (avs_buffer_create(&buffer, BUFFER_SIZE)) {
+        return -1;
+    }
+    const char *base = avs_buffer_data(buffer);
+    char record[BUFFER_SIZE];
+    size_t produced = 0;
+    size_t consumed = 0;
+    uint64_t moved = 0;
+    int result = 0;
+
+    avs_time_monotonic_t start = avs_time_monotonic_now();
+    while (!result && consumed < total_bytes) {
+        if (avs_buffer_data(buffer) != base) {
+            moved += avs_buffer_data_size(buffer);
+        }
+        size_t received =
+                fake_recv(avs_buffer_raw_insert_ptr(buffer),
+                          avs_buffer_space_left(buffer), &produced);
+        avs_buffer_advance_ptr(buffer, received);
+        while (!result && avs_buffer_data_size(buffer) >= record_size) {
+            memcpy(record, avs_buffer_data(buffer), record_size);
+            avs_buffer_consume_bytes(buffer, record_size);
+            result = check_record(record, record_size, &consumed);
+        }
+    }
+    int64_t us = elapsed_us(start);
+
+    printf("%-12s record %4zu: %12zu bytes %10" PRId64
+           " us %8.3f bytes moved/byte\n",
+           "avs_buffer", record_size, consumed, us,
+           (double) moved / (double) consumed);
+    avs_buffer_free(&buffer);
+    return result;
+}
+
+static int bench_ring(size_t total_bytes, size_t record_size) {
+    avs_ring_buffer_t *buffer;
+    if (avs_ring_buffer_create(&buffer, BUFFER_SIZE)) {
+        return -1;
+    }
+    char record[BUFFER_SIZE];
+    size_t produced = 0;
+    size_t consumed = 0;
+    int result = 0;
+
+    avs_time_monotonic_t start = avs_time_monotonic_now();
+    while (!result && consumed < total_bytes) {
+        avs_ring_buffer_segment_t segments[2];
+        if (avs_ring_buffer_space_segments(buffer, segments)) {
+            size_t received =
+                    fake_recv(segments[0].ptr, segments[0].size, &produced);
+            avs_ring_buffer_advance_ptr(buffer, received);
+        }
+        while (!result && avs_ring_buffer_data_size(buffer) >= record_size) {
+            avs_ring_buffer_copy_data(buffer, 0, record, record_size);
+            avs_ring_buffer_consume_bytes(buffer, record_size);
+            result = check_record(record, record_size, &consumed);
+        }
+    }
+    int64_t us = elapsed_us(start);
+
+    printf("%-12s record %4zu: %12zu bytes %10" PRId64
+           " us %8.3f bytes moved/byte\n",
+           "ring_buffer", record_size, consumed, us, 0.0);
+    avs_ring_buffer_free(&buffer);
+    return result;
+}
+
+int main(int argc, char *argv[]) {
+    size_t total_bytes = DEFAULT_TOTAL_BYTES;
+    if (argc > 2 || (argc == 2 && !(total_bytes = strtoul(argv[1], NULL, 0)))) {
+        fprintf(stderr, "usage: %s [TOTAL_BYTES]\n", argv[0]);
+        return 1;
+    }
+
+    for (size_t i = 0; i < sizeof(RECORD_SIZES) / sizeof(*RECORD_SIZES); ++i) {
+        if (bench_linear(total_bytes, RECORD_SIZES[i])
+                || bench_ring(total_bytes, RECORD_SIZES[i])) {
+            return 1;
+        }
+    }
+    return 0;
+}
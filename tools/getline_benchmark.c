@@ -0,0 +1,152 @@
+/*
+ * Copyright 2023 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Micro-benchmark of avs_stream_getline() used the way the HTTP client reads
+ * response headers. Built if the project is configured with
+ * -DWITH_BENCHMARKS=ON.
+ *
+ * Usage: getline_benchmark [ITERATIONS]
+ *
+ * Each iteration parses a typical response header block, line by line, through
+ * a buffered stream (with the same input buffer size as the HTTP client) on
+ * top of a simple input stream, and through a membuf stream.
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <avsystem/commons/avs_stream_buffered.h>
+#include <avsystem/commons/avs_stream_membuf.h>
+#include <avsystem/commons/avs_stream_simple_io.h>
+#include <avsystem/commons/avs_time.h>
+
+#define DEFAULT_ITERATIONS 200000
+
+#define IN_BUFFER_SIZE 4096
+#define LINE_BUFFER_SIZE 512
+
+static const char HEADERS[] =
+        "HTTP/1.1 200 OK\r\n"
+        "Date: Mon, 27 Jul 2009 12:28:53 GMT\r\n"
+        "Server: Apache/2.2.14 (Win32)\r\n"
+        "Last-Modified: Wed, 22 Jul 2009 19:15:56 GMT\r\n"
+        "ETag: \"34aa387-d-1568eb00\"\r\n"
+        "Accept-Ranges: bytes\r\n"
+        "Cache-Control: no-cache, no-store, max-age=0, must-revalidate\r\n"
+        "Content-Type: application/vnd.oma.lwm2m+tlv; charset=utf-8\r\n"
+        "Content-Length: 1048576\r\n"
+        "Set-Cookie: session=0123456789abcdef0123456789abcdef; Path=/; "
+        "HttpOnly; Secure\r\n"
+        "Strict-Transport-Security: max-age=63072000; includeSubDomains\r\n"
+        "X-Request-Id: 5f0c7b8e-2a4d-4c61-9b8f-0e1d2c3b4a59\r\n"
+        "Vary: Accept-Encoding, Origin\r\n"
+        "Connection: keep-alive\r\n"
+        "\r\n";
+
+typedef struct {
+    size_t offset;
+} reader_ctx_t;
+
+static int64_t elapsed_us(avs_time_monotonic_t since) {
+    int64_t result;
+    avs_time_duration_to_scalar(&result, AVS_TIME_US,
+                                avs_time_monotonic_diff(
+                                        avs_time_monotonic_now(), since));
+    return result;
+}
+
+static int reader(void *ctx_, void *buffer, size_t *inout_size) {
+    reader_ctx_t *ctx = (reader_ctx_t *) ctx_;
+    size_t size = sizeof(HEADERS) - 1 - ctx->offset;
+    if (size > *inout_size) {
+        size = *inout_size;
+    }
+    memcpy(buffer, HEADERS + ctx->offset, size);
+    ctx->offset += size;
+    *inout_size = size;
+    return 0;
+}
+
+static int read_headers(avs_stream_t *stream, size_t *inout_bytes) {
+    char line[LINE_BUFFER_SIZE];
+    size_t bytes_read;
+    do {
+        if (avs_is_err(avs_stream_getline(stream, &bytes_read, NULL, line,
+                                          sizeof(line)))) {
+            fprintf(stderr, "getline failed\n");
+            return -1;
+        }
+        *inout_bytes += bytes_read;
+    } while (bytes_read);
+    return 0;
+}
+
+static void report(const char *name, size_t bytes, int64_t us) {
+    printf("%-10s %12zu bytes %10" PRId64 " us %8.1f MB/s\n", name, bytes, us,
+           (double) bytes / (double) us);
+}
+
+static int bench_buffered(unsigned long iterations) {
+    reader_ctx_t ctx;
+    avs_stream_t *stream = avs_stream_simple_input_create(reader, &ctx);
+    if (!stream || avs_stream_buffered_create(&stream, IN_BUFFER_SIZE, 0)) {
+        avs_stream_cleanup(&stream);
+        return -1;
+    }
+    size_t bytes = 0;
+    int result = 0;
+    avs_time_monotonic_t start = avs_time_monotonic_now();
+    for (unsigned long i = 0; !result && i < iterations; ++i) {
+        ctx.offset = 0;
+        result = read_headers(stream, &bytes);
+    }
+    report("buffered", bytes, elapsed_us(start));
+    avs_stream_cleanup(&stream);
+    return result;
+}
+
+static int bench_membuf(unsigned long iterations) {
+    avs_stream_t *stream = avs_stream_membuf_create();
+    if (!stream) {
+        return -1;
+    }
+    size_t bytes = 0;
+    int result = 0;
+    avs_time_monotonic_t start = avs_time_monotonic_now();
+    for (unsigned long i = 0; !result && i < iterations; ++i) {
+        if (avs_is_err(avs_stream_write(stream, HEADERS,
+                                        sizeof(HEADERS) - 1))) {
+            result = -1;
+        } else {
+            result = read_headers(stream, &bytes);
+        }
+    }
+    report("membuf", bytes, elapsed_us(start));
+    avs_stream_cleanup(&stream);
+    return result;
+}
+
+int main(int argc, char *argv[]) {
+    unsigned long iterations = DEFAULT_ITERATIONS;
+    if (argc > 2 || (argc == 2 && !(iterations = strtoul(argv[1], NULL, 0)))) {
+        fprintf(stderr, "usage: %s [ITERATIONS]\n", argv[0]);
+        return 1;
+    }
+    return bench_buffered(iterations) || bench_membuf(iterations) ? 1 : 0;
+}
@@ -0,0 +1,283 @@
+/*
+ * Copyright 2023 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Micro-benchmark comparing the content decoders of avs_http: zlib ("gzip" and
+ * "deflate"), Brotli ("br") and zstd ("zstd"). Built if the project is
+ * configured with -DWITH_BENCHMARKS=ON; only the decoders enabled with
+ * WITH_AVS_HTTP_ZLIB, WITH_AVS_HTTP_BROTLI and WITH_AVS_HTTP_ZSTD are compared.
+ *
+ * Usage: http_decoding_benchmark [TOTAL_BYTES]
+ *
+ * A synthetic payload, resembling a JSON report sent to a device, is compressed
+ * with each codec, at a level typical for compressing on the fly and at the
+ * highest level, as used for static content. Then it is repeatedly decoded
+ * through a decoder stream with the default avs_http buffer sizes, until
+ * TOTAL_BYTES of decompressed data have been produced. A new decoder is created
+ * for each payload, so the results for small payloads include setup costs.
+ */
+
+#define AVS_SUPPRESS_POISONING
+#include <avs_commons_init.h>
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef AVS_COMMONS_HTTP_WITH_ZLIB
+#    include <zlib.h>
+#endif // AVS_COMMONS_HTTP_WITH_ZLIB
+#ifdef AVS_COMMONS_HTTP_WITH_BROTLI
+#    include <brotli/encode.h>
+#endif // AVS_COMMONS_HTTP_WITH_BROTLI
+#ifdef AVS_COMMONS_HTTP_WITH_ZSTD
+#    include <zstd.h>
+#endif // AVS_COMMONS_HTTP_WITH_ZSTD
+
+#include <avsystem/commons/avs_time.h>
+#include <avsystem/commons/avs_utils.h>
+
+#include "http/avs_compression.h"
+#include "http/avs_decompressor.h"
+
+#define DEFAULT_TOTAL_BYTES (64 * 1024 * 1024)
+
+/* defaults from AVS_HTTP_DEFAULT_BUFFER_SIZES */
+#define CODING_IN_BUF_SIZE 4096
+#define CODING_OUT_BUF_SIZE ((size_t) (1.2 * CODING_IN_BUF_SIZE))
+
+static const size_t PAYLOAD_SIZES[] = { 512, 4096, 65536, 1024 * 1024 };
+
+#define MAX_PAYLOAD_SIZE (1024 * 1024)
+
+typedef struct {
+    const char *name;
+    int levels[2];
+    /* returns 0 on success */
+    int (*compress)(int level,
+                    const char *data,
+                    size_t size,
+                    uint8_t *out,
+                    size_t *inout_out_size);
+    avs_stream_t *(*create_decoder)(void);
+} codec_t;
+
+#ifdef AVS_COMMONS_HTTP_WITH_ZLIB
+static int zlib_compress(int level,
+                         const char *data,
+                         size_t size,
+                         uint8_t *out,
+                         size_t *inout_out_size) {
+    uLongf out_size = (uLongf) *inout_out_size;
+    if (compress2(out, &out_size, (const Bytef *) data, (uLong) size, level)
+            != Z_OK) {
+        return -1;
+    }
+    *inout_out_size = out_size;
+    return 0;
+}
+
+static avs_stream_t *zlib_create_decoder(void) {
+    return _avs_http_create_decompressor(NULL, HTTP_COMPRESSION_ZLIB,
+                                         HTTP_DECOMPRESSOR_WINDOW_BITS_DEFAULT,
+                                         CODING_IN_BUF_SIZE,
+                                         CODING_OUT_BUF_SIZE);
+}
+#endif // AVS_COMMONS_HTTP_WITH_ZLIB
+
+#ifdef AVS_COMMONS_HTTP_WITH_BROTLI
+static int brotli_compress(int level,
+                           const char *data,
+                           size_t size,
+                           uint8_t *out,
+                           size_t *inout_out_size) {
+    return BrotliEncoderCompress(level, BROTLI_DEFAULT_WINDOW,
+                                 BROTLI_MODE_TEXT, size,
+                                 (const uint8_t *) data, inout_out_size, out)
+                   ? 0
+                   : -1;
+}
+
+static avs_stream_t *brotli_create_decoder(void) {
+    return _avs_http_decompressor_stream_create(&_AVS_HTTP_BROTLI_DECOMPRESSOR,
+                                                CODING_IN_BUF_SIZE,
+                                                CODING_OUT_BUF_SIZE);
+}
+#endif // AVS_COMMONS_HTTP_WITH_BROTLI
+
+#ifdef AVS_COMMONS_HTTP_WITH_ZSTD
+static int zstd_compress(int level,
+                         const char *data,
+                         size_t size,
+                         uint8_t *out,
+                         size_t *inout_out_size) {
+    size_t result = ZSTD_compress(out, *inout_out_size, data, size, level);
+    if (ZSTD_isError(result)) {
+        return -1;
+    }
+    *inout_out_size = result;
+    return 0;
+}
+
+static avs_stream_t *zstd_create_decoder(void) {
+    return _avs_http_decompressor_stream_create(&_AVS_HTTP_ZSTD_DECOMPRESSOR,
+                                                CODING_IN_BUF_SIZE,
+                                                CODING_OUT_BUF_SIZE);
+}
+#endif // AVS_COMMONS_HTTP_WITH_ZSTD
+
+static const codec_t CODECS[] = {
+#ifdef AVS_COMMONS_HTTP_WITH_ZLIB
+    { "deflate", { 6, 9 }, zlib_compress, zlib_create_decoder },
+#endif // AVS_COMMONS_HTTP_WITH_ZLIB
+#ifdef AVS_COMMONS_HTTP_WITH_BROTLI
+    { "br", { 5, 11 }, brotli_compress, brotli_create_decoder },
+#endif // AVS_COMMONS_HTTP_WITH_BROTLI
+#ifdef AVS_COMMONS_HTTP_WITH_ZSTD
+    { "zstd", { 3, 19 }, zstd_compress, zstd_create_decoder },
+#endif // AVS_COMMONS_HTTP_WITH_ZSTD
+    { NULL, { 0, 0 }, NULL, NULL }
+};
+
+static int64_t elapsed_us(avs_time_monotonic_t since) {
+    int64_t result;
+    avs_time_duration_to_scalar(&result, AVS_TIME_US,
+                                avs_time_monotonic_diff(
+                                        avs_time_monotonic_now(), since));
+    return result;
+}
+
+/* fills the buffer with JSON-like records with pseudo-random values */
+static void generate_payload(char *buf, size_t size) {
+    static const char *const STATES[] = { "ok", "warning", "error", "idle" };
+    uint32_t seed = 12345;
+    size_t offset = 0;
+    for (uint64_t ts = 1690000000; offset < size; ts += 15) {
+        char record[160];
+        seed = seed * 1103515245 + 12345;
+        int len = snprintf(record, sizeof(record),
+                           "{\"ts\":%" PRIu64 ",\"id\":\"sensor-%03u\","
+                           "\"temp\":%u.%02u,\"hum\":%u.%u,"
+                           "\"state\":\"%s\"},\n",
+                           ts, (unsigned) (seed >> 8) % 64,
+                           15 + (unsigned) (seed >> 12) % 15,
+                           (unsigned) (seed >> 4) % 100,
+                           30 + (unsigned) (seed >> 16) % 40,
+                           (unsigned) (seed >> 20) % 10,
+                           STATES[(seed >> 24) % AVS_ARRAY_SIZE(STATES)]);
+        size_t to_copy = AVS_MIN((size_t) len, size - offset);
+        memcpy(buf + offset, record, to_copy);
+        offset += to_copy;
+    }
+}
+
+/* feeds the whole compressed data into a new decoder and reads it back */
+static int decode(const codec_t *codec,
+                  const uint8_t *data,
+                  size_t size,
+                  char *out,
+                  size_t out_size,
+                  size_t *out_decoded) {
+    avs_stream_t *decoder = codec->create_decoder();
+    if (!decoder) {
+        return -1;
+    }
+    size_t offset = 0;
+    size_t decoded = 0;
+    bool finished = false;
+    avs_error_t err = AVS_OK;
+    while (avs_is_ok(err) && !finished) {
+        size_t written = size - offset;
+        size_t bytes_read = 0;
+        if (written) {
+            if (avs_is_ok((err = avs_stream_write_some(decoder, data + offset,
+                                                       &written)))
+                    && (offset += written) == size) {
+                err = avs_stream_finish_message(decoder);
+            }
+        }
+        if (avs_is_ok(err)
+                && avs_is_ok((err = avs_stream_read(decoder, &bytes_read,
+                                                    &finished, out + decoded,
+                                                    out_size - decoded)))
+                && !written && !bytes_read && !finished) {
+            err = avs_errno(AVS_EIO);
+        }
+        decoded += bytes_read;
+    }
+    avs_stream_cleanup(&decoder);
+    *out_decoded = decoded;
+    return avs_is_ok(err) ? 0 : -1;
+}
+
+static int bench(const codec_t *codec,
+                 int level,
+                 const char *payload,
+                 size_t payload_size,
+                 size_t total_bytes) {
+    static uint8_t compressed[2 * MAX_PAYLOAD_SIZE];
+    static char decoded[MAX_PAYLOAD_SIZE + 1];
+    size_t compressed_size = sizeof(compressed);
+    if (codec->compress(level, payload, payload_size, compressed,
+                        &compressed_size)) {
+        fprintf(stderr, "%s: compression failed\n", codec->name);
+        return -1;
+    }
+    size_t iterations = AVS_MAX(total_bytes / payload_size, 1);
+    size_t decoded_size = 0;
+    avs_time_monotonic_t start = avs_time_monotonic_now();
+    for (size_t i = 0; i < iterations; ++i) {
+        if (decode(codec, compressed, compressed_size, decoded,
+                   sizeof(decoded), &decoded_size)
+                || decoded_size != payload_size
+                || memcmp(decoded, payload, payload_size)) {
+            fprintf(stderr, "%s: decoding failed\n", codec->name);
+            return -1;
+        }
+    }
+    int64_t us = elapsed_us(start);
+    printf("%-8s level %2d %8zu -> %7zu bytes (%5.1f%%) %8.1f MB/s "
+           "%8.2f us/payload\n",
+           codec->name, level, payload_size, compressed_size,
+           100.0 * (double) compressed_size / (double) payload_size,
+           (double) (iterations * payload_size) / (double) us,
+           (double) us / (double) iterations);
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    unsigned long long total_bytes = DEFAULT_TOTAL_BYTES;
+    if (argc > 2
+            || (argc == 2 && !(total_bytes = strtoull(argv[1], NULL, 0)))) {
+        fprintf(stderr, "usage: %s [TOTAL_BYTES]\n", argv[0]);
+        return 1;
+    }
+    static char payload[MAX_PAYLOAD_SIZE];
+    generate_payload(payload, sizeof(payload));
+    for (size_t i = 0; i < AVS_ARRAY_SIZE(PAYLOAD_SIZES); ++i) {
+        for (const codec_t *codec = CODECS; codec->name; ++codec) {
+            for (size_t j = 0; j < AVS_ARRAY_SIZE(codec->levels); ++j) {
+                if (bench(codec, codec->levels[j], payload, PAYLOAD_SIZES[i],
+                          (size_t) total_bytes)) {
+                    return 1;
+                }
+            }
+        }
+        printf("\n");
+    }
+    return 0;
+}
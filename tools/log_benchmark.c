@@ -0,0 +1,221 @@
+/*
+ * Copyright 2023 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Micro-benchmark of runtime log level checks in avs_log. Built if the project
+ * is configured with -DWITH_BENCHMARKS=ON.
+ *
+ * Usage: log_benchmark [ITERATIONS [MAX_THREADS]]
+ *
+ * Each thread repeatedly issues TRACE-level log statements that are discarded
+ * by the runtime level check, either through the avs_log() macro (which caches
+ * the check result at the call site) or by calling avs_log_should_log__()
+ * directly. Checks are expected to scale linearly with the number of threads,
+ * up to the number of available CPU cores, as long as they do not need to take
+ * any locks.
+ *
+ * Finally, the cost of enqueueing enabled messages in asynchronous mode is
+ * measured, with messages formatted by the logging thread or deferred.
+ */
+
+#include <assert.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define AVS_LOG_WITH_TRACE
+#include <avsystem/commons/avs_log.h>
+#include <avsystem/commons/avs_time.h>
+#include <avsystem/commons/avs_utils.h>
+
+#define DEFAULT_ITERATIONS 10000000
+#define DEFAULT_MAX_THREADS 8
+
+/* Number of modules with explicitly configured levels in the second pass. */
+#define CONFIGURED_MODULES 32
+
+/* Messages enqueued between flushes in the asynchronous mode passes. */
+#define ASYNC_QUEUE_SIZE 4096
+
+typedef struct {
+    size_t (*check)(size_t iterations);
+    size_t iterations;
+    size_t logged;
+} bench_thread_t;
+
+static int64_t elapsed_us(avs_time_monotonic_t since) {
+    int64_t result = 0;
+    avs_time_duration_to_scalar(&result, AVS_TIME_US,
+                                avs_time_monotonic_diff(
+                                        avs_time_monotonic_now(), since));
+    return result;
+}
+
+static size_t check_call_site(size_t iterations) {
+    for (size_t i = 0; i < iterations; ++i) {
+        avs_log(bench, TRACE, "discarded %u", (unsigned) i);
+    }
+    return 0;
+}
+
+static size_t check_should_log(size_t iterations) {
+    size_t logged = 0;
+    for (size_t i = 0; i < iterations; ++i) {
+        if (avs_log_should_log__(AVS_LOG_TRACE, "bench")) {
+            ++logged;
+        }
+    }
+    return logged;
+}
+
+static void *bench_thread(void *arg_) {
+    bench_thread_t *arg = (bench_thread_t *) arg_;
+    arg->logged = arg->check(arg->iterations);
+    return NULL;
+}
+
+static int bench_should_log(const char *name,
+                            size_t (*check)(size_t iterations),
+                            size_t thread_count,
+                            size_t iterations) {
+    pthread_t threads[DEFAULT_MAX_THREADS * 8];
+    bench_thread_t args[DEFAULT_MAX_THREADS * 8];
+    assert(thread_count <= AVS_ARRAY_SIZE(threads));
+
+    avs_time_monotonic_t start = avs_time_monotonic_now();
+    size_t started = 0;
+    for (; started < thread_count; ++started) {
+        args[started].check = check;
+        args[started].iterations = iterations;
+        args[started].logged = 0;
+        if (pthread_create(&threads[started], NULL, bench_thread,
+                           &args[started])) {
+            break;
+        }
+    }
+    int result = (started == thread_count ? 0 : -1);
+    for (size_t i = 0; i < started; ++i) {
+        pthread_join(threads[i], NULL);
+        if (args[i].logged) {
+            result = -1;
+        }
+    }
+    int64_t us = elapsed_us(start);
+    size_t checks = thread_count * iterations;
+    if (!result) {
+        printf("%-30s %2zu thread(s) %12zu checks %10" PRId64
+               " us %8.1f checks/us\n",
+               name, thread_count, checks, us,
+               us ? (double) checks / (double) us : 0.0);
+    }
+    return result;
+}
+
+static void discarding_handler(avs_log_level_t level,
+                               const char *module,
+                               const char *message) {
+    (void) level;
+    (void) module;
+    (void) message;
+}
+
+static int bench_async(const char *name, bool deferred, size_t iterations) {
+    const avs_log_async_config_t config = {
+        .queue_size = ASYNC_QUEUE_SIZE,
+        .overflow_policy = AVS_LOG_ASYNC_OVERFLOW_DROP,
+        .deferred_formatting = deferred
+    };
+    if (avs_log_async_enable(&config)) {
+        return -1;
+    }
+    int64_t us = 0;
+    for (size_t done = 0; done < iterations;) {
+        size_t round = AVS_MIN(iterations - done, (size_t) ASYNC_QUEUE_SIZE);
+        avs_time_monotonic_t start = avs_time_monotonic_now();
+        for (size_t i = 0; i < round; ++i) {
+            avs_log(bench, INFO, "message %u: %s = %d (%.2f%%)",
+                    (unsigned) (done + i), "value", -42, 12.5);
+        }
+        us += elapsed_us(start);
+        // delivery is not measured
+        avs_log_async_flush();
+        done += round;
+    }
+    int result = avs_log_async_dropped_count() ? -1 : 0;
+    avs_log_async_disable();
+    if (!result) {
+        printf("%-30s %12zu messages %10" PRId64 " us %8.2f messages/us\n",
+               name, iterations, us,
+               us ? (double) iterations / (double) us : 0.0);
+    }
+    return result;
+}
+
+int main(int argc, char *argv[]) {
+    size_t iterations = DEFAULT_ITERATIONS;
+    size_t max_threads = DEFAULT_MAX_THREADS;
+    if (argc > 1) {
+        iterations = (size_t) strtoul(argv[1], NULL, 10);
+    }
+    if (argc > 2) {
+        max_threads = (size_t) strtoul(argv[2], NULL, 10);
+    }
+    if (!iterations || !max_threads
+            || max_threads > DEFAULT_MAX_THREADS * 8) {
+        fprintf(stderr, "usage: %s [ITERATIONS [MAX_THREADS]]\n", argv[0]);
+        return 1;
+    }
+
+    for (size_t threads = 1; threads <= max_threads; threads *= 2) {
+        if (bench_should_log("call site, default level", check_call_site,
+                             threads, iterations)
+                || bench_should_log("should_log, default level",
+                                    check_should_log, threads, iterations)) {
+            return 1;
+        }
+    }
+
+    for (int i = 0; i < CONFIGURED_MODULES; ++i) {
+        char module[16];
+        snprintf(module, sizeof(module), "module_%02d", i);
+        if (avs_log_set_level__(module, AVS_LOG_TRACE)) {
+            return 1;
+        }
+    }
+    if (avs_log_set_level__("bench", AVS_LOG_INFO)) {
+        return 1;
+    }
+    for (size_t threads = 1; threads <= max_threads; threads *= 2) {
+        if (bench_should_log("call site, per-module levels", check_call_site,
+                             threads, iterations)
+                || bench_should_log("should_log, per-module levels",
+                                    check_should_log, threads, iterations)) {
+            return 1;
+        }
+    }
+    avs_log_reset();
+
+    avs_log_set_handler(discarding_handler);
+    if (bench_async("async, formatted", false, iterations / 10)
+            || bench_async("async, deferred formatting", true,
+                           iterations / 10)) {
+        return 1;
+    }
+    avs_log_reset();
+    return 0;
+}
@@ -0,0 +1,340 @@
+/*
+ * Copyright 2023 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Micro-benchmark of avs_sched. Built if the project is configured with
+ * -DWITH_BENCHMARKS=ON.
+ *
+ * Usage: sched_benchmark [JOB_COUNT [MAX_THREADS]]
+ *
+ * The contention benchmark runs 1, 2, 4, ... MAX_THREADS threads, each of
+ * which operates on its own scheduler, and reports the aggregate throughput.
+ * Independent schedulers do not share any locks; the results are only
+ * meaningful on a machine with at least MAX_THREADS CPU cores.
+ */
+
+#include <assert.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <avsystem/commons/avs_log.h>
+#include <avsystem/commons/avs_memory.h>
+#include <avsystem/commons/avs_sched.h>
+#include <avsystem/commons/avs_time.h>
+#include <avsystem/commons/avs_utils.h>
+
+#define DEFAULT_JOB_COUNT 1000000
+#define DEFAULT_MAX_THREADS 8
+
+/* Delays are spread over this many milliseconds. */
+#define DELAY_SPREAD_MS 60000
+
+typedef struct {
+    const char *name;
+    avs_sched_config_t config;
+} backend_t;
+
+static const backend_t BACKENDS[] = {
+    { "heap", { .backend = AVS_SCHED_BACKEND_HEAP } },
+    // range of 10 s, most of the jobs end up in the overflow heap
+    { "wheel-10ms-1k",
+      { .backend = AVS_SCHED_BACKEND_TIMING_WHEEL,
+        .wheel_tick = { 0, 10000000 },
+        .wheel_slots = 1024 } },
+    // range of 82 s, all jobs fit in the wheel
+    { "wheel-10ms-8k",
+      { .backend = AVS_SCHED_BACKEND_TIMING_WHEEL,
+        .wheel_tick = { 0, 10000000 },
+        .wheel_slots = 8192 } }
+};
+
+static void noop_job(avs_sched_t *sched, const void *arg) {
+    (void) sched;
+    (void) arg;
+}
+
+static int64_t elapsed_us(avs_time_monotonic_t since) {
+    int64_t result = 0;
+    avs_time_duration_to_scalar(&result, AVS_TIME_US,
+                                avs_time_monotonic_diff(
+                                        avs_time_monotonic_now(), since));
+    return result;
+}
+
+static void
+report(const backend_t *backend, const char *what, size_t count, int64_t us) {
+    printf("%-14s %-30s %10zu ops %10" PRId64 " us %8.1f ns/op\n",
+           backend->name, what, count, us,
+           count ? (double) us * 1000.0 / (double) count : 0.0);
+}
+
+static int schedule_random(avs_sched_t *sched,
+                           avs_sched_handle_t *handles,
+                           size_t count,
+                           avs_rand_seed_t *seed) {
+    for (size_t i = 0; i < count; ++i) {
+        avs_time_duration_t delay = avs_time_duration_from_scalar(
+                1 + avs_rand_r(seed) % DELAY_SPREAD_MS, AVS_TIME_MS);
+        if (AVS_SCHED_DELAYED(sched, handles ? &handles[i] : NULL, delay,
+                              noop_job, NULL, 0)) {
+            fprintf(stderr, "could not schedule job %zu\n", i);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static int bench_schedule_cancel(const backend_t *backend, size_t count) {
+    avs_sched_t *sched =
+            avs_sched_new_with_config("benchmark", NULL, &backend->config);
+    avs_sched_handle_t *handles = (avs_sched_handle_t *) avs_calloc(
+            count, sizeof(avs_sched_handle_t));
+    if (!sched || !handles) {
+        avs_free(handles);
+        avs_sched_cleanup(&sched);
+        return -1;
+    }
+    avs_rand_seed_t seed = 42;
+    int result = 0;
+
+    avs_time_monotonic_t start = avs_time_monotonic_now();
+    if ((result = schedule_random(sched, handles, count, &seed))) {
+        goto finish;
+    }
+    report(backend, "schedule (random delays)", count, elapsed_us(start));
+
+    start = avs_time_monotonic_now();
+    for (size_t i = 0; i < count; ++i) {
+        AVS_RESCHED_DELAYED(&handles[i],
+                            avs_time_duration_from_scalar(
+                                    1 + avs_rand_r(&seed) % DELAY_SPREAD_MS,
+                                    AVS_TIME_MS));
+    }
+    report(backend, "reschedule (random delays)", count, elapsed_us(start));
+
+    start = avs_time_monotonic_now();
+    for (size_t i = 0; i < count; ++i) {
+        // cancel in a scrambled order to hit the middle of the queue
+        avs_sched_del(&handles[(i * 7919) % count]);
+    }
+    report(backend, "cancel (scrambled order)", count, elapsed_us(start));
+
+finish:
+    avs_free(handles);
+    avs_sched_cleanup(&sched);
+    return result;
+}
+
+static int bench_batch(const backend_t *backend, size_t count) {
+    avs_sched_t *sched =
+            avs_sched_new_with_config("benchmark", NULL, &backend->config);
+    avs_sched_handle_t *handles = (avs_sched_handle_t *) avs_calloc(
+            count, sizeof(avs_sched_handle_t));
+    avs_sched_handle_t **handle_ptrs = (avs_sched_handle_t **) avs_calloc(
+            count, sizeof(avs_sched_handle_t *));
+    avs_sched_batch_entry_t *entries = (avs_sched_batch_entry_t *) avs_calloc(
+            count, sizeof(avs_sched_batch_entry_t));
+    avs_rand_seed_t seed = 42;
+    avs_time_monotonic_t now;
+    avs_time_monotonic_t start;
+    int result = -1;
+    if (!sched || !handles || !handle_ptrs || !entries) {
+        goto finish;
+    }
+    now = avs_time_monotonic_now();
+    for (size_t i = 0; i < count; ++i) {
+        avs_time_monotonic_t instant = avs_time_monotonic_add(
+                now, avs_time_duration_from_scalar(
+                             1 + avs_rand_r(&seed) % DELAY_SPREAD_MS,
+                             AVS_TIME_MS));
+        const avs_sched_batch_entry_t entry =
+                AVS_SCHED_BATCH_ENTRY(&handles[i], instant, noop_job, NULL, 0);
+        entries[i] = entry;
+        // cancel in a scrambled order to hit the middle of the queue
+        handle_ptrs[i] = &handles[(i * 7919) % count];
+    }
+
+    start = avs_time_monotonic_now();
+    if ((result = avs_sched_at_batch(sched, entries, count))) {
+        goto finish;
+    }
+    report(backend, "schedule (batch)", count, elapsed_us(start));
+
+    start = avs_time_monotonic_now();
+    avs_sched_del_batch(handle_ptrs, count);
+    report(backend, "cancel (batch)", count, elapsed_us(start));
+
+finish:
+    avs_free(entries);
+    avs_free(handle_ptrs);
+    avs_free(handles);
+    avs_sched_cleanup(&sched);
+    return result;
+}
+
+static int bench_schedule_run(const backend_t *backend, size_t count) {
+    avs_sched_t *sched =
+            avs_sched_new_with_config("benchmark", NULL, &backend->config);
+    if (!sched) {
+        return -1;
+    }
+    avs_rand_seed_t seed = 42;
+    avs_time_monotonic_t now;
+    avs_sched_pool_stats_t stats;
+    int result = 0;
+
+    avs_time_monotonic_t start = avs_time_monotonic_now();
+    for (size_t i = 0; i < count; ++i) {
+        if ((result = AVS_SCHED_NOW(sched, NULL, noop_job, NULL, 0))) {
+            goto finish;
+        }
+    }
+    avs_sched_run(sched);
+    report(backend, "schedule now + run", count, elapsed_us(start));
+
+    // jobs scheduled in the past, so that all of them are due immediately
+    now = avs_time_monotonic_now();
+    for (size_t i = 0; i < count; ++i) {
+        avs_time_monotonic_t instant = avs_time_monotonic_add(
+                now, avs_time_duration_from_scalar(
+                             -1 - avs_rand_r(&seed) % DELAY_SPREAD_MS,
+                             AVS_TIME_MS));
+        if ((result = AVS_SCHED_AT(sched, NULL, instant, noop_job, NULL, 0))) {
+            goto finish;
+        }
+    }
+    start = avs_time_monotonic_now();
+    avs_sched_run(sched);
+    report(backend, "run (random past instants)", count, elapsed_us(start));
+
+    // all job structures are reused from the pool this time
+    start = avs_time_monotonic_now();
+    for (size_t i = 0; i < count; ++i) {
+        if ((result = AVS_SCHED_NOW(sched, NULL, noop_job, NULL, 0))) {
+            goto finish;
+        }
+    }
+    avs_sched_run(sched);
+    report(backend, "schedule now + run (pooled)", count, elapsed_us(start));
+
+    avs_sched_pool_stats(sched, &stats);
+    printf("%-14s job pool: %" PRIu64 " hits, %" PRIu64 " misses\n",
+           backend->name, stats.hits, stats.misses);
+
+finish:
+    avs_sched_cleanup(&sched);
+    return result;
+}
+
+typedef struct {
+    size_t iterations;
+    int result;
+} contention_thread_t;
+
+static void *contention_thread(void *arg) {
+    contention_thread_t *thread = (contention_thread_t *) arg;
+    avs_sched_t *sched = avs_sched_new("contention", NULL);
+    if (!sched) {
+        thread->result = -1;
+        return NULL;
+    }
+    avs_rand_seed_t seed = (avs_rand_seed_t) (uintptr_t) thread;
+    for (size_t i = 0; i < thread->iterations; ++i) {
+        avs_sched_handle_t handle = NULL;
+        avs_time_duration_t delay = avs_time_duration_from_scalar(
+                1 + avs_rand_r(&seed) % DELAY_SPREAD_MS, AVS_TIME_MS);
+        if (AVS_SCHED_DELAYED(sched, &handle, delay, noop_job, NULL, 0)
+                || AVS_RESCHED_NOW(&handle)) {
+            thread->result = -1;
+            break;
+        }
+        if (i % 2) {
+            avs_sched_del(&handle);
+        } else {
+            avs_sched_run(sched);
+        }
+    }
+    avs_sched_cleanup(&sched);
+    return NULL;
+}
+
+/**
+ * Each of @p thread_count threads performs @p count iterations of
+ * schedule + reschedule + cancel/run on its own scheduler.
+ */
+static int bench_contention(size_t thread_count, size_t count) {
+    pthread_t threads[DEFAULT_MAX_THREADS * 8];
+    contention_thread_t args[DEFAULT_MAX_THREADS * 8];
+    assert(thread_count <= AVS_ARRAY_SIZE(threads));
+
+    avs_time_monotonic_t start = avs_time_monotonic_now();
+    size_t started = 0;
+    for (; started < thread_count; ++started) {
+        args[started].iterations = count;
+        args[started].result = 0;
+        if (pthread_create(&threads[started], NULL, contention_thread,
+                           &args[started])) {
+            break;
+        }
+    }
+    int result = (started == thread_count ? 0 : -1);
+    for (size_t i = 0; i < started; ++i) {
+        pthread_join(threads[i], NULL);
+        if (args[i].result) {
+            result = -1;
+        }
+    }
+    int64_t us = elapsed_us(start);
+    if (!result) {
+        printf("contention     %2zu thread(s) %19zu ops %10" PRId64
+               " us %8.1f ops/us\n",
+               thread_count, thread_count * count, us,
+               us ? (double) (thread_count * count) / (double) us : 0.0);
+    }
+    return result;
+}
+
+int main(int argc, char *argv[]) {
+    size_t count = DEFAULT_JOB_COUNT;
+    size_t max_threads = DEFAULT_MAX_THREADS;
+    if (argc > 1) {
+        count = (size_t) strtoul(argv[1], NULL, 10);
+    }
+    if (argc > 2) {
+        max_threads = (size_t) strtoul(argv[2], NULL, 10);
+    }
+    if (!count || !max_threads || max_threads > DEFAULT_MAX_THREADS * 8) {
+        fprintf(stderr, "usage: %s [JOB_COUNT [MAX_THREADS]]\n", argv[0]);
+        return 1;
+    }
+    avs_log_set_default_level(AVS_LOG_QUIET);
+
+    for (size_t i = 0; i < AVS_ARRAY_SIZE(BACKENDS); ++i) {
+        if (bench_schedule_cancel(&BACKENDS[i], count)
+                || bench_batch(&BACKENDS[i], count)
+                || bench_schedule_run(&BACKENDS[i], count)) {
+            return 1;
+        }
+    }
+    for (size_t threads = 1; threads <= max_threads; threads *= 2) {
+        if (bench_contention(threads, count)) {
+            return 1;
+        }
+    }
+    return 0;
+}